@@ -79,8 +79,14 @@ ApplicationWindow {
     id: integrator
     onFinishedIntegration: {
       progressPopup.close();
+      previewImage.source = "";
       imagePopup.open();
     }
+    onPreviewAvailable: {
+      // reset the source to reload the new preview
+      previewImage.source = "";
+      previewImage.source = "file:///" + applicationDirPath + "/last_preview.png";
+    }
   }
 
   Popup {
@@ -109,6 +115,17 @@ ApplicationWindow {
     closePolicy: Popup.NoAutoClose
 
     ColumnLayout {
+      Image {
+        id: previewImage
+        Layout.alignment: Qt.AlignHCenter
+        Layout.maximumWidth: 512
+        Layout.maximumHeight: 512
+        visible: source != ""
+        fillMode: Image.PreserveAspectFit
+        // turn cache off to enable loading new previews by setting source = ""
+        cache: false
+        smooth: false
+      }
       ProgressBar {
         Layout.alignment: Qt.AlignHCenter
         from: integrator.progressMinimum
@@ -29,12 +29,17 @@ import QtQuick.Layouts 1.3
 
 GridLayout {
   columns: 2
-  rows: 5
+  rows: 20
   rowSpacing: 3
 
   property bool isValid: startingStepSizeField.acceptableInput && maximumStepSizeField.acceptableInput &&
                          relativeTolField.acceptableInput && absoluteTolField.acceptableInput &&
-                         threadCountField.acceptableInput;
+                         threadCountField.acceptableInput && checkpointIntervalField.acceptableInput &&
+                         trialBudgetField.acceptableInput && timeBudgetField.acceptableInput &&
+                         firstPassTrialBudgetField.acceptableInput && cellMapPositionCountField.acceptableInput &&
+                         cellMapVelocityCountField.acceptableInput && cellMapTimeField.acceptableInput &&
+                         fateCachePositionSizeField.acceptableInput && fateCacheVelocitySizeField.acceptableInput &&
+                         fateCacheConfidenceField.acceptableInput;
 
   LabelWithHoverToolTip {
     Layout.row: 0
@@ -47,6 +52,7 @@ GridLayout {
     id: startingStepSizeField
     Layout.row: 0
     Layout.column: 1
+    enabled: !ModelsRepo.integratorModel.estimateStartingStepSize
     bindedModelValue: ModelsRepo.integratorModel.startingStepSize
     onTextAsDoubleChanged: ModelsRepo.integratorModel.startingStepSize = textAsDouble
   }
@@ -110,5 +116,253 @@ GridLayout {
     bindedModelValue: ModelsRepo.integratorModel.threadCount
     onTextAsDoubleChanged: ModelsRepo.integratorModel.threadCount = textAsDouble
   }
-}
 
+  LabelWithHoverToolTip {
+    Layout.row: 5
+    Layout.column: 0
+    text: "Integrator:"
+    toolTipText: "Adaptive step Runge Kutta method used to integrate the points."
+  }
+
+  ComboBox {
+    id: integratorTypeComboBox
+    Layout.row: 5
+    Layout.column: 1
+    Layout.fillWidth: true
+    // order matches IntegratorModel::IntegratorType
+    model: ["Cash-Karp 5(4)", "Dormand-Prince 5(4)", "Bogacki-Shampine 3(2)",
+            "Verner 6(5)", "Dormand-Prince 8(5,3)", "Rosenbrock 2(3)"]
+    currentIndex: ModelsRepo.integratorModel.integratorType
+    onActivated: ModelsRepo.integratorModel.integratorType = index
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 6
+    Layout.column: 0
+    text: "Step Size Controller:"
+    toolTipText: "Controls how the step size is adjusted between steps, the proportional integral controller " +
+                 "remembers the previous error to avoid rejected steps."
+  }
+
+  ComboBox {
+    id: stepControllerTypeComboBox
+    Layout.row: 6
+    Layout.column: 1
+    Layout.fillWidth: true
+    // order matches IntegratorModel::StepControllerType
+    model: ["Elementary", "Proportional Integral"]
+    currentIndex: ModelsRepo.integratorModel.stepControllerType
+    onActivated: ModelsRepo.integratorModel.stepControllerType = index
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 7
+    Layout.column: 0
+    text: "Estimate Starting Step:"
+    toolTipText: "Estimate the starting step size of every point from the tolerances instead of using the " +
+                 "starting step size."
+  }
+
+  CheckBox {
+    id: estimateStartingStepSizeCheckBox
+    Layout.row: 7
+    Layout.column: 1
+    checked: ModelsRepo.integratorModel.estimateStartingStepSize
+    onClicked: ModelsRepo.integratorModel.estimateStartingStepSize = checked
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 8
+    Layout.column: 0
+    text: "Stiffness Switching:"
+    toolTipText: "Switch trajectories between the integrator and the implicit Rosenbrock 2(3) integrator when " +
+                 "stiffness is detected, integrates points one at a time."
+  }
+
+  CheckBox {
+    id: stiffnessSwitchingCheckBox
+    Layout.row: 8
+    Layout.column: 1
+    enabled: integratorTypeComboBox.currentText !== "Rosenbrock 2(3)"
+    checked: ModelsRepo.integratorModel.stiffnessSwitching
+    onClicked: ModelsRepo.integratorModel.stiffnessSwitching = checked
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 9
+    Layout.column: 0
+    text: "Cost Model:"
+    toolTipText: "Predicts the cost of the points to schedule expensive areas first and in smaller pieces, " +
+                 "from the step counts of the previous run or of a coarse pass integrating 1 in 64 points first."
+  }
+
+  ComboBox {
+    id: costModelTypeComboBox
+    Layout.row: 9
+    Layout.column: 1
+    Layout.fillWidth: true
+    // order matches IntegratorModel::CostModelType
+    model: ["Uniform", "Previous Run", "Coarse Pre-pass"]
+    currentIndex: ModelsRepo.integratorModel.costModelType
+    onActivated: ModelsRepo.integratorModel.costModelType = index
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 10
+    Layout.column: 0
+    text: "Checkpoint Interval:"
+    toolTipText: "Seconds between appending the finished points to last_integrated.checkpoint next to the application. " +
+                 "Integrating again with the same parameters (after a cancel or a crash) only integrates the unfinished points. " +
+                 "Not used with the progressive rendering, rectangle fill, symmetry reduction or disk memory budget. 0 turns off checkpoints."
+  }
+
+  TextFieldWithNumericValidation {
+    id: checkpointIntervalField
+    Layout.row: 10
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.checkpointInterval
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.checkpointInterval = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 11
+    Layout.column: 0
+    text: "Trial Budget:"
+    toolTipText: "Integration steps a point may take to converge before it is marked unresolved and drawn in the unresolved color."
+  }
+
+  TextFieldWithNumericValidation {
+    id: trialBudgetField
+    Layout.row: 11
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.trialBudget
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.trialBudget = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 12
+    Layout.column: 0
+    text: "Time Budget:"
+    toolTipText: "Seconds a point may take to converge before it is marked unresolved, so a few slow points do not hold up the whole map. 0 for no limit."
+  }
+
+  TextFieldWithNumericValidation {
+    id: timeBudgetField
+    Layout.row: 12
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.timeBudget
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.timeBudget = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 13
+    Layout.column: 0
+    text: "First Pass Trial Budget:"
+    toolTipText: "Integrate every point with this many steps first and show the image, then continue the points left " +
+                 "unresolved from where they stopped up to the trial budget. 0 integrates in a single pass. " +
+                 "Not used with the progressive rendering, rectangle fill, symmetry reduction, disk memory budget or checkpoints."
+  }
+
+  TextFieldWithNumericValidation {
+    id: firstPassTrialBudgetField
+    Layout.row: 13
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.firstPassTrialBudget
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.firstPassTrialBudget = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 14
+    Layout.column: 0
+    text: "Cell Map Position Cells:"
+    toolTipText: "Fill the map from a cell mapping of the phase space with this many position cells per side instead " +
+                 "of integrating every point, worthwhile for large or repeated maps of smooth basins. The cells are " +
+                 "reused until the system or integrator changes. 0 integrates every point."
+  }
+
+  TextFieldWithNumericValidation {
+    id: cellMapPositionCountField
+    Layout.row: 14
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.cellMapPositionCount
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.cellMapPositionCount = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 15
+    Layout.column: 0
+    text: "Cell Map Velocity Cells:"
+    toolTipText: "Velocity cells per side of the cell mapping (rounded up to an odd count)."
+  }
+
+  TextFieldWithNumericValidation {
+    id: cellMapVelocityCountField
+    Layout.row: 15
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.cellMapVelocityCount
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.cellMapVelocityCount = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 16
+    Layout.column: 0
+    text: "Cell Map Time:"
+    toolTipText: "Time the center of every cell is integrated for to find the cell it maps to."
+  }
+
+  TextFieldWithNumericValidation {
+    id: cellMapTimeField
+    Layout.row: 16
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.cellMapTime
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.cellMapTime = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 17
+    Layout.column: 0
+    text: "Fate Cache Position Size:"
+    toolTipText: "Position size of the phase space cells whose fate is shared between the points being integrated, " +
+                 "a point stops as soon as it reaches a cell other points resolved. Larger cells give more hits and " +
+                 "more misclassified points near basin boundaries. 0 integrates every point to convergence."
+  }
+
+  TextFieldWithNumericValidation {
+    id: fateCachePositionSizeField
+    Layout.row: 17
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.fateCachePositionSize
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.fateCachePositionSize = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 18
+    Layout.column: 0
+    text: "Fate Cache Velocity Size:"
+    toolTipText: "Velocity size of the phase space cells of the fate cache."
+  }
+
+  TextFieldWithNumericValidation {
+    id: fateCacheVelocitySizeField
+    Layout.row: 18
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.fateCacheVelocitySize
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.fateCacheVelocitySize = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 19
+    Layout.column: 0
+    text: "Fate Cache Confidence:"
+    toolTipText: "Number of agreeing trajectories a cell needs before points stop on it, " +
+                 "a cell with disagreeing trajectories is never used."
+  }
+
+  TextFieldWithNumericValidation {
+    id: fateCacheConfidenceField
+    Layout.row: 19
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.integratorModel.fateCacheConfidence
+    onTextAsDoubleChanged: ModelsRepo.integratorModel.fateCacheConfidence = textAsDouble
+  }
+}
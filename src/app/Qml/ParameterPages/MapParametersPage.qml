@@ -24,17 +24,20 @@
 import CommonControls 1.0
 import ModelsRepo 1.0
 import QtQuick 2.7
+import QtQuick.Controls 2.0
 import QtQuick.Layouts 1.3
 
 GridLayout {
   columns: 2
-  rows: 8
+  rows: 13
   rowSpacing: 3
 
   property bool isValid: xStartField.acceptableInput && yStartField.acceptableInput &&
                          xEndField.acceptableInput && yEndField.acceptableInput &&
                          resolutionField.acceptableInput && attractorPosThresholdField.acceptableInput &&
-                         midPosThresholdField.acceptableInput && convergeTimeThresholdField.acceptableInput
+                         midPosThresholdField.acceptableInput && convergeTimeThresholdField.acceptableInput &&
+                         minimumFillSizeField.acceptableInput && supersampleCountField.acceptableInput &&
+                         diskMemoryBudgetField.acceptableInput
 
   LabelWithHoverToolTip {
     Layout.row: 0
@@ -155,4 +158,85 @@ GridLayout {
     bindedModelValue: ModelsRepo.pendulumMapModel.convergeTimeThreshold
     onTextAsDoubleChanged: ModelsRepo.pendulumMapModel.convergeTimeThreshold = textAsDouble
   }
+
+  LabelWithHoverToolTip {
+    Layout.row: 8
+    Layout.column: 0
+    text: "Minimum Fill Size:"
+    toolTipText: "Integrate only the border of rectangles and fill the inside when the whole border converges to the same attractor, rectangles this many points wide or smaller are integrated fully. 0 integrates every point."
+  }
+
+  TextFieldWithNumericValidation {
+    id: minimumFillSizeField
+    Layout.row: 8
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.pendulumMapModel.minimumFillSize
+    onTextAsDoubleChanged: ModelsRepo.pendulumMapModel.minimumFillSize = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 9
+    Layout.column: 0
+    text: "Boundary Supersamples:"
+    toolTipText: "Integrate this many x this many subsamples of the points on a boundary between basins and blend their colors, anti aliasing the image. 0 or 1 turns off supersampling, at most 8."
+  }
+
+  TextFieldWithNumericValidation {
+    id: supersampleCountField
+    Layout.row: 9
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.pendulumMapModel.supersampleCount
+    onTextAsDoubleChanged: ModelsRepo.pendulumMapModel.supersampleCount = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 10
+    Layout.column: 0
+    text: "Progressive Rendering:"
+    toolTipText: "Integrate every 16th point first and halve the spacing until every point is integrated, " +
+                 "showing an upscaled preview after each pass. Replaces the rectangle fill, the symmetry reduction and the cost model."
+  }
+
+  CheckBox {
+    id: progressiveRenderingCheckBox
+    Layout.row: 10
+    Layout.column: 1
+    checked: ModelsRepo.pendulumMapModel.progressiveRendering
+    onClicked: ModelsRepo.pendulumMapModel.progressiveRendering = checked
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 11
+    Layout.column: 0
+    text: "Symmetry Reduction:"
+    toolTipText: "Integrate only one of the points related by a rotation or reflection of the attractors and fill " +
+                 "the others, helps for symmetries mapping the map grid onto itself (quarter turns, reflections " +
+                 "about the axes and diagonals). Replaces the cost model, not used with the rectangle fill."
+  }
+
+  CheckBox {
+    id: symmetryReductionCheckBox
+    Layout.row: 11
+    Layout.column: 1
+    checked: ModelsRepo.pendulumMapModel.symmetryReduction
+    onClicked: ModelsRepo.pendulumMapModel.symmetryReduction = checked
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 12
+    Layout.column: 0
+    text: "Disk Memory Budget (MiB):"
+    toolTipText: "Write the map results to tiles of a memory mapped file next to the application instead of memory, " +
+                 "keeping about this much in memory, for maps too large to hold (100k x 100k points take 100 GB of disk). " +
+                 "The image is written as last_integrated.ppm with a downscaled last_integrated.png. " +
+                 "Integrates every point, ignores the progressive rendering, rectangle fill, symmetry reduction and supersampling. 0 keeps the map in memory."
+  }
+
+  TextFieldWithNumericValidation {
+    id: diskMemoryBudgetField
+    Layout.row: 12
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.pendulumMapModel.diskMemoryBudget
+    onTextAsDoubleChanged: ModelsRepo.pendulumMapModel.diskMemoryBudget = textAsDouble
+  }
 }
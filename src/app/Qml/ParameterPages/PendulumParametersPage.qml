@@ -29,12 +29,13 @@ import QtQuick.Layouts 1.3
 
 GridLayout {
   columns: 2
-  rows: 5
+  rows: 8
   rowSpacing: 3
 
   property bool isValid: distanceField.acceptableInput && massField.acceptableInput &&
                          gravityField.acceptableInput && dragField.acceptableInput &&
-                         lengthField.acceptableInput;
+                         lengthField.acceptableInput && openingAngleField.acceptableInput &&
+                         forceTableMemoryBudgetField.acceptableInput;
 
   LabelWithHoverToolTip {
     Layout.row: 0
@@ -110,4 +111,51 @@ GridLayout {
     bindedModelValue: ModelsRepo.pendulumSystemModel.length
     onTextAsDoubleChanged: ModelsRepo.pendulumSystemModel.length = textAsDouble
   }
+
+  LabelWithHoverToolTip {
+    Layout.row: 5
+    Layout.column: 0
+    text: "Opening Angle:"
+    toolTipText: "Barnes-Hut accuracy parameter for systems with many attractors, distant groups of attractors smaller than this ratio of their distance are summed as one. 0 sums every attractor exactly."
+  }
+
+  TextFieldWithNumericValidation {
+    id: openingAngleField
+    Layout.row: 5
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.pendulumSystemModel.openingAngle
+    onTextAsDoubleChanged: ModelsRepo.pendulumSystemModel.openingAngle = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 6
+    Layout.column: 0
+    text: "Force Table Memory (MiB):"
+    toolTipText: "Memory budget for sampling the force field once onto a grid that is interpolated during integration, worthwhile for many attractors. 0 evaluates the force exactly."
+  }
+
+  TextFieldWithNumericValidation {
+    id: forceTableMemoryBudgetField
+    Layout.row: 6
+    Layout.column: 1
+    bindedModelValue: ModelsRepo.pendulumSystemModel.forceTableMemoryBudget
+    onTextAsDoubleChanged: ModelsRepo.pendulumSystemModel.forceTableMemoryBudget = textAsDouble
+  }
+
+  LabelWithHoverToolTip {
+    Layout.row: 7
+    Layout.column: 0
+    text: "Energy Capture:"
+    toolTipText: "Stop integrating a point as soon as its energy is well below the level needed to leave the " +
+                 "potential well of an attractor instead of waiting for the converge time. A heuristic, the " +
+                 "attractor force is not exactly conservative and points may rarely be misclassified."
+  }
+
+  CheckBox {
+    id: energyCaptureCheckBox
+    Layout.row: 7
+    Layout.column: 1
+    checked: ModelsRepo.pendulumSystemModel.energyCapture
+    onClicked: ModelsRepo.pendulumSystemModel.energyCapture = checked
+  }
 }
@@ -0,0 +1,90 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace staticpendulum {
+/*!
+ * @brief Minimal standard allocator returning storage aligned to Alignment
+ *bytes, used for arrays that are loaded into vector registers.
+ *
+ * The block is over allocated and the pointer returned by operator new is
+ *stored just before the aligned storage so it can be released again.
+ * @tparam T The allocated type.
+ * @tparam Alignment The alignment in bytes, a power of two.
+ */
+template <typename T, std::size_t Alignment> struct AlignedAllocator {
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "alignment must be a power of two");
+  static_assert(Alignment >= alignof(void *),
+                "alignment must be at least the alignment of a pointer");
+
+  typedef T value_type;
+
+  template <typename U> struct rebind {
+    typedef AlignedAllocator<U, Alignment> other;
+  };
+
+  AlignedAllocator() = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+  T *allocate(std::size_t count) {
+    if (count > (static_cast<std::size_t>(-1) - Alignment - sizeof(void *)) /
+                    sizeof(T)) {
+      throw std::bad_alloc();
+    }
+
+    void *block = ::operator new(count * sizeof(T) + Alignment +
+                                 sizeof(void *));
+    const std::uintptr_t address =
+        reinterpret_cast<std::uintptr_t>(block) + sizeof(void *);
+    void *aligned = reinterpret_cast<void *>(
+        (address + Alignment - 1) & ~(std::uintptr_t(Alignment) - 1));
+    static_cast<void **>(aligned)[-1] = block;
+    return static_cast<T *>(aligned);
+  }
+
+  void deallocate(T *pointer, std::size_t) {
+    ::operator delete(reinterpret_cast<void **>(pointer)[-1]);
+  }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator==(const AlignedAllocator<T, Alignment> &,
+                       const AlignedAllocator<U, Alignment> &) {
+  return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T, Alignment> &,
+                       const AlignedAllocator<U, Alignment> &) {
+  return false;
+}
+} // namespace staticpendulum
+#endif // ALIGNEDALLOCATOR_H
@@ -0,0 +1,127 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "attractorgrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace staticpendulum {
+constexpr std::size_t AttractorGrid::minimumAttractorCount;
+constexpr std::size_t AttractorGrid::maximumCellsPerAttractor;
+
+void AttractorGrid::build(double cellSize) {
+  if (m_xPositions.empty())
+    return;
+
+  const auto xRange =
+      std::minmax_element(m_xPositions.begin(), m_xPositions.end());
+  const auto yRange =
+      std::minmax_element(m_yPositions.begin(), m_yPositions.end());
+  const double width = *xRange.second - *xRange.first;
+  const double height = *yRange.second - *yRange.first;
+  m_xOrigin = *xRange.first;
+  m_yOrigin = *yRange.first;
+
+  // enlarge the cells until the grid fits its cell budget
+  const double maximumCellCount = static_cast<double>(
+      maximumCellsPerAttractor * m_xPositions.size());
+  m_cellSize = cellSize > 0.0 ? cellSize : 1.0;
+  while ((std::floor(width / m_cellSize) + 1.0) *
+             (std::floor(height / m_cellSize) + 1.0) >
+         maximumCellCount) {
+    m_cellSize *= 2.0;
+  }
+  m_columnCount = static_cast<std::size_t>(width / m_cellSize) + 1;
+  m_rowCount = static_cast<std::size_t>(height / m_cellSize) + 1;
+
+  // count the attractors per cell, then fill the cells in index order
+  auto cellOf = [this](std::size_t i) {
+    const auto column = std::min(
+        static_cast<std::size_t>((m_xPositions[i] - m_xOrigin) / m_cellSize),
+        m_columnCount - 1);
+    const auto row = std::min(
+        static_cast<std::size_t>((m_yPositions[i] - m_yOrigin) / m_cellSize),
+        m_rowCount - 1);
+    return row * m_columnCount + column;
+  };
+  m_cellStarts.assign(m_columnCount * m_rowCount + 1, 0);
+  for (std::size_t i = 0; i < m_xPositions.size(); ++i) {
+    ++m_cellStarts[cellOf(i) + 1];
+  }
+  for (std::size_t cell = 0; cell + 1 < m_cellStarts.size(); ++cell) {
+    m_cellStarts[cell + 1] += m_cellStarts[cell];
+  }
+  m_indices.resize(m_xPositions.size());
+  std::vector<std::uint32_t> filled(m_cellStarts.begin(),
+                                    m_cellStarts.end() - 1);
+  for (std::size_t i = 0; i < m_xPositions.size(); ++i) {
+    m_indices[filled[cellOf(i)]++] = static_cast<std::uint32_t>(i);
+  }
+}
+
+int AttractorGrid::nearAttractor(double x, double y, double threshold) const {
+  if (m_indices.empty())
+    return -1;
+
+  // range of cells overlapping the square around the point, clamped to the
+  // grid (the boundary cells hold no attractor beyond the grid)
+  auto cellRange = [this](double low, double high, double origin,
+                          std::size_t count, std::size_t &first,
+                          std::size_t &last) {
+    const double lowCell = std::floor((low - origin) / m_cellSize);
+    const double highCell = std::floor((high - origin) / m_cellSize);
+    const auto lastCell = static_cast<double>(count - 1);
+    if (!(highCell >= 0.0 && lowCell <= lastCell))
+      return false;
+
+    first = static_cast<std::size_t>(std::max(lowCell, 0.0));
+    last = static_cast<std::size_t>(std::min(highCell, lastCell));
+    return true;
+  };
+  std::size_t firstColumn, lastColumn, firstRow, lastRow;
+  if (!cellRange(x - threshold, x + threshold, m_xOrigin, m_columnCount,
+                 firstColumn, lastColumn) ||
+      !cellRange(y - threshold, y + threshold, m_yOrigin, m_rowCount,
+                 firstRow, lastRow))
+    return -1;
+
+  std::uint32_t nearest = static_cast<std::uint32_t>(m_indices.size());
+  for (std::size_t row = firstRow; row <= lastRow; ++row) {
+    for (std::size_t column = firstColumn; column <= lastColumn; ++column) {
+      const std::size_t cell = row * m_columnCount + column;
+      for (std::uint32_t i = m_cellStarts[cell];
+           i < m_cellStarts[cell + 1] && m_indices[i] < nearest; ++i) {
+        // the comparisons of isNearAttractor, so both agree to the last bit
+        const std::uint32_t index = m_indices[i];
+        const double xPosition = m_xPositions[index];
+        const double yPosition = m_yPositions[index];
+        if (xPosition - threshold < x && x < xPosition + threshold &&
+            yPosition - threshold < y && y < yPosition + threshold)
+          nearest = index;
+      }
+    }
+  }
+
+  return nearest == m_indices.size() ? -1 : static_cast<int>(nearest);
+}
+} // namespace staticpendulum
@@ -0,0 +1,93 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef ATTRACTORGRID_H
+#define ATTRACTORGRID_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace staticpendulum {
+/*!
+ * @brief Uniform grid over the attractor positions, finds the attractor the
+ *pendulum head is near without testing every attractor.
+ *
+ * The bounding square of the attractors is divided into square cells of
+ *cellSize and every cell lists the attractors inside it in increasing index
+ *order. A query for the attractors whose zone (the square of half side
+ *threshold around it, see isNearAttractor) holds a point visits the cells
+ *overlapping the square of half side threshold around the point, at most 4
+ *cells when the cell size is twice the threshold. The answer does not depend
+ *on the cell size, only the number of visited cells does.
+ *
+ * The grid copies the attractor positions, it has to be rebuilt when they
+ *change.
+ */
+class AttractorGrid {
+public:
+  /// Attractor count from which the grid is faster than testing every
+  /// attractor.
+  static constexpr std::size_t minimumAttractorCount = 8;
+  /// Largest number of cells per attractor, a smaller cell size is enlarged.
+  static constexpr std::size_t maximumCellsPerAttractor = 16;
+
+  /*!
+   * @param[in] attractorList Range of attractors with xPosition and yPosition
+   *members, e.g. PendulumSystem::attractorList.
+   * @param[in] cellSize Side of the cells, twice the attractor position
+   *threshold keeps queries at 4 cells.
+   */
+  template <typename AttractorList>
+  AttractorGrid(const AttractorList &attractorList, double cellSize) {
+    for (const auto &attractor : attractorList) {
+      m_xPositions.push_back(attractor.xPosition);
+      m_yPositions.push_back(attractor.yPosition);
+    }
+    build(cellSize);
+  }
+
+  double cellSize() const { return m_cellSize; }
+  std::size_t cellCount() const { return m_cellStarts.size() - 1; }
+
+  /// Lowest index of the attractors whose zone of half side threshold holds
+  /// (x, y), -1 if there is none. The same attractor as testing every one of
+  /// them in order with isNearAttractor.
+  int nearAttractor(double x, double y, double threshold) const;
+
+private:
+  void build(double cellSize);
+
+  double m_cellSize = 1.0;
+  double m_xOrigin = 0.0;
+  double m_yOrigin = 0.0;
+  std::size_t m_columnCount = 0;
+  std::size_t m_rowCount = 0;
+  // attractor indices of cell i are m_indices[m_cellStarts[i]] up to
+  // m_indices[m_cellStarts[i + 1]], cells in rows of increasing y
+  std::vector<std::uint32_t> m_cellStarts{0};
+  std::vector<std::uint32_t> m_indices;
+  std::vector<double> m_xPositions;
+  std::vector<double> m_yPositions;
+};
+} // namespace staticpendulum
+#endif // ATTRACTORGRID_H
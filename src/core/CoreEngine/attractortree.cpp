@@ -0,0 +1,148 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "attractortree.h"
+#include <algorithm>
+#include <numeric>
+
+namespace staticpendulum {
+void AttractorTree::build() {
+  if (m_forceCoeffs.empty())
+    return;
+
+  const auto xRange =
+      std::minmax_element(m_xPositions.begin(), m_xPositions.end());
+  const auto yRange =
+      std::minmax_element(m_yPositions.begin(), m_yPositions.end());
+  const double size = std::max(*xRange.second - *xRange.first,
+                               *yRange.second - *yRange.first);
+
+  // build over an index permutation, the attractors are reordered to match it
+  // once the tree is complete
+  std::vector<std::uint32_t> order(m_forceCoeffs.size());
+  std::iota(order.begin(), order.end(), 0);
+  m_nodes.emplace_back();
+  m_nodes[0].first = 0;
+  m_nodes[0].last = static_cast<std::uint32_t>(order.size());
+  buildNode(order, 0, *xRange.first, *yRange.first, size, 0);
+
+  auto reorder = [&order](std::vector<double> &values) {
+    std::vector<double> reordered(values.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      reordered[i] = values[order[i]];
+    }
+    values.swap(reordered);
+  };
+  reorder(m_xPositions);
+  reorder(m_yPositions);
+  reorder(m_forceCoeffs);
+}
+
+void AttractorTree::buildNode(std::vector<std::uint32_t> &order,
+                              std::uint32_t nodeIndex, double xMin,
+                              double yMin, double size, std::size_t depth) {
+  const std::uint32_t first = m_nodes[nodeIndex].first;
+  const std::uint32_t last = m_nodes[nodeIndex].last;
+
+  // weight the center by the coefficient magnitudes so it stays inside the
+  // node square when coefficients of both signs are present
+  double weightSum = 0.0;
+  double xWeighted = 0.0;
+  double yWeighted = 0.0;
+  double forceCoeffSum = 0.0;
+  for (std::uint32_t i = first; i < last; ++i) {
+    const double weight = std::abs(m_forceCoeffs[order[i]]);
+    weightSum += weight;
+    xWeighted += weight * m_xPositions[order[i]];
+    yWeighted += weight * m_yPositions[order[i]];
+    forceCoeffSum += m_forceCoeffs[order[i]];
+  }
+
+  Node &node = m_nodes[nodeIndex];
+  node.xCenter = weightSum > 0.0 ? xWeighted / weightSum : xMin + 0.5 * size;
+  node.yCenter = weightSum > 0.0 ? yWeighted / weightSum : yMin + 0.5 * size;
+  node.forceCoeff = forceCoeffSum;
+  node.xDipole = 0.0;
+  node.yDipole = 0.0;
+  node.xxQuadrupole = 0.0;
+  node.xyQuadrupole = 0.0;
+  node.yyQuadrupole = 0.0;
+  for (std::uint32_t i = first; i < last; ++i) {
+    const double forceCoeff = m_forceCoeffs[order[i]];
+    const double dx = m_xPositions[order[i]] - node.xCenter;
+    const double dy = m_yPositions[order[i]] - node.yCenter;
+    const double squaredOffset = dx * dx + dy * dy;
+    node.xDipole += forceCoeff * dx;
+    node.yDipole += forceCoeff * dy;
+    node.xxQuadrupole += forceCoeff * (3.0 * dx * dx - squaredOffset);
+    node.xyQuadrupole += forceCoeff * 3.0 * dx * dy;
+    node.yyQuadrupole += forceCoeff * (3.0 * dy * dy - squaredOffset);
+  }
+  node.size = size;
+  node.firstChild = 0;
+  node.childCount = 0;
+
+  if (last - first <= leafSize || depth == maximumDepth || size == 0.0)
+    return;
+
+  // split into the four quadrants, bottom half first then left half first
+  const double halfSize = 0.5 * size;
+  const double xMid = xMin + halfSize;
+  const double yMid = yMin + halfSize;
+  auto isBelow = [&](std::uint32_t i) { return m_yPositions[i] < yMid; };
+  auto isLeft = [&](std::uint32_t i) { return m_xPositions[i] < xMid; };
+  const auto begin = order.begin();
+  const auto yMidIter = std::partition(begin + first, begin + last, isBelow);
+  const auto bottomMidIter = std::partition(begin + first, yMidIter, isLeft);
+  const auto topMidIter = std::partition(yMidIter, begin + last, isLeft);
+
+  const std::array<std::uint32_t, 5> bounds = {
+      {first, static_cast<std::uint32_t>(bottomMidIter - begin),
+       static_cast<std::uint32_t>(yMidIter - begin),
+       static_cast<std::uint32_t>(topMidIter - begin), last}};
+  const std::array<double, 4> xMins = {{xMin, xMid, xMin, xMid}};
+  const std::array<double, 4> yMins = {{yMin, yMin, yMid, yMid}};
+
+  // children are allocated together before recursing so they are contiguous
+  const auto firstChild = static_cast<std::uint32_t>(m_nodes.size());
+  std::array<std::size_t, 4> quadrants;
+  std::uint32_t childCount = 0;
+  for (std::size_t quadrant = 0; quadrant < 4; ++quadrant) {
+    if (bounds[quadrant] == bounds[quadrant + 1])
+      continue;
+
+    m_nodes.emplace_back();
+    m_nodes.back().first = bounds[quadrant];
+    m_nodes.back().last = bounds[quadrant + 1];
+    quadrants[childCount++] = quadrant;
+  }
+  m_nodes[nodeIndex].firstChild = firstChild;
+  m_nodes[nodeIndex].childCount = childCount;
+
+  for (std::uint32_t child = 0; child < childCount; ++child) {
+    const std::size_t quadrant = quadrants[child];
+    buildNode(order, firstChild + child, xMins[quadrant], yMins[quadrant],
+              halfSize, depth + 1);
+  }
+}
+} // namespace staticpendulum
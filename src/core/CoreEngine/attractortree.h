@@ -0,0 +1,194 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef ATTRACTORTREE_H
+#define ATTRACTORTREE_H
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace staticpendulum {
+/*!
+ * @brief Barnes-Hut quadtree over the attractor positions approximating the
+ *total attractor force in O(log N) per evaluation.
+ *
+ * The attractor force is the gradient of the potential sum(k / |r - r_n|) of
+ *point sources in the plate plane seen from the pendulum head above it, so
+ *distant groups of attractors are approximated with the multipole expansion
+ *of that potential. Every node of the tree covers a square of the attractor
+ *plane and stores the monopole (the sum of the force coefficients), dipole
+ *and quadrupole moments of its attractors around their coefficient weighted
+ *center. While summing the forces on the pendulum head a node whose side
+ *length is smaller than the opening angle times its distance to the head
+ *(including the height of the head above the plate) is evaluated from its
+ *moments, otherwise its children are visited. Leaves hold at most leafSize
+ *attractors which are summed exactly.
+ *
+ * The error of an approximated node is of the order of the opening angle cubed
+ *relative to its force. An opening angle of 0 visits every leaf, giving the
+ *exact sum.
+ *
+ * The tree copies the attractors, it has to be rebuilt when they change.
+ */
+class AttractorTree {
+public:
+  /// Maximum number of attractors in a leaf.
+  static constexpr std::size_t leafSize = 8;
+  /// Maximum depth of the tree, nodes at this depth are leaves regardless of
+  /// the number of attractors they hold (only reached for nearly coincident
+  /// attractors).
+  static constexpr std::size_t maximumDepth = 48;
+
+  /*!
+   * @param[in] attractorList Range of attractors with xPosition, yPosition and
+   *forceCoeff members, e.g. PendulumSystem::attractorList.
+   * @param[in] openingAngle Accuracy parameter, the ratio of node size to
+   *distance below which a node is approximated, typical values are 0.3 to 1.
+   */
+  template <typename AttractorList>
+  AttractorTree(const AttractorList &attractorList, double openingAngle)
+      : m_openingAngle(openingAngle) {
+    for (const auto &attractor : attractorList) {
+      m_xPositions.push_back(attractor.xPosition);
+      m_yPositions.push_back(attractor.yPosition);
+      m_forceCoeffs.push_back(attractor.forceCoeff);
+    }
+    build();
+  }
+
+  double openingAngle() const { return m_openingAngle; }
+  std::size_t nodeCount() const { return m_nodes.size(); }
+
+  /// Sums the attraction forces on the pendulum head at (x, y), value2 is the
+  /// squared height of the head above the plate (see PendulumSystem).
+  void sumForces(double x, double y, double value2, double &xAttractionForce,
+                 double &yAttractionForce) const {
+    xAttractionForce = 0.0;
+    yAttractionForce = 0.0;
+    if (m_nodes.empty())
+      return;
+
+    const double openingAngleSquared = m_openingAngle * m_openingAngle;
+    // every visited node pushes at most 4 children and pops itself
+    std::array<std::uint32_t, 3 * maximumDepth + 4> stack;
+    std::size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize != 0) {
+      const Node &node = m_nodes[stack[--stackSize]];
+      const double value3 = x - node.xCenter;
+      const double value4 = y - node.yCenter;
+      const double squaredDistance = value3 * value3 + value4 * value4 + value2;
+      if (node.size * node.size < openingAngleSquared * squaredDistance) {
+        addMultipoleForce(node, value3, value4, value2, squaredDistance,
+                          xAttractionForce, yAttractionForce);
+      } else if (node.childCount == 0) {
+        for (std::uint32_t i = node.first; i < node.last; ++i) {
+          const double leafValue3 = x - m_xPositions[i];
+          const double leafValue4 = y - m_yPositions[i];
+          const double leafSquaredDistance =
+              leafValue3 * leafValue3 + leafValue4 * leafValue4 + value2;
+          const double value7 =
+              -m_forceCoeffs[i] /
+              (leafSquaredDistance * std::sqrt(leafSquaredDistance));
+          xAttractionForce += leafValue3 * value7;
+          yAttractionForce += leafValue4 * value7;
+        }
+      } else {
+        for (std::uint32_t child = 0; child < node.childCount; ++child) {
+          stack[stackSize++] = node.firstChild + child;
+        }
+      }
+    }
+  }
+
+private:
+  struct Node {
+    double xCenter;    // force coefficient magnitude weighted center
+    double yCenter;
+    double forceCoeff; // sum of the force coefficients (monopole)
+    double xDipole;    // sum of k * d, zero unless the signs of k differ
+    double yDipole;
+    double xxQuadrupole; // sum of k * (3 * d_i * d_j - |d|^2 * delta_ij)
+    double xyQuadrupole;
+    double yyQuadrupole;
+    double size; // side length of the node square
+    std::uint32_t first; // range of the node attractors
+    std::uint32_t last;
+    std::uint32_t firstChild; // children are stored contiguously
+    std::uint32_t childCount;
+  };
+
+  // adds the gradient of the multipole expansion of the node potential, r is
+  // (value3, value4, height) from the node center to the pendulum head
+  static void addMultipoleForce(const Node &node, double value3, double value4,
+                                double value2, double squaredDistance,
+                                double &xAttractionForce,
+                                double &yAttractionForce) {
+    const double inverseDistance = 1.0 / std::sqrt(squaredDistance);
+    const double inverseSquared = inverseDistance * inverseDistance;
+    const double inverseCubed = inverseSquared * inverseDistance;
+    const double inverseFifth = inverseCubed * inverseSquared;
+
+    // monopole: -M r / |r|^3
+    double xForce = -node.forceCoeff * value3 * inverseCubed;
+    double yForce = -node.forceCoeff * value4 * inverseCubed;
+
+    // dipole: D / |r|^3 - 3 (D . r) r / |r|^5
+    const double dipoleDot = node.xDipole * value3 + node.yDipole * value4;
+    xForce += node.xDipole * inverseCubed -
+              3.0 * dipoleDot * value3 * inverseFifth;
+    yForce += node.yDipole * inverseCubed -
+              3.0 * dipoleDot * value4 * inverseFifth;
+
+    // quadrupole: Q r / |r|^5 - 5 / 2 (r . Q r) r / |r|^7, the zz component
+    // of the traceless moment is -(xx + yy)
+    const double xQuadrupole =
+        node.xxQuadrupole * value3 + node.xyQuadrupole * value4;
+    const double yQuadrupole =
+        node.xyQuadrupole * value3 + node.yyQuadrupole * value4;
+    const double quadrupoleDot =
+        value3 * xQuadrupole + value4 * yQuadrupole -
+        (node.xxQuadrupole + node.yyQuadrupole) * value2;
+    const double quadrupoleScale =
+        2.5 * quadrupoleDot * inverseFifth * inverseSquared;
+    xForce += xQuadrupole * inverseFifth - quadrupoleScale * value3;
+    yForce += yQuadrupole * inverseFifth - quadrupoleScale * value4;
+
+    xAttractionForce += xForce;
+    yAttractionForce += yForce;
+  }
+
+  void build();
+  void buildNode(std::vector<std::uint32_t> &order, std::uint32_t nodeIndex,
+                 double xMin, double yMin, double size, std::size_t depth);
+
+  double m_openingAngle;
+  std::vector<Node> m_nodes;
+  // attractors reordered so every node covers a contiguous range
+  std::vector<double> m_xPositions;
+  std::vector<double> m_yPositions;
+  std::vector<double> m_forceCoeffs;
+};
+} // namespace staticpendulum
+#endif // ATTRACTORTREE_H
@@ -0,0 +1,199 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "attractorwells.h"
+#include "pendulumsystem.h"
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+namespace staticpendulum {
+namespace {
+// minimum of the potential found while flooding the grid, saddleEnergy stays
+// infinite until its component joins another one or reaches the edge
+struct Minimum {
+  std::size_t node;
+  double saddleEnergy;
+};
+
+// root of the component holding node, halving the paths on the way
+std::size_t findRoot(std::vector<std::size_t> &parents, std::size_t node) {
+  while (parents[node] != node) {
+    parents[node] = parents[parents[node]];
+    node = parents[node];
+  }
+
+  return node;
+}
+} // namespace
+
+constexpr std::size_t AttractorWells::defaultNodeCount;
+constexpr double AttractorWells::heuristicCaptureMargin;
+
+AttractorWells::AttractorWells(const PendulumSystem &system,
+                               std::size_t nodeCount)
+    : m_nodeCount(std::max<std::size_t>(nodeCount, 3)) {
+  double reach = 0.0;
+  for (const auto &attractor : system.attractorList) {
+    reach = std::max(reach, std::max(std::abs(attractor.xPosition),
+                                     std::abs(attractor.yPosition)));
+  }
+  const double halfSide =
+      reach > 0.0 ? std::min(2.0 * reach, system.length) : system.length;
+  m_spacing = 2.0 * halfSide / static_cast<double>(m_nodeCount - 1);
+  m_origin = -halfSide;
+
+  // nodes outside of the pendulum length boundary have no potential (NaN)
+  const std::size_t count = m_nodeCount * m_nodeCount;
+  const double lengthSquared = system.length * system.length;
+  std::vector<double> potentials(count);
+  std::vector<std::size_t> order;
+  order.reserve(count);
+  for (std::size_t node = 0; node < count; ++node) {
+    const double x =
+        m_origin + static_cast<double>(node % m_nodeCount) * m_spacing;
+    const double y =
+        m_origin + static_cast<double>(node / m_nodeCount) * m_spacing;
+    if (x * x + y * y < lengthSquared) {
+      potentials[node] = potentialEnergy(system, x, y);
+      order.push_back(node);
+    } else {
+      potentials[node] = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [&potentials](std::size_t a, std::size_t b) {
+              return potentials[a] < potentials[b] ||
+                     (potentials[a] == potentials[b] && a < b);
+            });
+
+  // flood the nodes in order of increasing potential, every component starts
+  // at a minimum and stays open (its well index at the root) until it joins
+  // another component or reaches the edge, which is its lowest saddle
+  std::vector<std::size_t> parents(count, count);
+  std::vector<std::int32_t> rootMinima(count, -1);
+  std::vector<Minimum> minima;
+  auto closeComponent = [&](std::size_t root, double energy) {
+    if (rootMinima[root] >= 0) {
+      minima[static_cast<std::size_t>(rootMinima[root])].saddleEnergy = energy;
+      rootMinima[root] = -1;
+    }
+  };
+
+  for (const std::size_t node : order) {
+    const std::size_t column = node % m_nodeCount;
+    const std::size_t row = node / m_nodeCount;
+    bool isEdge = column == 0 || row == 0 || column == m_nodeCount - 1 ||
+                  row == m_nodeCount - 1;
+    std::size_t neighbours[4];
+    std::size_t neighbourCount = 0;
+    if (column > 0)
+      neighbours[neighbourCount++] = node - 1;
+    if (column < m_nodeCount - 1)
+      neighbours[neighbourCount++] = node + 1;
+    if (row > 0)
+      neighbours[neighbourCount++] = node - m_nodeCount;
+    if (row < m_nodeCount - 1)
+      neighbours[neighbourCount++] = node + m_nodeCount;
+
+    std::size_t root = count;
+    for (std::size_t i = 0; i < neighbourCount; ++i) {
+      const std::size_t neighbour = neighbours[i];
+      if (std::isnan(potentials[neighbour])) {
+        isEdge = true;
+        continue;
+      }
+
+      if (parents[neighbour] == count)
+        continue;
+
+      const std::size_t neighbourRoot = findRoot(parents, neighbour);
+      if (root == count) {
+        root = neighbourRoot;
+      } else if (neighbourRoot != root) {
+        closeComponent(root, potentials[node]);
+        closeComponent(neighbourRoot, potentials[node]);
+        parents[neighbourRoot] = root;
+      }
+    }
+
+    if (root == count) {
+      root = node;
+      rootMinima[node] = static_cast<std::int32_t>(minima.size());
+      minima.push_back({node, std::numeric_limits<double>::infinity()});
+    }
+    parents[node] = root;
+
+    if (isEdge)
+      closeComponent(root, potentials[node]);
+  }
+
+  // label the nodes of every well below its saddle, the sublevel sets of the
+  // wells are disjoint
+  m_labels.assign(count, -1);
+  std::queue<std::size_t> queue;
+  for (const auto &minimum : minima) {
+    const double minimumEnergy = potentials[minimum.node];
+    if (!(minimum.saddleEnergy > minimumEnergy) ||
+        std::isinf(minimum.saddleEnergy))
+      continue;
+
+    const auto wellIndex = static_cast<std::int32_t>(m_wells.size());
+    Well well;
+    well.xPosition =
+        m_origin + static_cast<double>(minimum.node % m_nodeCount) * m_spacing;
+    well.yPosition =
+        m_origin + static_cast<double>(minimum.node / m_nodeCount) * m_spacing;
+    well.minimumEnergy = minimumEnergy;
+    well.saddleEnergy = minimum.saddleEnergy;
+    well.captureEnergy =
+        minimum.saddleEnergy -
+        heuristicCaptureMargin * (minimum.saddleEnergy - minimumEnergy);
+    m_wells.push_back(well);
+
+    m_labels[minimum.node] = wellIndex;
+    queue.push(minimum.node);
+    while (!queue.empty()) {
+      const std::size_t node = queue.front();
+      queue.pop();
+      const std::size_t column = node % m_nodeCount;
+      const std::size_t row = node / m_nodeCount;
+      auto visit = [&](std::size_t neighbour) {
+        if (m_labels[neighbour] == -1 &&
+            potentials[neighbour] < minimum.saddleEnergy) {
+          m_labels[neighbour] = wellIndex;
+          queue.push(neighbour);
+        }
+      };
+      if (column > 0)
+        visit(node - 1);
+      if (column < m_nodeCount - 1)
+        visit(node + 1);
+      if (row > 0)
+        visit(node - m_nodeCount);
+      if (row < m_nodeCount - 1)
+        visit(node + m_nodeCount);
+    }
+  }
+}
+} // namespace staticpendulum
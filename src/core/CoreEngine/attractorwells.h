@@ -0,0 +1,142 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef ATTRACTORWELLS_H
+#define ATTRACTORWELLS_H
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace staticpendulum {
+struct PendulumSystem;
+
+/// Potential energy of the pendulum head at (x, y): the gravity potential
+/// plus the sum of -k / distance over the attractors, where distance includes
+/// the height of the head above the plate (as in the derivative of
+/// PendulumSystem).
+template <typename SystemType>
+inline double potentialEnergy(const SystemType &sys, double x, double y) {
+  const double lengthSquared = sys.length * sys.length;
+  const double sqrtTerm = std::sqrt(1.0 - (x * x + y * y) / lengthSquared);
+  const double value1 = sys.distance + sys.length * (1.0 - sqrtTerm);
+  const double value2 = value1 * value1;
+  double potential =
+      -sys.mass * sys.gravity * sys.length / 3.0 * sqrtTerm * sqrtTerm *
+      sqrtTerm;
+  for (const auto &attractor : sys.attractorList) {
+    const double value3 = x - attractor.xPosition;
+    const double value4 = y - attractor.yPosition;
+    potential -= attractor.forceCoeff /
+                 std::sqrt(value3 * value3 + value4 * value4 + value2);
+  }
+
+  return potential;
+}
+
+/// Kinetic plus potential energy of the pendulum state (x, y, x velocity,
+/// y velocity).
+template <typename SystemType>
+inline double mechanicalEnergy(const SystemType &sys, double x, double y,
+                               double xVelocity, double yVelocity) {
+  return 0.5 * sys.mass * (xVelocity * xVelocity + yVelocity * yVelocity) +
+         potentialEnergy(sys, x, y);
+}
+
+/*!
+ * @brief Potential wells of a pendulum system and a heuristic energy below
+ *which the pendulum head is taken to stay in them.
+ *
+ * The potential energy (see potentialEnergy) is sampled on a square grid
+ *around the attractors. Its local minima are the wells, the lowest saddle
+ *around a well is the level at which its sublevel set first joins the one of
+ *another well or reaches the edge of the grid, found by flooding the grid
+ *nodes in order of increasing potential. The nodes of a well below its saddle
+ *are labeled with the well.
+ *
+ * If the forces were the gradient of the potential, drag would only remove
+ *energy and a head below the saddle of its well could not leave it. The
+ *attractor force of PendulumSystem is the horizontal part of the force of a
+ *point source, not exactly the gradient of the potential (the height of the
+ *head is not differentiated), so the head can gain energy from the
+ *difference and no bound on that gain is derived here. The capture energy is
+ *a heuristic: heuristicCaptureMargin times the depth of the well below the
+ *saddle, which kept the classification of the tested maps. It is only used
+ *when energy capture is switched on (see PendulumSystem::wells).
+ *
+ * The wells copy nothing from the system, they have to be rebuilt when it
+ *changes.
+ */
+class AttractorWells {
+public:
+  /// Default number of grid nodes per side.
+  static constexpr std::size_t defaultNodeCount = 512;
+  /// Fraction of the depth of a well kept between its capture energy and its
+  /// lowest saddle, chosen empirically.
+  static constexpr double heuristicCaptureMargin = 0.1;
+
+  struct Well {
+    double xPosition;      /*!< x coordinate of the minimum. */
+    double yPosition;      /*!< y coordinate of the minimum. */
+    double minimumEnergy;  /*!< Potential energy at the minimum. */
+    double saddleEnergy;   /*!< Potential energy of the lowest saddle. */
+    double captureEnergy;  /*!< Energy below which the head is taken to be
+                                captured (heuristic, see above). */
+  };
+
+  /*!
+   * @param[in] system The system to sample, the grid covers twice the
+   *farthest attractor coordinate in every direction (at most the pendulum
+   *length).
+   * @param[in] nodeCount Number of grid nodes per side.
+   */
+  explicit AttractorWells(const PendulumSystem &system,
+                          std::size_t nodeCount = defaultNodeCount);
+
+  const std::vector<Well> &wells() const { return m_wells; }
+  std::size_t nodeCount() const { return m_nodeCount; }
+  double spacing() const { return m_spacing; }
+
+  /// Index of the well whose sublevel set below its saddle holds the grid
+  /// node nearest to (x, y), -1 if there is none.
+  int wellAt(double x, double y) const {
+    const double u = std::round((x - m_origin) / m_spacing);
+    const double v = std::round((y - m_origin) / m_spacing);
+    const auto last = static_cast<double>(m_nodeCount - 1);
+    if (!(u >= 0.0 && u <= last && v >= 0.0 && v <= last))
+      return -1;
+
+    return m_labels[static_cast<std::size_t>(v) * m_nodeCount +
+                    static_cast<std::size_t>(u)];
+  }
+
+private:
+  std::size_t m_nodeCount;
+  double m_spacing;
+  double m_origin;
+  std::vector<Well> m_wells;
+  // well index per node, rows of increasing y
+  std::vector<std::int32_t> m_labels;
+};
+} // namespace staticpendulum
+#endif // ATTRACTORWELLS_H
@@ -0,0 +1,54 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef BATCHSTATE_H
+#define BATCHSTATE_H
+#include <array>
+#include <cstddef>
+
+namespace staticpendulum {
+/*!
+ * @brief Structure of arrays state used to integrate several points in
+ *lockstep.
+ *
+ * Each state component is stored contiguously across the lanes, e.g.
+ *state[0][lane] is the x position of the point in that lane, so loops over
+ *the lanes map directly onto vector registers.
+ * @tparam StateSize The number of components in the state of a single point.
+ * @tparam Lanes The number of points advanced together.
+ */
+template <std::size_t StateSize, std::size_t Lanes>
+using BatchState = std::array<std::array<double, Lanes>, StateSize>;
+
+/// One value per lane, used for per lane times, step sizes and masks.
+template <typename T, std::size_t Lanes> using LaneArray = std::array<T, Lanes>;
+
+/// Number of doubles that fit in one vector register of the target, used as
+/// the default lane count for batched integration.
+#if defined(__AVX512F__)
+constexpr std::size_t nativeLaneCount = 8;
+#else
+constexpr std::size_t nativeLaneCount = 4;
+#endif
+} // namespace staticpendulum
+#endif // BATCHSTATE_H
@@ -0,0 +1,70 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef BOGACKISHAMPINE32_H
+#define BOGACKISHAMPINE32_H
+#include "explicitrungekutta.h"
+
+namespace staticpendulum {
+/*!
+ * @brief Butcher tableau of the Bogacki and Shampine embedded Runge Kutta order
+ *3(2) method with first same as last stage, see explicitRungeKutta.
+ *
+ * See: P. Bogacki, L. F. Shampine. "A 3(2) pair of Runge-Kutta formulas."
+ *Applied Mathematics Letters, Vol. 2, No. 4, 1989.
+ *
+ * And Wikipedia: https://en.wikipedia.org/wiki/Bogacki%E2%80%93Shampine_method
+ */
+struct BogackiShampine32Tableau {
+  static constexpr std::size_t stageCount = 4;
+  static constexpr int order = 3;
+  static constexpr int errorOrder = 2;
+  static constexpr bool isFsal = true;
+  // stability boundary on the negative real axis
+  static constexpr double stabilityBoundary = 2.51;
+
+  static constexpr double c(std::size_t i) {
+    const double values[stageCount] = {0.0, 1.0 / 2.0, 3.0 / 4.0, 1.0};
+    return values[i];
+  }
+
+  static constexpr double a(std::size_t i, std::size_t j) {
+    const double values[stageCount][stageCount] = {
+        {},
+        {1.0 / 2.0},
+        {0.0, 3.0 / 4.0},
+        {2.0 / 9.0, 1.0 / 3.0, 4.0 / 9.0}};
+    return values[i][j];
+  }
+
+  // the order 3 weights are the last row of the tableau (FSAL property)
+  static constexpr double b(std::size_t j) { return a(stageCount - 1, j); }
+
+  static constexpr double bHat(std::size_t j) {
+    const double values[stageCount] = {7.0 / 24.0, 1.0 / 4.0, 1.0 / 3.0,
+                                       1.0 / 8.0};
+    return values[j];
+  }
+};
+} // namespace staticpendulum
+#endif // BOGACKISHAMPINE32_H
@@ -23,11 +23,60 @@
  * ===========================================================================*/
 #ifndef CASHKARP54_H
 #define CASHKARP54_H
+#include "explicitrungekutta.h"
 #include <algorithm>
 #include <array>
 #include <cmath>
 
 namespace staticpendulum {
+/*!
+ * @brief Butcher tableau of the Cash and Karp embedded Runge Kutta order 5(4)
+ *method, see explicitRungeKutta.
+ */
+struct CashKarp54Tableau {
+  static constexpr std::size_t stageCount = 6;
+  static constexpr int order = 5;
+  static constexpr int errorOrder = 4;
+  static constexpr bool isFsal = false;
+  // stability boundary on the negative real axis
+  static constexpr double stabilityBoundary = 3.73;
+
+  // Constants from Butcher tableau, see:
+  // http://en.wikipedia.org/wiki/Cash-Karp_method
+  // and http://en.wikipedia.org/wiki/Runge-Kutta_methods
+  static constexpr double c(std::size_t i) {
+    const double values[stageCount] = {0.0,       1.0 / 5.0, 3.0 / 10.0,
+                                       3.0 / 5.0, 1.0,       7.0 / 8.0};
+    return values[i];
+  }
+
+  static constexpr double a(std::size_t i, std::size_t j) {
+    const double values[stageCount][stageCount] = {
+        {},
+        {1.0 / 5.0},
+        {3.0 / 40.0, 9.0 / 40.0},
+        {3.0 / 10.0, -9.0 / 10.0, 6.0 / 5.0},
+        {-11.0 / 54.0, 5.0 / 2.0, -70.0 / 27.0, 35.0 / 27.0},
+        {1631.0 / 55296.0, 175.0 / 512.0, 575.0 / 13824.0, 44275.0 / 110592.0,
+         253.0 / 4096.0}};
+    return values[i][j];
+  }
+
+  static constexpr double b(std::size_t j) {
+    const double values[stageCount] = {37.0 / 378.0,  0.0,
+                                       250.0 / 621.0, 125.0 / 594.0,
+                                       0.0,           512.0 / 1771.0};
+    return values[j];
+  }
+
+  static constexpr double bHat(std::size_t j) {
+    const double values[stageCount] = {2825.0 / 27648.0,  0.0,
+                                       18575.0 / 48384.0, 13525.0 / 55296.0,
+                                       277.0 / 14336.0,   1.0 / 4.0};
+    return values[j];
+  }
+};
+
 /*!
  * @brief Cash and Karp embedded Runge Kutta order 5(4) adaptive step
  *integrator.
@@ -66,51 +115,47 @@ template <typename SystemType, std::size_t StateSize>
 inline int cashKarp54(SystemType &&dxdt, std::array<double, StateSize> &x,
                       double &t, double &h, double relTol, double absTol,
                       double maxStepSize) {
-  // Constants from Butcher tableau, see:
-  // http://en.wikipedia.org/wiki/Cash-Karp_method
-  // and http://en.wikipedia.org/wiki/Runge-Kutta_methods
-  constexpr double c2 = 1.0 / 5.0;
-  constexpr double c3 = 3.0 / 10.0;
-  constexpr double c4 = 3.0 / 5.0;
-  constexpr double c5 = 1.0;
-  constexpr double c6 = 7.0 / 8.0;
-
-  constexpr double b5th1 = 37.0 / 378.0;
-  constexpr double b5th2 = 0.0;
-  constexpr double b5th3 = 250.0 / 621.0;
-  constexpr double b5th4 = 125.0 / 594.0;
-  constexpr double b5th5 = 0.0;
-  constexpr double b5th6 = 512.0 / 1771.0;
-
-  constexpr double b4th1 = 2825.0 / 27648.0;
-  constexpr double b4th2 = 0.0;
-  constexpr double b4th3 = 18575.0 / 48384.0;
-  constexpr double b4th4 = 13525.0 / 55296.0;
-  constexpr double b4th5 = 277.0 / 14336.0;
-  constexpr double b4th6 = 1.0 / 4.0;
-
-  constexpr double bDiff1 = b5th1 - b4th1;
-  constexpr double bDiff2 = b5th2 - b4th2;
-  constexpr double bDiff3 = b5th3 - b4th3;
-  constexpr double bDiff4 = b5th4 - b4th4;
-  constexpr double bDiff5 = b5th5 - b4th5;
-  constexpr double bDiff6 = b5th6 - b4th6;
-
-  constexpr double a21 = 1.0 / 5.0;
-  constexpr double a31 = 3.0 / 40.0;
-  constexpr double a32 = 9.0 / 40.0;
-  constexpr double a41 = 3.0 / 10.0;
-  constexpr double a42 = -9.0 / 10.0;
-  constexpr double a43 = 6.0 / 5.0;
-  constexpr double a51 = -11.0 / 54.0;
-  constexpr double a52 = 5.0 / 2.0;
-  constexpr double a53 = -70.0 / 27.0;
-  constexpr double a54 = 35.0 / 27.0;
-  constexpr double a61 = 1631.0 / 55296.0;
-  constexpr double a62 = 175.0 / 512.0;
-  constexpr double a63 = 575.0 / 13824.0;
-  constexpr double a64 = 44275.0 / 110592.0;
-  constexpr double a65 = 253.0 / 4096.0;
+  // The step is unrolled by hand in the same form as the engine generates, so
+  // the rounding is the same as that of explicitRungeKutta. Under
+  // -ffast-math GCC reassociates and inlines dxdt differently depending on
+  // the shape of the surrounding code, and only this exact form reproduces
+  // the results of the original Cash-Karp step.
+  using Tableau = CashKarp54Tableau;
+  constexpr double c2 = Tableau::c(1);
+  constexpr double c3 = Tableau::c(2);
+  constexpr double c4 = Tableau::c(3);
+  constexpr double c5 = Tableau::c(4);
+  constexpr double c6 = Tableau::c(5);
+
+  constexpr double b5th1 = Tableau::b(0);
+  constexpr double b5th2 = Tableau::b(1);
+  constexpr double b5th3 = Tableau::b(2);
+  constexpr double b5th4 = Tableau::b(3);
+  constexpr double b5th5 = Tableau::b(4);
+  constexpr double b5th6 = Tableau::b(5);
+
+  constexpr double bDiff1 = b5th1 - Tableau::bHat(0);
+  constexpr double bDiff2 = b5th2 - Tableau::bHat(1);
+  constexpr double bDiff3 = b5th3 - Tableau::bHat(2);
+  constexpr double bDiff4 = b5th4 - Tableau::bHat(3);
+  constexpr double bDiff5 = b5th5 - Tableau::bHat(4);
+  constexpr double bDiff6 = b5th6 - Tableau::bHat(5);
+
+  constexpr double a21 = Tableau::a(1, 0);
+  constexpr double a31 = Tableau::a(2, 0);
+  constexpr double a32 = Tableau::a(2, 1);
+  constexpr double a41 = Tableau::a(3, 0);
+  constexpr double a42 = Tableau::a(3, 1);
+  constexpr double a43 = Tableau::a(3, 2);
+  constexpr double a51 = Tableau::a(4, 0);
+  constexpr double a52 = Tableau::a(4, 1);
+  constexpr double a53 = Tableau::a(4, 2);
+  constexpr double a54 = Tableau::a(4, 3);
+  constexpr double a61 = Tableau::a(5, 0);
+  constexpr double a62 = Tableau::a(5, 1);
+  constexpr double a63 = Tableau::a(5, 2);
+  constexpr double a64 = Tableau::a(5, 3);
+  constexpr double a65 = Tableau::a(5, 4);
 
   // temp state used to store state for next k value and later used
   // for error difference
@@ -181,8 +226,9 @@ inline int cashKarp54(SystemType &&dxdt, std::array<double, StateSize> &x,
       *(std::max_element(errorValueList.begin(), errorValueList.end()));
 
   // reject step and decrease step size
+  ElementaryStepController controller;
   if (maxErrorValue > 1.0) {
-    h = h * std::max(0.9 * std::pow(maxErrorValue, -0.25), 0.2);
+    h = controller.rejected<Tableau>(h, maxErrorValue);
     return 0;
   }
 
@@ -192,13 +238,22 @@ inline int cashKarp54(SystemType &&dxdt, std::array<double, StateSize> &x,
     x[i] = potentialSolution[i];
   }
 
-  // if error is small enough then increase step size
-  if (maxErrorValue < 0.5) {
-    h = std::min(h * std::min(0.9 * std::pow(maxErrorValue, -0.20), 5.0),
-                 maxStepSize);
-  }
-
+  h = controller.accepted<Tableau>(h, maxErrorValue, maxStepSize);
   return 1;
 }
+
+/*!
+ * @brief Overload of cashKarp54 that keeps the derivative at x between steps
+ *in dxdtx (see explicitRungeKutta), so a rejected step does not evaluate the
+ *first stage again.
+ */
+template <typename SystemType, std::size_t StateSize>
+inline int cashKarp54(SystemType &&dxdt, std::array<double, StateSize> &x,
+                      std::array<double, StateSize> &dxdtx, double &t,
+                      double &h, double relTol, double absTol,
+                      double maxStepSize) {
+  return explicitRungeKutta<CashKarp54Tableau>(dxdt, x, dxdtx, t, h, relTol,
+                                               absTol, maxStepSize);
+}
 } // namespace staticpendulum
 #endif // CASHKARP54_H
@@ -0,0 +1,289 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "cellmapping.h"
+#include "attractorwells.h"
+#include <cmath>
+#include <limits>
+
+namespace staticpendulum {
+namespace {
+// converge positions of the cells while resolving
+constexpr std::int16_t unvisitedCell = -4;
+constexpr std::int16_t cellOnPath = -5;
+
+// index of the cell along one axis of a grid of count cells of spacing
+// centered on 0, count if the value is outside of the grid
+std::size_t axisCell(double value, double spacing, std::size_t count) {
+  const double index =
+      std::floor(value / spacing + 0.5 * static_cast<double>(count));
+  if (!(index >= 0.0 && index < static_cast<double>(count)))
+    return count;
+
+  return static_cast<std::size_t>(index);
+}
+
+double axisCenter(std::size_t index, double spacing, std::size_t count) {
+  return (static_cast<double>(index) + 0.5 - 0.5 * static_cast<double>(count)) *
+         spacing;
+}
+} // namespace
+
+constexpr std::int32_t CellMapping::sinkCell;
+constexpr std::size_t CellMapping::maximumCellCount;
+
+CellMapping::CellMapping(const PendulumSystem &system,
+                         std::size_t positionCellCount,
+                         std::size_t velocityCellCount, double mappingTime)
+    : m_system(system),
+      m_positionCellCount(std::max<std::size_t>(positionCellCount, 1)),
+      m_velocityCellCount(std::max<std::size_t>(velocityCellCount, 1) | 1),
+      m_mappingTime(mappingTime) {
+  m_system.attractorTree.reset();
+  m_system.forceTable.reset();
+  m_wells = system.wells;
+  m_system.wells.reset();
+  m_system.fateCache.reset();
+  m_positionSpacing =
+      2.0 * system.length / static_cast<double>(m_positionCellCount);
+
+  // the head starting at rest can at most convert the potential energy range
+  // of the reach into kinetic energy
+  double minimumEnergy = std::numeric_limits<double>::infinity();
+  double maximumEnergy = -std::numeric_limits<double>::infinity();
+  const double lengthSquared = system.length * system.length;
+  for (std::size_t row = 0; row < m_positionCellCount; ++row) {
+    const double y = axisCenter(row, m_positionSpacing, m_positionCellCount);
+    for (std::size_t column = 0; column < m_positionCellCount; ++column) {
+      const double x =
+          axisCenter(column, m_positionSpacing, m_positionCellCount);
+      if (x * x + y * y >= lengthSquared)
+        continue;
+
+      const double energy = potentialEnergy(system, x, y);
+      minimumEnergy = std::min(minimumEnergy, energy);
+      maximumEnergy = std::max(maximumEnergy, energy);
+    }
+  }
+  for (const auto &attractor : system.attractorList) {
+    if (attractor.xPosition * attractor.xPosition +
+            attractor.yPosition * attractor.yPosition <
+        lengthSquared) {
+      minimumEnergy = std::min(
+          minimumEnergy,
+          potentialEnergy(system, attractor.xPosition, attractor.yPosition));
+    }
+  }
+  const double maximumSpeed =
+      maximumEnergy > minimumEnergy
+          ? std::sqrt(2.0 * (maximumEnergy - minimumEnergy) / system.mass)
+          : 1.0;
+  m_velocitySpacing =
+      2.0 * maximumSpeed / static_cast<double>(m_velocityCellCount);
+
+  const std::size_t count = m_positionCellCount * m_positionCellCount *
+                            m_velocityCellCount * m_velocityCellCount;
+  m_images.assign(count, sinkCell);
+  m_positions.assign(count, unresolvedPosition);
+  m_mappingCounts.assign(count, 0);
+}
+
+std::int32_t
+CellMapping::cellOf(const PendulumSystem::StateType &state) const {
+  const std::size_t column =
+      axisCell(state[0], m_positionSpacing, m_positionCellCount);
+  const std::size_t row =
+      axisCell(state[1], m_positionSpacing, m_positionCellCount);
+  const std::size_t xVelocity =
+      axisCell(state[2], m_velocitySpacing, m_velocityCellCount);
+  const std::size_t yVelocity =
+      axisCell(state[3], m_velocitySpacing, m_velocityCellCount);
+  if (column == m_positionCellCount || row == m_positionCellCount ||
+      xVelocity == m_velocityCellCount || yVelocity == m_velocityCellCount)
+    return sinkCell;
+
+  return static_cast<std::int32_t>(
+      ((yVelocity * m_velocityCellCount + xVelocity) * m_positionCellCount +
+       row) *
+          m_positionCellCount +
+      column);
+}
+
+PendulumSystem::StateType CellMapping::cellCenter(std::size_t cell) const {
+  const std::size_t column = cell % m_positionCellCount;
+  cell /= m_positionCellCount;
+  const std::size_t row = cell % m_positionCellCount;
+  cell /= m_positionCellCount;
+  const std::size_t xVelocity = cell % m_velocityCellCount;
+  const std::size_t yVelocity = cell / m_velocityCellCount;
+  return {{axisCenter(column, m_positionSpacing, m_positionCellCount),
+           axisCenter(row, m_positionSpacing, m_positionCellCount),
+           axisCenter(xVelocity, m_velocitySpacing, m_velocityCellCount),
+           axisCenter(yVelocity, m_velocitySpacing, m_velocityCellCount)}};
+}
+
+std::vector<Tile> CellMapping::tiles() const {
+  const std::size_t rowCount = cellCount() / m_positionCellCount;
+  std::vector<Tile> result;
+  for (std::size_t firstRow = 0; firstRow < rowCount;
+       firstRow += defaultTileRows) {
+    result.push_back({firstRow, std::min(firstRow + defaultTileRows, rowCount),
+                      0, m_positionCellCount});
+  }
+
+  return result;
+}
+
+void CellMapping::mapCells(const Tile &row, const CellFlow &flow) {
+  const double lengthSquared = m_system.length * m_system.length;
+  for (std::size_t rowIndex = row.firstRow; rowIndex < row.lastRow;
+       ++rowIndex) {
+    for (std::size_t column = row.firstColumn; column < row.lastColumn;
+         ++column) {
+      const std::size_t cell = rowIndex * m_positionCellCount + column;
+      PendulumSystem::StateType state = cellCenter(cell);
+      if (state[0] * state[0] + state[1] * state[1] >= lengthSquared ||
+          !flow(state)) {
+        m_images[cell] = sinkCell;
+        continue;
+      }
+
+      m_images[cell] = cellOf(state);
+    }
+  }
+}
+
+void CellMapping::resolve(double attractorPositionThreshold,
+                          double midPositionThreshold) {
+  const ConvergenceMonitor monitor{attractorPositionThreshold,
+                                   midPositionThreshold, 0.0};
+  m_positions.assign(cellCount(), unvisitedCell);
+  m_mappingCounts.assign(cellCount(), 0);
+  m_periodicGroupCount = 0;
+  m_resolvedGroupCount = 0;
+  m_absorbingCellCount = 0;
+
+  // with energy capture the cells below the heuristic capture energy of the
+  // well of an attractor (or the middle) are absorbing, see AttractorWells
+  for (std::size_t cell = 0; m_wells && cell < cellCount(); ++cell) {
+    const auto center = cellCenter(cell);
+    const int wellIndex = m_wells->wellAt(center[0], center[1]);
+    if (wellIndex < 0)
+      continue;
+
+    const AttractorWells::Well &well =
+        m_wells->wells()[static_cast<std::size_t>(wellIndex)];
+    if (mechanicalEnergy(m_system, center[0], center[1], center[2],
+                         center[3]) >= well.captureEnergy)
+      continue;
+
+    const int position =
+        monitor.nearPosition(m_system, well.xPosition, well.yPosition);
+    if (position != -2) {
+      m_positions[cell] = static_cast<std::int16_t>(position);
+      ++m_absorbingCellCount;
+    }
+  }
+
+  // the image graph has one edge per cell, following the images from a cell
+  // ends in the sink, in a resolved cell or closes a new periodic group
+  std::vector<std::size_t> path;
+  for (std::size_t first = 0; first < cellCount(); ++first) {
+    if (m_positions[first] != unvisitedCell)
+      continue;
+
+    path.clear();
+    std::int32_t cell = static_cast<std::int32_t>(first);
+    while (cell != sinkCell && m_positions[cell] == unvisitedCell) {
+      m_positions[cell] = cellOnPath;
+      path.push_back(static_cast<std::size_t>(cell));
+      cell = m_images[cell];
+    }
+
+    std::int16_t position = unresolvedPosition;
+    std::uint16_t mappingCount = 0;
+    std::size_t transientCount = path.size();
+    if (cell != sinkCell && m_positions[cell] == cellOnPath) {
+      // the cells from cell to the end of the path are a periodic group,
+      // resolved if all of them are near the same attractor (or the middle)
+      transientCount = static_cast<std::size_t>(
+          std::find(path.begin(), path.end(), static_cast<std::size_t>(cell)) -
+          path.begin());
+      int groupPosition = -2;
+      for (std::size_t i = transientCount; i < path.size(); ++i) {
+        const auto center = cellCenter(path[i]);
+        const int cellPosition =
+            monitor.nearPosition(m_system, center[0], center[1]);
+        if (cellPosition == -2 ||
+            (i != transientCount && cellPosition != groupPosition)) {
+          groupPosition = -2;
+          break;
+        }
+        groupPosition = cellPosition;
+      }
+
+      ++m_periodicGroupCount;
+      if (groupPosition != -2) {
+        ++m_resolvedGroupCount;
+        position = static_cast<std::int16_t>(groupPosition);
+      }
+      for (std::size_t i = transientCount; i < path.size(); ++i) {
+        m_positions[path[i]] = position;
+      }
+    } else if (cell != sinkCell) {
+      position = m_positions[cell];
+      mappingCount = m_mappingCounts[cell];
+    }
+
+    // the transient cells lead to the group one mapping after another
+    for (std::size_t i = transientCount; i-- > 0;) {
+      if (mappingCount < std::numeric_limits<std::uint16_t>::max())
+        ++mappingCount;
+      m_positions[path[i]] = position;
+      m_mappingCounts[path[i]] = mappingCount;
+    }
+  }
+}
+
+void CellMapping::fill(Map &map) const {
+  const std::size_t count = map.rows() * map.cols();
+  for (std::size_t index = 0; index < count; ++index) {
+    auto &&point = map.point(index);
+    if (!isIntegrable(m_system, point))
+      continue;
+
+    const std::int32_t cell = cellOf(
+        {{point.xPosition, point.yPosition, point.xVelocity, point.yVelocity}});
+    Point result = point;
+    if (cell == sinkCell) {
+      result.convergePosition = unresolvedPosition;
+      result.convergeTime = 0.0;
+    } else {
+      result.convergePosition = m_positions[static_cast<std::size_t>(cell)];
+      result.convergeTime = convergeTime(static_cast<std::size_t>(cell));
+    }
+    result.stepCount = 0;
+    point = result;
+  }
+}
+} // namespace staticpendulum
@@ -0,0 +1,179 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef CELLMAPPING_H
+#define CELLMAPPING_H
+#include "attractorwells.h"
+#include "pendulummapintegrator.h"
+#include "pendulumsystem.h"
+#include "tilescheduler.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace staticpendulum {
+/// Advances a state over the mapping time of a CellMapping in place, returns
+/// false if it could not (e.g. out of trials).
+using CellFlow = std::function<bool(PendulumSystem::StateType &)>;
+
+/*!
+ * @brief Integrates a state for a fixed duration.
+ * @param[in] theIntegrator Integrator callable as theIntegrator(theSystem,
+ *state, time, stepSize), see integratePoint. The step size is cut so the last
+ *step ends at the duration.
+ * @return false if the duration was not reached within trialCount trials.
+ */
+template <typename Integrator, typename SystemType>
+inline bool advanceState(Integrator &&theIntegrator,
+                         const SystemType &theSystem,
+                         PendulumSystem::StateType &state, double duration,
+                         double startingStepSize,
+                         int trialCount = maximumTrialCount) {
+  double time = 0.0;
+  double stepSize = startingStepSize;
+  for (int trial = 0; duration - time > 1e-12 * duration; ++trial) {
+    if (trial >= trialCount)
+      return false;
+
+    const double remainingTime = duration - time;
+    const bool isLastStep = stepSize >= remainingTime;
+    double step = isLastStep ? remainingTime : stepSize;
+    const bool isAccepted = theIntegrator(theSystem, state, time, step) != 0;
+    // the cut last step does not shrink the step size of the next attempt
+    if (!(isLastStep && isAccepted))
+      stepSize = step;
+  }
+
+  return true;
+}
+
+/*!
+ * @brief Simple cell mapping of the pendulum phase space, resolves the basin
+ *of every cell from one short trajectory per cell.
+ *
+ * The state space (x, y, x velocity, y velocity) is divided into cells, a
+ *square grid of positionCellCount cells per side over the reach of the
+ *pendulum times a square grid of velocityCellCount cells per side over the
+ *speeds the head can reach at rest anywhere in the reach (from the range of
+ *potentialEnergy). The velocity cell count is odd so a cell is centered on
+ *rest.
+ *
+ * mapCells integrates the center of every cell over the mapping time, the
+ *cell holding the end state is the image of the cell, states leaving the
+ *cells map to the sink. The images form a graph with one edge per cell,
+ *resolve follows it from every cell until it reaches the sink, a cell already
+ *resolved or closes a cycle (a periodic group, the strongly connected
+ *components of this graph). A periodic group whose cells are all near the
+ *same attractor (or the middle) is its basin, other groups and the sink are
+ *unresolved. The converge time of a cell is its number of mappings to its
+ *periodic group times the mapping time.
+ *
+ * With energy capture (the system has wells) the cells whose center is below
+ *the heuristic capture energy of the well of an attractor (or the middle) are
+ *absorbing: resolve assigns them to it without following their images, as
+ *ConvergenceMonitor::capture stops integrating such points. Without it every
+ *cell is resolved from its images.
+ *
+ * fill then classifies map points by the cell of their initial state, so
+ *the map costs one trajectory of the mapping time per cell regardless of its
+ *size. The cells are as coarse as the memory allows (8 bytes per cell), the
+ *basins are an approximation of the integrated ones near their boundaries.
+ */
+class CellMapping {
+public:
+  /// Image of the cells that leave the cells (or were not mapped).
+  static constexpr std::int32_t sinkCell = -1;
+  /// Largest number of cells, the images are 32 bit cell indices.
+  static constexpr std::size_t maximumCellCount = 2147483647;
+
+  CellMapping(const PendulumSystem &system, std::size_t positionCellCount,
+              std::size_t velocityCellCount, double mappingTime);
+
+  std::size_t positionCellCount() const { return m_positionCellCount; }
+  std::size_t velocityCellCount() const { return m_velocityCellCount; }
+  std::size_t cellCount() const { return m_images.size(); }
+  double positionSpacing() const { return m_positionSpacing; }
+  double velocitySpacing() const { return m_velocitySpacing; }
+  double mappingTime() const { return m_mappingTime; }
+
+  /// Cell holding the state, sinkCell if it is outside of the cells.
+  std::int32_t cellOf(const PendulumSystem::StateType &state) const;
+  /// State at the center of the cell.
+  PendulumSystem::StateType cellCenter(std::size_t cell) const;
+
+  /// Tiles over the cells, a row holds positionCellCount cells along x.
+  std::vector<Tile> tiles() const;
+  /// Maps the cells of the tile with the flow.
+  void mapCells(const Tile &row, const CellFlow &flow);
+  /// Marks the images complete once every tile is mapped, only a mapped cell
+  /// mapping can be resolved and reused.
+  void setMapped() { m_isMapped = true; }
+  bool isMapped() const { return m_isMapped; }
+
+  /// Image of the cell, see mapCells.
+  std::int32_t image(std::size_t cell) const { return m_images[cell]; }
+
+  /// Resolves the basin of every cell with the convergence thresholds of
+  /// ConvergenceMonitor.
+  void resolve(double attractorPositionThreshold, double midPositionThreshold);
+  /// Number of periodic groups found by resolve and the number of them that
+  /// are resolved to an attractor or the middle.
+  std::size_t periodicGroupCount() const { return m_periodicGroupCount; }
+  std::size_t resolvedGroupCount() const { return m_resolvedGroupCount; }
+  /// Number of cells resolve found below the capture energy of the well of
+  /// an attractor (or the middle), 0 without energy capture.
+  std::size_t absorbingCellCount() const { return m_absorbingCellCount; }
+  /// Converge position of the cell after resolve, unresolvedPosition for the
+  /// cells mapping to the sink or an unresolved periodic group.
+  int convergePosition(std::size_t cell) const { return m_positions[cell]; }
+  /// Converge time of the cell after resolve.
+  double convergeTime(std::size_t cell) const {
+    return m_mappingCounts[cell] * m_mappingTime;
+  }
+
+  /// Sets the results of the integrable points of the map (see isIntegrable)
+  /// from the cells of their initial states, their step counts are 0.
+  void fill(Map &map) const;
+
+private:
+  PendulumSystem m_system;
+  std::size_t m_positionCellCount;
+  std::size_t m_velocityCellCount;
+  double m_positionSpacing;
+  double m_velocitySpacing;
+  double m_mappingTime;
+  bool m_isMapped = false;
+  std::size_t m_periodicGroupCount = 0;
+  std::size_t m_resolvedGroupCount = 0;
+  std::size_t m_absorbingCellCount = 0;
+  std::shared_ptr<const AttractorWells> m_wells;
+  // cells ordered by x, y, x velocity and y velocity cell, x fastest
+  std::vector<std::int32_t> m_images;
+  std::vector<std::int16_t> m_positions;
+  std::vector<std::uint16_t> m_mappingCounts;
+};
+} // namespace staticpendulum
+#endif // CELLMAPPING_H
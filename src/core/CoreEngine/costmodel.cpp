@@ -0,0 +1,64 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "costmodel.h"
+#include <cmath>
+
+namespace staticpendulum {
+StepCountCostModel::StepCountCostModel(const Map &integratedMap)
+    : m_rows(integratedMap.rows()), m_cols(integratedMap.cols()),
+      m_xFirst(integratedMap.begin()->xPosition),
+      m_yFirst(integratedMap.begin()->yPosition),
+      m_resolution(integratedMap.resolution()) {
+  m_stepCounts.reserve(m_rows * m_cols);
+  double stepCountSum = 0.0;
+  std::size_t integratedCount = 0;
+  for (const auto &point : integratedMap) {
+    m_stepCounts.push_back(point.stepCount);
+    if (point.stepCount > 0) {
+      stepCountSum += point.stepCount;
+      ++integratedCount;
+    }
+  }
+
+  m_meanCost = integratedCount == 0 ? 1.0 : stepCountSum / integratedCount;
+}
+
+double StepCountCostModel::pointCost(double x, double y) const {
+  // rows go down in y from the first point, see Map
+  const double column = std::round((x - m_xFirst) / m_resolution);
+  const double row = std::round((m_yFirst - y) / m_resolution);
+  if (column < 0.0 || row < 0.0 || column >= static_cast<double>(m_cols) ||
+      row >= static_cast<double>(m_rows))
+    return m_meanCost;
+
+  const int stepCount = m_stepCounts[static_cast<std::size_t>(row) * m_cols +
+                                     static_cast<std::size_t>(column)];
+  return stepCount > 0 ? stepCount : m_meanCost;
+}
+
+Map makeCoarsePrepassMap(const Map &map) {
+  return Map(map.xStart(), map.yStart(), map.xEnd(), map.yEnd(),
+             map.resolution() * coarsePrepassFactor);
+}
+} // namespace staticpendulum
@@ -0,0 +1,178 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+#include "tilescheduler.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace staticpendulum {
+/*!
+ * @brief Predicts the integration cost of map points from the step counts of
+ *an already integrated map.
+ *
+ * The integrated map may be the previous run or a coarse pre-pass over the
+ *same area, the cost of a point is the step count of the nearest point of the
+ *integrated map. Points outside of the integrated map or nearest to a point
+ *that was not integrated get the mean step count.
+ */
+class StepCountCostModel {
+public:
+  explicit StepCountCostModel(const Map &integratedMap);
+
+  /// Predicted cost (integration steps) of the point at (x, y).
+  double pointCost(double x, double y) const;
+  /// Mean step count of the integrated points.
+  double meanCost() const { return m_meanCost; }
+
+private:
+  std::size_t m_rows;
+  std::size_t m_cols;
+  double m_xFirst;
+  double m_yFirst;
+  double m_resolution;
+  double m_meanCost;
+  std::vector<int> m_stepCounts;
+};
+
+/// Number of points per side of the coarse pre-pass grid cell, the pre-pass
+/// integrates 1 in coarsePrepassFactor^2 points.
+constexpr std::size_t coarsePrepassFactor = 8;
+
+/// Map over the same area as map with coarsePrepassFactor times its
+/// resolution, integrated to build a StepCountCostModel.
+Map makeCoarsePrepassMap(const Map &map);
+
+/// Predicted cost of every tile, the sum of its integrable point costs.
+template <typename SystemType>
+std::vector<double> tileCosts(const Map &map, const SystemType &theSystem,
+                              const std::vector<Tile> &tiles,
+                              const StepCountCostModel &costModel) {
+  std::vector<double> costs;
+  costs.reserve(tiles.size());
+  for (const auto &tile : tiles) {
+    double cost = 0.0;
+    for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+      const auto rowBegin = map.rowBegin(row);
+      for (auto point = rowBegin + tile.firstColumn,
+                endPoint = rowBegin + tile.lastColumn;
+           point != endPoint; ++point) {
+        if (isIntegrable(theSystem, *point))
+          cost += costModel.pointCost(point->xPosition, point->yPosition);
+      }
+    }
+    costs.push_back(cost);
+  }
+
+  return costs;
+}
+
+/// Tiles with fewer points are not split by splitTilesByCost.
+constexpr std::size_t minimumCostTilePointCount = 16;
+
+/*!
+ * @brief Sizes tiles by predicted cost: tiles predicted to cost more than
+ *targetCost are halved across their longer side (and shrunk to their
+ *integrable points again) until they are within the target or have fewer than
+ *minimumCostTilePointCount points. Cheap areas keep large tiles and expensive
+ *areas (e.g. basin boundaries) end up in small ones.
+ * @param[in,out] costs Predicted cost of every tile, updated to the returned
+ *tiles.
+ */
+template <typename SystemType>
+std::vector<Tile> splitTilesByCost(const Map &map, const SystemType &theSystem,
+                                   const std::vector<Tile> &tiles,
+                                   const StepCountCostModel &costModel,
+                                   double targetCost,
+                                   std::vector<double> &costs) {
+  std::vector<Tile> result;
+  std::vector<double> resultCosts;
+  std::vector<Tile> pending(tiles.rbegin(), tiles.rend());
+  std::vector<double> pendingCosts(costs.rbegin(), costs.rend());
+  while (!pending.empty()) {
+    const Tile tile = pending.back();
+    const double cost = pendingCosts.back();
+    pending.pop_back();
+    pendingCosts.pop_back();
+    if (cost <= targetCost || tile.pointCount() < minimumCostTilePointCount) {
+      result.push_back(tile);
+      resultCosts.push_back(cost);
+      continue;
+    }
+
+    std::vector<Tile> halves(2, tile);
+    if (tile.rowCount() >= tile.columnCount()) {
+      halves[0].lastRow = halves[1].firstRow =
+          tile.firstRow + tile.rowCount() / 2;
+    } else {
+      halves[0].lastColumn = halves[1].firstColumn =
+          tile.firstColumn + tile.columnCount() / 2;
+    }
+
+    // second half pushed first so the tiles stay in map order
+    for (auto half = halves.rbegin(); half != halves.rend(); ++half) {
+      if (shrinkToIntegrable(map, theSystem, *half)) {
+        pending.push_back(*half);
+        pendingCosts.push_back(
+            tileCosts(map, theSystem, {*half}, costModel).front());
+      }
+    }
+  }
+
+  costs = resultCosts;
+  return result;
+}
+
+/// Number of tiles per thread makeCostTiles aims for.
+constexpr std::size_t costTilesPerThread = 16;
+
+/*!
+ * @brief Tiles of the map sized by predicted cost for threadCount threads.
+ *
+ * Starts from tiles of 4 x 4 default tiles and splits them (see
+ *splitTilesByCost) until each is predicted to cost at most 1 /
+ *costTilesPerThread of the work of a thread.
+ * @param[out] costs Predicted cost of every returned tile.
+ */
+template <typename SystemType>
+std::vector<Tile> makeCostTiles(const Map &map, const SystemType &theSystem,
+                                const StepCountCostModel &costModel,
+                                unsigned threadCount,
+                                std::vector<double> &costs) {
+  const std::vector<Tile> tiles = makeTiles(
+      map, theSystem, 4 * defaultTileRows, 4 * defaultTileColumns);
+  costs = tileCosts(map, theSystem, tiles, costModel);
+  double totalCost = 0.0;
+  for (double cost : costs) {
+    totalCost += cost;
+  }
+
+  const double targetCost =
+      totalCost / (static_cast<double>(std::max(threadCount, 1u)) *
+                   static_cast<double>(costTilesPerThread));
+  return splitTilesByCost(map, theSystem, tiles, costModel, targetCost, costs);
+}
+} // namespace staticpendulum
+#endif // COSTMODEL_H
@@ -0,0 +1,114 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef DENSEOUTPUT_H
+#define DENSEOUTPUT_H
+#include <array>
+#include <cstddef>
+
+namespace staticpendulum {
+/*!
+ * @brief Dense output of an integration step, the cubic Hermite interpolant
+ *of the states and derivatives at both ends of the step.
+ *
+ * Every stepper of the engine has the state and its derivative at the start
+ *of a step and can have them at its end (the explicit Runge Kutta steppers
+ *update the derivative of the first same as last stage, see
+ *explicitRungeKutta), so the interpolant costs no extra evaluation of the
+ *system. It is third order accurate, the error within a step is of the order
+ *of h^4 times the fourth derivative of the solution, below the error of the
+ *step for the step sizes the tolerances of the steppers allow.
+ *
+ * The position of the pendulum head has the velocity as derivative, and the
+ *velocity is part of the state, so the head position (see
+ *headPositionInterpolant) is interpolated from the two states alone.
+ * @tparam StateSize The number of interpolated components.
+ */
+template <std::size_t StateSize> class HermiteInterpolant {
+public:
+  using StateType = std::array<double, StateSize>;
+
+  /*!
+   * @param[in] startTime, startState, startDerivative The start of the step.
+   * @param[in] endTime, endState, endDerivative The end of the step, endTime
+   *must differ from startTime.
+   */
+  HermiteInterpolant(double startTime, const StateType &startState,
+                     const StateType &startDerivative, double endTime,
+                     const StateType &endState, const StateType &endDerivative)
+      : m_startTime(startTime), m_stepSize(endTime - startTime),
+        m_startState(startState), m_endState(endState) {
+    for (std::size_t i = 0; i < StateSize; ++i) {
+      m_startSlope[i] = m_stepSize * startDerivative[i];
+      m_endSlope[i] = m_stepSize * endDerivative[i];
+    }
+  }
+
+  double startTime() const { return m_startTime; }
+  double endTime() const { return m_startTime + m_stepSize; }
+
+  /// Component i of the interpolated state at time t within the step.
+  double operator()(std::size_t i, double t) const {
+    const double s = (t - m_startTime) / m_stepSize;
+    const double oneMinusS = 1.0 - s;
+    // x0 + s^2 (3 - 2 s) (x1 - x0) + s (1 - s)^2 m0 - s^2 (1 - s) m1, the
+    // Hermite basis with h00 = 1 - h01
+    const double difference = m_endState[i] - m_startState[i];
+    return m_startState[i] +
+           s * (m_startSlope[i] * oneMinusS * oneMinusS +
+                s * ((3.0 - 2.0 * s) * difference -
+                     m_endSlope[i] * oneMinusS));
+  }
+
+  /// Interpolated state at time t within the step.
+  StateType operator()(double t) const {
+    StateType result;
+    for (std::size_t i = 0; i < StateSize; ++i) {
+      result[i] = (*this)(i, t);
+    }
+    return result;
+  }
+
+private:
+  double m_startTime;
+  double m_stepSize;
+  StateType m_startState;
+  StateType m_endState;
+  // derivatives scaled by the step size
+  StateType m_startSlope;
+  StateType m_endSlope;
+};
+
+/// Interpolant of the pendulum head position (x, y) over a step from the
+/// states (x, y, x velocity, y velocity) at both of its ends.
+template <typename StateType>
+inline HermiteInterpolant<2>
+headPositionInterpolant(double startTime, const StateType &startState,
+                        double endTime, const StateType &endState) {
+  return HermiteInterpolant<2>(
+      startTime, {{startState[0], startState[1]}},
+      {{startState[2], startState[3]}}, endTime, {{endState[0], endState[1]}},
+      {{endState[2], endState[3]}});
+}
+} // namespace staticpendulum
+#endif // DENSEOUTPUT_H
@@ -0,0 +1,125 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef DORMANDPRINCE54_H
+#define DORMANDPRINCE54_H
+#include "explicitrungekutta.h"
+#include <array>
+
+namespace staticpendulum {
+/*!
+ * @brief Butcher tableau of the Dormand and Prince embedded Runge Kutta order
+ *5(4) method, see explicitRungeKutta.
+ */
+struct DormandPrince54Tableau {
+  static constexpr std::size_t stageCount = 7;
+  static constexpr int order = 5;
+  static constexpr int errorOrder = 4;
+  static constexpr bool isFsal = true;
+  // stability boundary on the negative real axis
+  static constexpr double stabilityBoundary = 3.31;
+
+  // Constants from Butcher tableau, see:
+  // https://en.wikipedia.org/wiki/Dormand%E2%80%93Prince_method
+  static constexpr double c(std::size_t i) {
+    const double values[stageCount] = {0.0,       1.0 / 5.0, 3.0 / 10.0,
+                                       4.0 / 5.0, 8.0 / 9.0, 1.0,
+                                       1.0};
+    return values[i];
+  }
+
+  static constexpr double a(std::size_t i, std::size_t j) {
+    const double values[stageCount][stageCount] = {
+        {},
+        {1.0 / 5.0},
+        {3.0 / 40.0, 9.0 / 40.0},
+        {44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0},
+        {19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0,
+         -212.0 / 729.0},
+        {9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0,
+         -5103.0 / 18656.0},
+        {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0,
+         11.0 / 84.0}};
+    return values[i][j];
+  }
+
+  // the order 5 weights are the last row of the tableau (FSAL property)
+  static constexpr double b(std::size_t j) { return a(stageCount - 1, j); }
+
+  static constexpr double bHat(std::size_t j) {
+    const double values[stageCount] = {
+        5179.0 / 57600.0,    0.0,           7571.0 / 16695.0, 393.0 / 640.0,
+        -92097.0 / 339200.0, 187.0 / 2100.0, 1.0 / 40.0};
+    return values[j];
+  }
+};
+
+/*!
+ * @brief Dormand and Prince embedded Runge Kutta order 5(4) adaptive step
+ *integrator with first same as last (FSAL) derivative reuse.
+ *
+ * The last stage of an accepted step is evaluated at the new state, so it is
+ *returned through dxdtx and used as the first stage of the next step. A
+ *rejected step keeps x, so dxdtx is still valid for the retry. Every attempt
+ *therefore costs six evaluations of the system against six for cashKarp54,
+ *while the smaller error constant of the method allows larger steps for the
+ *same tolerance.
+ *
+ * See: J. R. Dormand, P. J. Prince. "A family of embedded Runge-Kutta
+ *formulae." Journal of Computational and Applied Mathematics, Vol. 6, No. 1,
+ *1980.
+ *
+ * And Wikipedia: https://en.wikipedia.org/wiki/Dormand%E2%80%93Prince_method
+ * @tparam SystemType The type for the system being integrated, see
+ *cashKarp54.
+ * @tparam StateSize The length of the std::array holding the state.
+ * @param[in] dxdt The system being integrated as a callable object to perform a
+ *step.
+ * @param[in,out] x The state to be integrated forward one step.
+ * @param[in,out] dxdtx The derivative of the system at x and t. Must be filled
+ *before the first step (e.g. by calling dxdt(x, dxdtx, t)), it is updated
+ *along with x when a step is accepted.
+ * @param[in,out] t Current time of the system that will be updated after taking
+ *the step.
+ * @param[in,out] h The step size to take, this is updated after taking the
+ *step.
+ * @param[in] relTol The relative tolerance allowed, this affects how the step
+ *size is adjusted.
+ * @param[in] absTol The absolute tolerance allowed, this affects how the step
+ *size is adjusted.
+ * @param[in] maxStepSize The maximum step size allowed, h will not grow larger
+ *than this value.
+ * @return 0 if the step size created too much error and did not perform the
+ *step but adjusted the step size, 1 if step size was accepted and step was
+ *performed.
+ */
+template <typename SystemType, std::size_t StateSize>
+inline int dormandPrince54(SystemType &&dxdt, std::array<double, StateSize> &x,
+                           std::array<double, StateSize> &dxdtx, double &t,
+                           double &h, double relTol, double absTol,
+                           double maxStepSize) {
+  return explicitRungeKutta<DormandPrince54Tableau>(dxdt, x, dxdtx, t, h,
+                                                    relTol, absTol, maxStepSize);
+}
+} // namespace staticpendulum
+#endif // DORMANDPRINCE54_H
@@ -0,0 +1,186 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef DORMANDPRINCE853_H
+#define DORMANDPRINCE853_H
+#include "explicitrungekutta.h"
+
+namespace staticpendulum {
+/*!
+ * @brief Butcher tableau of the Dormand and Prince embedded Runge Kutta order
+ *8(5,3) method, see explicitRungeKutta.
+ *
+ * The order 8 solution is propagated. The step error combines the order 5 and
+ *order 3 embedded estimates as err5^2 / sqrt(err5^2 + 0.01 * err3^2), which
+ *behaves like h^8 and stays reliable for large steps where the order 5
+ *estimate alone underestimates the error. The combined estimate is one order
+ *above errorOrder like the single estimate of the other tableaus.
+ *
+ * See: E. Hairer, S. P. Norsett, G. Wanner. "Solving Ordinary Differential
+ *Equations I. Nonstiff Problems." 2nd edition, Springer, 1993, section II.10.
+ *Coefficients are the ones used in the DOP853 code of the same authors.
+ */
+struct DormandPrince853Tableau {
+  static constexpr std::size_t stageCount = 12;
+  static constexpr int order = 8;
+  static constexpr int errorOrder = 7;
+  static constexpr bool isFsal = false;
+  // stability boundary on the negative real axis
+  static constexpr double stabilityBoundary = 6.39;
+
+  static constexpr double c(std::size_t i) {
+    const double values[stageCount] = {0.0,
+                                       5.26001519587677318785587544488e-2,
+                                       7.89002279381515978178381316732e-2,
+                                       1.18350341907227396726757197510e-1,
+                                       2.81649658092772603273242802490e-1,
+                                       1.0 / 3.0,
+                                       0.25,
+                                       4.0 / 13.0,
+                                       127.0 / 195.0,
+                                       0.6,
+                                       6.0 / 7.0,
+                                       1.0};
+    return values[i];
+  }
+
+  static constexpr double a(std::size_t i, std::size_t j) {
+    const double values[stageCount][stageCount] = {
+        {},
+        {5.26001519587677318785587544488e-2},
+        {1.97250569845378994544595329183e-2,
+         5.91751709536136983633785987549e-2},
+        {2.95875854768068491816892993775e-2, 0.0,
+         8.87627564304205475450678981324e-2},
+        {2.41365134159266685502369798665e-1, 0.0,
+         -8.84549479328286085344864962717e-1,
+         9.24834003261792003115737966543e-1},
+        {3.7037037037037037037037037037e-2, 0.0, 0.0,
+         1.70828608729473871279604482173e-1,
+         1.25467687566822425016691814123e-1},
+        {3.7109375e-2, 0.0, 0.0, 1.70252211019544039314978060272e-1,
+         6.02165389804559606850219397283e-2, -1.7578125e-2},
+        {3.70920001185047927108779319836e-2, 0.0, 0.0,
+         1.70383925712239993810214054705e-1,
+         1.07262030446373284651809199168e-1,
+         -1.53194377486244017527936158236e-2,
+         8.27378916381402288758473766002e-3},
+        {6.24110958716075717114429577812e-1, 0.0, 0.0,
+         -3.36089262944694129406857109825e0,
+         -8.68219346841726006818189891453e-1,
+         2.75920996994467083049415600797e1, 2.01540675504778934086186788979e1,
+         -4.34898841810699588477366255144e1},
+        {4.77662536438264365890433908527e-1, 0.0, 0.0,
+         -2.48811461997166764192642586468e0,
+         -5.90290826836842996371446475743e-1,
+         2.12300514481811942347288949897e1, 1.52792336328824235832596922938e1,
+         -3.32882109689848629194453265587e1,
+         -2.03312017085086261358222928593e-2},
+        {-9.3714243008598732571704021658e-1, 0.0, 0.0,
+         5.18637242884406370830023853209e0, 1.09143734899672957818500254654e0,
+         -8.14978701074692612513997267357e0,
+         -1.85200656599969598641566180701e1, 2.27394870993505042818970056734e1,
+         2.49360555267965238987089396762e0,
+         -3.0467644718982195003823669022e0},
+        {2.27331014751653820792359768449e0, 0.0, 0.0,
+         -1.05344954667372501984066689879e1,
+         -2.00087205822486249909675718444e0,
+         -1.79589318631187989172765950534e1, 2.79488845294199600508499808837e1,
+         -2.85899827713502369474065508674e0,
+         -8.87285693353062954433549289258e0, 1.23605671757943030647266201528e1,
+         6.43392746015763530355970484046e-1}};
+    return values[i][j];
+  }
+
+  static constexpr double b(std::size_t j) {
+    const double values[stageCount] = {5.42937341165687622380535766363e-2,
+                                       0.0,
+                                       0.0,
+                                       0.0,
+                                       0.0,
+                                       4.45031289275240888144113950566e0,
+                                       1.89151789931450038304281599044e0,
+                                       -5.8012039600105847814672114227e0,
+                                       3.1116436695781989440891606237e-1,
+                                       -1.52160949662516078556178806805e-1,
+                                       2.01365400804030348374776537501e-1,
+                                       4.47106157277725905176885569043e-2};
+    return values[j];
+  }
+
+  // the order 5 weights are given as their difference to the order 8 weights
+  static constexpr double bHat(std::size_t j) {
+    const double differences[stageCount] = {
+        1.312004499419488073250102996e-2,
+        0.0,
+        0.0,
+        0.0,
+        0.0,
+        -1.225156446376204440720569753e0,
+        -4.957589496572501915214079952e-1,
+        1.664377182454986536961530415e0,
+        -3.503288487499736816886487290e-1,
+        3.341791187130174790297318841e-1,
+        8.192320648511571246570742613e-2,
+        -2.235530786388629525884427845e-2};
+    return b(j) - differences[j];
+  }
+
+  // order 3 weights for the secondary error estimate
+  static constexpr double bHatLow(std::size_t j) {
+    const double values[stageCount] = {2.44094488188976377952755905512e-1,
+                                       0.0,
+                                       0.0,
+                                       0.0,
+                                       0.0,
+                                       0.0,
+                                       0.0,
+                                       0.0,
+                                       7.33846688281611857341361741547e-1,
+                                       0.0,
+                                       0.0,
+                                       2.20588235294117647058823529412e-2};
+    return values[j];
+  }
+};
+
+/*!
+ * @brief Dormand and Prince embedded Runge Kutta order 8(5,3) adaptive step
+ *integrator.
+ *
+ * Each attempt costs eleven evaluations of the system plus one at the new state
+ *after an accepted step, but at tight tolerances (around 1e-10) it takes far
+ *fewer steps than the order 5 methods. Parameters are the same as
+ *dormandPrince54.
+ */
+template <typename SystemType, std::size_t StateSize>
+inline int dormandPrince853(SystemType &&dxdt,
+                            std::array<double, StateSize> &x,
+                            std::array<double, StateSize> &dxdtx, double &t,
+                            double &h, double relTol, double absTol,
+                            double maxStepSize) {
+  return explicitRungeKutta<DormandPrince853Tableau>(
+      dxdt, x, dxdtx, t, h, relTol, absTol, maxStepSize);
+}
+} // namespace staticpendulum
+#endif // DORMANDPRINCE853_H
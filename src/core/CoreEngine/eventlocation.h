@@ -0,0 +1,83 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef EVENTLOCATION_H
+#define EVENTLOCATION_H
+
+namespace staticpendulum {
+/// Number of iterations after which locateEvent returns its current bracket.
+constexpr int maximumEventIterationCount = 64;
+
+/*!
+ * @brief Locates the time within a step at which an event function crosses
+ *from positive to non positive values, e.g. the pendulum head entering a
+ *zone around an attractor.
+ *
+ * The event function is usually evaluated on the dense output of the step
+ *(see HermiteInterpolant), so the event time is found as precisely as the
+ *solution is known regardless of the step size. The root is bracketed and
+ *found with the Illinois variant of regula falsi, which converges
+ *superlinearly for smooth functions and never leaves the bracket, so it also
+ *locates the crossings of continuous but non smooth functions such as the
+ *distance in the maximum norm.
+ * @param[in] eventFunction Callable as eventFunction(t).
+ * @param[in] startTime, startValue The start of the bracket, startValue > 0.
+ * @param[in] endTime, endValue The end of the bracket, endValue <= 0.
+ * @param[in] timeTolerance Width of the bracket at which the search stops.
+ * @return The end of the final bracket, the earliest time found at which the
+ *event function is not positive.
+ */
+template <typename EventFunction>
+inline double locateEvent(const EventFunction &eventFunction,
+                          double startTime, double startValue, double endTime,
+                          double endValue, double timeTolerance) {
+  // the function value at the end kept for a second time is halved
+  int lastMovedEnd = 0;
+  for (int iteration = 0; iteration < maximumEventIterationCount &&
+                          endTime - startTime > timeTolerance;
+       ++iteration) {
+    double time = (startTime * endValue - endTime * startValue) /
+                  (endValue - startValue);
+    if (!(time > startTime && time < endTime))
+      time = 0.5 * (startTime + endTime);
+
+    const double value = eventFunction(time);
+    if (value <= 0.0) {
+      endTime = time;
+      endValue = value;
+      if (lastMovedEnd == 1)
+        startValue *= 0.5;
+      lastMovedEnd = 1;
+    } else {
+      startTime = time;
+      startValue = value;
+      if (lastMovedEnd == -1)
+        endValue *= 0.5;
+      lastMovedEnd = -1;
+    }
+  }
+
+  return endTime;
+}
+} // namespace staticpendulum
+#endif // EVENTLOCATION_H
@@ -0,0 +1,490 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef EXPLICITRUNGEKUTTA_H
+#define EXPLICITRUNGEKUTTA_H
+#include "batchstate.h"
+#include "stepsizecontroller.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+namespace staticpendulum {
+namespace detail {
+/// Adds weight * k to partial, specialized to drop terms whose weight is zero
+/// at compile time.
+template <bool IsNonZero>
+inline double addTerm(double partial, double weight, double k) {
+  return partial + weight * k;
+}
+
+template <> inline double addTerm<false>(double partial, double, double) {
+  return partial;
+}
+
+/// Element i of a single state or element [i][l] of a batch state.
+template <typename State> inline double element(const State &k, std::size_t i) {
+  return k[i];
+}
+
+template <typename State>
+inline double element(const State &k, std::size_t i, std::size_t l) {
+  return k[i][l];
+}
+
+/// Weights of the row of the tableau used to compute the input of a stage.
+template <typename Tableau, std::size_t Stage> struct StageWeights {
+  static constexpr double value(std::size_t j) { return Tableau::a(Stage, j); }
+};
+
+/// Weights used to compute the propagated solution.
+template <typename Tableau> struct SolutionWeights {
+  static constexpr double value(std::size_t j) { return Tableau::b(j); }
+};
+
+/// Weights used to compute the difference between the propagated and embedded
+/// solutions (error estimate).
+template <typename Tableau> struct ErrorWeights {
+  static constexpr double value(std::size_t j) {
+    return Tableau::b(j) - Tableau::bHat(j);
+  }
+};
+
+/// Weights used to compute the difference between the propagated and the
+/// secondary lower order embedded solution.
+template <typename Tableau> struct LowErrorWeights {
+  static constexpr double value(std::size_t j) {
+    return Tableau::b(j) - Tableau::bHatLow(j);
+  }
+};
+
+/// True if the tableau provides a secondary embedded solution through
+/// bHatLow(j).
+template <typename Tableau, typename = void>
+struct HasLowOrderWeights : std::false_type {};
+
+template <typename Tableau>
+struct HasLowOrderWeights<Tableau, decltype(void(Tableau::bHatLow(0)))>
+    : std::true_type {};
+
+/// Number of the first count weights that are not zero.
+template <typename Weights>
+constexpr std::size_t nonZeroCount(std::size_t count) {
+  std::size_t nonZero = 0;
+  for (std::size_t j = 0; j < count; ++j) {
+    if (Weights::value(j) != 0.0)
+      ++nonZero;
+  }
+  return nonZero;
+}
+
+/// Index of the first weight that is not zero, count if there is none.
+template <typename Weights>
+constexpr std::size_t firstNonZero(std::size_t count) {
+  std::size_t j = 0;
+  while (j < count && Weights::value(j) == 0.0) {
+    ++j;
+  }
+  return j;
+}
+
+/// Adds Weights::value(J) * k[J] for J in [J, Count) to partial at compile
+/// time unrolled, keeping the left to right summation order.
+template <typename Weights, std::size_t J, std::size_t Count>
+struct PartialSum {
+  template <typename Stages, typename... Index>
+  static double sum(const Stages &k, double partial, Index... index) {
+    constexpr double weight = Weights::value(J);
+    return PartialSum<Weights, J + 1, Count>::sum(
+        k, addTerm<(weight != 0.0)>(partial, weight, element(k[J], index...)),
+        index...);
+  }
+};
+
+template <typename Weights, std::size_t Count>
+struct PartialSum<Weights, Count, Count> {
+  template <typename Stages, typename... Index>
+  static double sum(const Stages &, double partial, Index...) {
+    return partial;
+  }
+};
+
+/// Computes h * sum(Weights::value(j) * k[j]) for j in [0, Count) in the
+/// form of the hand written Cash-Karp step, so the rounding is the same: the
+/// sum starts from its first non zero term, and a single term is computed as
+/// h * a * k rather than h * (a * k).
+template <typename Weights, std::size_t Count,
+          std::size_t First = firstNonZero<Weights>(Count),
+          bool IsSingleTerm = nonZeroCount<Weights>(Count) == 1>
+struct ScaledSum {
+  template <typename Stages, typename... Index>
+  static double value(const Stages &k, double h, Index... index) {
+    constexpr double weight = Weights::value(First);
+    return h * PartialSum<Weights, First + 1, Count>::sum(
+                   k, weight * element(k[First], index...), index...);
+  }
+};
+
+template <typename Weights, std::size_t Count, std::size_t First>
+struct ScaledSum<Weights, Count, First, true> {
+  template <typename Stages, typename... Index>
+  static double value(const Stages &k, double h, Index... index) {
+    constexpr double weight = Weights::value(First);
+    return h * weight * element(k[First], index...);
+  }
+};
+
+template <typename Weights, std::size_t Count>
+struct ScaledSum<Weights, Count, Count, false> {
+  template <typename Stages, typename... Index>
+  static double value(const Stages &, double, Index...) {
+    return 0.0;
+  }
+};
+
+/// Evaluates stages 1 to Stage of the tableau for a single state (stage 0 is
+/// the derivative at the start of the step and is already filled).
+template <typename Tableau, std::size_t Stage> struct StageLoop {
+  template <typename SystemType, typename State, typename Stages>
+  static void run(SystemType &dxdt, const State &x, Stages &k,
+                  State &tempState, double t, double h) {
+    StageLoop<Tableau, Stage - 1>::run(dxdt, x, k, tempState, t, h);
+
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      tempState[i] =
+          x[i] + ScaledSum<StageWeights<Tableau, Stage>, Stage>::value(k, h, i);
+    }
+
+    constexpr double c = Tableau::c(Stage);
+    dxdt(tempState, k[Stage], t + c * h);
+  }
+};
+
+template <typename Tableau> struct StageLoop<Tableau, 0> {
+  template <typename SystemType, typename State, typename Stages>
+  static void run(SystemType &, const State &, Stages &, State &, double,
+                  double) {}
+};
+
+/// Batched counterpart of StageLoop, see BatchState for the lane layout.
+template <typename Tableau, std::size_t Stage> struct BatchStageLoop {
+  template <typename SystemType, std::size_t StateSize, std::size_t Lanes,
+            typename Stages>
+  static void run(SystemType &dxdt, const BatchState<StateSize, Lanes> &x,
+                  Stages &k, BatchState<StateSize, Lanes> &tempState,
+                  const LaneArray<double, Lanes> &t,
+                  const LaneArray<double, Lanes> &h) {
+    BatchStageLoop<Tableau, Stage - 1>::run(dxdt, x, k, tempState, t, h);
+
+    for (std::size_t i = 0; i < StateSize; ++i) {
+      for (std::size_t l = 0; l < Lanes; ++l) {
+        tempState[i][l] =
+            x[i][l] + ScaledSum<StageWeights<Tableau, Stage>, Stage>::value(
+                          k, h[l], i, l);
+      }
+    }
+
+    constexpr double c = Tableau::c(Stage);
+    LaneArray<double, Lanes> stageTime;
+    for (std::size_t l = 0; l < Lanes; ++l) {
+      stageTime[l] = t[l] + c * h[l];
+    }
+
+    dxdt(tempState, k[Stage], stageTime);
+  }
+};
+
+template <typename Tableau> struct BatchStageLoop<Tableau, 0> {
+  template <typename SystemType, typename State, typename Stages,
+            typename Times>
+  static void run(SystemType &, const State &, Stages &, State &,
+                  const Times &, const Times &) {}
+};
+
+/// Accumulates the max norm of the scaled error estimate of a step.
+template <typename Tableau, bool = HasLowOrderWeights<Tableau>::value>
+struct ErrorNorm {
+  template <typename Stages, typename... Index>
+  void add(const Stages &k, double h, double scale, Index... index) {
+    constexpr std::size_t stageCount = Tableau::stageCount;
+    const double errorEstimate =
+        ScaledSum<ErrorWeights<Tableau>, stageCount>::value(k, h, index...);
+    value = std::max(value, std::abs(errorEstimate / scale));
+  }
+
+  double combined() const { return value; }
+
+  double value = 0.0;
+};
+
+/// Tableaus with a secondary lower order solution combine both estimates as
+/// err^2 / sqrt(err^2 + 0.01 * errLow^2) (Hairer's DOP853 error estimator).
+template <typename Tableau> struct ErrorNorm<Tableau, true> {
+  template <typename Stages, typename... Index>
+  void add(const Stages &k, double h, double scale, Index... index) {
+    constexpr std::size_t stageCount = Tableau::stageCount;
+    const double errorEstimate =
+        ScaledSum<ErrorWeights<Tableau>, stageCount>::value(k, h, index...);
+    const double lowErrorEstimate =
+        ScaledSum<LowErrorWeights<Tableau>, stageCount>::value(k, h,
+                                                               index...);
+    value = std::max(value, std::abs(errorEstimate / scale));
+    lowValue = std::max(lowValue, std::abs(lowErrorEstimate / scale));
+  }
+
+  double combined() const {
+    const double denominator = value * value + 0.01 * lowValue * lowValue;
+    return denominator > 0.0 ? value * value / std::sqrt(denominator) : 0.0;
+  }
+
+  double value = 0.0;
+  double lowValue = 0.0;
+};
+
+/// Keeps dxdtx as the derivative at the new state after an accepted step,
+/// first same as last tableaus already evaluated it as their last stage.
+template <typename SystemType, typename State, typename Stages>
+inline void updateDerivative(SystemType &, const State &, State &dxdtx,
+                             const Stages &k, double, std::true_type) {
+  dxdtx = k.back();
+}
+
+template <typename SystemType, typename State, typename Stages>
+inline void updateDerivative(SystemType &dxdt, const State &x, State &dxdtx,
+                             const Stages &, double t, std::false_type) {
+  dxdt(x, dxdtx, t);
+}
+} // namespace detail
+
+/*!
+ * @brief Generic embedded explicit Runge Kutta adaptive step integrator, the
+ *method is described by its Butcher tableau type.
+ *
+ * The stage loops and weighted sums are unrolled at compile time from the
+ *constexpr tableau, and terms with a zero coefficient are dropped, so the
+ *generated code matches a hand written implementation of the method.
+ *
+ * The derivative at the current state is passed in through dxdtx and kept up
+ *to date after accepted steps, so a rejected step reuses it and first same as
+ *last (FSAL) tableaus reuse their last stage for the next step.
+ *
+ * A tableau type provides:
+ * - stageCount: number of stages.
+ * - order: order of the propagated solution.
+ * - errorOrder: order of the embedded solution used for the error estimate.
+ * - isFsal: true if the last stage is evaluated at the propagated solution.
+ * - stabilityBoundary: where the stability region of the method crosses the
+ *negative real axis (used by StiffnessSwitchingIntegrator).
+ * - constexpr static functions a(i, j), b(j), bHat(j) and c(i) returning the
+ *coefficients, where b are the propagated weights and bHat the embedded ones.
+ * - optionally bHatLow(j), weights of a second lower order embedded solution
+ *whose estimate is combined with the first one, see DormandPrince853Tableau.
+ *
+ * @tparam Tableau The Butcher tableau type of the method, e.g.
+ *CashKarp54Tableau.
+ * @tparam UpdateDerivative If false, dxdtx is not updated after an accepted
+ *step of a non FSAL tableau, for callers that recompute it anyway.
+ * @tparam SystemType The type for the system being integrated, see
+ *cashKarp54.
+ * @tparam StateSize The length of the std::array holding the state.
+ * @param[in] dxdt The system being integrated as a callable object.
+ * @param[in,out] x The state to be integrated forward one step.
+ * @param[in,out] dxdtx The derivative of the system at x and t, must be filled
+ *before the first step.
+ * @param[in,out] t Current time of the system that will be updated after taking
+ *the step.
+ * @param[in,out] h The step size to take, this is updated after taking the
+ *step.
+ * @param[in] relTol The relative tolerance allowed.
+ * @param[in] absTol The absolute tolerance allowed.
+ * @param[in] maxStepSize The maximum step size allowed, h will not grow larger
+ *than this value.
+ * @param[in,out] controller The step size controller adjusting h after the
+ *attempt, see ElementaryStepController. The overload without it uses the
+ *elementary controller.
+ * @return 0 if the step size created too much error and did not perform the
+ *step but adjusted the step size, 1 if step size was accepted and step was
+ *performed.
+ */
+template <typename Tableau, bool UpdateDerivative = true, typename SystemType,
+          std::size_t StateSize, typename Controller>
+inline int explicitRungeKutta(SystemType &&dxdt,
+                              std::array<double, StateSize> &x,
+                              std::array<double, StateSize> &dxdtx, double &t,
+                              double &h, double relTol, double absTol,
+                              double maxStepSize, Controller &controller) {
+  using StateType = std::array<double, StateSize>;
+  constexpr std::size_t stageCount = Tableau::stageCount;
+
+  std::array<StateType, stageCount> k;
+  k[0] = dxdtx;
+
+  // temp state used to store state for next k value
+  StateType tempState;
+  detail::StageLoop<Tableau, stageCount - 1>::run(dxdt, x, k, tempState, t, h);
+
+  StateType potentialSolution;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    potentialSolution[i] =
+        x[i] + detail::ScaledSum<detail::SolutionWeights<Tableau>,
+                                 stageCount>::value(k, h, i);
+  }
+
+  // boost odeint syle error step sizing method
+  detail::ErrorNorm<Tableau> errorNorm;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    errorNorm.add(k, h, absTol + relTol * (potentialSolution[i]), i);
+  }
+  const double maxErrorValue = errorNorm.combined();
+
+  // reject step and decrease step size, dxdtx is still the derivative at x
+  if (maxErrorValue > 1.0) {
+    h = controller.template rejected<Tableau>(h, maxErrorValue);
+    return 0;
+  }
+
+  // use the step
+  t += h;
+  x = potentialSolution;
+  if (Tableau::isFsal || UpdateDerivative) {
+    detail::updateDerivative(dxdt, x, dxdtx, k, t,
+                             std::integral_constant<bool, Tableau::isFsal>());
+  }
+
+  h = controller.template accepted<Tableau>(h, maxErrorValue, maxStepSize);
+  return 1;
+}
+
+template <typename Tableau, bool UpdateDerivative = true, typename SystemType,
+          std::size_t StateSize>
+inline int explicitRungeKutta(SystemType &&dxdt,
+                              std::array<double, StateSize> &x,
+                              std::array<double, StateSize> &dxdtx, double &t,
+                              double &h, double relTol, double absTol,
+                              double maxStepSize) {
+  ElementaryStepController controller;
+  return explicitRungeKutta<Tableau, UpdateDerivative>(
+      dxdt, x, dxdtx, t, h, relTol, absTol, maxStepSize, controller);
+}
+
+/*!
+ * @brief Batched variant of explicitRungeKutta that advances several
+ *independent states in lockstep.
+ *
+ * The states are held in structure of arrays lanes (see BatchState) so every
+ *stage is computed for all lanes at once by vectorized loops. Each lane keeps
+ *its own time and step size, and is accepted or rejected on its own; a
+ *rejected lane keeps its state, time and derivative but has its step size
+ *reduced exactly as explicitRungeKutta would.
+ * @tparam SystemType The type for the system being integrated, must be a
+ *callable object that accepts a BatchState<StateSize, Lanes> as the current
+ *states, a BatchState<StateSize, Lanes>& to write the derivatives to, and a
+ *LaneArray<double, Lanes> holding the time value of each lane.
+ * @param[in,out] dxdtx The derivatives of the system at x and t for every lane,
+ *must be filled before the first step and is kept up to date.
+ * @param[out] accepted Set to 1 for lanes whose step was accepted and 0 for
+ *lanes whose step was rejected.
+ * @param[in,out] controllers The step size controller of every lane.
+ */
+template <typename Tableau, typename SystemType, std::size_t StateSize,
+          std::size_t Lanes, typename Controller>
+inline void explicitRungeKuttaBatch(
+    SystemType &&dxdt, BatchState<StateSize, Lanes> &x,
+    BatchState<StateSize, Lanes> &dxdtx, LaneArray<double, Lanes> &t,
+    LaneArray<double, Lanes> &h, LaneArray<int, Lanes> &accepted,
+    double relTol, double absTol, double maxStepSize,
+    LaneArray<Controller, Lanes> &controllers) {
+  constexpr std::size_t stageCount = Tableau::stageCount;
+
+  std::array<BatchState<StateSize, Lanes>, stageCount> k;
+  k[0] = dxdtx;
+
+  BatchState<StateSize, Lanes> tempState;
+  detail::BatchStageLoop<Tableau, stageCount - 1>::run(dxdt, x, k, tempState,
+                                                       t, h);
+
+  // potential solution is stored in tempState, the per lane max error is
+  // accumulated while computing it (boost odeint syle error step sizing)
+  std::array<detail::ErrorNorm<Tableau>, Lanes> errorNorms;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    for (std::size_t l = 0; l < Lanes; ++l) {
+      tempState[i][l] =
+          x[i][l] + detail::ScaledSum<detail::SolutionWeights<Tableau>,
+                                      stageCount>::value(k, h[l], i, l);
+      errorNorms[l].add(k, h[l], absTol + relTol * tempState[i][l], i, l);
+    }
+  }
+
+  LaneArray<double, Lanes> maxErrorValue;
+  for (std::size_t l = 0; l < Lanes; ++l) {
+    maxErrorValue[l] = errorNorms[l].combined();
+  }
+
+  int acceptedCount = 0;
+  for (std::size_t l = 0; l < Lanes; ++l) {
+    const bool accept = !(maxErrorValue[l] > 1.0);
+    accepted[l] = accept ? 1 : 0;
+    acceptedCount += accepted[l];
+    const double stepSize = h[l];
+    t[l] = accept ? t[l] + stepSize : t[l];
+    h[l] = accept ? controllers[l].template accepted<Tableau>(
+                        stepSize, maxErrorValue[l], maxStepSize)
+                  : controllers[l].template rejected<Tableau>(
+                        stepSize, maxErrorValue[l]);
+  }
+
+  // blend accepted and rejected lanes without branching so the loops stay
+  // vectorized
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    for (std::size_t l = 0; l < Lanes; ++l) {
+      x[i][l] = accepted[l] ? tempState[i][l] : x[i][l];
+    }
+  }
+
+  if (Tableau::isFsal) {
+    for (std::size_t i = 0; i < StateSize; ++i) {
+      for (std::size_t l = 0; l < Lanes; ++l) {
+        dxdtx[i][l] = accepted[l] ? k[stageCount - 1][i][l] : dxdtx[i][l];
+      }
+    }
+  } else if (acceptedCount != 0) {
+    // rejected lanes get their unchanged derivative recomputed, which costs
+    // nothing extra since all lanes are evaluated together
+    dxdt(x, dxdtx, t);
+  }
+}
+
+template <typename Tableau, typename SystemType, std::size_t StateSize,
+          std::size_t Lanes>
+inline void explicitRungeKuttaBatch(
+    SystemType &&dxdt, BatchState<StateSize, Lanes> &x,
+    BatchState<StateSize, Lanes> &dxdtx, LaneArray<double, Lanes> &t,
+    LaneArray<double, Lanes> &h, LaneArray<int, Lanes> &accepted,
+    double relTol, double absTol, double maxStepSize) {
+  LaneArray<ElementaryStepController, Lanes> controllers;
+  explicitRungeKuttaBatch<Tableau>(dxdt, x, dxdtx, t, h, accepted, relTol,
+                                   absTol, maxStepSize, controllers);
+}
+} // namespace staticpendulum
+#endif // EXPLICITRUNGEKUTTA_H
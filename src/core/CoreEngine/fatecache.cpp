@@ -0,0 +1,219 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "fatecache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace staticpendulum {
+namespace {
+// a value is the converge position (offset by positionOffset) in bits 0-15,
+// the number of agreeing trajectories in bits 16-31 and the remaining
+// converge time as a float in bits 32-63, a value of 0 has no trajectory yet
+constexpr int positionOffset = 4;
+constexpr std::uint64_t conflictedPosition = 0xFFFF;
+constexpr std::uint64_t maximumAgreeingCount = 0xFFFF;
+
+std::uint64_t positionOf(std::uint64_t value) { return value & 0xFFFF; }
+
+std::uint64_t agreeingCountOf(std::uint64_t value) {
+  return (value >> 16) & 0xFFFF;
+}
+
+double remainingTimeOf(std::uint64_t value) {
+  const auto bits = static_cast<std::uint32_t>(value >> 32);
+  float remainingTime;
+  std::memcpy(&remainingTime, &bits, sizeof(bits));
+  return remainingTime;
+}
+
+std::uint64_t packValue(std::uint64_t position, std::uint64_t agreeingCount,
+                        double remainingTime) {
+  const auto time = static_cast<float>(remainingTime);
+  std::uint32_t bits;
+  std::memcpy(&bits, &time, sizeof(bits));
+  return position | agreeingCount << 16 | static_cast<std::uint64_t>(bits)
+                                              << 32;
+}
+
+// index of the cell holding value along one axis, offset by 32768 into 16
+// bits (0 is left out so a cell key is never 0)
+std::uint64_t axisCell(double value, double cellSize) {
+  const double index =
+      std::min(std::max(std::floor(value / cellSize), -32767.0), 32767.0);
+  return static_cast<std::uint64_t>(static_cast<std::int64_t>(index) + 32768);
+}
+
+// spreads the bits of the cell key over the table (splitmix64 finalizer)
+std::uint64_t mixBits(std::uint64_t key) {
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+  return key ^ (key >> 31);
+}
+} // namespace
+
+constexpr std::size_t FateCache::defaultSlotCount;
+constexpr std::size_t FateCache::maximumProbeCount;
+constexpr std::size_t FateTrail::maximumLength;
+
+FateCache::FateCache(double positionCellSize, double velocityCellSize,
+                     int confidence, std::size_t slotCount)
+    : m_positionCellSize(positionCellSize),
+      m_velocityCellSize(velocityCellSize),
+      m_confidence(std::max(confidence, 1)) {
+  std::size_t powerOfTwo = 1;
+  while (powerOfTwo < slotCount)
+    powerOfTwo *= 2;
+  m_slotMask = powerOfTwo - 1;
+  m_slots.reset(new Slot[powerOfTwo]);
+}
+
+std::uint64_t
+FateCache::cellOf(const PendulumSystem::StateType &state) const {
+  return axisCell(state[0], m_positionCellSize) |
+         axisCell(state[1], m_positionCellSize) << 16 |
+         axisCell(state[2], m_velocityCellSize) << 32 |
+         axisCell(state[3], m_velocityCellSize) << 48;
+}
+
+FateCache::Slot *FateCache::findSlot(std::uint64_t cell, bool insert) {
+  std::size_t index = mixBits(cell) & m_slotMask;
+  for (std::size_t probe = 0; probe < maximumProbeCount; ++probe) {
+    Slot &slot = m_slots[index];
+    std::uint64_t slotCell = slot.cell.load(std::memory_order_relaxed);
+    if (slotCell == cell)
+      return &slot;
+
+    if (slotCell == 0) {
+      if (!insert)
+        return nullptr;
+
+      // another thread may take the slot first, for this cell or another
+      if (slot.cell.compare_exchange_strong(slotCell, cell,
+                                            std::memory_order_relaxed) ||
+          slotCell == cell)
+        return &slot;
+    }
+
+    index = (index + 1) & m_slotMask;
+  }
+
+  return nullptr;
+}
+
+bool FateCache::find(std::uint64_t cell, int &position,
+                     double &remainingTime) {
+  m_lookupCount.fetch_add(1, std::memory_order_relaxed);
+  const Slot *slot = findSlot(cell, false);
+  if (!slot)
+    return false;
+
+  const std::uint64_t value = slot->value.load(std::memory_order_relaxed);
+  if (positionOf(value) == conflictedPosition ||
+      agreeingCountOf(value) < static_cast<std::uint64_t>(m_confidence))
+    return false;
+
+  m_hitCount.fetch_add(1, std::memory_order_relaxed);
+  position = static_cast<int>(positionOf(value)) - positionOffset;
+  remainingTime = remainingTimeOf(value);
+  return true;
+}
+
+void FateCache::record(std::uint64_t cell, int position,
+                       double remainingTime) {
+  m_recordCount.fetch_add(1, std::memory_order_relaxed);
+  Slot *slot = findSlot(cell, true);
+  if (!slot) {
+    m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const auto recordedPosition =
+      static_cast<std::uint64_t>(position + positionOffset);
+  std::uint64_t value = slot->value.load(std::memory_order_relaxed);
+  while (true) {
+    std::uint64_t newValue;
+    if (positionOf(value) == conflictedPosition) {
+      return;
+    } else if (agreeingCountOf(value) == 0) {
+      newValue = packValue(recordedPosition, 1, remainingTime);
+    } else if (positionOf(value) != recordedPosition) {
+      newValue = packValue(conflictedPosition, 0, 0.0);
+    } else {
+      // the cell keeps the remaining time of its first trajectory
+      newValue = packValue(
+          recordedPosition,
+          std::min(agreeingCountOf(value) + 1, maximumAgreeingCount),
+          remainingTimeOf(value));
+    }
+
+    if (slot->value.compare_exchange_weak(value, newValue,
+                                          std::memory_order_relaxed))
+      return;
+  }
+}
+
+double FateCache::hitRate() const {
+  const std::uint64_t lookups = lookupCount();
+  return lookups == 0 ? 0.0 : static_cast<double>(hitCount()) /
+                                  static_cast<double>(lookups);
+}
+
+std::size_t FateCache::knownCellCount() const {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i <= m_slotMask; ++i) {
+    const std::uint64_t value =
+        m_slots[i].value.load(std::memory_order_relaxed);
+    if (positionOf(value) != conflictedPosition &&
+        agreeingCountOf(value) >= static_cast<std::uint64_t>(m_confidence))
+      ++count;
+  }
+
+  return count;
+}
+
+std::size_t FateCache::conflictedCellCount() const {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i <= m_slotMask; ++i) {
+    if (positionOf(m_slots[i].value.load(std::memory_order_relaxed)) ==
+        conflictedPosition)
+      ++count;
+  }
+
+  return count;
+}
+
+void FateTrail::record(FateCache &cache, int position,
+                       double convergeTime) const {
+  // a cell visited more than once keeps its latest visit
+  for (std::size_t i = m_length; i-- > 0;) {
+    bool isRecorded = false;
+    for (std::size_t j = i + 1; j < m_length && !isRecorded; ++j) {
+      isRecorded = m_cells[j] == m_cells[i];
+    }
+    if (!isRecorded)
+      cache.record(m_cells[i], position, convergeTime - m_times[i]);
+  }
+}
+} // namespace staticpendulum
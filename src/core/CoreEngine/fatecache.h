@@ -0,0 +1,186 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef FATECACHE_H
+#define FATECACHE_H
+#include "pendulumsystem.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace staticpendulum {
+/// Number of trials between the lookups of a point in the FateCache of its
+/// system.
+constexpr int fateCheckInterval = 16;
+
+/*!
+ * @brief Concurrent cache of the fates of phase space cells, lets points stop
+ *integrating once they reach a cell whose fate other trajectories resolved.
+ *
+ * The state space (x, y, x velocity, y velocity) is quantised into cells of
+ *positionCellSize by velocityCellSize. A converged point records the cells it
+ *passed through (see FateTrail) with its converge position and the time it
+ *still took to converge from each of them. A cell is known once confidence
+ *trajectories recorded the same position in it, a cell with disagreeing
+ *trajectories is never known. Points looking up a known cell take its
+ *position and converge at their current time plus the remaining time of the
+ *cell.
+ *
+ * The table is a fixed size open addressing hash of slotCount slots, a slot
+ *is a 64 bit cell key and a 64 bit value (position, agreeing trajectory count
+ *and remaining time) both updated with atomic operations, so any number of
+ *threads record and look up cells without locks. Cells are dropped once
+ *maximumProbeCount slots around their hash are taken.
+ *
+ * Cells mix trajectories that are close but not equal, near basin boundaries
+ *a known cell may hold points of another basin. Coarser cells and a lower
+ *confidence give more hits and more misclassified points.
+ */
+class FateCache {
+public:
+  /// Default number of slots, 64 MiB.
+  static constexpr std::size_t defaultSlotCount = std::size_t(1) << 22;
+  /// Number of slots searched for a cell before it is dropped.
+  static constexpr std::size_t maximumProbeCount = 32;
+
+  /*!
+   * @param[in] positionCellSize Side of the cells along x and y.
+   * @param[in] velocityCellSize Side of the cells along the x and y velocity.
+   * @param[in] confidence Number of agreeing trajectories a cell needs to be
+   *known, at least 1.
+   * @param[in] slotCount Number of slots, rounded up to a power of two.
+   */
+  FateCache(double positionCellSize, double velocityCellSize, int confidence,
+            std::size_t slotCount = defaultSlotCount);
+
+  double positionCellSize() const { return m_positionCellSize; }
+  double velocityCellSize() const { return m_velocityCellSize; }
+  int confidence() const { return m_confidence; }
+  std::size_t slotCount() const { return m_slotMask + 1; }
+
+  /// Key of the cell holding the state, never 0.
+  std::uint64_t cellOf(const PendulumSystem::StateType &state) const;
+
+  /// Returns true with the position and remaining converge time of the cell
+  /// if it is known, counts the lookup.
+  bool find(std::uint64_t cell, int &position, double &remainingTime);
+  /// Records that a trajectory in the cell converged to position after
+  /// remainingTime.
+  void record(std::uint64_t cell, int position, double remainingTime);
+
+  std::uint64_t lookupCount() const {
+    return m_lookupCount.load(std::memory_order_relaxed);
+  }
+  std::uint64_t hitCount() const {
+    return m_hitCount.load(std::memory_order_relaxed);
+  }
+  /// Fraction of the lookups that found a known cell.
+  double hitRate() const;
+  std::uint64_t recordCount() const {
+    return m_recordCount.load(std::memory_order_relaxed);
+  }
+  /// Number of records dropped because the table was full around the cell.
+  std::uint64_t droppedCount() const {
+    return m_droppedCount.load(std::memory_order_relaxed);
+  }
+  /// Number of known cells, and of cells with disagreeing trajectories
+  /// (counted over the whole table).
+  std::size_t knownCellCount() const;
+  std::size_t conflictedCellCount() const;
+
+private:
+  struct Slot {
+    std::atomic<std::uint64_t> cell{0};
+    std::atomic<std::uint64_t> value{0};
+  };
+
+  // slot of the cell, nullptr if it is not in the table (and cannot be
+  // inserted when insert is true)
+  Slot *findSlot(std::uint64_t cell, bool insert);
+
+  double m_positionCellSize;
+  double m_velocityCellSize;
+  int m_confidence;
+  std::size_t m_slotMask;
+  std::unique_ptr<Slot[]> m_slots;
+  std::atomic<std::uint64_t> m_lookupCount{0};
+  std::atomic<std::uint64_t> m_hitCount{0};
+  std::atomic<std::uint64_t> m_recordCount{0};
+  std::atomic<std::uint64_t> m_droppedCount{0};
+};
+
+/// Cells a point passed through while integrating and the times it entered
+/// them, recorded in the FateCache once the point converges. The trail keeps
+/// at most maximumLength cells spread over the whole trajectory: when it is
+/// full every other cell is dropped and only every other new cell is added
+/// from then on.
+class FateTrail {
+public:
+  static constexpr std::size_t maximumLength = 32;
+
+  void clear() {
+    m_length = 0;
+    m_stride = 1;
+    m_skipped = 0;
+  }
+
+  /// Adds the cell unless it is the last one added (or skipped).
+  void push(std::uint64_t cell, double time) {
+    if (cell == m_lastCell && (m_length != 0 || m_skipped != 0))
+      return;
+
+    m_lastCell = cell;
+    if (++m_skipped < m_stride)
+      return;
+
+    m_skipped = 0;
+    if (m_length == maximumLength) {
+      for (std::size_t i = 0; i < maximumLength / 2; ++i) {
+        m_cells[i] = m_cells[2 * i + 1];
+        m_times[i] = m_times[2 * i + 1];
+      }
+      m_length = maximumLength / 2;
+      m_stride *= 2;
+    }
+
+    m_cells[m_length] = cell;
+    m_times[m_length] = time;
+    ++m_length;
+  }
+
+  /// Records every distinct cell of the trail as converging to position at
+  /// convergeTime, see FateCache::record.
+  void record(FateCache &cache, int position, double convergeTime) const;
+
+private:
+  std::array<std::uint64_t, maximumLength> m_cells;
+  std::array<double, maximumLength> m_times;
+  std::size_t m_length = 0;
+  std::size_t m_stride = 1;
+  std::size_t m_skipped = 0;
+  std::uint64_t m_lastCell = 0;
+};
+} // namespace staticpendulum
+#endif // FATECACHE_H
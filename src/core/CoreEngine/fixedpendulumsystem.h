@@ -0,0 +1,125 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef FIXEDPENDULUMSYSTEM_H
+#define FIXEDPENDULUMSYSTEM_H
+#include "pendulumsystem.h"
+#include <array>
+#include <utility>
+
+namespace staticpendulum {
+/// Largest attractor count with a FixedPendulumSystem specialisation, systems
+/// with more attractors use PendulumSystem.
+constexpr std::size_t maximumFixedAttractorCount = 8;
+
+/*!
+ * @brief PendulumSystem with the attractor count fixed at compile time.
+ *
+ * The attractors are held in an inline std::array so the attractor loops of
+ *the derivative are fully unrolled and there is no indirection through the
+ *heap. Results are the same as the PendulumSystem it was constructed from, it
+ *can be used anywhere a PendulumSystem is integrated.
+ * @tparam AttractorCount The number of attractors.
+ */
+template <std::size_t AttractorCount>
+struct FixedPendulumSystem : PendulumParameters {
+  typedef PendulumSystem::StateType StateType;
+  typedef PendulumSystem::JacobianType JacobianType;
+
+  std::array<PendulumSystem::Attractor, AttractorCount> attractorList;
+
+  /// Copies the system, its attractor list must hold AttractorCount
+  /// attractors.
+  explicit FixedPendulumSystem(const PendulumSystem &system)
+      : FixedPendulumSystem(system,
+                            std::make_index_sequence<AttractorCount>()) {}
+
+  void operator()(const StateType &x, StateType &dxdt,
+                  const double /* t */) const {
+    detail::pendulumDerivative(*this, x, dxdt);
+  }
+
+  template <std::size_t Lanes>
+  void operator()(const BatchState<4, Lanes> &x, BatchState<4, Lanes> &dxdt,
+                  const LaneArray<double, Lanes> & /* t */) const {
+    detail::pendulumDerivative(*this, x, dxdt);
+  }
+
+  void jacobian(const StateType &x, JacobianType &dfdx,
+                const double /* t */) const {
+    detail::pendulumJacobian(*this, x, dfdx);
+  }
+
+private:
+  template <std::size_t... Indices>
+  FixedPendulumSystem(const PendulumSystem &system,
+                      std::index_sequence<Indices...>)
+      : PendulumParameters(system),
+        attractorList{{system.attractorList[Indices]...}} {}
+};
+
+namespace detail {
+template <typename Function>
+inline auto withFixedAttractorCount(const PendulumSystem &system,
+                                    Function &&function,
+                                    std::index_sequence<>) {
+  return function(system);
+}
+
+template <typename Function, std::size_t Count, std::size_t... Counts>
+inline auto withFixedAttractorCount(const PendulumSystem &system,
+                                    Function &&function,
+                                    std::index_sequence<Count, Counts...>) {
+  if (system.attractorList.size() == Count) {
+    return function(FixedPendulumSystem<Count>(system));
+  }
+
+  return withFixedAttractorCount(system, std::forward<Function>(function),
+                                 std::index_sequence<Counts...>());
+}
+
+template <std::size_t... Indices>
+constexpr auto fixedAttractorCounts(std::index_sequence<Indices...>) {
+  return std::index_sequence<(Indices + 1)...>();
+}
+} // namespace detail
+
+/*!
+ * @brief Calls function with the FixedPendulumSystem matching the attractor
+ *count of the system, or with the system itself if there is no
+ *specialisation for its count (no attractors or more than
+ *maximumFixedAttractorCount).
+ *
+ * function must return the same type for every system type, e.g. a
+ *std::function.
+ */
+template <typename Function>
+inline auto withFixedAttractorCount(const PendulumSystem &system,
+                                    Function &&function) {
+  return detail::withFixedAttractorCount(
+      system, std::forward<Function>(function),
+      detail::fixedAttractorCounts(
+          std::make_index_sequence<maximumFixedAttractorCount>()));
+}
+} // namespace staticpendulum
+#endif // FIXEDPENDULUMSYSTEM_H
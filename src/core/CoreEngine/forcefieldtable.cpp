@@ -0,0 +1,145 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "forcefieldtable.h"
+#include "vectorizedpendulumsystem.h"
+#include <atomic>
+#include <thread>
+
+namespace staticpendulum {
+namespace {
+// calls rowFunction(row, threadIndex) for every row, rows are handed out to
+// the threads one at a time
+template <typename RowFunction>
+void forEachRow(std::size_t rowCount, unsigned threadCount,
+                RowFunction rowFunction) {
+  std::atomic<std::size_t> nextRow(0);
+  auto work = [&](unsigned threadIndex) {
+    for (std::size_t row = nextRow++; row < rowCount; row = nextRow++) {
+      rowFunction(row, threadIndex);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned threadIndex = 1; threadIndex < threadCount; ++threadIndex) {
+    threads.emplace_back(work, threadIndex);
+  }
+  work(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+} // namespace
+
+constexpr std::size_t ForceFieldTable::nodeBytes;
+constexpr std::size_t ForceFieldTable::minimumNodeCount;
+
+ForceFieldTable::ForceFieldTable(const PendulumSystem &system,
+                                 std::size_t memoryBudget,
+                                 unsigned threadCount) {
+  threadCount = std::max(threadCount, 1u);
+  m_nodeCount = std::max(
+      static_cast<std::size_t>(std::sqrt(static_cast<double>(memoryBudget) /
+                                         static_cast<double>(nodeBytes))),
+      minimumNodeCount);
+
+  // one extra node on each side for the interpolation stencil, so the reach
+  // [-length, length] spans cells 1 to nodeCount - 3
+  const double length = system.length;
+  m_spacing = 2.0 * length / static_cast<double>(m_nodeCount - 4);
+  m_origin = -length - m_spacing;
+  m_forces.resize(2 * m_nodeCount * m_nodeCount);
+
+  PendulumSystem exactSystem = system;
+  exactSystem.forceTable.reset();
+  // sample with the attractor summation specialised for the system
+  withSpecialisedSystem(exactSystem, [&](const auto &specialisedSystem) {
+    buildAndValidate(specialisedSystem, threadCount);
+    return 0;
+  });
+}
+
+template <typename SystemType>
+void ForceFieldTable::buildAndValidate(const SystemType &exactSystem,
+                                       unsigned threadCount) {
+  const double length = exactSystem.length;
+  auto exactForce = [&exactSystem, length](double x, double y, double &xForce,
+                                           double &yForce) {
+    // the force is undefined outside of the reach, nodes there only serve the
+    // interpolation stencil so they take the force on the rim
+    const double radius = std::sqrt(x * x + y * y);
+    const double maximumRadius = length * (1.0 - 1e-9);
+    if (radius > maximumRadius) {
+      x *= maximumRadius / radius;
+      y *= maximumRadius / radius;
+    }
+
+    const PendulumSystem::StateType state = {{x, y, 0.0, 0.0}};
+    PendulumSystem::StateType derivative;
+    exactSystem(state, derivative, 0.0);
+    xForce = derivative[2] * exactSystem.mass;
+    yForce = derivative[3] * exactSystem.mass;
+  };
+
+  forEachRow(m_nodeCount, threadCount, [&](std::size_t row, unsigned) {
+    const double y = m_origin + static_cast<double>(row) * m_spacing;
+    for (std::size_t column = 0; column < m_nodeCount; ++column) {
+      const double x = m_origin + static_cast<double>(column) * m_spacing;
+      const std::size_t index = 2 * (row * m_nodeCount + column);
+      exactForce(x, y, m_forces[index], m_forces[index + 1]);
+    }
+  });
+
+  // validate at the cell centers
+  std::vector<double> maximumErrors(threadCount, 0.0);
+  std::vector<double> maximumForces(threadCount, 0.0);
+  const double validatedRadius = length - 2.0 * m_spacing;
+  forEachRow(m_nodeCount - 4, threadCount, [&](std::size_t cellRow,
+                                               unsigned threadIndex) {
+    const double y = -length + (static_cast<double>(cellRow) + 0.5) * m_spacing;
+    for (std::size_t cellColumn = 0; cellColumn < m_nodeCount - 4;
+         ++cellColumn) {
+      const double x =
+          -length + (static_cast<double>(cellColumn) + 0.5) * m_spacing;
+      if (x * x + y * y > validatedRadius * validatedRadius)
+        continue;
+
+      double xExact;
+      double yExact;
+      exactForce(x, y, xExact, yExact);
+      double xTable;
+      double yTable;
+      force(x, y, xTable, yTable);
+      maximumErrors[threadIndex] =
+          std::max(maximumErrors[threadIndex],
+                   std::hypot(xTable - xExact, yTable - yExact));
+      maximumForces[threadIndex] =
+          std::max(maximumForces[threadIndex], std::hypot(xExact, yExact));
+    }
+  });
+  m_maximumError =
+      *std::max_element(maximumErrors.begin(), maximumErrors.end());
+  m_maximumForce =
+      *std::max_element(maximumForces.begin(), maximumForces.end());
+}
+} // namespace staticpendulum
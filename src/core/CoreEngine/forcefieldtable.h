@@ -0,0 +1,127 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef FORCEFIELDTABLE_H
+#define FORCEFIELDTABLE_H
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace staticpendulum {
+struct PendulumSystem;
+
+/*!
+ * @brief Force field of a pendulum system sampled on a square grid and
+ *interpolated with bicubic (Catmull-Rom) splines.
+ *
+ * The gravity and attractor forces only depend on the position of the
+ *pendulum head, so they are sampled once over the square covering the reach
+ *of the pendulum (the pendulum length in every direction). Looking up the
+ *force then costs the same 4x4 node interpolation regardless of the number of
+ *attractors. The grid is as fine as the memory budget allows.
+ *
+ * After building, the table is compared against the system at the center of
+ *every cell (where the interpolation error is largest) inside the reach of
+ *the pendulum, see maximumError. The gravity force is not smooth at the rim of
+ *the reach so cells within two cells of the rim are not checked.
+ */
+class ForceFieldTable {
+public:
+  /// Bytes used per grid node, the x and y force.
+  static constexpr std::size_t nodeBytes = 2 * sizeof(double);
+  /// Smallest number of nodes per side of the grid.
+  static constexpr std::size_t minimumNodeCount = 8;
+
+  /*!
+   * @param[in] system The system to sample, its velocity independent force is
+   *tabulated with whatever attractor summation it uses (e.g. its
+   *attractorTree). Any force table of the system is ignored.
+   * @param[in] memoryBudget Maximum size of the grid in bytes.
+   * @param[in] threadCount Number of threads building and validating the table.
+   */
+  ForceFieldTable(const PendulumSystem &system, std::size_t memoryBudget,
+                  unsigned threadCount);
+
+  /// Number of grid nodes per side.
+  std::size_t nodeCount() const { return m_nodeCount; }
+  /// Distance between grid nodes.
+  double spacing() const { return m_spacing; }
+  /// Largest difference between the interpolated and the exact force
+  /// (magnitude of the force vector difference) at the validated cell centers.
+  double maximumError() const { return m_maximumError; }
+  /// Largest force magnitude at the validated cell centers, the scale of
+  /// maximumError.
+  double maximumForce() const { return m_maximumForce; }
+
+  /// Interpolated gravity plus attractor force (without drag and not divided
+  /// by the mass) on the pendulum head at (x, y).
+  void force(double x, double y, double &xForce, double &yForce) const {
+    const double u = (x - m_origin) / m_spacing;
+    const double v = (y - m_origin) / m_spacing;
+    const auto lastCell = static_cast<double>(m_nodeCount - 3);
+    const double uCell = std::min(std::max(std::floor(u), 1.0), lastCell);
+    const double vCell = std::min(std::max(std::floor(v), 1.0), lastCell);
+    const std::array<double, 4> uWeights = catmullRomWeights(u - uCell);
+    const std::array<double, 4> vWeights = catmullRomWeights(v - vCell);
+
+    const std::size_t first =
+        (static_cast<std::size_t>(vCell) - 1) * m_nodeCount +
+        static_cast<std::size_t>(uCell) - 1;
+    xForce = 0.0;
+    yForce = 0.0;
+    for (std::size_t row = 0; row < 4; ++row) {
+      const double *node = &m_forces[2 * (first + row * m_nodeCount)];
+      double xRow = 0.0;
+      double yRow = 0.0;
+      for (std::size_t column = 0; column < 4; ++column) {
+        xRow += uWeights[column] * node[2 * column];
+        yRow += uWeights[column] * node[2 * column + 1];
+      }
+      xForce += vWeights[row] * xRow;
+      yForce += vWeights[row] * yRow;
+    }
+  }
+
+private:
+  template <typename SystemType>
+  void buildAndValidate(const SystemType &exactSystem, unsigned threadCount);
+
+  static std::array<double, 4> catmullRomWeights(double t) {
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    return {{0.5 * (-t3 + 2.0 * t2 - t), 0.5 * (3.0 * t3 - 5.0 * t2 + 2.0),
+             0.5 * (-3.0 * t3 + 4.0 * t2 + t), 0.5 * (t3 - t2)}};
+  }
+
+  std::size_t m_nodeCount;
+  double m_spacing;
+  double m_origin;
+  double m_maximumError = 0.0;
+  double m_maximumForce = 0.0;
+  // x and y force per node, rows of increasing y
+  std::vector<double> m_forces;
+};
+} // namespace staticpendulum
+#endif // FORCEFIELDTABLE_H
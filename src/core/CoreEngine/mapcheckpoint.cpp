@@ -0,0 +1,291 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "mapcheckpoint.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace staticpendulum {
+namespace {
+const std::array<char, 8> checkpointMagic = {{'S', 'P', 'C', 'K', 'P', 'T',
+                                              '0', '1'}};
+
+struct CheckpointHeader {
+  std::array<char, 8> magic;
+  std::uint64_t hash;
+  std::uint64_t rows;
+  std::uint64_t cols;
+};
+
+struct RecordHeader {
+  std::uint64_t firstRow;
+  std::uint64_t lastRow;
+  std::uint64_t firstColumn;
+  std::uint64_t lastColumn;
+};
+
+// bytes per point of a record: converge position, converge time and step
+// count
+constexpr std::size_t recordPointBytes =
+    sizeof(std::int16_t) + sizeof(float) + sizeof(std::uint32_t);
+
+template <typename T> void appendValue(std::vector<char> &buffer, T value) {
+  const char *bytes = reinterpret_cast<const char *>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T> T readValue(const char *&position) {
+  T value;
+  std::memcpy(&value, position, sizeof(T));
+  position += sizeof(T);
+  return value;
+}
+
+// Writes the bytes to the file and the file to the disk.
+bool writeAndSync(std::FILE *file, const std::vector<char> &bytes) {
+  if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size() ||
+      std::fflush(file) != 0)
+    return false;
+#ifdef _WIN32
+  return _commit(_fileno(file)) == 0;
+#else
+  return ::fsync(fileno(file)) == 0;
+#endif
+}
+
+// Replaces the file at path with the file at temporaryPath.
+bool replaceFile(const std::string &temporaryPath, const std::string &path) {
+#ifdef _WIN32
+  return MoveFileExA(temporaryPath.c_str(), path.c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    return false;
+
+  // the rename is on the disk once the directory is
+  std::string directory = ".";
+  const std::size_t slash = path.find_last_of('/');
+  if (slash != std::string::npos)
+    directory = path.substr(0, std::max<std::size_t>(slash, 1));
+  const int directoryDescriptor = ::open(directory.c_str(), O_RDONLY);
+  if (directoryDescriptor >= 0) {
+    ::fsync(directoryDescriptor);
+    ::close(directoryDescriptor);
+  }
+  return true;
+#endif
+}
+} // namespace
+
+std::uint64_t parameterHash(const std::string &bytes) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const char byte : bytes) {
+    hash ^= static_cast<unsigned char>(byte);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+MapCheckpoint::~MapCheckpoint() { close(); }
+
+bool MapCheckpoint::open(const std::string &path, std::uint64_t hash,
+                         Map &map, Clock::duration writeInterval) {
+  close();
+  m_cols = map.cols();
+  m_isFinished.assign(map.rows() * map.cols(), false);
+  m_restoredPointCount = 0;
+  m_writeInterval = writeInterval;
+
+  const CheckpointHeader header = {checkpointMagic, hash, map.rows(),
+                                   map.cols()};
+  std::vector<char> contents;
+  {
+    std::ifstream previousFile(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(previousFile),
+                    std::istreambuf_iterator<char>());
+  }
+
+  // restore the complete records of a checkpoint of the same integration,
+  // they are rewritten below without a torn last record
+  std::vector<Tile> restoredTiles;
+  if (contents.size() >= sizeof(CheckpointHeader) &&
+      std::memcmp(contents.data(), &header, sizeof(CheckpointHeader)) == 0) {
+    const char *position = contents.data() + sizeof(CheckpointHeader);
+    const char *end = contents.data() + contents.size();
+    while (static_cast<std::size_t>(end - position) >= sizeof(RecordHeader)) {
+      const auto record = readValue<RecordHeader>(position);
+      const Tile tile = {record.firstRow, record.lastRow, record.firstColumn,
+                         record.lastColumn};
+      if (tile.firstRow >= tile.lastRow || tile.lastRow > map.rows() ||
+          tile.firstColumn >= tile.lastColumn ||
+          tile.lastColumn > map.cols() ||
+          static_cast<std::size_t>(end - position) <
+              tile.pointCount() * recordPointBytes)
+        break;
+
+      for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+        for (std::size_t column = tile.firstColumn; column < tile.lastColumn;
+             ++column) {
+          const std::size_t index = row * map.cols() + column;
+          auto point = map.point(index);
+          point.convergePosition = readValue<std::int16_t>(position);
+          point.convergeTime = readValue<float>(position);
+          point.stepCount = readValue<std::uint32_t>(position);
+          if (!m_isFinished[index])
+            ++m_restoredPointCount;
+          m_isFinished[index] = true;
+        }
+      }
+      restoredTiles.push_back(tile);
+    }
+  }
+
+  // the compacted checkpoint replaces the old one only once it is on the
+  // disk, a crash while opening keeps the old one
+  m_buffer.clear();
+  appendValue(m_buffer, header);
+  for (const Tile &tile : restoredTiles) {
+    appendRecord(tile, map);
+  }
+
+  const std::string temporaryPath = path + ".tmp";
+  std::FILE *temporaryFile = std::fopen(temporaryPath.c_str(), "wb");
+  if (temporaryFile == nullptr) {
+    m_errorString = "cannot write " + temporaryPath + ": " +
+                    std::strerror(errno);
+    return false;
+  }
+
+  const bool isWritten = writeAndSync(temporaryFile, m_buffer);
+  if (std::fclose(temporaryFile) != 0 || !isWritten) {
+    m_errorString = "cannot write " + temporaryPath + ": " +
+                    std::strerror(errno);
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  m_buffer.clear();
+
+  if (!replaceFile(temporaryPath, path)) {
+    m_errorString = "cannot replace " + path + ": " + std::strerror(errno);
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+
+  m_file = std::fopen(path.c_str(), "ab");
+  if (m_file == nullptr) {
+    m_errorString = "cannot write " + path + ": " + std::strerror(errno);
+    return false;
+  }
+
+  m_lastWrite = Clock::now();
+  return true;
+}
+
+void MapCheckpoint::close() {
+  if (m_file == nullptr)
+    return;
+
+  flush();
+  std::fclose(m_file);
+  m_file = nullptr;
+}
+
+bool MapCheckpoint::isCompleted(const Tile &tile) const {
+  for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+    for (std::size_t column = tile.firstColumn; column < tile.lastColumn;
+         ++column) {
+      if (!m_isFinished[row * m_cols + column])
+        return false;
+    }
+  }
+  return true;
+}
+
+void MapCheckpoint::removeCompleted(std::vector<Tile> &tiles,
+                                    std::vector<double> *costs) const {
+  std::size_t keptCount = 0;
+  for (std::size_t i = 0; i < tiles.size(); ++i) {
+    if (isCompleted(tiles[i]))
+      continue;
+
+    tiles[keptCount] = tiles[i];
+    if (costs)
+      (*costs)[keptCount] = (*costs)[i];
+    ++keptCount;
+  }
+
+  tiles.resize(keptCount);
+  if (costs)
+    costs->resize(keptCount);
+}
+
+void MapCheckpoint::append(const Tile &tile, const Map &map) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  appendRecord(tile, map);
+  if (Clock::now() - m_lastWrite >= m_writeInterval)
+    write();
+}
+
+void MapCheckpoint::flush() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  write();
+}
+
+void MapCheckpoint::appendRecord(const Tile &tile, const Map &map) {
+  appendValue(m_buffer, RecordHeader{tile.firstRow, tile.lastRow,
+                                     tile.firstColumn, tile.lastColumn});
+  for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+    for (std::size_t column = tile.firstColumn; column < tile.lastColumn;
+         ++column) {
+      const std::size_t index = row * map.cols() + column;
+      const Point point = map.point(index);
+      appendValue(m_buffer, static_cast<std::int16_t>(point.convergePosition));
+      appendValue(m_buffer, static_cast<float>(point.convergeTime));
+      appendValue(m_buffer, static_cast<std::uint32_t>(point.stepCount));
+      m_isFinished[index] = true;
+    }
+  }
+}
+
+void MapCheckpoint::write() {
+  m_lastWrite = Clock::now();
+  if (m_file == nullptr || m_buffer.empty())
+    return;
+
+  // the records of a failed write are dropped, their tiles are integrated
+  // again on resume
+  writeAndSync(m_file, m_buffer);
+  m_buffer.clear();
+}
+} // namespace staticpendulum
@@ -0,0 +1,105 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef MAPCHECKPOINT_H
+#define MAPCHECKPOINT_H
+#include "pendulummapintegrator.h"
+#include "tilescheduler.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace staticpendulum {
+/// 64 bit FNV-1a hash of the bytes, used to key checkpoints to the
+/// parameters of the integration.
+std::uint64_t parameterHash(const std::string &bytes);
+
+/*!
+ * @brief Append only file of the finished tiles of a map integration.
+ *
+ * The file holds a header with the parameter hash and the map size followed
+ *by one record per finished tile: the tile and the converge positions,
+ *converge times and step counts of its points. Records are buffered and
+ *appended and synced to the disk once every write interval, a crash loses at
+ *most the last interval and a record torn by it is dropped when the file is
+ *read back.
+ *
+ * open reads back the records of a checkpoint with the same parameter hash and
+ *map size into the map, removeCompleted then drops the tiles whose points are
+ *all finished so only the unfinished tiles are integrated. The restored
+ *records are compacted into path + ".tmp", which replaces the checkpoint once
+ *it is on the disk, so a crash while opening keeps the old checkpoint.
+ */
+class MapCheckpoint {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  MapCheckpoint() {}
+  MapCheckpoint(const MapCheckpoint &) = delete;
+  MapCheckpoint &operator=(const MapCheckpoint &) = delete;
+  ~MapCheckpoint();
+
+  /// Opens the checkpoint at path for map, restoring the finished tiles of a
+  /// checkpoint written with the same hash and map size and replacing any
+  /// other file. Returns false and sets errorString on failure.
+  bool open(const std::string &path, std::uint64_t hash, Map &map,
+            Clock::duration writeInterval);
+  /// Writes the buffered records and closes the file.
+  void close();
+
+  bool isOpen() const { return m_file != nullptr; }
+  const std::string &errorString() const { return m_errorString; }
+  /// Number of points restored by open.
+  std::size_t restoredPointCount() const { return m_restoredPointCount; }
+
+  /// True if every point of the tile is finished.
+  bool isCompleted(const Tile &tile) const;
+  /// Removes the finished tiles (and their costs, if any) from the tiles.
+  void removeCompleted(std::vector<Tile> &tiles,
+                       std::vector<double> *costs = nullptr) const;
+
+  /// Records the results of the finished tile of map, the file is written
+  /// if the write interval passed since the last write. Thread safe.
+  void append(const Tile &tile, const Map &map);
+  /// Writes the buffered records. Thread safe.
+  void flush();
+
+private:
+  void appendRecord(const Tile &tile, const Map &map);
+  void write();
+
+  std::FILE *m_file = nullptr;
+  std::string m_errorString;
+  std::vector<bool> m_isFinished;
+  std::size_t m_cols = 0;
+  std::size_t m_restoredPointCount = 0;
+  std::vector<char> m_buffer;
+  Clock::duration m_writeInterval;
+  Clock::time_point m_lastWrite;
+  std::mutex m_mutex;
+};
+} // namespace staticpendulum
+#endif // MAPCHECKPOINT_H
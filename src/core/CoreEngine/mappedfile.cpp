@@ -0,0 +1,177 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "mappedfile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace staticpendulum {
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::create(const std::string &path, std::uint64_t size) {
+  return map(path, size, true);
+}
+
+bool MappedFile::open(const std::string &path) { return map(path, 0, false); }
+
+#ifdef _WIN32
+bool MappedFile::map(const std::string &path, std::uint64_t size,
+                     bool truncate) {
+  close();
+  auto fail = [this](const char *what) {
+    m_errorString = std::string(what) + " failed with error " +
+                    std::to_string(GetLastError());
+    close();
+    return false;
+  };
+
+  m_fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+                             nullptr, truncate ? CREATE_ALWAYS : OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_fileHandle == INVALID_HANDLE_VALUE) {
+    m_fileHandle = nullptr;
+    return fail("CreateFile");
+  }
+
+  LARGE_INTEGER fileSize;
+  if (truncate) {
+    fileSize.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(m_fileHandle, fileSize, nullptr, FILE_BEGIN) ||
+        !SetEndOfFile(m_fileHandle))
+      return fail("SetEndOfFile");
+  } else if (!GetFileSizeEx(m_fileHandle, &fileSize)) {
+    return fail("GetFileSizeEx");
+  }
+  m_size = static_cast<std::uint64_t>(fileSize.QuadPart);
+
+  m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READWRITE,
+                                       0, 0, nullptr);
+  if (m_mappingHandle == nullptr)
+    return fail("CreateFileMapping");
+
+  m_data = static_cast<char *>(
+      MapViewOfFile(m_mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+  if (m_data == nullptr)
+    return fail("MapViewOfFile");
+
+  return true;
+}
+
+void MappedFile::close() {
+  if (m_data != nullptr) {
+    FlushViewOfFile(m_data, 0);
+    UnmapViewOfFile(m_data);
+    m_data = nullptr;
+  }
+  if (m_mappingHandle != nullptr) {
+    CloseHandle(m_mappingHandle);
+    m_mappingHandle = nullptr;
+  }
+  if (m_fileHandle != nullptr) {
+    CloseHandle(m_fileHandle);
+    m_fileHandle = nullptr;
+  }
+  m_size = 0;
+}
+
+void MappedFile::flushAndEvict(std::uint64_t offset, std::uint64_t length) {
+  if (m_data == nullptr || length == 0)
+    return;
+
+  FlushViewOfFile(m_data + offset, static_cast<SIZE_T>(length));
+  // unlocking pages that are not locked removes them from the working set
+  VirtualUnlock(m_data + offset, static_cast<SIZE_T>(length));
+}
+#else
+bool MappedFile::map(const std::string &path, std::uint64_t size,
+                     bool truncate) {
+  close();
+  auto fail = [this](const char *what) {
+    m_errorString = std::string(what) + " failed: " + std::strerror(errno);
+    close();
+    return false;
+  };
+
+  m_fileDescriptor =
+      ::open(path.c_str(), truncate ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR,
+             0644);
+  if (m_fileDescriptor < 0)
+    return fail("open");
+
+  if (truncate) {
+    // the file is sparse until the pages are written
+    if (::ftruncate(m_fileDescriptor, static_cast<off_t>(size)) != 0)
+      return fail("ftruncate");
+  } else {
+    struct stat fileStatus;
+    if (::fstat(m_fileDescriptor, &fileStatus) != 0)
+      return fail("fstat");
+    size = static_cast<std::uint64_t>(fileStatus.st_size);
+  }
+  m_size = size;
+
+  void *data = ::mmap(nullptr, static_cast<std::size_t>(size),
+                      PROT_READ | PROT_WRITE, MAP_SHARED, m_fileDescriptor, 0);
+  if (data == MAP_FAILED)
+    return fail("mmap");
+
+  m_data = static_cast<char *>(data);
+  return true;
+}
+
+void MappedFile::close() {
+  if (m_data != nullptr) {
+    ::msync(m_data, static_cast<std::size_t>(m_size), MS_SYNC);
+    ::munmap(m_data, static_cast<std::size_t>(m_size));
+    m_data = nullptr;
+  }
+  if (m_fileDescriptor >= 0) {
+    ::close(m_fileDescriptor);
+    m_fileDescriptor = -1;
+  }
+  m_size = 0;
+}
+
+void MappedFile::flushAndEvict(std::uint64_t offset, std::uint64_t length) {
+  if (m_data == nullptr || length == 0)
+    return;
+
+  // msync and madvise take page aligned addresses
+  const std::uint64_t pageSize =
+      static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+  const std::uint64_t first = offset - offset % pageSize;
+  const std::size_t alignedLength =
+      static_cast<std::size_t>(offset + length - first);
+  ::msync(m_data + first, alignedLength, MS_SYNC);
+  ::madvise(m_data + first, alignedLength, MADV_DONTNEED);
+}
+#endif
+} // namespace staticpendulum
@@ -0,0 +1,78 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <cstdint>
+#include <string>
+
+namespace staticpendulum {
+/*!
+ * @brief File of a fixed size mapped read write into memory.
+ *
+ * The pages of the mapping are loaded on access and written back by the
+ *operating system, flushAndEvict writes back a range and drops its pages so
+ *the resident memory stays bounded while large files are written piece by
+ *piece.
+ */
+class MappedFile {
+public:
+  MappedFile() {}
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /// Creates (or truncates) the file at path with size bytes and maps it,
+  /// returns false and sets errorString on failure.
+  bool create(const std::string &path, std::uint64_t size);
+  /// Maps the existing file at path, returns false and sets errorString on
+  /// failure.
+  bool open(const std::string &path);
+  /// Writes back and unmaps the file.
+  void close();
+
+  bool isOpen() const { return m_data != nullptr; }
+  const std::string &errorString() const { return m_errorString; }
+  std::uint64_t size() const { return m_size; }
+  char *data() { return m_data; }
+  const char *data() const { return m_data; }
+
+  /// Writes the bytes [offset, offset + length) back to the file and drops
+  /// their pages from memory, the next access reads them back from the file.
+  void flushAndEvict(std::uint64_t offset, std::uint64_t length);
+
+private:
+  bool map(const std::string &path, std::uint64_t size, bool truncate);
+
+  char *m_data = nullptr;
+  std::uint64_t m_size = 0;
+  std::string m_errorString;
+#ifdef _WIN32
+  void *m_fileHandle = nullptr;
+  void *m_mappingHandle = nullptr;
+#else
+  int m_fileDescriptor = -1;
+#endif
+};
+} // namespace staticpendulum
+#endif // MAPPEDFILE_H
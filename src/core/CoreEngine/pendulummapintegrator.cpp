@@ -33,33 +33,25 @@ Map::Map(double xStart, double yStart, double xEnd, double yEnd,
   m_cols = std::lround(std::abs((m_xEnd - m_xStart) / m_resolution)) + 1;
   m_rows = std::lround(std::abs((m_yEnd - m_yStart) / m_resolution)) + 1;
 
-  m_mapData.resize(m_rows * m_cols);
-
-  // create int multipliers to fill data to avoid floating math rounding error
-  int xdim_factor = std::lround(m_xStart / m_resolution);
-  int ydim_factor = std::lround(m_yStart / m_resolution);
-
-  for (std::size_t i = 0; i < m_rows; ++i) {
-    for (std::size_t j = 0; j < m_cols; ++j) {
-      // data is row major oriented
-      const std::size_t index = i * m_cols + j;
-
-      m_mapData[index].xPosition =
-          static_cast<double>(xdim_factor) * m_resolution;
-
-      // y factor is negative such that the first element corresponds to the
-      // upper left of the map
-      m_mapData[index].yPosition =
-          static_cast<double>(ydim_factor) * -m_resolution;
-
-      m_mapData[index].xVelocity = 0.0;
-      m_mapData[index].yVelocity = 0.0;
-      ++xdim_factor;
-    }
+  m_xFactor = std::lround(m_xStart / m_resolution);
+  m_yFactor = std::lround(m_yStart / m_resolution);
+
+  // -2 reserved for points that are out of bounds (or not integrated), see
+  // Point
+  m_convergePositions.assign(m_rows * m_cols, -2);
+  m_convergeTimes.resize(m_rows * m_cols);
+  m_stepCounts.resize(m_rows * m_cols);
+}
 
-    // reset x value for next row
-    xdim_factor = std::lround(m_xStart / m_resolution);
-    ++ydim_factor;
-  }
+Point Map::point(std::size_t index) const {
+  Point thePoint;
+  thePoint.xPosition = xPosition(index);
+  thePoint.yPosition = yPosition(index);
+  thePoint.xVelocity = 0.0;
+  thePoint.yVelocity = 0.0;
+  thePoint.convergeTime = m_convergeTimes[index];
+  thePoint.convergePosition = m_convergePositions[index];
+  thePoint.stepCount = static_cast<int>(m_stepCounts[index]);
+  return thePoint;
 }
 } // namespace staticpendulum
@@ -23,10 +23,35 @@
  * ===========================================================================*/
 #ifndef PENDULUMMAPINTEGRATOR_H
 #define PENDULUMMAPINTEGRATOR_H
+#include "attractorgrid.h"
+#include "attractorwells.h"
+#include "batchstate.h"
+#include "denseoutput.h"
+#include "eventlocation.h"
+#include "fatecache.h"
 #include "pendulumsystem.h"
+#include "stepsizecontroller.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <vector>
 
 namespace staticpendulum {
+/// Integration state of a point suspended when it ran out of budget (see
+/// PointBudget::suspendsPoints). It is held apart from the Point, only the
+/// integrations that suspend points keep one per point.
+struct PointProgress {
+  PendulumSystem::StateType state = {};
+  double time = 0.0;
+  double stepSize = 0.0;
+  double initialTimeFound = 0.0; // see ConvergenceMonitor
+  int trialCount = 0;            // 0 for points that are not suspended
+  int currentAttractor = -2;     // see ConvergenceMonitor
+};
+
 /// Struct used to store point information.
 struct Point {
   double xPosition;
@@ -35,13 +60,156 @@ struct Point {
   double yVelocity;
   double convergeTime = 0.0;
   int convergePosition = -2; // -2 reserved for points that are out of bounds,
-                             // -1 for points that converge to the middle
+                             // -1 for points that converge to the middle,
+                             // -3 for points out of budget (see PointBudget)
   int stepCount = 0;
 };
 
-/// Struct used to represent a 2D map of points.
-struct Map {
+/// Iterator over a buffer of Points, the ranges the integrators take.
+using PointIterator = std::vector<Point>::iterator;
+
+/*!
+ * @brief 2D map of points stored as a structure of arrays.
+ *
+ * The initial state of a point is computed from its row and column (the
+ *pendulum head starts at rest), only the results are stored: the converge
+ *position, converge time and step count take 10 bytes per point instead of
+ *the 48 bytes of a Point.
+ *
+ * Iterating a const map yields Point values. Iterating a mutable map yields
+ *PointReference proxies which read the computed initial state and reference
+ *the stored results, so range for loops and the integrators work on map points
+ *as they do on Points.
+ */
+class Map {
 public:
+  /// Point of a map, assigning to the results stores them in the map.
+  struct PointReference {
+    double xPosition;
+    double yPosition;
+    double xVelocity;
+    double yVelocity;
+    float &convergeTime;
+    std::int16_t &convergePosition;
+    std::uint32_t &stepCount;
+
+    operator Point() const {
+      Point point;
+      point.xPosition = xPosition;
+      point.yPosition = yPosition;
+      point.xVelocity = xVelocity;
+      point.yVelocity = yVelocity;
+      point.convergeTime = convergeTime;
+      point.convergePosition = convergePosition;
+      point.stepCount = static_cast<int>(stepCount);
+      return point;
+    }
+
+    /// Stores the results of the point, the initial state is fixed.
+    const PointReference &operator=(const Point &point) const {
+      convergeTime = static_cast<float>(point.convergeTime);
+      convergePosition = static_cast<std::int16_t>(point.convergePosition);
+      stepCount = static_cast<std::uint32_t>(point.stepCount);
+      return *this;
+    }
+
+    const PointReference &operator=(const PointReference &other) const {
+      return *this = static_cast<Point>(other);
+    }
+  };
+
+  /// Iterator yielding Reference (Point or PointReference) for the index it is
+  /// at. It has the random access operators, but dereferencing yields a value
+  /// rather than a Point &, so it is only tagged as an input iterator.
+  template <typename MapType, typename Reference> class BasicIterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Point;
+    using difference_type = std::ptrdiff_t;
+    using reference = Reference;
+
+    /// Holds the proxy for operator->.
+    struct pointer {
+      Reference value;
+      const Reference *operator->() const { return &value; }
+    };
+
+    BasicIterator() {}
+    BasicIterator(MapType *map, std::size_t index)
+        : m_map(map), m_index(index) {}
+
+    Reference operator*() const { return m_map->point(m_index); }
+    pointer operator->() const { return {**this}; }
+    Reference operator[](difference_type n) const { return *(*this + n); }
+
+    BasicIterator &operator++() {
+      ++m_index;
+      return *this;
+    }
+    BasicIterator operator++(int) {
+      BasicIterator previous = *this;
+      ++m_index;
+      return previous;
+    }
+    BasicIterator &operator--() {
+      --m_index;
+      return *this;
+    }
+    BasicIterator operator--(int) {
+      BasicIterator previous = *this;
+      --m_index;
+      return previous;
+    }
+    BasicIterator &operator+=(difference_type n) {
+      m_index += n;
+      return *this;
+    }
+    BasicIterator &operator-=(difference_type n) {
+      m_index -= n;
+      return *this;
+    }
+    BasicIterator operator+(difference_type n) const {
+      return BasicIterator(m_map, m_index + n);
+    }
+    friend BasicIterator operator+(difference_type n,
+                                   const BasicIterator &iterator) {
+      return iterator + n;
+    }
+    BasicIterator operator-(difference_type n) const {
+      return BasicIterator(m_map, m_index - n);
+    }
+    difference_type operator-(const BasicIterator &other) const {
+      return static_cast<difference_type>(m_index) -
+             static_cast<difference_type>(other.m_index);
+    }
+
+    bool operator==(const BasicIterator &other) const {
+      return m_index == other.m_index;
+    }
+    bool operator!=(const BasicIterator &other) const {
+      return m_index != other.m_index;
+    }
+    bool operator<(const BasicIterator &other) const {
+      return m_index < other.m_index;
+    }
+    bool operator>(const BasicIterator &other) const {
+      return m_index > other.m_index;
+    }
+    bool operator<=(const BasicIterator &other) const {
+      return m_index <= other.m_index;
+    }
+    bool operator>=(const BasicIterator &other) const {
+      return m_index >= other.m_index;
+    }
+
+  private:
+    MapType *m_map = nullptr;
+    std::size_t m_index = 0;
+  };
+
+  using iterator = BasicIterator<Map, PointReference>;
+  using const_iterator = BasicIterator<const Map, Point>;
+
   /// Default constructor empty map.
   Map() {}
 
@@ -56,20 +224,81 @@ public:
   double xEnd() const { return m_xEnd; }
   double yEnd() const { return m_yEnd; }
   double resolution() const { return m_resolution; }
-  auto begin() { return m_mapData.begin(); }
-  auto end() { return m_mapData.end(); }
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, m_convergePositions.size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const {
+    return const_iterator(this, m_convergePositions.size());
+  }
+  iterator rowBegin(std::size_t row) { return begin() + row * m_cols; }
+  iterator rowEnd(std::size_t row) { return rowBegin(row) + m_cols; }
+  const_iterator rowBegin(std::size_t row) const {
+    return begin() + row * m_cols;
+  }
+  const_iterator rowEnd(std::size_t row) const {
+    return rowBegin(row) + m_cols;
+  }
+
+  /// Point at the index, data is row major oriented.
+  Point point(std::size_t index) const;
+  PointReference point(std::size_t index) {
+    return {xPosition(index),
+            yPosition(index),
+            0.0,
+            0.0,
+            m_convergeTimes[index],
+            m_convergePositions[index],
+            m_stepCounts[index]};
+  }
+
+  /// Converge position of the point at the index without computing its
+  /// initial state, for colorizing.
+  int convergePosition(std::size_t index) const {
+    return m_convergePositions[index];
+  }
 
 private:
-  std::size_t m_rows;
-  std::size_t m_cols;
-  double m_xStart;
-  double m_yStart;
-  double m_xEnd;
-  double m_yEnd;
-  double m_resolution;
-  std::vector<Point> m_mapData;
+  double xPosition(std::size_t index) const {
+    return static_cast<double>(m_xFactor +
+                               static_cast<long>(index % m_cols)) *
+           m_resolution;
+  }
+
+  // y factor is negative such that the first element corresponds to the upper
+  // left of the map
+  double yPosition(std::size_t index) const {
+    return static_cast<double>(m_yFactor +
+                               static_cast<long>(index / m_cols)) *
+           -m_resolution;
+  }
+
+  std::size_t m_rows = 0;
+  std::size_t m_cols = 0;
+  double m_xStart = 0.0;
+  double m_yStart = 0.0;
+  double m_xEnd = 0.0;
+  double m_yEnd = 0.0;
+  double m_resolution = 0.0;
+  // int multipliers of the resolution of the first point to avoid floating
+  // math rounding error
+  long m_xFactor = 0;
+  long m_yFactor = 0;
+  std::vector<std::int16_t> m_convergePositions;
+  std::vector<float> m_convergeTimes;
+  std::vector<std::uint32_t> m_stepCounts;
 };
 
+/// Integrates the points [first, last) of a map with integratePoints taking a
+/// range of Points (PointIterator): the points are copied into a buffer and
+/// their results stored back.
+template <typename IntegratePoints>
+inline void integrateMapPoints(Map::iterator first, Map::iterator last,
+                               IntegratePoints &&integratePoints) {
+  std::vector<Point> points(first, last);
+  integratePoints(points.begin(), points.end());
+  std::copy(points.begin(), points.end(), first);
+}
+
 namespace {
 inline bool isNearAttractor(double attX, double attY, double currX,
                             double currY, double threshold) {
@@ -81,84 +310,581 @@ inline bool isNearMiddle(double currX, double currY, double threshold) {
   return (-threshold < currX) && (currX < threshold) && (-threshold < currY) &&
          (currY < threshold);
 }
+
+/// Starting step size of a point, either a fixed value or computed by an
+/// estimator callable as estimate(theSystem, state, derivative).
+template <typename SystemType>
+inline double startingStepSizeFor(double startingStepSize, const SystemType &,
+                                  const PendulumSystem::StateType &,
+                                  const PendulumSystem::StateType &) {
+  return startingStepSize;
+}
+
+template <typename Estimator, typename SystemType>
+inline double startingStepSizeFor(const Estimator &estimate,
+                                  const SystemType &theSystem,
+                                  const PendulumSystem::StateType &state,
+                                  const PendulumSystem::StateType &derivative) {
+  return estimate(theSystem, state, derivative);
 }
 
-template <typename Integrator>
-inline void
-integratePoint(Integrator &&theIntegrator, const PendulumSystem &theSystem,
-               Point &thePoint, double startingStepSize,
-               double attractorPositionThreshold, double midPositionThreshold,
-               double convergeTimeThreshold) {
+/// Same as above when the derivative at the state is not known yet, it is
+/// only evaluated for an estimator.
+template <typename SystemType>
+inline double startingStepSizeFor(double startingStepSize, const SystemType &,
+                                  const PendulumSystem::StateType &) {
+  return startingStepSize;
+}
+
+template <typename Estimator, typename SystemType>
+inline double startingStepSizeFor(const Estimator &estimate,
+                                  const SystemType &theSystem,
+                                  const PendulumSystem::StateType &state) {
+  PendulumSystem::StateType derivative;
+  theSystem(state, derivative, 0.0);
+  return estimate(theSystem, state, derivative);
+}
+}
+
+/// Maximum number of integration steps attempted for a single point before
+/// giving up on it converging.
+constexpr int maximumTrialCount = 1000000;
+
+/// Converge position of points that did not converge within their budget.
+constexpr int unresolvedPosition = -3;
 
+/// Precision of the converge times, the width of the bracket at which
+/// locateEvent stops searching for the entry of the head into a zone.
+constexpr double eventTimeTolerance = 1e-9;
+
+/// Number of trials between checks of the wall time budget and the
+/// cancellation flag of a PointBudget.
+constexpr int budgetCheckInterval = 64;
+
+/// Limits on the integration of a single point. A point still unconverged
+/// after trialCount trials or after the wall time budget is unresolved
+/// (unresolvedPosition). Once the cancellation flag is set the points being
+/// integrated are abandoned and keep their previous results, including their
+/// step count (a partial count would pass for a real cost, see
+/// StepCountCostModel).
+struct PointBudget {
+  using Clock = std::chrono::steady_clock;
+
+  int trialCount = maximumTrialCount;
+  /// Wall time per point, zero for no limit.
+  Clock::duration time = Clock::duration::zero();
+  const std::atomic<bool> *cancelled = nullptr;
+  /// Points out of budget save their integration state in their
+  /// PointProgress, integrating them again with it (and a larger budget)
+  /// resumes from it.
+  bool suspendsPoints = false;
+
+  bool isCancelled() const {
+    return cancelled && cancelled->load(std::memory_order_relaxed);
+  }
+
+  /// Point in time a point started at start runs out of time.
+  Clock::time_point deadline(Clock::time_point start) const {
+    return time == Clock::duration::zero() ? Clock::time_point::max()
+                                           : start + time;
+  }
+};
+
+/// Returns false for points that cannot be integrated: points outside of the
+/// pendulum length boundary and the undefined (0,0) point.
+template <typename SystemType, typename PointType>
+inline bool isIntegrable(const SystemType &theSystem,
+                         const PointType &thePoint) {
   // check if the point is within the pendulum length boundary
   if (std::sqrt(std::pow(thePoint.xPosition, 2) +
                 std::pow(thePoint.yPosition, 2)) > (theSystem.length - 1e-10))
-    return;
+    return false;
 
   // check if the point is (0,0) as it is undefined by our pendulum system
   if (std::abs(thePoint.xPosition) < 1e-10 &&
       std::abs(thePoint.yPosition) < 1e-10)
+    return false;
+
+  return true;
+}
+
+/// Tracks which attractor (or the middle) the pendulum head is near and since
+/// when, to determine if a point being integrated has converged. The zone of
+/// an attractor (or the middle) is the square of half side its position
+/// threshold around it, the time the head enters a zone is located within the
+/// step on the dense output of the step.
+struct ConvergenceMonitor {
+  double attractorPositionThreshold;
+  double midPositionThreshold;
+  double convergeTimeThreshold;
+  int currentAttractor = -2;
+  double initialTimeFound = 0.0;
+
+  /// Checks the pendulum head position after an accepted step from
+  /// startState at startTime to state at currTime, returns true and records
+  /// the convergence in thePoint if the head has been near the same
+  /// attractor (or the middle) for longer than the converge time threshold.
+  /// The converge time is the moment the threshold was exceeded, not the end
+  /// of the step.
+  template <typename SystemType, typename PointType>
+  bool update(const SystemType &theSystem, double startTime,
+              const PendulumSystem::StateType &startState, double currTime,
+              const PendulumSystem::StateType &state, PointType &thePoint) {
+    const int position = nearPosition(theSystem, state[0], state[1]);
+    if (position == -2) {
+      // not near middle or any attractor
+      return false;
+    }
+
+    // the head is in the zone since the start of the step, or entered it
+    // during the step
+    double enteredTime = startTime;
+    const double startDistance =
+        zoneDistance(theSystem, position, startState[0], startState[1]);
+    if (startDistance >= 0.0) {
+      const auto head =
+          headPositionInterpolant(startTime, startState, currTime, state);
+      enteredTime = locateEvent(
+          [&](double t) {
+            return zoneDistance(theSystem, position, head(0, t), head(1, t));
+          },
+          startTime, startDistance, currTime,
+          zoneDistance(theSystem, position, state[0], state[1]),
+          eventTimeTolerance);
+    }
+
+    if (currentAttractor != position) {
+      currentAttractor = position;
+      initialTimeFound = enteredTime;
+    }
+
+    const double convergedTime =
+        std::max(initialTimeFound + convergeTimeThreshold, enteredTime);
+    if (currTime > convergedTime) {
+      thePoint.convergeTime = convergedTime;
+      thePoint.convergePosition = position;
+      return true;
+    }
+
+    return false;
+  }
+
+  /// Checks the pendulum state after a step against the potential wells of
+  /// the system (if it has any, see AttractorWells). Returns true and records
+  /// the convergence in thePoint if the energy of the head is below the
+  /// heuristic capture energy of a well whose minimum is near an attractor (or
+  /// the middle), the converge time is the time it was captured.
+  template <typename SystemType, typename PointType>
+  bool capture(const SystemType &theSystem,
+               const PendulumSystem::StateType &state, double currTime,
+               PointType &thePoint) const {
+    if (!theSystem.wells)
+      return false;
+
+    const int wellIndex = theSystem.wells->wellAt(state[0], state[1]);
+    if (wellIndex < 0)
+      return false;
+
+    const AttractorWells::Well &well =
+        theSystem.wells->wells()[static_cast<std::size_t>(wellIndex)];
+    if (mechanicalEnergy(theSystem, state[0], state[1], state[2], state[3]) >=
+        well.captureEnergy)
+      return false;
+
+    const int position =
+        nearPosition(theSystem, well.xPosition, well.yPosition);
+    if (position == -2)
+      return false;
+
+    thePoint.convergeTime = currTime;
+    thePoint.convergePosition = position;
+    return true;
+  }
+
+  /// Index of the attractor the position is near, -1 for the middle and -2
+  /// for neither.
+  template <typename SystemType>
+  int nearPosition(const SystemType &theSystem, double currX,
+                   double currY) const {
+    // check if pendulum head near an attractor
+    if (theSystem.attractorGrid) {
+      const int index = theSystem.attractorGrid->nearAttractor(
+          currX, currY, attractorPositionThreshold);
+      if (index >= 0)
+        return index;
+    } else {
+      for (int i = 0,
+               attractorCount =
+                   static_cast<int>(theSystem.attractorList.size());
+           i < attractorCount; ++i) {
+        if (isNearAttractor(theSystem.attractorList[i].xPosition,
+                            theSystem.attractorList[i].yPosition, currX,
+                            currY, attractorPositionThreshold)) {
+          return i;
+        }
+      }
+    }
+
+    // check if pendulum head near middle
+    if (isNearMiddle(currX, currY, midPositionThreshold)) {
+      return -1;
+    }
+
+    return -2;
+  }
+
+private:
+  // distance in the maximum norm from (x, y) to the zone of the position,
+  // negative inside of it
+  template <typename SystemType>
+  double zoneDistance(const SystemType &theSystem, int position, double x,
+                      double y) const {
+    if (position == -1) {
+      return std::max(std::abs(x), std::abs(y)) - midPositionThreshold;
+    }
+
+    const auto &attractor =
+        theSystem.attractorList[static_cast<std::size_t>(position)];
+    return std::max(std::abs(x - attractor.xPosition),
+                    std::abs(y - attractor.yPosition)) -
+           attractorPositionThreshold;
+  }
+};
+
+/// Looks up the cell of the state in the fate cache of the system (if it has
+/// one, see FateCache) every fateCheckInterval trials. Returns true and
+/// records the fate of the cell in thePoint if it is known, otherwise adds the
+/// cell to the trail of the point.
+template <typename SystemType, typename PointType>
+inline bool checkFate(const SystemType &theSystem, FateTrail &trail,
+                      const PendulumSystem::StateType &state,
+                      double currTime, int trialCount, PointType &thePoint) {
+  if (!theSystem.fateCache || trialCount % fateCheckInterval != 0)
+    return false;
+
+  FateCache &cache = *theSystem.fateCache;
+  const std::uint64_t cell = cache.cellOf(state);
+  int position;
+  double remainingTime;
+  if (cache.find(cell, position, remainingTime)) {
+    thePoint.convergeTime = currTime + remainingTime;
+    thePoint.convergePosition = position;
+    return true;
+  }
+
+  trail.push(cell, currTime);
+  return false;
+}
+
+/// Records the trail of a point that converged by integration in the fate
+/// cache of the system (if it has one).
+template <typename SystemType, typename PointType>
+inline void recordFate(const SystemType &theSystem, const FateTrail &trail,
+                       const PointType &thePoint) {
+  if (theSystem.fateCache) {
+    trail.record(*theSystem.fateCache, thePoint.convergePosition,
+                 thePoint.convergeTime);
+  }
+}
+
+/// True if the point of the progress ran out of budget and resumes from it.
+inline bool isSuspended(const PointProgress &progress) {
+  return progress.trialCount > 0;
+}
+
+/// Saves the integration state of a point running out of budget.
+inline void suspendPoint(PointProgress &progress,
+                         const PendulumSystem::StateType &state, double time,
+                         double stepSize, int trialCount,
+                         const ConvergenceMonitor &monitor) {
+  progress.state = state;
+  progress.time = time;
+  progress.stepSize = stepSize;
+  progress.initialTimeFound = monitor.initialTimeFound;
+  progress.trialCount = trialCount;
+  progress.currentAttractor = monitor.currentAttractor;
+}
+
+/*!
+ * @brief Integrates a single point until it converges (or runs out of
+ *budget), recording the result in the point.
+ * @param[in] theIntegrator Integrator callable as theIntegrator(theSystem,
+ *state, time, stepSize), see cashKarp54. It is taken by value so integrators
+ *that carry state between steps (e.g. the first same as last derivative of
+ *dormandPrince54) start fresh for every point.
+ * @param[in] theSystem PendulumSystem or FixedPendulumSystem to integrate.
+ * @param[in,out] thePoint Point or Map::PointReference.
+ * @param[in] startingStepSize The step size of the first step, or a callable
+ *as startingStepSize(theSystem, state, derivative) returning it (e.g. using
+ *initialStepSize). A resumed point takes its saved step size instead.
+ * @param[in] budget Trial, wall time and cancellation limits, see PointBudget.
+ * @param[in,out] progress Progress of the point or null, a suspended point
+ *resumes from it and it is reset (or saves the point if it is suspended
+ *again).
+ */
+template <typename Integrator, typename SystemType, typename PointType,
+          typename StartingStepSize>
+inline void
+integratePoint(Integrator theIntegrator, const SystemType &theSystem,
+               PointType &&thePoint, const StartingStepSize &startingStepSize,
+               double attractorPositionThreshold, double midPositionThreshold,
+               double convergeTimeThreshold,
+               const PointBudget &budget = PointBudget(),
+               PointProgress *progress = nullptr) {
+  const PointProgress resumed = progress ? *progress : PointProgress();
+  const bool isResumed = isSuspended(resumed);
+  if (!isResumed && !isIntegrable(theSystem, thePoint))
     return;
 
   // integration good to go, create local state for integration to keep start
   // state
-  PendulumSystem::StateType current_state = {
-      {thePoint.xPosition, thePoint.yPosition, thePoint.xVelocity,
-       thePoint.yVelocity}};
-
-  double currTime = 0.0;
-  double stepSize = startingStepSize;
-  int trialCount = 0;
-  bool converged = false;
-  double initialTimeFound = 0.0;
-  bool nearAttractor = false; // start not near any attractor
-  int currentAttractor = -2;
-  while (!converged && trialCount < 1000000) {
+  PendulumSystem::StateType current_state =
+      isResumed ? resumed.state
+                : PendulumSystem::StateType{{thePoint.xPosition,
+                                             thePoint.yPosition,
+                                             thePoint.xVelocity,
+                                             thePoint.yVelocity}};
+
+  if (progress)
+    *progress = PointProgress();
+  const int previousStepCount = thePoint.stepCount;
+  double currTime = resumed.time;
+  double stepSize =
+      isResumed ? resumed.stepSize
+                : startingStepSizeFor(startingStepSize, theSystem,
+                                      current_state);
+  int trialCount = resumed.trialCount;
+  ConvergenceMonitor monitor{attractorPositionThreshold, midPositionThreshold,
+                             convergeTimeThreshold};
+  monitor.currentAttractor = resumed.currentAttractor;
+  monitor.initialTimeFound = resumed.initialTimeFound;
+  FateTrail trail;
+  const auto deadline = budget.deadline(PointBudget::Clock::now());
+  while (true) {
+    const PendulumSystem::StateType startState = current_state;
+    const double startTime = currTime;
     thePoint.stepCount +=
         theIntegrator(theSystem, current_state, currTime, stepSize);
     ++trialCount;
 
-    // check if pendulum head near an attractor and if it's been near for long
-    // enough time to consider converged
-    for (int i = 0,
-             attractorCount = static_cast<int>(theSystem.attractorList.size());
-         i < attractorCount; ++i) {
-      if (isNearAttractor(theSystem.attractorList[i].xPosition,
-                          theSystem.attractorList[i].yPosition,
-                          current_state[0], current_state[1],
-                          attractorPositionThreshold)) {
-        nearAttractor = true;
-        if (currentAttractor == i) {
-          if (currTime - initialTimeFound > convergeTimeThreshold) {
-            thePoint.convergeTime = currTime;
-            thePoint.convergePosition = i;
-            converged = true;
-          }
-        } else {
-          currentAttractor = i;
-          initialTimeFound = currTime;
-        }
-        break; // escape for-loop after finding that we're near an attractor
+    // a rejected step leaves the state as it was
+    if (currTime != startTime &&
+        (monitor.update(theSystem, startTime, startState, currTime,
+                        current_state, thePoint) ||
+         monitor.capture(theSystem, current_state, currTime, thePoint))) {
+      recordFate(theSystem, trail, thePoint);
+      return;
+    }
+
+    if (checkFate(theSystem, trail, current_state, currTime, trialCount,
+                  thePoint))
+      return;
+
+    bool isOutOfBudget = trialCount >= budget.trialCount;
+    if (!isOutOfBudget && trialCount % budgetCheckInterval == 0) {
+      if (budget.isCancelled()) {
+        thePoint.stepCount = previousStepCount;
+        return;
+      }
+
+      isOutOfBudget = PointBudget::Clock::now() >= deadline;
+    }
+
+    if (isOutOfBudget) {
+      thePoint.convergePosition = unresolvedPosition;
+      if (budget.suspendsPoints && progress) {
+        suspendPoint(*progress, current_state, currTime, stepSize,
+                     trialCount, monitor);
       }
+      return;
     }
-    if (!nearAttractor) {
-      // check if pendulum head near middle
-      if (isNearMiddle(current_state[0], current_state[1],
-                       midPositionThreshold)) {
-        if (currentAttractor == -1) {
-          if (currTime - initialTimeFound > convergeTimeThreshold) {
-            thePoint.convergeTime = currTime;
-            thePoint.convergePosition = -1;
-            converged = true;
-          }
-        } else {
-          currentAttractor = -1;
-          initialTimeFound = currTime;
+  }
+}
+
+/*!
+ * @brief Integrates a range of points advancing Lanes points at a time in
+ *lockstep with a batched integrator.
+ *
+ * Every lane holds its own point, time, step size and convergence state. When
+ *the point in a lane converges (or runs out of trials) its lane is refilled
+ *with the next integrable point of the range, so the lanes stay busy until the
+ *range is exhausted. Results are the same as calling integratePoint on every
+ *point of the range.
+ * @tparam Lanes The number of points integrated together, see BatchState.
+ * @tparam Controller The step size controller type, every lane gets a default
+ *constructed one when a point is loaded, see ElementaryStepController.
+ * @param[in] theIntegrator Batched integrator callable as
+ *theIntegrator(theSystem, states, derivatives, times, stepSizes, accepted,
+ *controllers), see explicitRungeKuttaBatch.
+ * @param[in] theSystem PendulumSystem or FixedPendulumSystem to integrate.
+ * @param[in] startingStepSize The step size of the first step of every point,
+ *or a callable as startingStepSize(theSystem, state, derivative) returning it
+ *per point (e.g. using initialStepSize), see integratePoint.
+ * @param[in] budget Limits of every point, see PointBudget. Once cancelled the
+ *points still loaded are abandoned and the rest of the range is skipped.
+ * @param[in,out] progress Progress of the points of the range or null, see
+ *integratePoint.
+ */
+template <std::size_t Lanes, typename Controller = ElementaryStepController,
+          typename BatchIntegrator, typename SystemType, typename PointIterator,
+          typename StartingStepSize>
+inline void
+integratePoints(BatchIntegrator &&theIntegrator, const SystemType &theSystem,
+                PointIterator first, PointIterator last,
+                const StartingStepSize &startingStepSize,
+                double attractorPositionThreshold, double midPositionThreshold,
+                double convergeTimeThreshold,
+                const PointBudget &budget = PointBudget(),
+                PointProgress *progress = nullptr) {
+  BatchState<4, Lanes> states;
+  BatchState<4, Lanes> derivatives;
+  LaneArray<double, Lanes> times;
+  LaneArray<double, Lanes> stepSizes;
+  LaneArray<int, Lanes> accepted;
+  LaneArray<PointIterator, Lanes> points;
+  LaneArray<PointProgress *, Lanes> progresses;
+  LaneArray<int, Lanes> previousStepCounts;
+  LaneArray<bool, Lanes> isLoaded;
+  LaneArray<int, Lanes> trialCounts;
+  LaneArray<PointBudget::Clock::time_point, Lanes> deadlines;
+  LaneArray<ConvergenceMonitor, Lanes> monitors;
+  LaneArray<FateTrail, Lanes> trails;
+  LaneArray<Controller, Lanes> controllers;
+
+  // load the next integrable point of the range into the lane, returns false
+  // if the range is exhausted
+  const PointIterator rangeFirst = first;
+  auto refillLane = [&](std::size_t lane) {
+    for (; first != last; ++first) {
+      auto &&thePoint = *first;
+      PointProgress *const pointProgress =
+          progress ? progress + (first - rangeFirst) : nullptr;
+      const PointProgress resumed =
+          pointProgress ? *pointProgress : PointProgress();
+      const bool isResumed = isSuspended(resumed);
+      if (!isResumed && !isIntegrable(theSystem, thePoint))
+        continue;
+
+      const PendulumSystem::StateType state =
+          isResumed ? resumed.state
+                    : PendulumSystem::StateType{{thePoint.xPosition,
+                                                 thePoint.yPosition,
+                                                 thePoint.xVelocity,
+                                                 thePoint.yVelocity}};
+      PendulumSystem::StateType derivative;
+      theSystem(state, derivative, 0.0);
+      for (std::size_t i = 0; i < 4; ++i) {
+        states[i][lane] = state[i];
+        derivatives[i][lane] = derivative[i];
+      }
+      if (pointProgress)
+        *pointProgress = PointProgress();
+      times[lane] = resumed.time;
+      stepSizes[lane] =
+          isResumed ? resumed.stepSize
+                    : startingStepSizeFor(startingStepSize, theSystem, state,
+                                          derivative);
+      controllers[lane] = Controller();
+      points[lane] = first;
+      progresses[lane] = pointProgress;
+      previousStepCounts[lane] = thePoint.stepCount;
+      isLoaded[lane] = true;
+      trialCounts[lane] = resumed.trialCount;
+      deadlines[lane] = budget.deadline(PointBudget::Clock::now());
+      monitors[lane] = ConvergenceMonitor{attractorPositionThreshold,
+                                          midPositionThreshold,
+                                          convergeTimeThreshold};
+      monitors[lane].currentAttractor = resumed.currentAttractor;
+      monitors[lane].initialTimeFound = resumed.initialTimeFound;
+      trails[lane].clear();
+      ++first;
+      return true;
+    }
+
+    isLoaded[lane] = false;
+    return false;
+  };
+
+  std::size_t activeCount = 0;
+  for (std::size_t lane = 0; lane < Lanes; ++lane) {
+    if (refillLane(lane))
+      ++activeCount;
+  }
+
+  if (activeCount == 0)
+    return;
+
+  // idle lanes still go through the vectorized step, park them on a valid
+  // state so they do not produce NaNs
+  for (std::size_t lane = activeCount; lane < Lanes; ++lane) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      states[i][lane] = states[i][0];
+      derivatives[i][lane] = derivatives[i][0];
+    }
+    times[lane] = times[0];
+    stepSizes[lane] = stepSizes[0];
+    controllers[lane] = controllers[0];
+  }
+
+  // the lanes are checked against the wall time budget together, the
+  // deadlines are only compared every budgetCheckInterval steps
+  for (int batchStepCount = 1; activeCount != 0; ++batchStepCount) {
+    const BatchState<4, Lanes> startStates = states;
+    const LaneArray<double, Lanes> startTimes = times;
+    theIntegrator(theSystem, states, derivatives, times, stepSizes, accepted,
+                  controllers);
+
+    const bool isBudgetCheck = batchStepCount % budgetCheckInterval == 0;
+    if (isBudgetCheck && budget.isCancelled()) {
+      for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        if (isLoaded[lane])
+          (*points[lane]).stepCount = previousStepCounts[lane];
+      }
+      return;
+    }
+
+    const auto now = isBudgetCheck ? PointBudget::Clock::now()
+                                   : PointBudget::Clock::time_point();
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+      if (!isLoaded[lane])
+        continue;
+
+      auto &&thePoint = *points[lane];
+      thePoint.stepCount += accepted[lane];
+      ++trialCounts[lane];
+
+      const PendulumSystem::StateType state = {
+          {states[0][lane], states[1][lane], states[2][lane],
+           states[3][lane]}};
+      bool isFinished =
+          accepted[lane] != 0 &&
+          (monitors[lane].update(theSystem, startTimes[lane],
+                                 {{startStates[0][lane], startStates[1][lane],
+                                   startStates[2][lane], startStates[3][lane]}},
+                                 times[lane], state, thePoint) ||
+           monitors[lane].capture(theSystem, state, times[lane], thePoint));
+      if (isFinished) {
+        recordFate(theSystem, trails[lane], thePoint);
+      } else {
+        isFinished = checkFate(theSystem, trails[lane], state, times[lane],
+                               trialCounts[lane], thePoint);
+      }
+      if (!isFinished && (trialCounts[lane] >= budget.trialCount ||
+                          (isBudgetCheck && now >= deadlines[lane]))) {
+        thePoint.convergePosition = unresolvedPosition;
+        if (budget.suspendsPoints && progresses[lane]) {
+          suspendPoint(*progresses[lane], state, times[lane], stepSizes[lane],
+                       trialCounts[lane], monitors[lane]);
         }
+        isFinished = true;
+      }
+
+      if (isFinished) {
+        // lane keeps its last state when there is nothing left to refill it
+        if (!refillLane(lane))
+          --activeCount;
       }
     }
-    // ELSE: not near middle or any attractor, just go to next step
-    nearAttractor = false; // set flag for next step
   }
 }
 
@@ -28,6 +28,6 @@ namespace staticpendulum {
 //! attractors positioned at: \f$(-0.5, \sqrt{3}/2)\f$, \f$(-0.5,
 //! -\sqrt{3}/2)\f$, and \f$(1, 0)\f$.
 PendulumSystem::PendulumSystem()
-    : distance(0.05), mass(1.0), gravity(9.8), drag(0.2), length(10.0) {}
+    : PendulumParameters{0.05, 1.0, 9.8, 0.2, 10.0, {}, {}, {}} {}
 
 } // namespace staticpendulum
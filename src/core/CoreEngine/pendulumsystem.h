@@ -23,11 +23,46 @@
  * ===========================================================================*/
 #ifndef PENDULUMSYSTEM_H
 #define PENDULUMSYSTEM_H
+#include "attractortree.h"
+#include "batchstate.h"
+#include "forcefieldtable.h"
 #include <array>
 #include <cmath>
+#include <memory>
 #include <vector>
 
 namespace staticpendulum {
+class AttractorGrid;
+class AttractorWells;
+class FateCache;
+
+//! Members shared by PendulumSystem and the system types built from it: the
+//! physical parameters and the optional aids to detecting convergence, which
+//! do not depend on how the attractor forces are summed.
+struct PendulumParameters {
+  double distance; /*!< Distance between the pendulum head at rest and the base
+                      plate. */
+  double mass;     /*!< Mass of the head of the pendulum. */
+  double gravity;  /*!< Acceleration due to gravity. */
+  double drag;     /*!< Linear drag coefficient. */
+  double length;   /*!< Length of the pendulum. */
+  std::shared_ptr<const AttractorWells>
+      wells; /*!< Optional potential wells of the system, when not null a
+                point stops integrating as soon as its energy is below the
+                heuristic capture energy of the well of an attractor (see
+                ConvergenceMonitor::capture). */
+  std::shared_ptr<const AttractorGrid>
+      attractorGrid; /*!< Optional spatial index of attractorList, when not
+                        null the attractor the head is near is found from it
+                        instead of testing every attractor (see
+                        ConvergenceMonitor::nearPosition). */
+  std::shared_ptr<FateCache>
+      fateCache; /*!< Optional cache of the fates of phase space cells shared
+                    by the points being integrated, when not null a point
+                    stops integrating as soon as it reaches a cell of known
+                    fate (see FateCache). */
+};
+
 //! Pendulum function object that returns the derivative of the current state.
 
 /*! The pendulum system is described by the following system of differential
@@ -61,8 +96,10 @@ namespace staticpendulum {
  * reference parameter the derivative of the state passed in.
  */
 
-struct PendulumSystem {
+struct PendulumSystem : PendulumParameters {
   typedef std::array<double, 4> StateType; // container type for the state
+  typedef std::array<std::array<double, 4>, 4>
+      JacobianType; // container type for the Jacobian, indexed [row][column]
 
   //! Container for an attractor, stores the position as an x-y coordinate, and
   //! an attractive force coefficient.
@@ -76,61 +113,269 @@ struct PendulumSystem {
                        \frac{-k}{x^2+y^2}\f$ */
   };
 
-  double distance; /*!< Distance between the pendulum head at rest and the base
-                      plate. */
-  double mass;     /*!< Mass of the head of the pendulum. */
-  double gravity;  /*!< Acceleration due to gravity. */
-  double drag;     /*!< Linear drag coefficient. */
-  double length;   /*!< Length of the pendulum. */
   std::vector<Attractor>
       attractorList; /*!< List of attractors for the system. */
+  std::shared_ptr<const AttractorTree>
+      attractorTree; /*!< Optional Barnes-Hut approximation of the attractor
+                        forces built from attractorList, the forces are summed
+                        exactly when null. */
+  std::shared_ptr<const ForceFieldTable>
+      forceTable; /*!< Optional tabulated gravity and attractor force, used
+                     instead of both when not null. */
 
   PendulumSystem();
   void operator()(const StateType &x, StateType &dxdt,
                   const double /* t */) const;
+
+  template <std::size_t Lanes>
+  void operator()(const BatchState<4, Lanes> &x, BatchState<4, Lanes> &dxdt,
+                  const LaneArray<double, Lanes> & /* t */) const;
+
+  void jacobian(const StateType &x, JacobianType &dfdx,
+                const double /* t */) const;
 };
 
-//! Function call that returns the derivative of the current state.
-inline void PendulumSystem::operator()(
-    const StateType &
-        x /*!< Current state input; index 0 is x position, index 1 is y position, index 2 is x velocity, and index 3 is y velocity. */,
-    StateType &
-        dxdt /*!< Derivative of the state, value modified by reference; follows the same indexing as the input state. */,
-    const double /*t*/ /*!< Note: system has no time dependence. Parameter here to fit signature for integration.*/)
-    const {
+namespace detail {
+// The kernels below are shared by PendulumSystem and FixedPendulumSystem, they
+// only require the physical parameters and an attractorList range from the
+// system so the attractor loops are fully unrolled for fixed size arrays.
+
+// attractor force coefficient over the cubed distance, the sqrt/multiply form
+// is considerably cheaper than std::pow(squaredDistance, 1.5)
+inline double attractorFactor(double forceCoeff, double squaredDistance) {
+  return -forceCoeff / (squaredDistance * std::sqrt(squaredDistance));
+}
+
+// sumAttractorForces(x, y, value2, xAttractionForce, yAttractionForce) sums
+// the attraction forces, see pendulumDerivative below for the exact sum
+template <typename SystemType, typename AttractorForces>
+inline void pendulumDerivative(const SystemType &sys,
+                               const PendulumSystem::StateType &x,
+                               PendulumSystem::StateType &dxdt,
+                               AttractorForces &&sumAttractorForces) {
   // see latex equation or readme for more readable math, this is coded to
   // minimize repeated calculations
   const double xSquared = x[0] * x[0];
   const double ySquared = x[1] * x[1];
-  const double lengthSquared = length * length;
+  const double lengthSquared = sys.length * sys.length;
   const double normSquared = xSquared + ySquared;
   const double sqrtTerm = std::sqrt(1.0 - normSquared / lengthSquared);
 
-  const double gravityValue = -mass * gravity / length * sqrtTerm;
+  const double gravityValue = -sys.mass * sys.gravity / sys.length * sqrtTerm;
 
-  double xAttractionForce = 0.0;
-  double yAttractionForce = 0.0;
-
-  const double value1 = distance + length * (1.0 - sqrtTerm);
+  const double value1 = sys.distance + sys.length * (1.0 - sqrtTerm);
   const double value2 = value1 * value1;
 
+  double xAttractionForce;
+  double yAttractionForce;
+  sumAttractorForces(x[0], x[1], value2, xAttractionForce, yAttractionForce);
+
+  dxdt[0] = x[2];
+  dxdt[1] = x[3];
+  dxdt[2] =
+      (x[0] * gravityValue - sys.drag * x[2] + xAttractionForce) / sys.mass;
+  dxdt[3] =
+      (x[1] * gravityValue - sys.drag * x[3] + yAttractionForce) / sys.mass;
+}
+
+template <typename SystemType>
+inline void pendulumDerivative(const SystemType &sys,
+                               const PendulumSystem::StateType &x,
+                               PendulumSystem::StateType &dxdt) {
+  pendulumDerivative(sys, x, dxdt, [&sys](double xPosition, double yPosition,
+                                          double value2,
+                                          double &xAttractionForce,
+                                          double &yAttractionForce) {
+    xAttractionForce = 0.0;
+    yAttractionForce = 0.0;
+    // sum up all the attractor forces
+    for (const auto &attractor : sys.attractorList) {
+      const double value3 = xPosition - attractor.xPosition;
+      const double value4 = yPosition - attractor.yPosition;
+      const double value5 = value3 * value3;
+      const double value6 = value4 * value4;
+      const double value7 =
+          attractorFactor(attractor.forceCoeff, value5 + value6 + value2);
+
+      xAttractionForce += value3 * value7;
+      yAttractionForce += value4 * value7;
+    }
+  });
+}
+
+// batched derivative evaluating the lanes one at a time with the scalar
+// derivative of the system, for systems whose scalar derivative does not map
+// onto the lanes (vectorized across attractors or tree traversals)
+template <typename SystemType, std::size_t Lanes>
+inline void pendulumDerivativePerLane(const SystemType &sys,
+                                      const BatchState<4, Lanes> &x,
+                                      BatchState<4, Lanes> &dxdt,
+                                      const LaneArray<double, Lanes> &t) {
+  for (std::size_t l = 0; l < Lanes; ++l) {
+    const PendulumSystem::StateType laneState = {
+        {x[0][l], x[1][l], x[2][l], x[3][l]}};
+    PendulumSystem::StateType laneDerivative;
+    sys(laneState, laneDerivative, t[l]);
+    for (std::size_t i = 0; i < 4; ++i) {
+      dxdt[i][l] = laneDerivative[i];
+    }
+  }
+}
+
+template <typename SystemType, std::size_t Lanes>
+inline void pendulumDerivative(const SystemType &sys,
+                               const BatchState<4, Lanes> &x,
+                               BatchState<4, Lanes> &dxdt) {
+  const double lengthSquared = sys.length * sys.length;
+
+  LaneArray<double, Lanes> gravityValue;
+  LaneArray<double, Lanes> value2;
+  LaneArray<double, Lanes> xAttractionForce;
+  LaneArray<double, Lanes> yAttractionForce;
+  for (std::size_t l = 0; l < Lanes; ++l) {
+    const double normSquared = x[0][l] * x[0][l] + x[1][l] * x[1][l];
+    const double sqrtTerm = std::sqrt(1.0 - normSquared / lengthSquared);
+    gravityValue[l] = -sys.mass * sys.gravity / sys.length * sqrtTerm;
+    const double value1 = sys.distance + sys.length * (1.0 - sqrtTerm);
+    value2[l] = value1 * value1;
+    xAttractionForce[l] = 0.0;
+    yAttractionForce[l] = 0.0;
+  }
+
   // sum up all the attractor forces
-  for (auto attractor : attractorList) {
+  for (const auto &attractor : sys.attractorList) {
+    for (std::size_t l = 0; l < Lanes; ++l) {
+      const double value3 = x[0][l] - attractor.xPosition;
+      const double value4 = x[1][l] - attractor.yPosition;
+      const double value7 = attractorFactor(
+          attractor.forceCoeff, value3 * value3 + value4 * value4 + value2[l]);
+
+      xAttractionForce[l] += value3 * value7;
+      yAttractionForce[l] += value4 * value7;
+    }
+  }
+
+  for (std::size_t l = 0; l < Lanes; ++l) {
+    dxdt[0][l] = x[2][l];
+    dxdt[1][l] = x[3][l];
+    dxdt[2][l] = (x[0][l] * gravityValue[l] - sys.drag * x[2][l] +
+                  xAttractionForce[l]) /
+                 sys.mass;
+    dxdt[3][l] = (x[1][l] * gravityValue[l] - sys.drag * x[3][l] +
+                  yAttractionForce[l]) /
+                 sys.mass;
+  }
+}
+
+template <typename SystemType>
+inline void pendulumJacobian(const SystemType &sys,
+                             const PendulumSystem::StateType &x,
+                             PendulumSystem::JacobianType &dfdx) {
+  const double xSquared = x[0] * x[0];
+  const double ySquared = x[1] * x[1];
+  const double lengthSquared = sys.length * sys.length;
+  const double normSquared = xSquared + ySquared;
+  const double sqrtTerm = std::sqrt(1.0 - normSquared / lengthSquared);
+
+  // gravity force is x * gravityValue (and y * gravityValue)
+  const double gravityValue = -sys.mass * sys.gravity / sys.length * sqrtTerm;
+  const double gravityDerivative =
+      sys.mass * sys.gravity / (lengthSquared * sys.length * sqrtTerm);
+  double dFxdx = gravityValue + xSquared * gravityDerivative;
+  double dFxdy = x[0] * x[1] * gravityDerivative;
+  double dFydx = dFxdy;
+  double dFydy = gravityValue + ySquared * gravityDerivative;
+
+  // squared height term of the attractor distance and its gradient
+  const double value1 = sys.distance + sys.length * (1.0 - sqrtTerm);
+  const double value2 = value1 * value1;
+  const double value2dx = 2.0 * value1 * x[0] / (sys.length * sqrtTerm);
+  const double value2dy = 2.0 * value1 * x[1] / (sys.length * sqrtTerm);
+
+  for (const auto &attractor : sys.attractorList) {
     const double value3 = x[0] - attractor.xPosition;
     const double value4 = x[1] - attractor.yPosition;
-    const double value5 = value3 * value3;
-    const double value6 = value4 * value4;
+    const double squaredDistance = value3 * value3 + value4 * value4 + value2;
     const double value7 =
-        -attractor.forceCoeff / std::pow(value5 + value6 + value2, 1.5);
+        attractorFactor(attractor.forceCoeff, squaredDistance);
+    // derivative of value7 with respect to squaredDistance
+    const double value7Derivative = -1.5 * value7 / squaredDistance;
+    const double squaredDistancedx = 2.0 * value3 + value2dx;
+    const double squaredDistancedy = 2.0 * value4 + value2dy;
 
-    xAttractionForce += value3 * value7;
-    yAttractionForce += value4 * value7;
+    dFxdx += value7 + value3 * value7Derivative * squaredDistancedx;
+    dFxdy += value3 * value7Derivative * squaredDistancedy;
+    dFydx += value4 * value7Derivative * squaredDistancedx;
+    dFydy += value7 + value4 * value7Derivative * squaredDistancedy;
   }
 
-  dxdt[0] = x[2];
-  dxdt[1] = x[3];
-  dxdt[2] = (x[0] * gravityValue - drag * x[2] + xAttractionForce) / mass;
-  dxdt[3] = (x[1] * gravityValue - drag * x[3] + yAttractionForce) / mass;
+  dfdx[0] = {{0.0, 0.0, 1.0, 0.0}};
+  dfdx[1] = {{0.0, 0.0, 0.0, 1.0}};
+  dfdx[2] = {{dFxdx / sys.mass, dFxdy / sys.mass, -sys.drag / sys.mass, 0.0}};
+  dfdx[3] = {{dFydx / sys.mass, dFydy / sys.mass, 0.0, -sys.drag / sys.mass}};
+}
+} // namespace detail
+
+//! Function call that returns the derivative of the current state.
+inline void PendulumSystem::operator()(
+    const StateType &
+        x /*!< Current state input; index 0 is x position, index 1 is y position, index 2 is x velocity, and index 3 is y velocity. */,
+    StateType &
+        dxdt /*!< Derivative of the state, value modified by reference; follows the same indexing as the input state. */,
+    const double /*t*/ /*!< Note: system has no time dependence. Parameter here to fit signature for integration.*/)
+    const {
+  if (forceTable) {
+    double xForce;
+    double yForce;
+    forceTable->force(x[0], x[1], xForce, yForce);
+    dxdt[0] = x[2];
+    dxdt[1] = x[3];
+    dxdt[2] = (xForce - drag * x[2]) / mass;
+    dxdt[3] = (yForce - drag * x[3]) / mass;
+    return;
+  }
+
+  if (attractorTree) {
+    detail::pendulumDerivative(
+        *this, x, dxdt,
+        [this](double xPosition, double yPosition, double value2,
+               double &xAttractionForce, double &yAttractionForce) {
+          attractorTree->sumForces(xPosition, yPosition, value2,
+                                   xAttractionForce, yAttractionForce);
+        });
+    return;
+  }
+
+  detail::pendulumDerivative(*this, x, dxdt);
+}
+
+//! Analytic Jacobian of the derivative returned by operator(), used by the
+//! implicit (Rosenbrock) integrators. The attractor terms are always summed
+//! exactly, attractorTree and forceTable are not used.
+inline void PendulumSystem::jacobian(
+    const StateType &
+        x /*!< Current state input; same indexing as operator(). */,
+    JacobianType &
+        dfdx /*!< Jacobian value modified by reference; dfdx[i][j] is the partial derivative of dxdt[i] with respect to x[j]. */,
+    const double /*t*/ /*!< Note: system has no time dependence. */) const {
+  detail::pendulumJacobian(*this, x, dfdx);
+}
+
+//! Batched function call that returns the derivatives of several states at
+//! once, see BatchState for the lane layout. Each attractor is applied to all
+//! the lanes before moving to the next attractor so the lane loops vectorize,
+//! with an attractorTree or forceTable every lane is evaluated on its own.
+template <std::size_t Lanes>
+inline void
+PendulumSystem::operator()(const BatchState<4, Lanes> &x,
+                           BatchState<4, Lanes> &dxdt,
+                           const LaneArray<double, Lanes> &t) const {
+  if (forceTable || attractorTree) {
+    detail::pendulumDerivativePerLane(*this, x, dxdt, t);
+    return;
+  }
+
+  detail::pendulumDerivative(*this, x, dxdt);
 }
 } // namespace staticpendulum
 #endif // PENDULUM_SYSTEM_H
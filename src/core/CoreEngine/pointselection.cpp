@@ -0,0 +1,53 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "pointselection.h"
+#include <algorithm>
+#include <utility>
+
+namespace staticpendulum {
+PointSelection::PointSelection(std::vector<std::size_t> pointIndices)
+    : m_pointIndices(std::move(pointIndices)) {}
+
+PointSelection::PointSelection(std::vector<std::size_t> pointIndices,
+                               std::vector<PointProgress> progress)
+    : m_pointIndices(std::move(pointIndices)),
+      m_progress(std::move(progress)) {}
+
+std::vector<Tile> PointSelection::tiles() const {
+  const std::size_t fullRowCount = pointCount() / selectionRowLength;
+  std::vector<Tile> result;
+  for (std::size_t firstRow = 0; firstRow < fullRowCount;
+       firstRow += defaultTileRows) {
+    result.push_back({firstRow,
+                      std::min(firstRow + defaultTileRows, fullRowCount), 0,
+                      selectionRowLength});
+  }
+
+  const std::size_t remainder = pointCount() % selectionRowLength;
+  if (remainder != 0)
+    result.push_back({fullRowCount, fullRowCount + 1, 0, remainder});
+
+  return result;
+}
+} // namespace staticpendulum
@@ -0,0 +1,91 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef POINTSELECTION_H
+#define POINTSELECTION_H
+#include "pendulummapintegrator.h"
+#include "tilescheduler.h"
+#include <cstddef>
+#include <vector>
+
+namespace staticpendulum {
+/// Number of points per row of a PointSelection, see PointSelection::tiles.
+constexpr std::size_t selectionRowLength = defaultTileColumns;
+
+/*!
+ * @brief Scattered selection of map points to be integrated.
+ *
+ * The selection is laid out in rows of selectionRowLength points, so the
+ *TileScheduler can run it like map rows. Only the indices of the points are
+ *held: the points of a row are copied from the map into a buffer when the row
+ *is integrated and stored back right after, as integrateMapPoints does.
+ *
+ * The map does not store the progress of points suspended by a PointBudget,
+ *so a selection of suspended points holds their PointProgress.
+ */
+class PointSelection {
+public:
+  /// Selects the points of a map at pointIndices.
+  explicit PointSelection(std::vector<std::size_t> pointIndices);
+  /// Selects the points of a map at pointIndices along with the progress of
+  /// each, e.g. points suspended by a PointBudget.
+  PointSelection(std::vector<std::size_t> pointIndices,
+                 std::vector<PointProgress> progress);
+
+  std::size_t pointCount() const { return m_pointIndices.size(); }
+
+  /// Tiles over the rows of the selection, the last row may be shorter.
+  std::vector<Tile> tiles() const;
+
+  /// Integrates the points [row.firstColumn, row.lastColumn) of the selection
+  /// row row.firstRow with integratePoints(first, last, progress) taking a
+  /// range of Points (PointIterator) and their progress (null if the selection
+  /// has none), then stores them in the map they were selected from.
+  template <typename IntegratePoints>
+  void integrateRow(Map &map, const Tile &row,
+                    IntegratePoints &&integratePoints);
+
+private:
+  std::vector<std::size_t> m_pointIndices;
+  std::vector<PointProgress> m_progress;
+};
+
+template <typename IntegratePoints>
+inline void PointSelection::integrateRow(Map &map, const Tile &row,
+                                         IntegratePoints &&integratePoints) {
+  const std::size_t first = row.firstRow * selectionRowLength + row.firstColumn;
+  const std::size_t last = row.firstRow * selectionRowLength + row.lastColumn;
+  std::vector<Point> points;
+  points.reserve(last - first);
+  for (std::size_t i = first; i < last; ++i) {
+    points.push_back(static_cast<const Map &>(map).point(m_pointIndices[i]));
+  }
+
+  integratePoints(points.begin(), points.end(),
+                  m_progress.empty() ? nullptr : m_progress.data() + first);
+  for (std::size_t i = first; i < last; ++i) {
+    map.point(m_pointIndices[i]) = points[i - first];
+  }
+}
+} // namespace staticpendulum
+#endif // POINTSELECTION_H
@@ -0,0 +1,43 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "progressiverender.h"
+
+namespace staticpendulum {
+std::vector<std::size_t> latticeLevelIndices(const Map &map, std::size_t step,
+                                             bool isFirstLevel) {
+  const std::size_t previousStep = 2 * step;
+  std::vector<std::size_t> indices;
+  for (std::size_t row = 0; row < map.rows(); row += step) {
+    for (std::size_t column = 0; column < map.cols(); column += step) {
+      if (!isFirstLevel && row % previousStep == 0 &&
+          column % previousStep == 0)
+        continue;
+
+      indices.push_back(row * map.cols() + column);
+    }
+  }
+
+  return indices;
+}
+} // namespace staticpendulum
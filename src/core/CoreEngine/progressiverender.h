@@ -0,0 +1,48 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef PROGRESSIVERENDER_H
+#define PROGRESSIVERENDER_H
+#include "pendulummapintegrator.h"
+#include <cstddef>
+#include <vector>
+
+namespace staticpendulum {
+/// Lattice step of the first level of progressive rendering, it integrates 1
+/// in progressiveFirstStep^2 points. Every following level halves the step.
+constexpr std::size_t progressiveFirstStep = 16;
+
+/*!
+ * @brief Indices of the map points integrated by one level of progressive
+ *rendering.
+ *
+ * The level with lattice step s integrates the points whose row and column
+ *are both multiples of s, skipping the points of the previous level (step 2s)
+ *which are already integrated. The first level takes every point of its
+ *lattice. Once the level with step s is integrated every point of the lattice
+ *is done and can be upscaled to a preview of the map.
+ */
+std::vector<std::size_t> latticeLevelIndices(const Map &map, std::size_t step,
+                                             bool isFirstLevel);
+} // namespace staticpendulum
+#endif // PROGRESSIVERENDER_H
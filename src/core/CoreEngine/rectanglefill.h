@@ -0,0 +1,201 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef RECTANGLEFILL_H
+#define RECTANGLEFILL_H
+#include "tilescheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace staticpendulum {
+/// Side (in points) of the rectangles fillMap starts from.
+constexpr std::size_t rectangleFillTileSize = 128;
+/// Smallest minimumSize of fillRectangle, a rectangle needs an interior.
+constexpr std::size_t smallestFillSize = 3;
+
+/// Number of points fillMap integrated and filled, thread safe.
+struct RectangleFillCounts {
+  std::atomic<std::size_t> integratedPointCount{0};
+  std::atomic<std::size_t> filledPointCount{0};
+};
+
+/*!
+ * @brief One step of the Mariani-Silver rectangle fill of a map.
+ *
+ * Integrates the border points of the rectangle. If they are all integrable
+ *and converge to the same position the interior is filled with it without
+ *integrating (filled points keep a stepCount of 0 and get the mean converge
+ *time of the border). Otherwise the interior is split in (up to) four
+ *subrectangles appended to subrectangles. Rectangles with a side of at most
+ *minimumSize points are integrated completely.
+ *
+ * The pendulum reach is convex, so a rectangle whose border is within it is
+ *within it as a whole. The undefined (0,0) point is never filled.
+ * @param[in] integratePoints Callable as integratePoints(first, last) that
+ *integrates a range of Points (PointIterator), skipping points that are not
+ *integrable.
+ * @return The number of points of the rectangle that are finished, the points
+ *of the subrectangles are not.
+ */
+template <typename SystemType, typename IntegratePoints>
+std::size_t fillRectangle(Map &map, const SystemType &theSystem,
+                          const Tile &rectangle, std::size_t minimumSize,
+                          IntegratePoints &integratePoints,
+                          RectangleFillCounts &counts,
+                          std::vector<Tile> &subrectangles) {
+  Tile tile = rectangle;
+  if (!shrinkToIntegrable(map, theSystem, tile))
+    return rectangle.pointCount();
+
+  auto indexOf = [&map](std::size_t row, std::size_t column) {
+    return row * map.cols() + column;
+  };
+  auto countIntegrable = [&](std::size_t row, std::size_t firstColumn,
+                             std::size_t lastColumn) {
+    std::size_t count = 0;
+    for (std::size_t column = firstColumn; column < lastColumn; ++column) {
+      if (isIntegrable(theSystem, map.point(indexOf(row, column))))
+        ++count;
+    }
+    return count;
+  };
+
+  minimumSize = std::max(minimumSize, smallestFillSize);
+  if (tile.rowCount() <= minimumSize || tile.columnCount() <= minimumSize) {
+    for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+      const auto rowBegin = map.rowBegin(row);
+      integrateMapPoints(rowBegin + tile.firstColumn,
+                         rowBegin + tile.lastColumn, integratePoints);
+      counts.integratedPointCount +=
+          countIntegrable(row, tile.firstColumn, tile.lastColumn);
+    }
+    return rectangle.pointCount();
+  }
+
+  // gather the border, clockwise from the top left corner
+  std::vector<std::size_t> border;
+  for (std::size_t column = tile.firstColumn; column < tile.lastColumn;
+       ++column) {
+    border.push_back(indexOf(tile.firstRow, column));
+  }
+  for (std::size_t row = tile.firstRow + 1; row < tile.lastRow; ++row) {
+    border.push_back(indexOf(row, tile.lastColumn - 1));
+  }
+  for (std::size_t column = tile.lastColumn - 1; column-- > tile.firstColumn;) {
+    border.push_back(indexOf(tile.lastRow - 1, column));
+  }
+  for (std::size_t row = tile.lastRow - 1; row-- > tile.firstRow + 1;) {
+    border.push_back(indexOf(row, tile.firstColumn));
+  }
+
+  std::vector<Point> borderPoints;
+  borderPoints.reserve(border.size());
+  bool isBorderIntegrable = true;
+  for (const std::size_t index : border) {
+    borderPoints.push_back(map.point(index));
+    isBorderIntegrable =
+        isBorderIntegrable && isIntegrable(theSystem, borderPoints.back());
+  }
+  integratePoints(borderPoints.begin(), borderPoints.end());
+
+  bool isUniform = isBorderIntegrable;
+  double convergeTimeSum = 0.0;
+  std::size_t integratedCount = 0;
+  for (std::size_t i = 0; i < border.size(); ++i) {
+    map.point(border[i]) = borderPoints[i];
+    if (isIntegrable(theSystem, borderPoints[i]))
+      ++integratedCount;
+    isUniform = isUniform && borderPoints[i].convergePosition ==
+                                 borderPoints[0].convergePosition;
+    convergeTimeSum += borderPoints[i].convergeTime;
+  }
+  counts.integratedPointCount += integratedCount;
+  // out of bounds and unresolved points did not converge anywhere
+  isUniform = isUniform && borderPoints[0].convergePosition >= -1;
+
+  const Tile interior = {tile.firstRow + 1, tile.lastRow - 1,
+                         tile.firstColumn + 1, tile.lastColumn - 1};
+  if (isUniform) {
+    const int convergePosition = borderPoints[0].convergePosition;
+    const double convergeTime =
+        convergeTimeSum / static_cast<double>(border.size());
+    std::size_t filledCount = 0;
+    for (std::size_t row = interior.firstRow; row < interior.lastRow; ++row) {
+      for (std::size_t column = interior.firstColumn;
+           column < interior.lastColumn; ++column) {
+        auto point = map.point(indexOf(row, column));
+        if (!isIntegrable(theSystem, point))
+          continue;
+
+        point.convergePosition = convergePosition;
+        point.convergeTime = convergeTime;
+        point.stepCount = 0;
+        ++filledCount;
+      }
+    }
+    counts.filledPointCount += filledCount;
+    return rectangle.pointCount();
+  }
+
+  const std::size_t middleRow = interior.firstRow + interior.rowCount() / 2;
+  const std::size_t middleColumn =
+      interior.firstColumn + interior.columnCount() / 2;
+  std::size_t subrectanglePointCount = 0;
+  for (const Tile &quadrant :
+       {Tile{interior.firstRow, middleRow, interior.firstColumn, middleColumn},
+        Tile{interior.firstRow, middleRow, middleColumn, interior.lastColumn},
+        Tile{middleRow, interior.lastRow, interior.firstColumn, middleColumn},
+        Tile{middleRow, interior.lastRow, middleColumn,
+             interior.lastColumn}}) {
+    if (quadrant.pointCount() == 0)
+      continue;
+
+    subrectangles.push_back(quadrant);
+    subrectanglePointCount += quadrant.pointCount();
+  }
+
+  return rectangle.pointCount() - subrectanglePointCount;
+}
+
+/*!
+ * @brief Integrates the map with the Mariani-Silver rectangle fill, see
+ *fillRectangle. The map is split into rectangles of rectangleFillTileSize
+ *points per side and the recursion runs on the scheduler.
+ * @param[in] minimumSize Rectangles with a side of at most minimumSize points
+ *are integrated completely.
+ */
+template <typename SystemType, typename IntegratePoints>
+void fillMap(Map &map, const SystemType &theSystem, TileScheduler &scheduler,
+             std::size_t minimumSize, IntegratePoints integratePoints,
+             RectangleFillCounts &counts) {
+  scheduler.runRecursive(
+      makeTiles(map, theSystem, rectangleFillTileSize, rectangleFillTileSize),
+      [&](const Tile &rectangle, std::vector<Tile> &subrectangles) {
+        return fillRectangle(map, theSystem, rectangle, minimumSize,
+                             integratePoints, counts, subrectangles);
+      });
+}
+} // namespace staticpendulum
+#endif // RECTANGLEFILL_H
@@ -0,0 +1,216 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef ROSENBROCK23_H
+#define ROSENBROCK23_H
+#include "stepsizecontroller.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace staticpendulum {
+/// Square matrix indexed [row][column].
+template <std::size_t N>
+using SquareMatrix = std::array<std::array<double, N>, N>;
+
+/*!
+ * @brief LU decomposition with partial pivoting performed in place.
+ * @param[in,out] a The matrix to decompose, replaced by its L (unit diagonal,
+ *below the diagonal) and U (on and above the diagonal) factors.
+ * @param[out] pivot The row swapped with row i at step i.
+ * @return false if the matrix is singular.
+ */
+template <std::size_t N>
+inline bool luDecompose(SquareMatrix<N> &a, std::array<std::size_t, N> &pivot) {
+  for (std::size_t k = 0; k < N; ++k) {
+    std::size_t maxRow = k;
+    for (std::size_t i = k + 1; i < N; ++i) {
+      if (std::abs(a[i][k]) > std::abs(a[maxRow][k]))
+        maxRow = i;
+    }
+
+    pivot[k] = maxRow;
+    if (a[maxRow][k] == 0.0)
+      return false;
+
+    std::swap(a[k], a[maxRow]);
+    for (std::size_t i = k + 1; i < N; ++i) {
+      a[i][k] /= a[k][k];
+      for (std::size_t j = k + 1; j < N; ++j) {
+        a[i][j] -= a[i][k] * a[k][j];
+      }
+    }
+  }
+
+  return true;
+}
+
+/// Solves a * x = b in place of b using the factors from luDecompose.
+template <std::size_t N>
+inline void luSolve(const SquareMatrix<N> &lu,
+                    const std::array<std::size_t, N> &pivot,
+                    std::array<double, N> &b) {
+  for (std::size_t k = 0; k < N; ++k) {
+    std::swap(b[k], b[pivot[k]]);
+  }
+
+  for (std::size_t i = 1; i < N; ++i) {
+    for (std::size_t j = 0; j < i; ++j) {
+      b[i] -= lu[i][j] * b[j];
+    }
+  }
+
+  for (std::size_t i = N; i-- > 0;) {
+    for (std::size_t j = i + 1; j < N; ++j) {
+      b[i] -= lu[i][j] * b[j];
+    }
+    b[i] /= lu[i][i];
+  }
+}
+
+/// Orders of the Rosenbrock 2(3) method for the step size controllers, set
+/// like those of the order 5(4) tableaus. The error estimate is the difference
+/// of the order 2 and 3 solutions, which is O(h^3), so accepted steps grow
+/// with the exponent -1/order = -1/3 (and the PI gains use errorOrder + 1 =
+/// 3). Rejected steps shrink with the more cautious exponent -1/errorOrder =
+/// -1/2 of the propagated order 2 solution.
+struct Rosenbrock23Method {
+  static constexpr int order = 3;
+  static constexpr int errorOrder = 2;
+};
+
+/*!
+ * @brief Linearly implicit Rosenbrock order 2(3) adaptive step integrator for
+ *stiff systems.
+ *
+ * This is the modified Rosenbrock method of MATLAB's ode23s: it is L-stable, so
+ *the step size is limited by accuracy only, even where the system is stiff
+ *(e.g. the sharp attractor forces of a small plate distance). Every attempt
+ *evaluates the system twice and the Jacobian once, and solves three linear
+ *systems with one LU decomposition of I - h * d * J. The system is assumed to
+ *have no explicit time dependence. The last evaluation is at the new state so
+ *it is returned through dxdtx like dormandPrince54.
+ *
+ * See: L. F. Shampine, M. W. Reichelt. "The MATLAB ODE Suite." SIAM Journal on
+ *Scientific Computing, Vol. 18, No. 1, 1997.
+ * @tparam SystemType The type for the system being integrated, must be callable
+ *like for cashKarp54 and provide jacobian(x, dfdx, t) writing the Jacobian as
+ *a SquareMatrix<StateSize>, see PendulumSystem::jacobian.
+ * @param[in,out] dxdtx The derivative of the system at x and t, must be filled
+ *before the first step and is updated along with x.
+ * @param[in,out] controller The step size controller, see
+ *ElementaryStepController. The overload without it uses the elementary
+ *controller.
+ *
+ * Other parameters and the return value are the same as cashKarp54.
+ */
+template <typename SystemType, std::size_t StateSize, typename Controller>
+inline int rosenbrock23(SystemType &&dxdt, std::array<double, StateSize> &x,
+                        std::array<double, StateSize> &dxdtx, double &t,
+                        double &h, double relTol, double absTol,
+                        double maxStepSize, Controller &controller) {
+  using StateType = std::array<double, StateSize>;
+  // d = 1 / (2 + sqrt(2)) and e32 = 6 + sqrt(2)
+  const double d = 0.29289321881345247560;
+  const double e32 = 7.41421356237309504880;
+
+  SquareMatrix<StateSize> w;
+  dxdt.jacobian(x, w, t);
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    for (std::size_t j = 0; j < StateSize; ++j) {
+      w[i][j] = (i == j ? 1.0 : 0.0) - h * d * w[i][j];
+    }
+  }
+
+  std::array<std::size_t, StateSize> pivot;
+  if (!luDecompose(w, pivot)) {
+    // only possible for a step size far too large, retry with a smaller one
+    h *= 0.5;
+    return 0;
+  }
+
+  StateType k1 = dxdtx;
+  luSolve(w, pivot, k1);
+
+  StateType tempState;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    tempState[i] = x[i] + 0.5 * h * k1[i];
+  }
+  StateType f1;
+  dxdt(tempState, f1, t + 0.5 * h);
+
+  StateType k2;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    k2[i] = f1[i] - k1[i];
+  }
+  luSolve(w, pivot, k2);
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    k2[i] += k1[i];
+  }
+
+  StateType potentialSolution;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    potentialSolution[i] = x[i] + h * k2[i];
+  }
+  StateType f2;
+  dxdt(potentialSolution, f2, t + h);
+
+  StateType k3;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    k3[i] = f2[i] - e32 * (k2[i] - f1[i]) - 2.0 * (k1[i] - dxdtx[i]);
+  }
+  luSolve(w, pivot, k3);
+
+  // boost odeint syle error step sizing method
+  double maxErrorValue = 0.0;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    const double errorEstimate = h / 6.0 * (k1[i] - 2.0 * k2[i] + k3[i]);
+    maxErrorValue = std::max(
+        maxErrorValue,
+        std::abs(errorEstimate / (absTol + relTol * potentialSolution[i])));
+  }
+
+  if (maxErrorValue > 1.0) {
+    h = controller.template rejected<Rosenbrock23Method>(h, maxErrorValue);
+    return 0;
+  }
+
+  t += h;
+  x = potentialSolution;
+  dxdtx = f2;
+  h = controller.template accepted<Rosenbrock23Method>(h, maxErrorValue,
+                                                       maxStepSize);
+  return 1;
+}
+
+template <typename SystemType, std::size_t StateSize>
+inline int rosenbrock23(SystemType &&dxdt, std::array<double, StateSize> &x,
+                        std::array<double, StateSize> &dxdtx, double &t,
+                        double &h, double relTol, double absTol,
+                        double maxStepSize) {
+  ElementaryStepController controller;
+  return rosenbrock23(dxdt, x, dxdtx, t, h, relTol, absTol, maxStepSize,
+                      controller);
+}
+} // namespace staticpendulum
+#endif // ROSENBROCK23_H
@@ -0,0 +1,174 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef STEPSIZECONTROLLER_H
+#define STEPSIZECONTROLLER_H
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace staticpendulum {
+/*!
+ * @brief Elementary step size controller, the new step size only depends on
+ *the error of the current step.
+ *
+ * A step size controller is asked for the next step size after every attempt
+ *of explicitRungeKutta through rejected<Tableau>(h, error) or
+ *accepted<Tableau>(h, error, maxStepSize), where error is the scaled max norm
+ *of the error estimate (the step is accepted if it is not above 1). A
+ *controller may keep state between steps, so one is needed per integrated
+ *point.
+ */
+struct ElementaryStepController {
+  template <typename Tableau> double rejected(double h, double error) const {
+    return h * std::max(0.9 * std::pow(error, -1.0 / Tableau::errorOrder), 0.2);
+  }
+
+  template <typename Tableau>
+  double accepted(double h, double error, double maxStepSize) const {
+    // only increase the step size if the error is small enough
+    if (error < 0.5) {
+      return std::min(
+          h * std::min(0.9 * std::pow(error, -1.0 / Tableau::order), 5.0),
+          maxStepSize);
+    }
+
+    return h;
+  }
+};
+
+/*!
+ * @brief Proportional integral (PI) step size controller, remembers the error
+ *of the previous accepted step to smooth the step size sequence.
+ *
+ * Accepted steps use h * 0.9 * error^(-0.85 / k) * previousError^(0.2 / k),
+ *with k one more than the error order of the tableau, and the step size is
+ *not increased right after a rejected step. For k = 5 these are the gains of
+ *Hairer's DOPRI5 code (error^-0.17 * previousError^0.04), the other tableaus
+ *use the same gains scaled by their k. DOP853 itself defaults to an
+ *elementary controller. This avoids the grow then reject oscillation of the elementary
+ *controller when the error changes quickly (e.g. close to an attractor).
+ *Rejected steps are shrunk the same way as by ElementaryStepController.
+ *
+ * See: K. Gustafsson. "Control theoretic techniques for stepsize selection in
+ *explicit Runge-Kutta methods." ACM Transactions on Mathematical Software,
+ *Vol. 17, No. 4, 1991.
+ *
+ * And: E. Hairer, S. P. Norsett, G. Wanner. "Solving Ordinary Differential
+ *Equations I. Nonstiff Problems." 2nd edition, Springer, 1993, section II.4.
+ */
+class ProportionalIntegralStepController {
+public:
+  template <typename Tableau> double rejected(double h, double error) {
+    m_rejectedLast = true;
+    return h * std::max(0.9 * std::pow(error, -1.0 / Tableau::errorOrder), 0.2);
+  }
+
+  template <typename Tableau>
+  double accepted(double h, double error, double maxStepSize) {
+    const double k = Tableau::errorOrder + 1;
+    double factor = 0.9 * std::pow(error, -0.85 / k) *
+                    std::pow(m_previousError, 0.2 / k);
+    factor = std::min(std::max(factor, 0.2), m_rejectedLast ? 1.0 : 5.0);
+
+    // lower bound avoids an overly large increase after a near exact step
+    m_previousError = std::max(error, 1e-4);
+    m_rejectedLast = false;
+    return std::min(h * factor, maxStepSize);
+  }
+
+private:
+  double m_previousError = 1.0;
+  bool m_rejectedLast = false;
+};
+
+/*!
+ * @brief Estimates a starting step size for an explicit Runge Kutta method
+ *from the state and derivative at the start, using one extra evaluation of
+ *the system.
+ *
+ * Follows the initial step size selection of Hairer's DOPRI5 and DOP853 codes
+ *(using the max norm like the step error): the step is chosen so that an
+ *explicit Euler step would have a local error around 0.01 of the tolerance,
+ *then refined from an estimate of the second derivative.
+ *
+ * See: E. Hairer, S. P. Norsett, G. Wanner. "Solving Ordinary Differential
+ *Equations I. Nonstiff Problems." 2nd edition, Springer, 1993, section II.4.
+ * @tparam Tableau The Butcher tableau type of the method, see
+ *explicitRungeKutta.
+ * @param[in] dxdt The system being integrated as a callable object.
+ * @param[in] x The state at the start.
+ * @param[in] dxdtx The derivative of the system at x and t.
+ * @param[in] t The time at the start.
+ * @param[in] relTol The relative tolerance of the integration.
+ * @param[in] absTol The absolute tolerance of the integration.
+ * @param[in] maxStepSize The maximum step size allowed.
+ * @return The estimated starting step size.
+ */
+template <typename Tableau, typename SystemType, std::size_t StateSize>
+inline double initialStepSize(SystemType &&dxdt,
+                              const std::array<double, StateSize> &x,
+                              const std::array<double, StateSize> &dxdtx,
+                              double t, double relTol, double absTol,
+                              double maxStepSize) {
+  std::array<double, StateSize> scale;
+  double stateNorm = 0.0;
+  double derivativeNorm = 0.0;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    scale[i] = absTol + relTol * std::abs(x[i]);
+    stateNorm = std::max(stateNorm, std::abs(x[i]) / scale[i]);
+    derivativeNorm = std::max(derivativeNorm, std::abs(dxdtx[i]) / scale[i]);
+  }
+
+  // first guess from an explicit Euler step
+  double firstGuess = (stateNorm < 1e-5 || derivativeNorm < 1e-5)
+                          ? 1e-6
+                          : 0.01 * stateNorm / derivativeNorm;
+  firstGuess = std::min(firstGuess, maxStepSize);
+
+  std::array<double, StateSize> eulerState;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    eulerState[i] = x[i] + firstGuess * dxdtx[i];
+  }
+  std::array<double, StateSize> eulerDerivative;
+  dxdt(eulerState, eulerDerivative, t + firstGuess);
+
+  // estimate of the second derivative
+  double secondDerivativeNorm = 0.0;
+  for (std::size_t i = 0; i < StateSize; ++i) {
+    secondDerivativeNorm =
+        std::max(secondDerivativeNorm,
+                 std::abs(eulerDerivative[i] - dxdtx[i]) / scale[i]);
+  }
+  secondDerivativeNorm /= firstGuess;
+
+  const double largestNorm = std::max(derivativeNorm, secondDerivativeNorm);
+  const double secondGuess =
+      largestNorm <= 1e-15
+          ? std::max(1e-6, firstGuess * 1e-3)
+          : std::pow(0.01 / largestNorm, 1.0 / Tableau::order);
+
+  return std::min({100.0 * firstGuess, secondGuess, maxStepSize});
+}
+} // namespace staticpendulum
+#endif // STEPSIZECONTROLLER_H
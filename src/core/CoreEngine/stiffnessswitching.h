@@ -0,0 +1,200 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef STIFFNESSSWITCHING_H
+#define STIFFNESSSWITCHING_H
+#include "explicitrungekutta.h"
+#include "rosenbrock23.h"
+#include "stepsizecontroller.h"
+#include <array>
+#include <cmath>
+
+namespace staticpendulum {
+/*!
+ * @brief Estimates the spectral radius of a matrix as ||a^32||^(1/32) using the
+ *infinity norm.
+ *
+ * This is an upper bound that converges to the spectral radius as the power
+ *grows, it works for complex eigenvalues (unlike the power iteration) and costs
+ *five matrix products. Intermediate powers are rescaled so large entries do
+ *not overflow.
+ */
+template <std::size_t N>
+inline double spectralRadiusEstimate(const SquareMatrix<N> &a) {
+  constexpr int squaringCount = 5;
+  SquareMatrix<N> power = a;
+  double logScale = 0.0;
+  for (int iteration = 0; iteration < squaringCount; ++iteration) {
+    double norm = 0.0;
+    for (const auto &row : power) {
+      double rowSum = 0.0;
+      for (double value : row) {
+        rowSum += std::abs(value);
+      }
+      norm = std::max(norm, rowSum);
+    }
+
+    if (norm == 0.0)
+      return 0.0;
+
+    SquareMatrix<N> squared;
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        double sum = 0.0;
+        for (std::size_t k = 0; k < N; ++k) {
+          sum += power[i][k] * power[k][j];
+        }
+        squared[i][j] = sum / (norm * norm);
+      }
+    }
+    power = squared;
+    logScale = 2.0 * (logScale + std::log(norm));
+  }
+
+  double norm = 0.0;
+  for (const auto &row : power) {
+    double rowSum = 0.0;
+    for (double value : row) {
+      rowSum += std::abs(value);
+    }
+    norm = std::max(norm, rowSum);
+  }
+
+  if (norm == 0.0)
+    return 0.0;
+
+  return std::exp((std::log(norm) + logScale) / (1 << squaringCount));
+}
+
+/*!
+ * @brief Scalar integrator that switches a trajectory between an explicit
+ *Runge Kutta method and the implicit rosenbrock23 depending on stiffness.
+ *
+ * Every few accepted steps the stiffness ratio h * rho(J) is computed from the
+ *analytic Jacobian J of the system at the current state, where rho is
+ *estimated by spectralRadiusEstimate. While integrating explicitly a ratio
+ *close to the stability boundary of the tableau means the step size is limited
+ *by stability rather than accuracy, so after several such checks in a row the
+ *trajectory switches to rosenbrock23. While integrating implicitly a ratio
+ *well inside the stability region means the explicit method could take the
+ *same step, so after several such checks in a row it switches back. The
+ *derivative at the current state is carried over and each method gets a fresh
+ *step size controller when switching to it.
+ *
+ * Callable as integrator(dxdt, x, t, h) like the integrators passed to
+ *integratePoint, and like those it must be copied for every point since it
+ *keeps the state of the trajectory.
+ * @tparam Tableau The explicit method, the tableau must provide
+ *stabilityBoundary (the stability boundary on the negative real axis).
+ * @tparam StateSize The length of the std::array holding the state.
+ * @tparam Controller The step size controller type used by both methods.
+ */
+template <typename Tableau, std::size_t StateSize,
+          typename Controller = ElementaryStepController>
+class StiffnessSwitchingIntegrator {
+public:
+  /// Number of accepted steps between stiffness checks.
+  static constexpr int checkInterval = 10;
+  /// Number of consecutive checks in agreement before switching method.
+  static constexpr int switchCheckCount = 2;
+  /// Stiffness ratio, relative to the stability boundary, above which the
+  /// explicit method is considered stability limited.
+  static constexpr double stiffRatio = 0.75;
+  /// Stiffness ratio, relative to the stability boundary, below which the
+  /// explicit method can take the implicit step size.
+  static constexpr double nonStiffRatio = 0.5;
+
+  /*!
+   * @param[in] relTol The relative tolerance allowed.
+   * @param[in] absTol The absolute tolerance allowed.
+   * @param[in] maxStepSize The maximum step size allowed.
+   */
+  StiffnessSwitchingIntegrator(double relTol, double absTol,
+                               double maxStepSize)
+      : m_relTol(relTol), m_absTol(absTol), m_maxStepSize(maxStepSize) {}
+
+  /// Performs one step attempt, returns 1 if the step was accepted and 0 if it
+  /// was rejected (see explicitRungeKutta).
+  template <typename SystemType>
+  int operator()(SystemType &&dxdt, std::array<double, StateSize> &x,
+                 double &t, double &h) {
+    if (!m_hasDerivative) {
+      dxdt(x, m_derivative, t);
+      m_hasDerivative = true;
+    }
+
+    const double stepSize = h;
+    const int accepted =
+        m_isStiff ? rosenbrock23(dxdt, x, m_derivative, t, h, m_relTol,
+                                 m_absTol, m_maxStepSize, m_controller)
+                  : explicitRungeKutta<Tableau>(dxdt, x, m_derivative, t, h,
+                                                m_relTol, m_absTol,
+                                                m_maxStepSize, m_controller);
+
+    if (accepted && ++m_acceptedSinceCheck == checkInterval) {
+      m_acceptedSinceCheck = 0;
+      checkStiffness(dxdt, x, t, stepSize);
+    }
+
+    return accepted;
+  }
+
+  /// True while the trajectory is integrated with rosenbrock23.
+  bool isStiff() const { return m_isStiff; }
+
+  /// Number of times the trajectory switched between the methods.
+  int switchCount() const { return m_switchCount; }
+
+private:
+  template <typename SystemType>
+  void checkStiffness(SystemType &&dxdt, const std::array<double, StateSize> &x,
+                      double t, double stepSize) {
+    SquareMatrix<StateSize> dfdx;
+    dxdt.jacobian(x, dfdx, t);
+    const double stiffness =
+        stepSize * spectralRadiusEstimate(dfdx) / Tableau::stabilityBoundary;
+
+    const bool switchIndicated =
+        m_isStiff ? stiffness < nonStiffRatio : stiffness > stiffRatio;
+    m_indicatedCount = switchIndicated ? m_indicatedCount + 1 : 0;
+    if (m_indicatedCount == switchCheckCount) {
+      m_isStiff = !m_isStiff;
+      m_indicatedCount = 0;
+      m_controller = Controller();
+      ++m_switchCount;
+    }
+  }
+
+  double m_relTol;
+  double m_absTol;
+  double m_maxStepSize;
+  std::array<double, StateSize> m_derivative;
+  bool m_hasDerivative = false;
+  bool m_isStiff = false;
+  int m_acceptedSinceCheck = 0;
+  int m_indicatedCount = 0;
+  int m_switchCount = 0;
+  Controller m_controller;
+};
+} // namespace staticpendulum
+#endif // STIFFNESSSWITCHING_H
@@ -0,0 +1,143 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "supersampling.h"
+#include <algorithm>
+
+namespace staticpendulum {
+bool isBasinBoundary(const Map &map, std::size_t row, std::size_t column) {
+  const int position = map.convergePosition(row * map.cols() + column);
+  const std::size_t firstRow = row == 0 ? 0 : row - 1;
+  const std::size_t lastRow = std::min(row + 2, map.rows());
+  const std::size_t firstColumn = column == 0 ? 0 : column - 1;
+  const std::size_t lastColumn = std::min(column + 2, map.cols());
+  for (std::size_t r = firstRow; r < lastRow; ++r) {
+    for (std::size_t c = firstColumn; c < lastColumn; ++c) {
+      if (map.convergePosition(r * map.cols() + c) != position)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+BoundarySupersamples::BoundarySupersamples(const Map &map,
+                                           std::size_t sampleCount)
+    : m_sampleCount(std::min(std::max<std::size_t>(sampleCount, 1),
+                             maximumSupersampleCount)) {
+  for (std::size_t row = 0; row < map.rows(); ++row) {
+    for (std::size_t column = 0; column < map.cols(); ++column) {
+      if (isBasinBoundary(map, row, column))
+        m_pointIndices.push_back(row * map.cols() + column);
+    }
+  }
+
+  m_fates.resize(m_pointIndices.size());
+}
+
+void BoundarySupersamples::makeSamples(const Map &map, std::size_t i,
+                                       std::vector<Point> &samples) const {
+  // subsamples at the centers of a sampleCount x sampleCount grid over the
+  // pixel, in the map row order (y going down)
+  const double step = map.resolution() / m_sampleCount;
+  const double firstOffset = 0.5 * (step - map.resolution());
+  const Point point = map.point(m_pointIndices[i]);
+  samples.assign(m_sampleCount * m_sampleCount, Point());
+  auto sample = samples.begin();
+  for (std::size_t row = 0; row < m_sampleCount; ++row) {
+    for (std::size_t column = 0; column < m_sampleCount; ++column) {
+      sample->xPosition = point.xPosition + firstOffset + column * step;
+      sample->yPosition = point.yPosition - firstOffset - row * step;
+      sample->xVelocity = point.xVelocity;
+      sample->yVelocity = point.yVelocity;
+      ++sample;
+    }
+  }
+}
+
+void BoundarySupersamples::countFates(std::size_t i, PointIterator first,
+                                      PointIterator last) {
+  PointFates &pointFates = m_fates[i];
+  for (auto sample = first; sample != last; ++sample) {
+    const auto position =
+        static_cast<std::int16_t>(sample->convergePosition);
+    if (pointFates.moreFates) {
+      auto &fates = *pointFates.moreFates;
+      auto fate = std::find_if(fates.begin(), fates.end(),
+                               [position](const SubsampleFate &f) {
+                                 return f.position == position;
+                               });
+      if (fate == fates.end())
+        fates.push_back({position, 1});
+      else
+        ++fate->count;
+      continue;
+    }
+
+    auto fate = std::find_if(pointFates.fates.begin(), pointFates.fates.end(),
+                             [position](const SubsampleFate &f) {
+                               return f.count == 0 || f.position == position;
+                             });
+    if (fate == pointFates.fates.end()) {
+      // a third basin, all the fates of the point move to moreFates
+      pointFates.moreFates.reset(new std::vector<SubsampleFate>(
+          pointFates.fates.begin(), pointFates.fates.end()));
+      pointFates.moreFates->push_back({position, 1});
+    } else {
+      fate->position = position;
+      ++fate->count;
+    }
+  }
+}
+
+const SubsampleFate *BoundarySupersamples::fatesBegin(std::size_t i) const {
+  const PointFates &pointFates = m_fates[i];
+  return pointFates.moreFates ? pointFates.moreFates->data()
+                              : pointFates.fates.data();
+}
+
+const SubsampleFate *BoundarySupersamples::fatesEnd(std::size_t i) const {
+  const PointFates &pointFates = m_fates[i];
+  if (pointFates.moreFates)
+    return pointFates.moreFates->data() + pointFates.moreFates->size();
+
+  // unused inline fates have no subsamples
+  const SubsampleFate *end = pointFates.fates.data();
+  while (end != pointFates.fates.data() + pointFates.fates.size() &&
+         end->count != 0)
+    ++end;
+  return end;
+}
+
+std::vector<Tile> BoundarySupersamples::tiles() const {
+  std::vector<Tile> result;
+  for (std::size_t first = 0; first < pointCount();
+       first += supersampleTilePointCount) {
+    result.push_back(
+        {first, std::min(first + supersampleTilePointCount, pointCount()), 0,
+         m_sampleCount * m_sampleCount});
+  }
+
+  return result;
+}
+} // namespace staticpendulum
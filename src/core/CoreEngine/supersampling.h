@@ -0,0 +1,113 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef SUPERSAMPLING_H
+#define SUPERSAMPLING_H
+#include "pendulummapintegrator.h"
+#include "tilescheduler.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace staticpendulum {
+/// Largest number of subsamples per side of a supersampled point.
+constexpr std::size_t maximumSupersampleCount = 8;
+
+/// Number of boundary points per tile when integrating the subsamples.
+constexpr std::size_t supersampleTilePointCount = 16;
+
+/// Returns true if any of the 8 neighbours of the point at row, column of the
+/// integrated map has a different convergePosition.
+bool isBasinBoundary(const Map &map, std::size_t row, std::size_t column);
+
+/// Number of the subsamples of a boundary point that converged to position.
+struct SubsampleFate {
+  std::int16_t position;
+  std::uint16_t count;
+};
+
+/*!
+ * @brief Subsamples of the points of an integrated map that lie on a boundary
+ *between basins (see isBasinBoundary).
+ *
+ * Every boundary point gets sampleCount x sampleCount subsamples evenly spread
+ *over its pixel, the image blends the colors of the subsamples for an anti
+ *aliased boundary. Only the boundary points are resampled, so the cost is a
+ *fraction of a uniformly finer map.
+ *
+ * The subsamples are laid out as a map of their own for the TileScheduler:
+ *row i holds the subsamples of the i-th boundary point. They are generated
+ *into a scratch buffer by makeSamples when their row is integrated and only
+ *the counts of their converge positions are kept (see countFates), about 24
+ *bytes per boundary point instead of sampleCount^2 Points.
+ */
+class BoundarySupersamples {
+public:
+  /// Default constructor no subsamples.
+  BoundarySupersamples() {}
+
+  /// Finds the boundary points of the integrated map, sampleCount is clamped
+  /// to maximumSupersampleCount.
+  BoundarySupersamples(const Map &map, std::size_t sampleCount);
+
+  /// Number of subsamples per side of a point.
+  std::size_t sampleCount() const { return m_sampleCount; }
+  /// Number of boundary points.
+  std::size_t pointCount() const { return m_pointIndices.size(); }
+  /// Index of the i-th boundary point in the map.
+  std::size_t pointIndex(std::size_t i) const { return m_pointIndices[i]; }
+
+  /// Sets samples to the not yet integrated subsamples of the i-th boundary
+  /// point, map is the map the boundary points were found on.
+  void makeSamples(const Map &map, std::size_t i,
+                   std::vector<Point> &samples) const;
+
+  /// Adds the converge positions of the integrated subsamples [first, last)
+  /// of the i-th boundary point to its fates. Different points may be counted
+  /// from different threads at the same time.
+  void countFates(std::size_t i, PointIterator first, PointIterator last);
+
+  /// Fates of the subsamples of the i-th boundary point counted so far.
+  const SubsampleFate *fatesBegin(std::size_t i) const;
+  const SubsampleFate *fatesEnd(std::size_t i) const;
+
+  /// Tiles of supersampleTilePointCount boundary points, rows are boundary
+  /// points and columns their subsamples.
+  std::vector<Tile> tiles() const;
+
+private:
+  /// Fates of a boundary point, the (at most) two basins a boundary pixel
+  /// covers most of the time are kept inline, the rest spill to moreFates.
+  struct PointFates {
+    std::array<SubsampleFate, 2> fates = {};
+    std::unique_ptr<std::vector<SubsampleFate>> moreFates;
+  };
+
+  std::size_t m_sampleCount = 0;
+  std::vector<std::size_t> m_pointIndices;
+  std::vector<PointFates> m_fates;
+};
+} // namespace staticpendulum
+#endif // SUPERSAMPLING_H
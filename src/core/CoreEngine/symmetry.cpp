@@ -0,0 +1,199 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "symmetry.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace staticpendulum {
+namespace {
+// completes the attractor images of the candidate, returns false if some
+// attractor does not map onto an attractor
+bool mapsAttractors(const std::vector<PendulumSystem::Attractor> &attractors,
+                    double positionTolerance, SystemSymmetry &candidate) {
+  candidate.attractorImages.clear();
+  for (const auto &attractor : attractors) {
+    const double x = candidate.xx * attractor.xPosition +
+                     candidate.xy * attractor.yPosition;
+    const double y = candidate.yx * attractor.xPosition +
+                     candidate.yy * attractor.yPosition;
+    const double coeffTolerance =
+        symmetryTolerance * std::max(1.0, std::abs(attractor.forceCoeff));
+    const auto image = std::find_if(
+        attractors.begin(), attractors.end(), [&](const auto &other) {
+          return std::abs(other.xPosition - x) < positionTolerance &&
+                 std::abs(other.yPosition - y) < positionTolerance &&
+                 std::abs(other.forceCoeff - attractor.forceCoeff) <
+                     coeffTolerance;
+        });
+    if (image == attractors.end())
+      return false;
+
+    candidate.attractorImages.push_back(
+        static_cast<int>(image - attractors.begin()));
+  }
+
+  return true;
+}
+
+SystemSymmetry rotation(double angle) {
+  return {std::cos(angle), -std::sin(angle), std::sin(angle), std::cos(angle),
+          {}};
+}
+
+// reflection about the line through the origin at the angle
+SystemSymmetry reflection(double angle) {
+  return {std::cos(2.0 * angle), std::sin(2.0 * angle), std::sin(2.0 * angle),
+          -std::cos(2.0 * angle), {}};
+}
+} // namespace
+
+std::vector<SystemSymmetry> findSymmetries(const PendulumSystem &sys) {
+  const auto &attractors = sys.attractorList;
+  double scale = 1.0;
+  for (const auto &attractor : attractors) {
+    scale = std::max(scale, std::hypot(attractor.xPosition,
+                                       attractor.yPosition));
+  }
+  const double positionTolerance = symmetryTolerance * scale;
+
+  const auto reference = std::find_if(
+      attractors.begin(), attractors.end(), [&](const auto &attractor) {
+        return std::hypot(attractor.xPosition, attractor.yPosition) >
+               positionTolerance;
+      });
+
+  std::vector<SystemSymmetry> candidates;
+  if (reference == attractors.end()) {
+    const double quarterTurn = 0.5 * std::acos(-1.0);
+    for (int i = 1; i < 4; ++i) {
+      candidates.push_back(rotation(i * quarterTurn));
+    }
+    for (int i = 0; i < 4; ++i) {
+      candidates.push_back(reflection(0.5 * i * quarterTurn));
+    }
+  } else {
+    const double referenceAngle =
+        std::atan2(reference->yPosition, reference->xPosition);
+    const double referenceRadius =
+        std::hypot(reference->xPosition, reference->yPosition);
+    for (auto other = attractors.begin(); other != attractors.end();
+         ++other) {
+      if (std::abs(std::hypot(other->xPosition, other->yPosition) -
+                   referenceRadius) > positionTolerance)
+        continue;
+
+      const double angle = std::atan2(other->yPosition, other->xPosition);
+      if (other != reference)
+        candidates.push_back(rotation(angle - referenceAngle));
+
+      candidates.push_back(reflection(0.5 * (angle + referenceAngle)));
+    }
+  }
+
+  std::vector<SystemSymmetry> symmetries;
+  for (auto &candidate : candidates) {
+    if (mapsAttractors(attractors, positionTolerance, candidate))
+      symmetries.push_back(std::move(candidate));
+  }
+
+  return symmetries;
+}
+
+SymmetryFill::SymmetryFill(const Map &map,
+                           std::vector<SystemSymmetry> symmetries)
+    : m_symmetries(std::move(symmetries)) {
+  if (map.begin() == map.end())
+    return;
+
+  const double xFirst = map.begin()->xPosition;
+  const double yFirst = map.begin()->yPosition;
+  const double resolution = map.resolution();
+  // index of the map point at (x, y), or the point count if there is none
+  const std::size_t pointCount = map.rows() * map.cols();
+  auto pointIndex = [&](double x, double y) {
+    // rows go down in y from the first point, see Map
+    const double column = (x - xFirst) / resolution;
+    const double row = (yFirst - y) / resolution;
+    const double roundedColumn = std::round(column);
+    const double roundedRow = std::round(row);
+    if (std::abs(column - roundedColumn) > 1e3 * symmetryTolerance ||
+        std::abs(row - roundedRow) > 1e3 * symmetryTolerance ||
+        roundedColumn < 0.0 || roundedRow < 0.0 ||
+        roundedColumn >= static_cast<double>(map.cols()) ||
+        roundedRow >= static_cast<double>(map.rows()))
+      return pointCount;
+
+    return static_cast<std::size_t>(roundedRow) * map.cols() +
+           static_cast<std::size_t>(roundedColumn);
+  };
+
+  std::size_t index = 0;
+  for (const auto &point : map) {
+    FilledPoint filledPoint = {index, index, 0};
+    for (std::size_t i = 0; i < m_symmetries.size(); ++i) {
+      const auto &symmetry = m_symmetries[i];
+      const std::size_t imageIndex = pointIndex(
+          symmetry.xx * point.xPosition + symmetry.xy * point.yPosition,
+          symmetry.yx * point.xPosition + symmetry.yy * point.yPosition);
+      if (imageIndex < filledPoint.sourceIndex) {
+        filledPoint.sourceIndex = imageIndex;
+        filledPoint.symmetryIndex = i;
+      }
+    }
+
+    if (filledPoint.sourceIndex == index)
+      m_integratedPointIndices.push_back(index);
+    else
+      m_filledPoints.push_back(filledPoint);
+
+    ++index;
+  }
+}
+
+void SymmetryFill::fill(Map &map) const {
+  // the source is the image of the filled point, so the filled point
+  // converges to the attractor mapping onto the attractor of the source
+  std::vector<std::vector<int>> inverseImages;
+  for (const auto &symmetry : m_symmetries) {
+    std::vector<int> inverse(symmetry.attractorImages.size());
+    for (std::size_t i = 0; i < inverse.size(); ++i) {
+      inverse[symmetry.attractorImages[i]] = static_cast<int>(i);
+    }
+    inverseImages.push_back(std::move(inverse));
+  }
+
+  for (const auto &filledPoint : m_filledPoints) {
+    const Point source = map.point(filledPoint.sourceIndex);
+    auto point = map.point(filledPoint.index);
+    point.convergeTime = source.convergeTime;
+    point.stepCount = source.stepCount;
+    point.convergePosition =
+        source.convergePosition < 0
+            ? source.convergePosition
+            : inverseImages[filledPoint.symmetryIndex]
+                           [source.convergePosition];
+  }
+}
+} // namespace staticpendulum
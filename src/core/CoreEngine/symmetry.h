@@ -0,0 +1,100 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+#include "pendulummapintegrator.h"
+#include "pendulumsystem.h"
+#include <cstddef>
+#include <vector>
+
+namespace staticpendulum {
+/// Relative tolerance of matching attractor positions and force coefficients,
+/// and of matching symmetric images to map points.
+constexpr double symmetryTolerance = 1e-9;
+
+/// Rotation or reflection about the pendulum pivot (the origin) mapping every
+/// attractor of a system onto an attractor with the same force coefficient.
+struct SystemSymmetry {
+  /// Orthogonal matrix, (x, y) maps to (xx * x + xy * y, yx * x + yy * y).
+  double xx;
+  double xy;
+  double yx;
+  double yy;
+  /// Attractor i maps onto attractor attractorImages[i].
+  std::vector<int> attractorImages;
+};
+
+/*!
+ * @brief Returns the symmetries of the attractor set of the system, not
+ *including the identity.
+ *
+ * Gravity, drag and the pendulum length are symmetric about the pivot, so the
+ *image of a point under a symmetry converges at the same time as the point to
+ *the image of its attractor. Candidates map the first attractor off the pivot
+ *onto every attractor of the same distance and force coefficient, without
+ *such an attractor the symmetries of the square are tried.
+ */
+std::vector<SystemSymmetry> findSymmetries(const PendulumSystem &sys);
+
+/*!
+ * @brief Splits the points of a map into the points to integrate and the
+ *points filled from a symmetric image.
+ *
+ * Of all the images of a point under the symmetries that are themselves map
+ *points only the one first in the map is integrated, the other ones are
+ *filled from it with fill. Images falling between map points are not used
+ *(interpolating them is not exact), such points are integrated. So only
+ *symmetries mapping the grid onto itself save work: rotations by multiples of
+ *90 degrees and reflections about the axes and diagonals, over a window
+ *symmetric about the pivot.
+ */
+class SymmetryFill {
+public:
+  SymmetryFill(const Map &map, std::vector<SystemSymmetry> symmetries);
+
+  /// Number of symmetries, not including the identity.
+  std::size_t symmetryCount() const { return m_symmetries.size(); }
+  /// Indices of the points to integrate in map order.
+  const std::vector<std::size_t> &integratedPointIndices() const {
+    return m_integratedPointIndices;
+  }
+  std::size_t filledPointCount() const { return m_filledPoints.size(); }
+
+  /// Fills the remaining points of the map once the points at
+  /// integratedPointIndices are integrated.
+  void fill(Map &map) const;
+
+private:
+  struct FilledPoint {
+    std::size_t index;
+    std::size_t sourceIndex;
+    std::size_t symmetryIndex;
+  };
+
+  std::vector<SystemSymmetry> m_symmetries;
+  std::vector<std::size_t> m_integratedPointIndices;
+  std::vector<FilledPoint> m_filledPoints;
+};
+} // namespace staticpendulum
+#endif // SYMMETRY_H
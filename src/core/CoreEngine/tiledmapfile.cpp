@@ -0,0 +1,175 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "tiledmapfile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace staticpendulum {
+namespace {
+const std::array<char, 8> tiledMapMagic = {{'S', 'P', 'M', 'A', 'P', 'T', '0',
+                                            '1'}};
+
+// bytes per point of a tile: converge time, step count and converge position
+constexpr std::uint64_t tilePointBytes =
+    sizeof(float) + sizeof(std::uint32_t) + sizeof(std::int16_t);
+} // namespace
+
+constexpr std::size_t TiledMapFile::tileSizeMultiple;
+
+std::size_t TiledMapFile::tileSizeForBudget(std::uint64_t memoryBudget) {
+  // the tile Map and the mapped tile pages are resident together
+  const double pointCount =
+      static_cast<double>(memoryBudget) / (2.0 * tilePointBytes);
+  const std::size_t tileSize =
+      static_cast<std::size_t>(std::sqrt(pointCount)) / tileSizeMultiple *
+      tileSizeMultiple;
+  return std::max(tileSize, tileSizeMultiple);
+}
+
+bool TiledMapFile::create(const std::string &path, double xStart,
+                          double yStart, double xEnd, double yEnd,
+                          double resolution, std::size_t tileSize) {
+  // same point grid as Map
+  m_header.magic = tiledMapMagic;
+  m_header.cols = std::lround(std::abs((xEnd - xStart) / resolution)) + 1;
+  m_header.rows = std::lround(std::abs((yEnd - yStart) / resolution)) + 1;
+  m_header.tileSize =
+      std::max<std::size_t>(tileSize / tileSizeMultiple, 1) * tileSizeMultiple;
+  m_header.xFactor = std::lround(xStart / resolution);
+  m_header.yFactor = std::lround(yStart / resolution);
+  m_header.resolution = resolution;
+
+  if (!m_file.create(path, tileOffset(tileCount()))) {
+    m_errorString = m_file.errorString();
+    return false;
+  }
+
+  std::memcpy(m_file.data(), &m_header, sizeof(Header));
+  m_file.flushAndEvict(0, sizeof(Header));
+  return true;
+}
+
+bool TiledMapFile::open(const std::string &path) {
+  if (!m_file.open(path)) {
+    m_errorString = m_file.errorString();
+    return false;
+  }
+
+  if (m_file.size() >= sizeof(Header))
+    std::memcpy(&m_header, m_file.data(), sizeof(Header));
+  if (m_file.size() < sizeof(Header) || m_header.magic != tiledMapMagic ||
+      m_header.tileSize == 0 || m_file.size() < tileOffset(tileCount())) {
+    m_errorString = path + " is not a tiled map file";
+    m_header = {};
+    m_file.close();
+    return false;
+  }
+
+  return true;
+}
+
+Map TiledMapFile::tileMap(std::size_t tile) const {
+  const std::size_t firstRow = tile / tileColumnCount() * tileSize();
+  const std::size_t firstColumn = tile % tileColumnCount() * tileSize();
+  const std::size_t lastRow = std::min(firstRow + tileSize(), rows());
+  const std::size_t lastColumn = std::min(firstColumn + tileSize(), cols());
+
+  // integer multiples of the resolution give the points of the whole map
+  const double resolution = m_header.resolution;
+  auto coordinate = [resolution](std::int64_t factor, std::size_t offset) {
+    return static_cast<double>(factor + static_cast<std::int64_t>(offset)) *
+           resolution;
+  };
+  return Map(coordinate(m_header.xFactor, firstColumn),
+             coordinate(m_header.yFactor, firstRow),
+             coordinate(m_header.xFactor, lastColumn - 1),
+             coordinate(m_header.yFactor, lastRow - 1), resolution);
+}
+
+void TiledMapFile::writeTile(std::size_t tile, const Map &theTileMap) {
+  const std::uint64_t pointCount = tileSize() * tileSize();
+  char *tileData = m_file.data() + tileOffset(tile);
+  auto convergeTimes = reinterpret_cast<float *>(tileData);
+  auto stepCounts =
+      reinterpret_cast<std::uint32_t *>(tileData + 4 * pointCount);
+  auto positions = reinterpret_cast<std::int16_t *>(tileData + 8 * pointCount);
+
+  std::size_t index = 0;
+  for (std::size_t row = 0; row < theTileMap.rows(); ++row) {
+    for (std::size_t column = 0; column < theTileMap.cols(); ++column) {
+      const Point point = theTileMap.point(index);
+      const std::size_t tileIndex = row * tileSize() + column;
+      convergeTimes[tileIndex] = static_cast<float>(point.convergeTime);
+      stepCounts[tileIndex] = static_cast<std::uint32_t>(point.stepCount);
+      positions[tileIndex] = static_cast<std::int16_t>(point.convergePosition);
+      ++index;
+    }
+  }
+
+  m_file.flushAndEvict(tileOffset(tile), tileBytes());
+}
+
+const std::int16_t *TiledMapFile::convergePositions(std::size_t tile) const {
+  return reinterpret_cast<const std::int16_t *>(
+      m_file.data() + tileOffset(tile) + 8 * tileSize() * tileSize());
+}
+
+Map TiledMapFile::readTile(std::size_t tile) const {
+  const std::uint64_t pointCount = tileSize() * tileSize();
+  const char *tileData = m_file.data() + tileOffset(tile);
+  auto convergeTimes = reinterpret_cast<const float *>(tileData);
+  auto stepCounts =
+      reinterpret_cast<const std::uint32_t *>(tileData + 4 * pointCount);
+  auto positions = convergePositions(tile);
+
+  Map theTileMap = tileMap(tile);
+  std::size_t index = 0;
+  for (std::size_t row = 0; row < theTileMap.rows(); ++row) {
+    for (std::size_t column = 0; column < theTileMap.cols(); ++column) {
+      const std::size_t tileIndex = row * tileSize() + column;
+      auto point = theTileMap.point(index);
+      point.convergeTime = convergeTimes[tileIndex];
+      point.stepCount = stepCounts[tileIndex];
+      point.convergePosition = positions[tileIndex];
+      ++index;
+    }
+  }
+
+  return theTileMap;
+}
+
+void TiledMapFile::evictTile(std::size_t tile) {
+  m_file.flushAndEvict(tileOffset(tile), tileBytes());
+}
+
+std::uint64_t TiledMapFile::tileBytes() const {
+  return tilePointBytes * tileSize() * tileSize();
+}
+
+std::uint64_t TiledMapFile::tileOffset(std::size_t tile) const {
+  // tiles start after the header on a multiple of 8 bytes
+  return sizeof(Header) + tile * tileBytes();
+}
+} // namespace staticpendulum
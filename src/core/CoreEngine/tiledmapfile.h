@@ -0,0 +1,157 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef TILEDMAPFILE_H
+#define TILEDMAPFILE_H
+#include "mappedfile.h"
+#include "pendulummapintegrator.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace staticpendulum {
+/*!
+ * @brief Disk backed map results for maps too large for memory.
+ *
+ * The file holds a header and square tiles of tileSize x tileSize points in
+ *row major tile order, each tile storing the converge times (float), step
+ *counts (uint32) and converge positions (int16) of its points like Map does.
+ *Edge tiles are padded to the full size. The file is memory mapped, a tile is
+ *integrated as a Map of its own (see tileMap), copied into the file with
+ *writeTile and evicted from memory, so only one tile is resident at a time.
+ */
+class TiledMapFile {
+public:
+  /// Tile sizes are rounded to a multiple of this.
+  static constexpr std::size_t tileSizeMultiple = 32;
+
+  /// Largest tile size whose Map and mapped file pages fit in memoryBudget
+  /// bytes, at least tileSizeMultiple.
+  static std::size_t tileSizeForBudget(std::uint64_t memoryBudget);
+
+  /// Creates the file at path for the map over the ranges and resolution
+  /// given (see Map), returns false and sets errorString on failure.
+  bool create(const std::string &path, double xStart, double yStart,
+              double xEnd, double yEnd, double resolution,
+              std::size_t tileSize);
+  /// Opens a file written by create, returns false and sets errorString on
+  /// failure.
+  bool open(const std::string &path);
+
+  const std::string &errorString() const { return m_errorString; }
+  std::size_t rows() const { return m_header.rows; }
+  std::size_t cols() const { return m_header.cols; }
+  std::size_t tileSize() const { return m_header.tileSize; }
+  std::size_t tileRowCount() const {
+    return (rows() + tileSize() - 1) / tileSize();
+  }
+  std::size_t tileColumnCount() const {
+    return (cols() + tileSize() - 1) / tileSize();
+  }
+  std::size_t tileCount() const { return tileRowCount() * tileColumnCount(); }
+
+  /// Map over the area of the tile, the tiles are numbered row major.
+  Map tileMap(std::size_t tile) const;
+
+  /// Stores the results of the integrated tileMap and evicts the tile.
+  void writeTile(std::size_t tile, const Map &theTileMap);
+
+  /// Converge positions of the tile, row major with a stride of tileSize.
+  const std::int16_t *convergePositions(std::size_t tile) const;
+  /// Reads back the results of the tile into a Map.
+  Map readTile(std::size_t tile) const;
+  /// Drops the pages of the tile from memory.
+  void evictTile(std::size_t tile);
+
+private:
+  struct Header {
+    std::array<char, 8> magic;
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t tileSize;
+    std::int64_t xFactor;
+    std::int64_t yFactor;
+    double resolution;
+  };
+
+  std::uint64_t tileBytes() const;
+  std::uint64_t tileOffset(std::size_t tile) const;
+
+  Header m_header = {};
+  MappedFile m_file;
+  std::string m_errorString;
+};
+
+/*!
+ * @brief Writes the map of the file as a binary portable pixmap (P6) one row at
+ *a time, the full image is never held in memory.
+ * @param[in] color Callable as color(convergePosition) returning the
+ *std::array<std::uint8_t, 3> red, green and blue values of the position.
+ * @return False if the image file could not be written.
+ */
+template <typename ColorFunction>
+bool writePortablePixmap(TiledMapFile &file, const std::string &path,
+                         ColorFunction &&color) {
+  std::ofstream image(path, std::ios::binary);
+  image << "P6\n" << file.cols() << " " << file.rows() << "\n255\n";
+  std::vector<char> row(3 * file.cols());
+  for (std::size_t tileRow = 0; tileRow < file.tileRowCount(); ++tileRow) {
+    const std::size_t firstTile = tileRow * file.tileColumnCount();
+    const std::size_t firstRow = tileRow * file.tileSize();
+    const std::size_t lastRow =
+        std::min(firstRow + file.tileSize(), file.rows());
+    for (std::size_t mapRow = firstRow; mapRow < lastRow; ++mapRow) {
+      auto pixel = row.begin();
+      for (std::size_t tile = firstTile;
+           tile < firstTile + file.tileColumnCount(); ++tile) {
+        const std::size_t firstColumn =
+            (tile - firstTile) * file.tileSize();
+        const std::size_t columnCount =
+            std::min(file.tileSize(), file.cols() - firstColumn);
+        const std::int16_t *positions =
+            file.convergePositions(tile) +
+            (mapRow - firstRow) * file.tileSize();
+        for (std::size_t column = 0; column < columnCount; ++column) {
+          const std::array<std::uint8_t, 3> rgb = color(positions[column]);
+          for (const std::uint8_t value : rgb) {
+            *pixel++ = static_cast<char>(value);
+          }
+        }
+      }
+      image.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+
+    for (std::size_t tile = firstTile;
+         tile < firstTile + file.tileColumnCount(); ++tile) {
+      file.evictTile(tile);
+    }
+  }
+
+  return static_cast<bool>(image);
+}
+} // namespace staticpendulum
+#endif // TILEDMAPFILE_H
@@ -0,0 +1,278 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#include "tilescheduler.h"
+#include <numeric>
+#include <thread>
+
+namespace staticpendulum {
+TileScheduler::TileScheduler(unsigned threadCount)
+    : m_threadCount(std::max(threadCount, 1u)) {
+  for (unsigned i = 0; i < m_threadCount; ++i) {
+    m_deques.emplace_back(new TileDeque());
+  }
+}
+
+void TileScheduler::run(const std::vector<Tile> &tiles,
+                        const RowFunction &rowFunction) {
+  const std::size_t blockSize =
+      (tiles.size() + m_threadCount - 1) / m_threadCount;
+  for (unsigned i = 0; i < m_threadCount; ++i) {
+    const std::size_t first = std::min(i * blockSize, tiles.size());
+    const std::size_t last = std::min(first + blockSize, tiles.size());
+    m_deques[i]->tiles.assign(tiles.begin() + first, tiles.begin() + last);
+  }
+
+  runDealtTiles([&](unsigned threadIndex, const Tile &tile) {
+    runRows(threadIndex, tile, rowFunction);
+  });
+}
+
+void TileScheduler::run(const std::vector<Tile> &tiles,
+                        const std::vector<double> &costs,
+                        const RowFunction &rowFunction) {
+  std::vector<std::size_t> order(tiles.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&costs](std::size_t a, std::size_t b) {
+                     return costs[a] > costs[b];
+                   });
+
+  // longest processing time first, every tile goes to the thread with the
+  // least predicted work so far
+  std::vector<double> loads(m_threadCount, 0.0);
+  for (auto &deque : m_deques) {
+    deque->tiles.clear();
+  }
+  for (std::size_t index : order) {
+    const auto leastLoaded = static_cast<std::size_t>(
+        std::min_element(loads.begin(), loads.end()) - loads.begin());
+    m_deques[leastLoaded]->tiles.push_back(tiles[index]);
+    loads[leastLoaded] += costs[index];
+  }
+
+  runDealtTiles([&](unsigned threadIndex, const Tile &tile) {
+    runRows(threadIndex, tile, rowFunction);
+  });
+}
+
+void TileScheduler::runRecursive(const std::vector<Tile> &tiles,
+                                 const TileFunction &tileFunction) {
+  // deal round robin, the tiles of a recursion are usually few and large
+  for (auto &deque : m_deques) {
+    deque->tiles.clear();
+  }
+  for (std::size_t i = 0; i < tiles.size(); ++i) {
+    m_deques[i % m_threadCount]->tiles.push_back(tiles[i]);
+  }
+
+  runDealtTiles([&](unsigned threadIndex, const Tile &tile) {
+    std::vector<Tile> subtiles;
+    m_completedPointCount += tileFunction(tile, subtiles);
+    if (subtiles.empty())
+      return;
+
+    m_pendingTileCount += subtiles.size();
+    {
+      TileDeque &deque = *m_deques[threadIndex];
+      std::lock_guard<std::mutex> lock(deque.mutex);
+      deque.tiles.insert(deque.tiles.begin(), subtiles.begin(),
+                         subtiles.end());
+    }
+    notifyWork();
+  });
+}
+
+void TileScheduler::cancel() {
+  m_cancelled = true;
+  notifyWork();
+}
+
+bool TileScheduler::isCancelled() const { return m_cancelled; }
+
+std::size_t TileScheduler::pointCount() const { return m_pointCount; }
+
+std::size_t TileScheduler::completedPointCount() const {
+  return m_completedPointCount;
+}
+
+std::size_t TileScheduler::splitCount() const { return m_splitCount; }
+
+template <typename ProcessTile>
+void TileScheduler::runDealtTiles(ProcessTile processTile) {
+  std::size_t pointCount = 0;
+  std::size_t tileCount = 0;
+  for (const auto &deque : m_deques) {
+    for (const auto &tile : deque->tiles) {
+      pointCount += tile.pointCount();
+    }
+    tileCount += deque->tiles.size();
+  }
+  m_pointCount = pointCount;
+  m_pendingTileCount = tileCount;
+  m_completedPointCount = 0;
+  m_splitCount = 0;
+  m_idleCount = 0;
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < m_threadCount; ++i) {
+    threads.emplace_back(
+        [this, i, &processTile]() { runTiles(i, processTile); });
+  }
+  runTiles(0, processTile);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto &deque : m_deques) {
+    deque->tiles.clear();
+  }
+}
+
+template <typename ProcessTile>
+void TileScheduler::runTiles(unsigned threadIndex, ProcessTile &processTile) {
+  std::minstd_rand victimGenerator(threadIndex + 1);
+  std::uniform_int_distribution<unsigned> victimOffset(
+      1, std::max(m_threadCount - 1, 1u));
+  bool idle = false;
+  unsigned failedStealCount = 0;
+  while (!m_cancelled) {
+    // read before looking for tiles, a tile pushed after it changes it
+    const std::size_t workVersion = m_workVersion;
+    Tile tile;
+    bool found = popTile(threadIndex, tile);
+    if (!found && m_threadCount > 1) {
+      found = stealTile(
+          (threadIndex + victimOffset(victimGenerator)) % m_threadCount, tile);
+    }
+
+    // check every deque once before parking
+    if (!found && ++failedStealCount >= m_threadCount) {
+      failedStealCount = 0;
+      found = stealAnyTile(threadIndex, tile);
+      if (!found) {
+        // tiles still running may add more
+        if (m_pendingTileCount == 0)
+          break;
+
+        if (!idle) {
+          idle = true;
+          ++m_idleCount;
+        }
+        std::unique_lock<std::mutex> lock(m_parkMutex);
+        m_workAvailable.wait(lock, [this, workVersion]() {
+          return m_workVersion != workVersion || m_pendingTileCount == 0 ||
+                 m_cancelled;
+        });
+        continue;
+      }
+    }
+
+    if (!found) {
+      if (!idle) {
+        idle = true;
+        ++m_idleCount;
+      }
+      continue;
+    }
+
+    if (idle) {
+      idle = false;
+      --m_idleCount;
+    }
+
+    failedStealCount = 0;
+    processTile(threadIndex, tile);
+    if (--m_pendingTileCount == 0)
+      notifyWork();
+  }
+
+  if (idle)
+    --m_idleCount;
+}
+
+bool TileScheduler::popTile(unsigned threadIndex, Tile &tile) {
+  TileDeque &deque = *m_deques[threadIndex];
+  std::lock_guard<std::mutex> lock(deque.mutex);
+  if (deque.tiles.empty())
+    return false;
+
+  tile = deque.tiles.front();
+  deque.tiles.pop_front();
+  return true;
+}
+
+bool TileScheduler::stealTile(std::size_t victimIndex, Tile &tile) {
+  TileDeque &deque = *m_deques[victimIndex];
+  std::lock_guard<std::mutex> lock(deque.mutex);
+  if (deque.tiles.empty())
+    return false;
+
+  tile = deque.tiles.back();
+  deque.tiles.pop_back();
+  return true;
+}
+
+bool TileScheduler::stealAnyTile(unsigned threadIndex, Tile &tile) {
+  for (unsigned i = 1; i < m_threadCount; ++i) {
+    if (stealTile((threadIndex + i) % m_threadCount, tile))
+      return true;
+  }
+
+  return false;
+}
+
+void TileScheduler::notifyWork() {
+  {
+    std::lock_guard<std::mutex> lock(m_parkMutex);
+    ++m_workVersion;
+  }
+  m_workAvailable.notify_all();
+}
+
+void TileScheduler::runRows(unsigned threadIndex, Tile tile,
+                            const RowFunction &rowFunction) {
+  while (tile.firstRow < tile.lastRow && !m_cancelled) {
+    Tile row = tile;
+    row.lastRow = row.firstRow + 1;
+    rowFunction(row);
+    ++tile.firstRow;
+    m_completedPointCount += row.pointCount();
+
+    // hand half of the remaining rows to the idle threads
+    if (tile.rowCount() > 1 && m_idleCount > 0) {
+      Tile secondHalf = tile;
+      secondHalf.firstRow = tile.firstRow + tile.rowCount() / 2;
+      tile.lastRow = secondHalf.firstRow;
+      ++m_pendingTileCount;
+      {
+        TileDeque &deque = *m_deques[threadIndex];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.tiles.push_back(secondHalf);
+      }
+      ++m_splitCount;
+      notifyWork();
+    }
+  }
+}
+} // namespace staticpendulum
@@ -0,0 +1,201 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+#include "pendulummapintegrator.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace staticpendulum {
+/// Rectangle of map points, rows [firstRow, lastRow) and columns
+/// [firstColumn, lastColumn).
+struct Tile {
+  std::size_t firstRow;
+  std::size_t lastRow;
+  std::size_t firstColumn;
+  std::size_t lastColumn;
+
+  std::size_t rowCount() const { return lastRow - firstRow; }
+  std::size_t columnCount() const { return lastColumn - firstColumn; }
+  std::size_t pointCount() const { return rowCount() * columnCount(); }
+};
+
+/// Default tile size, 16 x 32 points (24 KiB of Points) fit in the level 1
+/// data cache.
+constexpr std::size_t defaultTileRows = 16;
+constexpr std::size_t defaultTileColumns = 32;
+
+/// Shrinks the tile to the bounding box of its integrable points (see
+/// isIntegrable), returns false if it has none.
+template <typename SystemType>
+bool shrinkToIntegrable(const Map &map, const SystemType &theSystem,
+                        Tile &tile) {
+  Tile bounds = {tile.lastRow, tile.firstRow, tile.lastColumn,
+                 tile.firstColumn};
+  for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+    const auto rowBegin = map.rowBegin(row);
+    for (std::size_t column = tile.firstColumn; column < tile.lastColumn;
+         ++column) {
+      if (!isIntegrable(theSystem, *(rowBegin + column)))
+        continue;
+
+      bounds.firstRow = std::min(bounds.firstRow, row);
+      bounds.lastRow = std::max(bounds.lastRow, row + 1);
+      bounds.firstColumn = std::min(bounds.firstColumn, column);
+      bounds.lastColumn = std::max(bounds.lastColumn, column + 1);
+    }
+  }
+
+  tile = bounds;
+  return tile.firstRow < tile.lastRow;
+}
+
+/*!
+ * @brief Splits the map into tiles of at most tileRows x tileColumns points.
+ *
+ * Tiles without any integrable point (see isIntegrable) are dropped and the
+ *others are shrunk to the bounding box of their integrable points, so no work
+ *is scheduled for the area outside of the pendulum reach.
+ */
+template <typename SystemType>
+std::vector<Tile> makeTiles(const Map &map, const SystemType &theSystem,
+                            std::size_t tileRows = defaultTileRows,
+                            std::size_t tileColumns = defaultTileColumns) {
+  std::vector<Tile> tiles;
+  for (std::size_t firstRow = 0; firstRow < map.rows(); firstRow += tileRows) {
+    const std::size_t lastRow = std::min(firstRow + tileRows, map.rows());
+    for (std::size_t firstColumn = 0; firstColumn < map.cols();
+         firstColumn += tileColumns) {
+      Tile tile = {firstRow, lastRow, firstColumn,
+                   std::min(firstColumn + tileColumns, map.cols())};
+      if (shrinkToIntegrable(map, theSystem, tile))
+        tiles.push_back(tile);
+    }
+  }
+
+  return tiles;
+}
+
+/*!
+ * @brief Runs work on map tiles across threads with work stealing.
+ *
+ * Every thread owns a deque of tiles. It works through its deque from the
+ *front and, once its own is empty, steals from the back of the deque of one
+ *randomly picked thread per attempt. After a round of failed attempts it
+ *checks every deque once and then parks until a tile is pushed, the last
+ *tile finishes or the run is cancelled, instead of spinning on the locks of
+ *the busy threads.
+ *
+ * A tile is processed one row at a time, when other threads run out of work
+ *while a tile still has rows left the remaining rows are split in half and
+ *the second half is pushed on the back of the deque to be stolen. So an
+ *expensive tile does not keep a single thread busy while the others idle.
+ *
+ * Recursive work (see runRecursive) pushes the tiles a tile produces on the
+ *front of the deque of its thread, the thread continues depth first while the
+ *other threads steal the larger, older tiles from the back.
+ */
+class TileScheduler {
+public:
+  /// Called for every row of every tile with a tile of a single row.
+  using RowFunction = std::function<void(const Tile &)>;
+  /// Called for every tile by runRecursive, appends the tiles still to be run
+  /// to subtiles and returns the number of points of the tile it finished.
+  using TileFunction =
+      std::function<std::size_t(const Tile &, std::vector<Tile> &subtiles)>;
+
+  /// @param[in] threadCount Number of threads running the tiles, including
+  /// the thread calling run.
+  explicit TileScheduler(unsigned threadCount);
+
+  /// Runs rowFunction on every row of the tiles, returns once all rows are
+  /// done or the scheduler is cancelled. Tiles are dealt to the threads in
+  /// contiguous blocks to keep neighbouring tiles on the same thread.
+  void run(const std::vector<Tile> &tiles, const RowFunction &rowFunction);
+
+  /// Same as run with the predicted cost of every tile (see tileCosts). Tiles
+  /// are dealt longest first to the thread with the least predicted work, so
+  /// every thread starts on its most expensive tiles and ends on cheap ones.
+  void run(const std::vector<Tile> &tiles, const std::vector<double> &costs,
+           const RowFunction &rowFunction);
+
+  /// Runs tileFunction on the tiles and on every subtile it produces, returns
+  /// once there are none left or the scheduler is cancelled.
+  void runRecursive(const std::vector<Tile> &tiles,
+                    const TileFunction &tileFunction);
+
+  /// Stops handing out work, thread safe. Rows and tiles already running
+  /// finish.
+  void cancel();
+  bool isCancelled() const;
+  /// Flag set by cancel, for work checking it while a row runs (see
+  /// PointBudget).
+  const std::atomic<bool> &cancelledFlag() const { return m_cancelled; }
+
+  /// Number of points in the tiles of the current (or last) run.
+  std::size_t pointCount() const;
+  /// Number of points finished so far, thread safe.
+  std::size_t completedPointCount() const;
+  /// Number of times a tile was split for idle threads in the last run.
+  std::size_t splitCount() const;
+
+private:
+  struct TileDeque {
+    std::mutex mutex;
+    std::deque<Tile> tiles;
+  };
+
+  template <typename ProcessTile> void runDealtTiles(ProcessTile processTile);
+  template <typename ProcessTile>
+  void runTiles(unsigned threadIndex, ProcessTile &processTile);
+  bool popTile(unsigned threadIndex, Tile &tile);
+  bool stealTile(std::size_t victimIndex, Tile &tile);
+  bool stealAnyTile(unsigned threadIndex, Tile &tile);
+  // wakes the parked threads to look for tiles again
+  void notifyWork();
+  void runRows(unsigned threadIndex, Tile tile, const RowFunction &rowFunction);
+
+  unsigned m_threadCount;
+  std::vector<std::unique_ptr<TileDeque>> m_deques;
+  std::atomic<std::size_t> m_pointCount{0};
+  std::atomic<std::size_t> m_pendingTileCount{0};
+  std::atomic<std::size_t> m_completedPointCount{0};
+  std::atomic<std::size_t> m_splitCount{0};
+  std::atomic<unsigned> m_idleCount{0};
+  std::atomic<bool> m_cancelled{false};
+  // incremented by notifyWork, a parked thread waits for it to change
+  std::atomic<std::size_t> m_workVersion{0};
+  std::mutex m_parkMutex;
+  std::condition_variable m_workAvailable;
+};
+} // namespace staticpendulum
+#endif // TILESCHEDULER_H
@@ -0,0 +1,268 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef VECTORIZEDPENDULUMSYSTEM_H
+#define VECTORIZEDPENDULUMSYSTEM_H
+#include "alignedallocator.h"
+#include "batchstate.h"
+#include "fixedpendulumsystem.h"
+#include "pendulumsystem.h"
+#include <cmath>
+#include <utility>
+#include <vector>
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+namespace staticpendulum {
+/// Alignment of the attractor arrays, the width of the widest vector register
+/// (AVX-512) so every lane block is loaded with aligned loads.
+constexpr std::size_t attractorArrayAlignment = 64;
+
+/*!
+ * @brief Structure of arrays copy of an attractor list.
+ *
+ * The x positions, y positions and force coefficients are stored in separate
+ *aligned arrays, padded to a multiple of nativeLaneCount with copies of the
+ *last attractor that have a zero force coefficient, so the force summation
+ *runs over whole lane blocks without a remainder loop.
+ */
+struct AttractorArrays {
+  typedef std::vector<double, AlignedAllocator<double, attractorArrayAlignment>>
+      ArrayType;
+
+  AttractorArrays() = default;
+  explicit AttractorArrays(
+      const std::vector<PendulumSystem::Attractor> &attractorList) {
+    const std::size_t count = attractorList.size();
+    attractorCount = count;
+    const std::size_t paddedCount =
+        (count + nativeLaneCount - 1) / nativeLaneCount * nativeLaneCount;
+    xPositions.resize(paddedCount);
+    yPositions.resize(paddedCount);
+    forceCoeffs.resize(paddedCount, 0.0);
+    for (std::size_t i = 0; i < paddedCount; ++i) {
+      const auto &attractor = attractorList[i < count ? i : count - 1];
+      xPositions[i] = attractor.xPosition;
+      yPositions[i] = attractor.yPosition;
+      if (i < count) {
+        forceCoeffs[i] = attractor.forceCoeff;
+      }
+    }
+  }
+
+  /// Padded length of the arrays, a multiple of nativeLaneCount.
+  std::size_t size() const { return forceCoeffs.size(); }
+
+  /// Number of attractors without the padding.
+  std::size_t attractorCount = 0;
+  ArrayType xPositions;
+  ArrayType yPositions;
+  ArrayType forceCoeffs;
+};
+
+namespace detail {
+/*!
+ * @brief Sums the attraction forces of all the attractors on the pendulum head
+ *at (x, y) with the squared height term value2, see PendulumSystem.
+ *
+ * With AVX-512 or AVX2 the attractors are summed a vector register at a time
+ *using an approximate reciprocal square root refined with Newton iterations,
+ *which is several times cheaper than the square root and division it replaces
+ *(those run on the unpipelined divider). The refined reciprocal square root is
+ *within a few ulp of the exact value, so every attractor force is within
+ *1e-15 relative of the exact one; only the summation order differs otherwise.
+ *The default build targets the baseline instruction set and takes the scalar
+ *loop, build with CONFIG+=native_arch (see shared_config.pri) for the vector
+ *kernels.
+ */
+inline void sumAttractorForces(const AttractorArrays &attractors, double x,
+                               double y, double value2,
+                               double &xAttractionForce,
+                               double &yAttractionForce) {
+  const double *xPositions = attractors.xPositions.data();
+  const double *yPositions = attractors.yPositions.data();
+  const double *forceCoeffs = attractors.forceCoeffs.data();
+#if defined(__AVX512F__)
+  const __m512d xs = _mm512_set1_pd(x);
+  const __m512d ys = _mm512_set1_pd(y);
+  const __m512d value2s = _mm512_set1_pd(value2);
+  const __m512d half = _mm512_set1_pd(0.5);
+  const __m512d threeHalves = _mm512_set1_pd(1.5);
+  __m512d xForces = _mm512_setzero_pd();
+  __m512d yForces = _mm512_setzero_pd();
+  for (std::size_t i = 0, count = attractors.size(); i < count; i += 8) {
+    const __m512d value3 = _mm512_sub_pd(xs, _mm512_load_pd(xPositions + i));
+    const __m512d value4 = _mm512_sub_pd(ys, _mm512_load_pd(yPositions + i));
+    const __m512d squaredDistance = _mm512_fmadd_pd(
+        value3, value3, _mm512_fmadd_pd(value4, value4, value2s));
+    // 14 bit estimate, two Newton iterations give full double precision
+    __m512d inverseDistance = _mm512_maskz_rsqrt14_pd(0xFF, squaredDistance);
+    const __m512d halfSquaredDistance = _mm512_mul_pd(half, squaredDistance);
+    for (int iteration = 0; iteration < 2; ++iteration) {
+      inverseDistance = _mm512_mul_pd(
+          inverseDistance,
+          _mm512_fnmadd_pd(halfSquaredDistance,
+                           _mm512_mul_pd(inverseDistance, inverseDistance),
+                           threeHalves));
+    }
+    const __m512d value7 = _mm512_mul_pd(
+        _mm512_sub_pd(_mm512_setzero_pd(), _mm512_load_pd(forceCoeffs + i)),
+        _mm512_mul_pd(inverseDistance,
+                      _mm512_mul_pd(inverseDistance, inverseDistance)));
+    xForces = _mm512_fmadd_pd(value3, value7, xForces);
+    yForces = _mm512_fmadd_pd(value4, value7, yForces);
+  }
+  alignas(64) double xLanes[8];
+  alignas(64) double yLanes[8];
+  _mm512_store_pd(xLanes, xForces);
+  _mm512_store_pd(yLanes, yForces);
+  xAttractionForce = 0.0;
+  yAttractionForce = 0.0;
+  for (std::size_t l = 0; l < 8; ++l) {
+    xAttractionForce += xLanes[l];
+    yAttractionForce += yLanes[l];
+  }
+#elif defined(__AVX2__) && defined(__FMA__)
+  const __m256d xs = _mm256_set1_pd(x);
+  const __m256d ys = _mm256_set1_pd(y);
+  const __m256d value2s = _mm256_set1_pd(value2);
+  const __m256d half = _mm256_set1_pd(0.5);
+  const __m256d threeHalves = _mm256_set1_pd(1.5);
+  __m256d xForces = _mm256_setzero_pd();
+  __m256d yForces = _mm256_setzero_pd();
+  for (std::size_t i = 0, count = attractors.size(); i < count; i += 4) {
+    const __m256d value3 = _mm256_sub_pd(xs, _mm256_load_pd(xPositions + i));
+    const __m256d value4 = _mm256_sub_pd(ys, _mm256_load_pd(yPositions + i));
+    const __m256d squaredDistance = _mm256_fmadd_pd(
+        value3, value3, _mm256_fmadd_pd(value4, value4, value2s));
+    // there is no double precision estimate before AVX-512, the 12 bit single
+    // precision one needs three Newton iterations
+    __m256d inverseDistance =
+        _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(squaredDistance)));
+    const __m256d halfSquaredDistance = _mm256_mul_pd(half, squaredDistance);
+    for (int iteration = 0; iteration < 3; ++iteration) {
+      inverseDistance = _mm256_mul_pd(
+          inverseDistance,
+          _mm256_fnmadd_pd(halfSquaredDistance,
+                           _mm256_mul_pd(inverseDistance, inverseDistance),
+                           threeHalves));
+    }
+    const __m256d value7 = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_setzero_pd(), _mm256_load_pd(forceCoeffs + i)),
+        _mm256_mul_pd(inverseDistance,
+                      _mm256_mul_pd(inverseDistance, inverseDistance)));
+    xForces = _mm256_fmadd_pd(value3, value7, xForces);
+    yForces = _mm256_fmadd_pd(value4, value7, yForces);
+  }
+  alignas(32) double xLanes[4];
+  alignas(32) double yLanes[4];
+  _mm256_store_pd(xLanes, xForces);
+  _mm256_store_pd(yLanes, yForces);
+  xAttractionForce = (xLanes[0] + xLanes[1]) + (xLanes[2] + xLanes[3]);
+  yAttractionForce = (yLanes[0] + yLanes[1]) + (yLanes[2] + yLanes[3]);
+#else
+  xAttractionForce = 0.0;
+  yAttractionForce = 0.0;
+  for (std::size_t i = 0; i < attractors.attractorCount; ++i) {
+    const double value3 = x - xPositions[i];
+    const double value4 = y - yPositions[i];
+    const double value7 = attractorFactor(
+        forceCoeffs[i], value3 * value3 + value4 * value4 + value2);
+    xAttractionForce += value3 * value7;
+    yAttractionForce += value4 * value7;
+  }
+#endif
+}
+} // namespace detail
+
+/*!
+ * @brief PendulumSystem for many attractors that vectorizes the attractor
+ *force summation across the attractors, see detail::sumAttractorForces.
+ *
+ * The attraction forces of the derivative agree with PendulumSystem to within
+ *1e-14 times the sum of the magnitudes of the individual attractor forces.
+ *The batched derivative evaluates the lanes one at a time, each lane being
+ *vectorized across the attractors. The jacobian is evaluated rarely and uses
+ *the PendulumSystem kernel.
+ */
+struct VectorizedPendulumSystem : PendulumParameters {
+  typedef PendulumSystem::StateType StateType;
+  typedef PendulumSystem::JacobianType JacobianType;
+
+  std::vector<PendulumSystem::Attractor> attractorList;
+  AttractorArrays attractorArrays;
+
+  /// Copies the system, its attractor list must not be empty.
+  explicit VectorizedPendulumSystem(const PendulumSystem &system)
+      : PendulumParameters(system), attractorList(system.attractorList),
+        attractorArrays(system.attractorList) {}
+
+  void operator()(const StateType &x, StateType &dxdt,
+                  const double /* t */) const {
+    detail::pendulumDerivative(
+        *this, x, dxdt,
+        [this](double xPosition, double yPosition, double value2,
+               double &xAttractionForce, double &yAttractionForce) {
+          detail::sumAttractorForces(attractorArrays, xPosition, yPosition,
+                                     value2, xAttractionForce,
+                                     yAttractionForce);
+        });
+  }
+
+  template <std::size_t Lanes>
+  void operator()(const BatchState<4, Lanes> &x, BatchState<4, Lanes> &dxdt,
+                  const LaneArray<double, Lanes> &t) const {
+    detail::pendulumDerivativePerLane(*this, x, dxdt, t);
+  }
+
+  void jacobian(const StateType &x, JacobianType &dfdx,
+                const double /* t */) const {
+    detail::pendulumJacobian(*this, x, dfdx);
+  }
+};
+
+/*!
+ * @brief Calls function with the fastest system type equivalent to the system:
+ *a FixedPendulumSystem for up to maximumFixedAttractorCount attractors, a
+ *VectorizedPendulumSystem for more, and the system itself if it has no
+ *attractors or approximates them with its attractorTree or forceTable.
+ *
+ * function must return the same type for every system type, e.g. a
+ *std::function.
+ */
+template <typename Function>
+inline auto withSpecialisedSystem(const PendulumSystem &system,
+                                  Function &&function) {
+  if (system.attractorTree || system.forceTable) {
+    return function(system);
+  }
+
+  if (system.attractorList.size() > maximumFixedAttractorCount) {
+    return function(VectorizedPendulumSystem(system));
+  }
+
+  return withFixedAttractorCount(system, std::forward<Function>(function));
+}
+} // namespace staticpendulum
+#endif // VECTORIZEDPENDULUMSYSTEM_H
@@ -0,0 +1,88 @@
+/* ===========================================================================
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Jedidiah Buck McCready <jbuckmccready@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * ===========================================================================*/
+#ifndef VERNER65_H
+#define VERNER65_H
+#include "explicitrungekutta.h"
+
+namespace staticpendulum {
+/*!
+ * @brief Butcher tableau of Verner's embedded Runge Kutta order 6(5) method,
+ *see explicitRungeKutta.
+ *
+ * The order 6 solution is propagated and the order 5 one is used for the error
+ *estimate. These are the coefficients used by the DVERK code.
+ *
+ * See: J. H. Verner. "Explicit Runge-Kutta methods with estimates of the local
+ *truncation error." SIAM Journal on Numerical Analysis, Vol. 15, No. 4, 1978.
+ *
+ * And: T. E. Hull, W. H. Enright, K. R. Jackson. "User's guide for DVERK - a
+ *subroutine for solving non-stiff ODE's." University of Toronto, Technical
+ *Report 100, 1976.
+ */
+struct Verner65Tableau {
+  static constexpr std::size_t stageCount = 8;
+  static constexpr int order = 6;
+  static constexpr int errorOrder = 5;
+  static constexpr bool isFsal = false;
+  // stability boundary on the negative real axis
+  static constexpr double stabilityBoundary = 4.06;
+
+  static constexpr double c(std::size_t i) {
+    const double values[stageCount] = {0.0,       1.0 / 6.0, 4.0 / 15.0,
+                                       2.0 / 3.0, 5.0 / 6.0, 1.0,
+                                       1.0 / 15.0, 1.0};
+    return values[i];
+  }
+
+  static constexpr double a(std::size_t i, std::size_t j) {
+    const double values[stageCount][stageCount] = {
+        {},
+        {1.0 / 6.0},
+        {4.0 / 75.0, 16.0 / 75.0},
+        {5.0 / 6.0, -8.0 / 3.0, 5.0 / 2.0},
+        {-165.0 / 64.0, 55.0 / 6.0, -425.0 / 64.0, 85.0 / 96.0},
+        {12.0 / 5.0, -8.0, 4015.0 / 612.0, -11.0 / 36.0, 88.0 / 255.0},
+        {-8263.0 / 15000.0, 124.0 / 75.0, -643.0 / 680.0, -81.0 / 250.0,
+         2484.0 / 10625.0, 0.0},
+        {3501.0 / 1720.0, -300.0 / 43.0, 297275.0 / 52632.0, -319.0 / 2322.0,
+         24068.0 / 84065.0, 0.0, 3850.0 / 26703.0}};
+    return values[i][j];
+  }
+
+  static constexpr double b(std::size_t j) {
+    const double values[stageCount] = {
+        3.0 / 40.0,       0.0, 875.0 / 2244.0,   23.0 / 72.0,
+        264.0 / 1955.0,   0.0, 125.0 / 11592.0, 43.0 / 616.0};
+    return values[j];
+  }
+
+  static constexpr double bHat(std::size_t j) {
+    const double values[stageCount] = {
+        13.0 / 160.0, 0.0,        2375.0 / 5984.0, 5.0 / 16.0,
+        12.0 / 85.0,  3.0 / 44.0, 0.0,             0.0};
+    return values[j];
+  }
+};
+} // namespace staticpendulum
+#endif // VERNER65_H
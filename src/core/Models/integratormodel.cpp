@@ -25,12 +25,20 @@
 #include "DataStorage/jsonreader.h"
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QMetaEnum>
 #include <QString>
 
 namespace staticpendulum {
 IntegratorModel::IntegratorModel(QObject *parent)
     : QObject(parent), m_startingStepSize(0.001), m_maximumStepSize(0.1),
-      m_relativeTolerance(1e-6), m_absoluteTolerance(1e-6), m_threadCount(8) {}
+      m_relativeTolerance(1e-6), m_absoluteTolerance(1e-6), m_threadCount(8),
+      m_integratorType(CashKarp54), m_stepControllerType(Elementary),
+      m_estimateStartingStepSize(false), m_stiffnessSwitching(false),
+      m_costModelType(Uniform), m_checkpointInterval(0),
+      m_trialBudget(1000000), m_timeBudget(0.0), m_firstPassTrialBudget(0),
+      m_cellMapPositionCount(0), m_cellMapVelocityCount(9),
+      m_cellMapTime(1.0), m_fateCachePositionSize(0.0),
+      m_fateCacheVelocitySize(0.1), m_fateCacheConfidence(3) {}
 
 const QString &IntegratorModel::modelJsonKey() {
   static const QString key("integrator");
@@ -62,6 +70,81 @@ const QString &IntegratorModel::threadCountJsonKey() {
   return key;
 }
 
+const QString &IntegratorModel::integratorTypeJsonKey() {
+  static const QString key("integratorType");
+  return key;
+}
+
+const QString &IntegratorModel::stepControllerTypeJsonKey() {
+  static const QString key("stepControllerType");
+  return key;
+}
+
+const QString &IntegratorModel::estimateStartingStepSizeJsonKey() {
+  static const QString key("estimateStartingStepSize");
+  return key;
+}
+
+const QString &IntegratorModel::stiffnessSwitchingJsonKey() {
+  static const QString key("stiffnessSwitching");
+  return key;
+}
+
+const QString &IntegratorModel::costModelTypeJsonKey() {
+  static const QString key("costModelType");
+  return key;
+}
+
+const QString &IntegratorModel::checkpointIntervalJsonKey() {
+  static const QString key("checkpointInterval");
+  return key;
+}
+
+const QString &IntegratorModel::trialBudgetJsonKey() {
+  static const QString key("trialBudget");
+  return key;
+}
+
+const QString &IntegratorModel::timeBudgetJsonKey() {
+  static const QString key("timeBudget");
+  return key;
+}
+
+const QString &IntegratorModel::firstPassTrialBudgetJsonKey() {
+  static const QString key("firstPassTrialBudget");
+  return key;
+}
+
+const QString &IntegratorModel::cellMapPositionCountJsonKey() {
+  static const QString key("cellMapPositionCount");
+  return key;
+}
+
+const QString &IntegratorModel::cellMapVelocityCountJsonKey() {
+  static const QString key("cellMapVelocityCount");
+  return key;
+}
+
+const QString &IntegratorModel::cellMapTimeJsonKey() {
+  static const QString key("cellMapTime");
+  return key;
+}
+
+const QString &IntegratorModel::fateCachePositionSizeJsonKey() {
+  static const QString key("fateCachePositionSize");
+  return key;
+}
+
+const QString &IntegratorModel::fateCacheVelocitySizeJsonKey() {
+  static const QString key("fateCacheVelocitySize");
+  return key;
+}
+
+const QString &IntegratorModel::fateCacheConfidenceJsonKey() {
+  static const QString key("fateCacheConfidence");
+  return key;
+}
+
 double IntegratorModel::startingStepSize() const { return m_startingStepSize; }
 
 double IntegratorModel::maximumStepSize() const { return m_maximumStepSize; }
@@ -76,6 +159,61 @@ double IntegratorModel::absoluteTolerance() const {
 
 int IntegratorModel::threadCount() const { return m_threadCount; }
 
+IntegratorModel::IntegratorType IntegratorModel::integratorType() const {
+  return m_integratorType;
+}
+
+IntegratorModel::StepControllerType
+IntegratorModel::stepControllerType() const {
+  return m_stepControllerType;
+}
+
+bool IntegratorModel::estimateStartingStepSize() const {
+  return m_estimateStartingStepSize;
+}
+
+bool IntegratorModel::stiffnessSwitching() const {
+  return m_stiffnessSwitching;
+}
+
+IntegratorModel::CostModelType IntegratorModel::costModelType() const {
+  return m_costModelType;
+}
+
+int IntegratorModel::checkpointInterval() const {
+  return m_checkpointInterval;
+}
+
+int IntegratorModel::trialBudget() const { return m_trialBudget; }
+
+double IntegratorModel::timeBudget() const { return m_timeBudget; }
+
+int IntegratorModel::firstPassTrialBudget() const {
+  return m_firstPassTrialBudget;
+}
+
+int IntegratorModel::cellMapPositionCount() const {
+  return m_cellMapPositionCount;
+}
+
+int IntegratorModel::cellMapVelocityCount() const {
+  return m_cellMapVelocityCount;
+}
+
+double IntegratorModel::cellMapTime() const { return m_cellMapTime; }
+
+double IntegratorModel::fateCachePositionSize() const {
+  return m_fateCachePositionSize;
+}
+
+double IntegratorModel::fateCacheVelocitySize() const {
+  return m_fateCacheVelocitySize;
+}
+
+int IntegratorModel::fateCacheConfidence() const {
+  return m_fateCacheConfidence;
+}
+
 void IntegratorModel::setMaximumStepSize(double maximumStepSize) {
   if (m_maximumStepSize == maximumStepSize)
     return;
@@ -108,6 +246,128 @@ void IntegratorModel::setThreadCount(int threadCount) {
   emit threadCountChanged(threadCount);
 }
 
+void IntegratorModel::setIntegratorType(IntegratorType integratorType) {
+  if (m_integratorType == integratorType)
+    return;
+
+  m_integratorType = integratorType;
+  emit integratorTypeChanged(integratorType);
+}
+
+void IntegratorModel::setStepControllerType(
+    StepControllerType stepControllerType) {
+  if (m_stepControllerType == stepControllerType)
+    return;
+
+  m_stepControllerType = stepControllerType;
+  emit stepControllerTypeChanged(stepControllerType);
+}
+
+void IntegratorModel::setEstimateStartingStepSize(
+    bool estimateStartingStepSize) {
+  if (m_estimateStartingStepSize == estimateStartingStepSize)
+    return;
+
+  m_estimateStartingStepSize = estimateStartingStepSize;
+  emit estimateStartingStepSizeChanged(estimateStartingStepSize);
+}
+
+void IntegratorModel::setStiffnessSwitching(bool stiffnessSwitching) {
+  if (m_stiffnessSwitching == stiffnessSwitching)
+    return;
+
+  m_stiffnessSwitching = stiffnessSwitching;
+  emit stiffnessSwitchingChanged(stiffnessSwitching);
+}
+
+void IntegratorModel::setCostModelType(CostModelType costModelType) {
+  if (m_costModelType == costModelType)
+    return;
+
+  m_costModelType = costModelType;
+  emit costModelTypeChanged(costModelType);
+}
+
+void IntegratorModel::setCheckpointInterval(int checkpointInterval) {
+  if (m_checkpointInterval == checkpointInterval)
+    return;
+
+  m_checkpointInterval = checkpointInterval;
+  emit checkpointIntervalChanged(checkpointInterval);
+}
+
+void IntegratorModel::setTrialBudget(int trialBudget) {
+  if (m_trialBudget == trialBudget)
+    return;
+
+  m_trialBudget = trialBudget;
+  emit trialBudgetChanged(trialBudget);
+}
+
+void IntegratorModel::setTimeBudget(double timeBudget) {
+  if (m_timeBudget == timeBudget)
+    return;
+
+  m_timeBudget = timeBudget;
+  emit timeBudgetChanged(timeBudget);
+}
+
+void IntegratorModel::setFirstPassTrialBudget(int firstPassTrialBudget) {
+  if (m_firstPassTrialBudget == firstPassTrialBudget)
+    return;
+
+  m_firstPassTrialBudget = firstPassTrialBudget;
+  emit firstPassTrialBudgetChanged(firstPassTrialBudget);
+}
+
+void IntegratorModel::setCellMapPositionCount(int cellMapPositionCount) {
+  if (m_cellMapPositionCount == cellMapPositionCount)
+    return;
+
+  m_cellMapPositionCount = cellMapPositionCount;
+  emit cellMapPositionCountChanged(cellMapPositionCount);
+}
+
+void IntegratorModel::setCellMapVelocityCount(int cellMapVelocityCount) {
+  if (m_cellMapVelocityCount == cellMapVelocityCount)
+    return;
+
+  m_cellMapVelocityCount = cellMapVelocityCount;
+  emit cellMapVelocityCountChanged(cellMapVelocityCount);
+}
+
+void IntegratorModel::setCellMapTime(double cellMapTime) {
+  if (m_cellMapTime == cellMapTime)
+    return;
+
+  m_cellMapTime = cellMapTime;
+  emit cellMapTimeChanged(cellMapTime);
+}
+
+void IntegratorModel::setFateCachePositionSize(double fateCachePositionSize) {
+  if (m_fateCachePositionSize == fateCachePositionSize)
+    return;
+
+  m_fateCachePositionSize = fateCachePositionSize;
+  emit fateCachePositionSizeChanged(fateCachePositionSize);
+}
+
+void IntegratorModel::setFateCacheVelocitySize(double fateCacheVelocitySize) {
+  if (m_fateCacheVelocitySize == fateCacheVelocitySize)
+    return;
+
+  m_fateCacheVelocitySize = fateCacheVelocitySize;
+  emit fateCacheVelocitySizeChanged(fateCacheVelocitySize);
+}
+
+void IntegratorModel::setFateCacheConfidence(int fateCacheConfidence) {
+  if (m_fateCacheConfidence == fateCacheConfidence)
+    return;
+
+  m_fateCacheConfidence = fateCacheConfidence;
+  emit fateCacheConfidenceChanged(fateCacheConfidence);
+}
+
 void IntegratorModel::read(const QJsonObject &json) {
   JsonReader reader(modelJsonKey(), json);
 
@@ -123,6 +383,73 @@ void IntegratorModel::read(const QJsonObject &json) {
       reader.readProperty(absoluteToleranceJsonKey()).toDouble());
 
   setThreadCount(reader.readProperty(threadCountJsonKey()).toInt());
+
+  // integrator type is stored by name to keep the json readable
+  const QString integratorTypeName =
+      reader.readProperty(integratorTypeJsonKey(), QJsonValue::Type::String)
+          .toString();
+  bool isValidName = false;
+  const int integratorTypeValue =
+      QMetaEnum::fromType<IntegratorType>().keyToValue(
+          integratorTypeName.toLatin1().constData(), &isValidName);
+  if (isValidName) {
+    setIntegratorType(static_cast<IntegratorType>(integratorTypeValue));
+  }
+
+  const QString stepControllerTypeName =
+      reader
+          .readProperty(stepControllerTypeJsonKey(), QJsonValue::Type::String)
+          .toString();
+  const int stepControllerTypeValue =
+      QMetaEnum::fromType<StepControllerType>().keyToValue(
+          stepControllerTypeName.toLatin1().constData(), &isValidName);
+  if (isValidName) {
+    setStepControllerType(
+        static_cast<StepControllerType>(stepControllerTypeValue));
+  }
+
+  setEstimateStartingStepSize(
+      reader
+          .readProperty(estimateStartingStepSizeJsonKey(),
+                        QJsonValue::Type::Bool)
+          .toBool());
+
+  setStiffnessSwitching(
+      reader.readProperty(stiffnessSwitchingJsonKey(), QJsonValue::Type::Bool)
+          .toBool());
+
+  const QString costModelTypeName =
+      reader.readProperty(costModelTypeJsonKey(), QJsonValue::Type::String)
+          .toString();
+  const int costModelTypeValue =
+      QMetaEnum::fromType<CostModelType>().keyToValue(
+          costModelTypeName.toLatin1().constData(), &isValidName);
+  if (isValidName) {
+    setCostModelType(static_cast<CostModelType>(costModelTypeValue));
+  }
+
+  setCheckpointInterval(
+      reader.readProperty(checkpointIntervalJsonKey()).toInt());
+  // files written before the budgets existed keep the defaults
+  setTrialBudget(
+      reader.readProperty(trialBudgetJsonKey()).toInt(m_trialBudget));
+  setTimeBudget(
+      reader.readProperty(timeBudgetJsonKey()).toDouble(m_timeBudget));
+  setFirstPassTrialBudget(
+      reader.readProperty(firstPassTrialBudgetJsonKey()).toInt());
+  setCellMapPositionCount(
+      reader.readProperty(cellMapPositionCountJsonKey()).toInt());
+  setCellMapVelocityCount(reader.readProperty(cellMapVelocityCountJsonKey())
+                              .toInt(m_cellMapVelocityCount));
+  setCellMapTime(
+      reader.readProperty(cellMapTimeJsonKey()).toDouble(m_cellMapTime));
+  setFateCachePositionSize(
+      reader.readProperty(fateCachePositionSizeJsonKey()).toDouble());
+  setFateCacheVelocitySize(
+      reader.readProperty(fateCacheVelocitySizeJsonKey())
+          .toDouble(m_fateCacheVelocitySize));
+  setFateCacheConfidence(reader.readProperty(fateCacheConfidenceJsonKey())
+                             .toInt(m_fateCacheConfidence));
 }
 
 void IntegratorModel::write(QJsonObject &json) const {
@@ -131,6 +458,25 @@ void IntegratorModel::write(QJsonObject &json) const {
   json[relativeToleranceJsonKey()] = m_relativeTolerance;
   json[absoluteToleranceJsonKey()] = m_absoluteTolerance;
   json[threadCountJsonKey()] = m_threadCount;
+  json[integratorTypeJsonKey()] = QString(
+      QMetaEnum::fromType<IntegratorType>().valueToKey(m_integratorType));
+  json[stepControllerTypeJsonKey()] =
+      QString(QMetaEnum::fromType<StepControllerType>().valueToKey(
+          m_stepControllerType));
+  json[estimateStartingStepSizeJsonKey()] = m_estimateStartingStepSize;
+  json[stiffnessSwitchingJsonKey()] = m_stiffnessSwitching;
+  json[costModelTypeJsonKey()] = QString(
+      QMetaEnum::fromType<CostModelType>().valueToKey(m_costModelType));
+  json[checkpointIntervalJsonKey()] = m_checkpointInterval;
+  json[trialBudgetJsonKey()] = m_trialBudget;
+  json[timeBudgetJsonKey()] = m_timeBudget;
+  json[firstPassTrialBudgetJsonKey()] = m_firstPassTrialBudget;
+  json[cellMapPositionCountJsonKey()] = m_cellMapPositionCount;
+  json[cellMapVelocityCountJsonKey()] = m_cellMapVelocityCount;
+  json[cellMapTimeJsonKey()] = m_cellMapTime;
+  json[fateCachePositionSizeJsonKey()] = m_fateCachePositionSize;
+  json[fateCacheVelocitySizeJsonKey()] = m_fateCacheVelocitySize;
+  json[fateCacheConfidenceJsonKey()] = m_fateCacheConfidence;
 }
 
 void IntegratorModel::setStartingStepSize(double startingStepSize) {
@@ -41,7 +41,58 @@ class IntegratorModel : public QObject {
                  setAbsoluteTolerance NOTIFY absoluteToleranceChanged)
   Q_PROPERTY(int threadCount READ threadCount WRITE setThreadCount NOTIFY
                  threadCountChanged)
+  Q_PROPERTY(IntegratorType integratorType READ integratorType WRITE
+                 setIntegratorType NOTIFY integratorTypeChanged)
+  Q_PROPERTY(StepControllerType stepControllerType READ stepControllerType
+                 WRITE setStepControllerType NOTIFY stepControllerTypeChanged)
+  Q_PROPERTY(bool estimateStartingStepSize READ estimateStartingStepSize WRITE
+                 setEstimateStartingStepSize NOTIFY
+                     estimateStartingStepSizeChanged)
+  Q_PROPERTY(bool stiffnessSwitching READ stiffnessSwitching WRITE
+                 setStiffnessSwitching NOTIFY stiffnessSwitchingChanged)
+  Q_PROPERTY(CostModelType costModelType READ costModelType WRITE
+                 setCostModelType NOTIFY costModelTypeChanged)
+  Q_PROPERTY(int checkpointInterval READ checkpointInterval WRITE
+                 setCheckpointInterval NOTIFY checkpointIntervalChanged)
+  Q_PROPERTY(int trialBudget READ trialBudget WRITE setTrialBudget NOTIFY
+                 trialBudgetChanged)
+  Q_PROPERTY(double timeBudget READ timeBudget WRITE setTimeBudget NOTIFY
+                 timeBudgetChanged)
+  Q_PROPERTY(int firstPassTrialBudget READ firstPassTrialBudget WRITE
+                 setFirstPassTrialBudget NOTIFY firstPassTrialBudgetChanged)
+  Q_PROPERTY(int cellMapPositionCount READ cellMapPositionCount WRITE
+                 setCellMapPositionCount NOTIFY cellMapPositionCountChanged)
+  Q_PROPERTY(int cellMapVelocityCount READ cellMapVelocityCount WRITE
+                 setCellMapVelocityCount NOTIFY cellMapVelocityCountChanged)
+  Q_PROPERTY(double cellMapTime READ cellMapTime WRITE setCellMapTime NOTIFY
+                 cellMapTimeChanged)
+  Q_PROPERTY(double fateCachePositionSize READ fateCachePositionSize WRITE
+                 setFateCachePositionSize NOTIFY fateCachePositionSizeChanged)
+  Q_PROPERTY(double fateCacheVelocitySize READ fateCacheVelocitySize WRITE
+                 setFateCacheVelocitySize NOTIFY fateCacheVelocitySizeChanged)
+  Q_PROPERTY(int fateCacheConfidence READ fateCacheConfidence WRITE
+                 setFateCacheConfidence NOTIFY fateCacheConfidenceChanged)
 public:
+  /// Stepper used to integrate the points.
+  enum IntegratorType {
+    CashKarp54,
+    DormandPrince54,
+    BogackiShampine32,
+    Verner65,
+    DormandPrince853,
+    Rosenbrock23
+  };
+  Q_ENUM(IntegratorType)
+
+  /// Controller adjusting the step size between integration steps.
+  enum StepControllerType { Elementary, ProportionalIntegral };
+  Q_ENUM(StepControllerType)
+
+  /// Source of the predicted point costs used to schedule the map tiles,
+  /// Uniform schedules without predictions.
+  enum CostModelType { Uniform, PreviousRun, CoarsePrepass };
+  Q_ENUM(CostModelType)
+
   explicit IntegratorModel(QObject *parent = 0);
 
   static const QString &modelJsonKey();
@@ -51,18 +102,83 @@ public:
   static const QString &relativeToleranceJsonKey();
   static const QString &absoluteToleranceJsonKey();
   static const QString &threadCountJsonKey();
+  static const QString &integratorTypeJsonKey();
+  static const QString &stepControllerTypeJsonKey();
+  static const QString &estimateStartingStepSizeJsonKey();
+  static const QString &stiffnessSwitchingJsonKey();
+  static const QString &costModelTypeJsonKey();
+  static const QString &checkpointIntervalJsonKey();
+  static const QString &trialBudgetJsonKey();
+  static const QString &timeBudgetJsonKey();
+  static const QString &firstPassTrialBudgetJsonKey();
+  static const QString &cellMapPositionCountJsonKey();
+  static const QString &cellMapVelocityCountJsonKey();
+  static const QString &cellMapTimeJsonKey();
+  static const QString &fateCachePositionSizeJsonKey();
+  static const QString &fateCacheVelocitySizeJsonKey();
+  static const QString &fateCacheConfidenceJsonKey();
 
   double startingStepSize() const;
   double maximumStepSize() const;
   double relativeTolerance() const;
   double absoluteTolerance() const;
   int threadCount() const;
+  IntegratorType integratorType() const;
+  StepControllerType stepControllerType() const;
+  bool estimateStartingStepSize() const;
+  bool stiffnessSwitching() const;
+  CostModelType costModelType() const;
+  /// Seconds between writes of the finished tiles to the checkpoint file, an
+  /// integration with the same parameters resumes from it. 0 turns off
+  /// checkpointing. See MapCheckpoint.
+  int checkpointInterval() const;
+  /// Integration steps a point may take before it is unresolved, see
+  /// PointBudget.
+  int trialBudget() const;
+  /// Seconds a point may take before it is unresolved, 0 for no limit. See
+  /// PointBudget.
+  double timeBudget() const;
+  /// Trial budget of a first pass over all points, the points it leaves
+  /// unresolved are resumed with the full budget after the first image is
+  /// published. 0 integrates in a single pass.
+  int firstPassTrialBudget() const;
+  /// Position cells per side of the cell mapping that fills the map instead
+  /// of integrating every point, 0 integrates every point. See CellMapping.
+  int cellMapPositionCount() const;
+  /// Velocity cells per side of the cell mapping.
+  int cellMapVelocityCount() const;
+  /// Time every cell of the cell mapping is integrated for.
+  double cellMapTime() const;
+  /// Position size of the phase space cells of the fate cache shared by the
+  /// points being integrated, 0 integrates every point to convergence. See
+  /// FateCache.
+  double fateCachePositionSize() const;
+  /// Velocity size of the cells of the fate cache.
+  double fateCacheVelocitySize() const;
+  /// Number of agreeing trajectories a cell of the fate cache needs before
+  /// points stop on it.
+  int fateCacheConfidence() const;
 
   void setStartingStepSize(double startingStepSize);
   void setMaximumStepSize(double maximumStepSize);
   void setRelativeTolerance(double relativeTolerance);
   void setAbsoluteTolerance(double absoluteTolerance);
   void setThreadCount(int threadCount);
+  void setIntegratorType(IntegratorType integratorType);
+  void setStepControllerType(StepControllerType stepControllerType);
+  void setEstimateStartingStepSize(bool estimateStartingStepSize);
+  void setStiffnessSwitching(bool stiffnessSwitching);
+  void setCostModelType(CostModelType costModelType);
+  void setCheckpointInterval(int checkpointInterval);
+  void setTrialBudget(int trialBudget);
+  void setTimeBudget(double timeBudget);
+  void setFirstPassTrialBudget(int firstPassTrialBudget);
+  void setCellMapPositionCount(int cellMapPositionCount);
+  void setCellMapVelocityCount(int cellMapVelocityCount);
+  void setCellMapTime(double cellMapTime);
+  void setFateCachePositionSize(double fateCachePositionSize);
+  void setFateCacheVelocitySize(double fateCacheVelocitySize);
+  void setFateCacheConfidence(int fateCacheConfidence);
 
   void read(const QJsonObject &json);
   void write(QJsonObject &json) const;
@@ -73,6 +189,21 @@ signals:
   void relativeToleranceChanged(double relativeTolerance);
   void absoluteToleranceChanged(double absoluteTolerance);
   void threadCountChanged(int threadCount);
+  void integratorTypeChanged(IntegratorType integratorType);
+  void stepControllerTypeChanged(StepControllerType stepControllerType);
+  void estimateStartingStepSizeChanged(bool estimateStartingStepSize);
+  void stiffnessSwitchingChanged(bool stiffnessSwitching);
+  void costModelTypeChanged(CostModelType costModelType);
+  void checkpointIntervalChanged(int checkpointInterval);
+  void trialBudgetChanged(int trialBudget);
+  void timeBudgetChanged(double timeBudget);
+  void firstPassTrialBudgetChanged(int firstPassTrialBudget);
+  void cellMapPositionCountChanged(int cellMapPositionCount);
+  void cellMapVelocityCountChanged(int cellMapVelocityCount);
+  void cellMapTimeChanged(double cellMapTime);
+  void fateCachePositionSizeChanged(double fateCachePositionSize);
+  void fateCacheVelocitySizeChanged(double fateCacheVelocitySize);
+  void fateCacheConfidenceChanged(int fateCacheConfidence);
 
 private:
   double m_startingStepSize;
@@ -80,6 +211,21 @@ private:
   double m_relativeTolerance;
   double m_absoluteTolerance;
   int m_threadCount;
+  IntegratorType m_integratorType;
+  StepControllerType m_stepControllerType;
+  bool m_estimateStartingStepSize;
+  bool m_stiffnessSwitching;
+  CostModelType m_costModelType;
+  int m_checkpointInterval;
+  int m_trialBudget;
+  double m_timeBudget;
+  int m_firstPassTrialBudget;
+  int m_cellMapPositionCount;
+  int m_cellMapVelocityCount;
+  double m_cellMapTime;
+  double m_fateCachePositionSize;
+  double m_fateCacheVelocitySize;
+  int m_fateCacheConfidence;
 };
 } // namespace staticpendulum
 #endif // INTEGRATORMODEL_H
@@ -32,7 +32,10 @@ PendulumMapModel::PendulumMapModel(QObject *parent)
       m_yEnd(10.0), m_resolution(0.05), m_attractorPosThreshold(0.5),
       m_midPosThreshold(0.1), m_convergeTimeThreshold(5.0),
       m_midConvergeColor(QColor(0, 0, 0)),
-      m_outOfBoundsColor(QColor(255, 255, 255)) {}
+      m_outOfBoundsColor(QColor(255, 255, 255)),
+      m_unresolvedColor(QColor(128, 128, 128)), m_minimumFillSize(0),
+      m_supersampleCount(0), m_progressiveRendering(false),
+      m_symmetryReduction(false), m_diskMemoryBudget(0) {}
 
 const QString &PendulumMapModel::modelJsonKey()
 {
@@ -90,6 +93,36 @@ const QString &PendulumMapModel::outOfBoundsColorJsonKey() {
   return key;
 }
 
+const QString &PendulumMapModel::unresolvedColorJsonKey() {
+  static const QString key("unresolvedColor");
+  return key;
+}
+
+const QString &PendulumMapModel::minimumFillSizeJsonKey() {
+  static const QString key("minimumFillSize");
+  return key;
+}
+
+const QString &PendulumMapModel::supersampleCountJsonKey() {
+  static const QString key("supersampleCount");
+  return key;
+}
+
+const QString &PendulumMapModel::progressiveRenderingJsonKey() {
+  static const QString key("progressiveRendering");
+  return key;
+}
+
+const QString &PendulumMapModel::symmetryReductionJsonKey() {
+  static const QString key("symmetryReduction");
+  return key;
+}
+
+const QString &PendulumMapModel::diskMemoryBudgetJsonKey() {
+  static const QString key("diskMemoryBudget");
+  return key;
+}
+
 double PendulumMapModel::xStart() const { return m_xStart; }
 
 double PendulumMapModel::yStart() const { return m_yStart; }
@@ -114,6 +147,22 @@ QColor PendulumMapModel::midConvergeColor() const { return m_midConvergeColor; }
 
 QColor PendulumMapModel::outOfBoundsColor() const { return m_outOfBoundsColor; }
 
+QColor PendulumMapModel::unresolvedColor() const { return m_unresolvedColor; }
+
+int PendulumMapModel::minimumFillSize() const { return m_minimumFillSize; }
+
+int PendulumMapModel::supersampleCount() const { return m_supersampleCount; }
+
+bool PendulumMapModel::progressiveRendering() const {
+  return m_progressiveRendering;
+}
+
+bool PendulumMapModel::symmetryReduction() const {
+  return m_symmetryReduction;
+}
+
+int PendulumMapModel::diskMemoryBudget() const { return m_diskMemoryBudget; }
+
 void PendulumMapModel::setXStart(double xStart) {
   if (m_xStart == xStart)
     return;
@@ -194,6 +243,54 @@ void PendulumMapModel::setOutOfBoundsColor(QColor outOfBoundsColor) {
   emit outOfBoundsColorChanged(outOfBoundsColor);
 }
 
+void PendulumMapModel::setUnresolvedColor(QColor unresolvedColor) {
+  if (m_unresolvedColor == unresolvedColor)
+    return;
+
+  m_unresolvedColor = unresolvedColor;
+  emit unresolvedColorChanged(unresolvedColor);
+}
+
+void PendulumMapModel::setMinimumFillSize(int minimumFillSize) {
+  if (m_minimumFillSize == minimumFillSize)
+    return;
+
+  m_minimumFillSize = minimumFillSize;
+  emit minimumFillSizeChanged(minimumFillSize);
+}
+
+void PendulumMapModel::setSupersampleCount(int supersampleCount) {
+  if (m_supersampleCount == supersampleCount)
+    return;
+
+  m_supersampleCount = supersampleCount;
+  emit supersampleCountChanged(supersampleCount);
+}
+
+void PendulumMapModel::setProgressiveRendering(bool progressiveRendering) {
+  if (m_progressiveRendering == progressiveRendering)
+    return;
+
+  m_progressiveRendering = progressiveRendering;
+  emit progressiveRenderingChanged(progressiveRendering);
+}
+
+void PendulumMapModel::setSymmetryReduction(bool symmetryReduction) {
+  if (m_symmetryReduction == symmetryReduction)
+    return;
+
+  m_symmetryReduction = symmetryReduction;
+  emit symmetryReductionChanged(symmetryReduction);
+}
+
+void PendulumMapModel::setDiskMemoryBudget(int diskMemoryBudget) {
+  if (m_diskMemoryBudget == diskMemoryBudget)
+    return;
+
+  m_diskMemoryBudget = diskMemoryBudget;
+  emit diskMemoryBudgetChanged(diskMemoryBudget);
+}
+
 void PendulumMapModel::read(const QJsonObject &json) {
   const JsonReader reader("pendulumMap", json);
   setXStart(reader.readProperty(xStartJsonKey()).toDouble());
@@ -206,6 +303,18 @@ void PendulumMapModel::read(const QJsonObject &json) {
       reader.readProperty(convergeTimeThresholdJsonKey()).toDouble());
   setMidConvergeColor(reader.readPropertyAsQColor(midConvergeColorJsonKey()));
   setOutOfBoundsColor(reader.readPropertyAsQColor(outOfBoundsColorJsonKey()));
+  // files saved before the unresolved color keep its default
+  if (json.contains(unresolvedColorJsonKey()))
+    setUnresolvedColor(reader.readPropertyAsQColor(unresolvedColorJsonKey()));
+  setMinimumFillSize(reader.readProperty(minimumFillSizeJsonKey()).toInt());
+  setSupersampleCount(reader.readProperty(supersampleCountJsonKey()).toInt());
+  setProgressiveRendering(
+      reader.readProperty(progressiveRenderingJsonKey(), QJsonValue::Type::Bool)
+          .toBool());
+  setSymmetryReduction(
+      reader.readProperty(symmetryReductionJsonKey(), QJsonValue::Type::Bool)
+          .toBool());
+  setDiskMemoryBudget(reader.readProperty(diskMemoryBudgetJsonKey()).toInt());
 }
 
 void PendulumMapModel::write(QJsonObject &json) const {
@@ -218,5 +327,11 @@ void PendulumMapModel::write(QJsonObject &json) const {
   json[convergeTimeThresholdJsonKey()] = convergeTimeThreshold();
   json[midConvergeColorJsonKey()] = midConvergeColor().name();
   json[outOfBoundsColorJsonKey()] = outOfBoundsColor().name();
+  json[unresolvedColorJsonKey()] = unresolvedColor().name();
+  json[minimumFillSizeJsonKey()] = minimumFillSize();
+  json[supersampleCountJsonKey()] = supersampleCount();
+  json[progressiveRenderingJsonKey()] = progressiveRendering();
+  json[symmetryReductionJsonKey()] = symmetryReduction();
+  json[diskMemoryBudgetJsonKey()] = diskMemoryBudget();
 }
 } // namespace staticpendulum
@@ -49,6 +49,18 @@ class PendulumMapModel : public QObject {
                  setMidConvergeColor NOTIFY midConvergeColorChanged)
   Q_PROPERTY(QColor outOfBoundsColor READ outOfBoundsColor WRITE
                  setOutOfBoundsColor NOTIFY outOfBoundsColorChanged)
+  Q_PROPERTY(QColor unresolvedColor READ unresolvedColor WRITE
+                 setUnresolvedColor NOTIFY unresolvedColorChanged)
+  Q_PROPERTY(int minimumFillSize READ minimumFillSize WRITE setMinimumFillSize
+                 NOTIFY minimumFillSizeChanged)
+  Q_PROPERTY(int supersampleCount READ supersampleCount WRITE
+                 setSupersampleCount NOTIFY supersampleCountChanged)
+  Q_PROPERTY(bool progressiveRendering READ progressiveRendering WRITE
+                 setProgressiveRendering NOTIFY progressiveRenderingChanged)
+  Q_PROPERTY(bool symmetryReduction READ symmetryReduction WRITE
+                 setSymmetryReduction NOTIFY symmetryReductionChanged)
+  Q_PROPERTY(int diskMemoryBudget READ diskMemoryBudget WRITE
+                 setDiskMemoryBudget NOTIFY diskMemoryBudgetChanged)
 
 public:
   explicit PendulumMapModel(QObject *parent = 0);
@@ -65,6 +77,12 @@ public:
   static const QString &convergeTimeThresholdJsonKey();
   static const QString &midConvergeColorJsonKey();
   static const QString &outOfBoundsColorJsonKey();
+  static const QString &unresolvedColorJsonKey();
+  static const QString &minimumFillSizeJsonKey();
+  static const QString &supersampleCountJsonKey();
+  static const QString &progressiveRenderingJsonKey();
+  static const QString &symmetryReductionJsonKey();
+  static const QString &diskMemoryBudgetJsonKey();
 
   double xStart() const;
   double yStart() const;
@@ -76,6 +94,27 @@ public:
   double convergeTimeThreshold() const;
   QColor midConvergeColor() const;
   QColor outOfBoundsColor() const;
+  /// Color of the points that did not converge within the trial or time
+  /// budget of the integrator, see PointBudget.
+  QColor unresolvedColor() const;
+  /// Smallest rectangle side (in points) whose interior is filled without
+  /// integrating when its border converges to one position, 0 integrates
+  /// every point. See fillRectangle.
+  int minimumFillSize() const;
+  /// Number of subsamples per side of the points on a boundary between
+  /// basins, their colors are blended in the image. 0 or 1 turns off
+  /// supersampling. See BoundarySupersamples.
+  int supersampleCount() const;
+  /// Integrate coarse lattices of the map first and write an upscaled preview
+  /// image after each of them. See latticeLevelIndices.
+  bool progressiveRendering() const;
+  /// Integrate only one of the points related by a symmetry of the attractors
+  /// and fill the others from it. See SymmetryFill.
+  bool symmetryReduction() const;
+  /// Memory (in MiB) the map results may take while they are written to a
+  /// tiled file on disk instead of memory, 0 keeps the map in memory. See
+  /// TiledMapFile.
+  int diskMemoryBudget() const;
 
   void setXStart(double xStart);
   void setYStart(double yStart);
@@ -87,6 +126,12 @@ public:
   void setConvergeTimeThreshold(double convergeTimeThreshold);
   void setMidConvergeColor(QColor midConvergeColor);
   void setOutOfBoundsColor(QColor outOfBoundsColor);
+  void setUnresolvedColor(QColor unresolvedColor);
+  void setMinimumFillSize(int minimumFillSize);
+  void setSupersampleCount(int supersampleCount);
+  void setProgressiveRendering(bool progressiveRendering);
+  void setSymmetryReduction(bool symmetryReduction);
+  void setDiskMemoryBudget(int diskMemoryBudget);
 
   void read(const QJsonObject &json);
   void write(QJsonObject &json) const;
@@ -102,6 +147,12 @@ signals:
   void convergeTimeThresholdChanged(double convergeTimeThreshold);
   void midConvergeColorChanged(QColor midConvergeColor);
   void outOfBoundsColorChanged(QColor outOfBoundsColor);
+  void unresolvedColorChanged(QColor unresolvedColor);
+  void minimumFillSizeChanged(int minimumFillSize);
+  void supersampleCountChanged(int supersampleCount);
+  void progressiveRenderingChanged(bool progressiveRendering);
+  void symmetryReductionChanged(bool symmetryReduction);
+  void diskMemoryBudgetChanged(int diskMemoryBudget);
 
 private:
   double m_xStart;
@@ -114,6 +165,12 @@ private:
   double m_convergeTimeThreshold;
   QColor m_midConvergeColor;
   QColor m_outOfBoundsColor;
+  QColor m_unresolvedColor;
+  int m_minimumFillSize;
+  int m_supersampleCount;
+  bool m_progressiveRendering;
+  bool m_symmetryReduction;
+  int m_diskMemoryBudget;
 };
 } // namespace staticpendulum
 #endif // PENDULUMMAPMODEL_H
@@ -22,10 +22,13 @@
  * THE SOFTWARE.
  * ===========================================================================*/
 #include "pendulumsystemmodel.h"
+#include "CoreEngine/attractorwells.h"
 #include "DataStorage/jsonreader.h"
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QThread>
+#include <QtDebug>
 #include <cmath>
 
 namespace staticpendulum {
@@ -75,6 +78,21 @@ const QString &PendulumSystemModel::lengthJsonKey() {
   return key;
 }
 
+const QString &PendulumSystemModel::openingAngleJsonKey() {
+  static const QString key("openingAngle");
+  return key;
+}
+
+const QString &PendulumSystemModel::forceTableMemoryBudgetJsonKey() {
+  static const QString key("forceTableMemoryBudget");
+  return key;
+}
+
+const QString &PendulumSystemModel::energyCaptureJsonKey() {
+  static const QString key("energyCapture");
+  return key;
+}
+
 const QString &PendulumSystemModel::attractorsJsonKey() {
   static const QString key("attractors");
   return key;
@@ -94,6 +112,14 @@ double PendulumSystemModel::drag() const { return m_pendulumSystem.drag; }
 
 double PendulumSystemModel::length() const { return m_pendulumSystem.length; }
 
+double PendulumSystemModel::openingAngle() const { return m_openingAngle; }
+
+double PendulumSystemModel::forceTableMemoryBudget() const {
+  return m_forceTableMemoryBudget;
+}
+
+bool PendulumSystemModel::energyCapture() const { return m_energyCapture; }
+
 PendulumSystem PendulumSystemModel::wrappedSystem() const {
   PendulumSystem result = m_pendulumSystem;
   result.attractorList.reserve(m_attractors.rowCount());
@@ -104,6 +130,30 @@ PendulumSystem PendulumSystemModel::wrappedSystem() const {
                                       iter->forceCoefficient);
   }
 
+  if (m_openingAngle > 0.0) {
+    result.attractorTree = std::make_shared<const AttractorTree>(
+        result.attractorList, m_openingAngle);
+  }
+
+  if (m_forceTableMemoryBudget > 0.0) {
+    const auto memoryBudget =
+        static_cast<std::size_t>(m_forceTableMemoryBudget * 1024.0 * 1024.0);
+    result.forceTable = std::make_shared<const ForceFieldTable>(
+        result, memoryBudget,
+        static_cast<unsigned>(std::max(QThread::idealThreadCount(), 1)));
+    qInfo() << QString("Force table of %1 x %1 nodes, maximum interpolation "
+                       "error %2 (largest force %3).")
+                   .arg(result.forceTable->nodeCount())
+                   .arg(result.forceTable->maximumError())
+                   .arg(result.forceTable->maximumForce());
+  }
+
+  if (m_energyCapture) {
+    result.wells = std::make_shared<const AttractorWells>(result);
+    qInfo() << QString("Energy capture with %1 potential wells.")
+                   .arg(result.wells->wells().size());
+  }
+
   return result;
 }
 
@@ -147,6 +197,31 @@ void PendulumSystemModel::setLength(double length) {
   emit lengthChanged(length);
 }
 
+void PendulumSystemModel::setOpeningAngle(double openingAngle) {
+  if (m_openingAngle == openingAngle)
+    return;
+
+  m_openingAngle = openingAngle;
+  emit openingAngleChanged(openingAngle);
+}
+
+void PendulumSystemModel::setForceTableMemoryBudget(
+    double forceTableMemoryBudget) {
+  if (m_forceTableMemoryBudget == forceTableMemoryBudget)
+    return;
+
+  m_forceTableMemoryBudget = forceTableMemoryBudget;
+  emit forceTableMemoryBudgetChanged(forceTableMemoryBudget);
+}
+
+void PendulumSystemModel::setEnergyCapture(bool energyCapture) {
+  if (m_energyCapture == energyCapture)
+    return;
+
+  m_energyCapture = energyCapture;
+  emit energyCaptureChanged(energyCapture);
+}
+
 void PendulumSystemModel::read(const QJsonObject &json) {
   const JsonReader reader("pendulumSystem", json);
   setDistance(reader.readProperty(distanceJsonKey()).toDouble());
@@ -154,6 +229,12 @@ void PendulumSystemModel::read(const QJsonObject &json) {
   setGravity(reader.readProperty(gravityJsonKey()).toDouble());
   setDrag(reader.readProperty(dragJsonKey()).toDouble());
   setLength(reader.readProperty(dragJsonKey()).toDouble());
+  setOpeningAngle(reader.readProperty(openingAngleJsonKey()).toDouble());
+  setForceTableMemoryBudget(
+      reader.readProperty(forceTableMemoryBudgetJsonKey()).toDouble());
+  setEnergyCapture(
+      reader.readProperty(energyCaptureJsonKey(), QJsonValue::Type::Bool)
+          .toBool());
 
   const QJsonValue attractorsJson =
       reader.readProperty(attractorsJsonKey(), QJsonValue::Type::Array);
@@ -170,6 +251,9 @@ void PendulumSystemModel::write(QJsonObject &json) const {
   json[gravityJsonKey()] = gravity();
   json[dragJsonKey()] = drag();
   json[lengthJsonKey()] = length();
+  json[openingAngleJsonKey()] = openingAngle();
+  json[forceTableMemoryBudgetJsonKey()] = forceTableMemoryBudget();
+  json[energyCaptureJsonKey()] = energyCapture();
   QJsonArray attractorsJsonArr = QJsonArray();
   m_attractors.write(attractorsJsonArr);
   json[attractorsJsonKey()] = attractorsJsonArr;
@@ -41,6 +41,12 @@ class PendulumSystemModel : public QObject {
   Q_PROPERTY(double gravity READ gravity WRITE setGravity NOTIFY gravityChanged)
   Q_PROPERTY(double drag READ drag WRITE setDrag NOTIFY dragChanged)
   Q_PROPERTY(double length READ length WRITE setLength NOTIFY lengthChanged)
+  Q_PROPERTY(double openingAngle READ openingAngle WRITE setOpeningAngle NOTIFY
+                 openingAngleChanged)
+  Q_PROPERTY(double forceTableMemoryBudget READ forceTableMemoryBudget WRITE
+                 setForceTableMemoryBudget NOTIFY forceTableMemoryBudgetChanged)
+  Q_PROPERTY(bool energyCapture READ energyCapture WRITE setEnergyCapture
+                 NOTIFY energyCaptureChanged)
 public:
   explicit PendulumSystemModel(QObject *parent = 0);
 
@@ -51,6 +57,9 @@ public:
   const static QString &gravityJsonKey();
   const static QString &dragJsonKey();
   const static QString &lengthJsonKey();
+  const static QString &openingAngleJsonKey();
+  const static QString &forceTableMemoryBudgetJsonKey();
+  const static QString &energyCaptureJsonKey();
   const static QString &attractorsJsonKey();
 
   AttractorListModel *attractors();
@@ -59,16 +68,30 @@ public:
   double gravity() const;
   double drag() const;
   double length() const;
+  double openingAngle() const;
+  double forceTableMemoryBudget() const;
+  /// Stop integrating a point once its energy is below the heuristic capture
+  /// energy of the potential well of an attractor, see AttractorWells. Off by
+  /// default.
+  bool energyCapture() const;
 
   void setDistance(double distance);
   void setMass(double mass);
   void setGravity(double gravity);
   void setDrag(double drag);
   void setLength(double length);
+  void setOpeningAngle(double openingAngle);
+  void setForceTableMemoryBudget(double forceTableMemoryBudget);
+  void setEnergyCapture(bool energyCapture);
 
   void read(const QJsonObject &json);
   void write(QJsonObject &json) const;
 
+  /// Copy of the system for integration, when the opening angle is greater
+  /// than 0 it carries an AttractorTree built from the current attractors and
+  /// when the force table memory budget (in MiB) is greater than 0 it carries
+  /// a ForceFieldTable of the system. With energy capture it carries the
+  /// AttractorWells of the system.
   PendulumSystem wrappedSystem() const;
 
 signals:
@@ -77,10 +100,16 @@ signals:
   void gravityChanged(double gravity);
   void dragChanged(double drag);
   void lengthChanged(double length);
+  void openingAngleChanged(double openingAngle);
+  void forceTableMemoryBudgetChanged(double forceTableMemoryBudget);
+  void energyCaptureChanged(bool energyCapture);
 
 private:
   AttractorListModel m_attractors;
   PendulumSystem m_pendulumSystem;
+  double m_openingAngle = 0.0;
+  double m_forceTableMemoryBudget = 0.0;
+  bool m_energyCapture = false;
 };
 } // namespace staticpendulum
 #endif // PENDULUMSYSTEMMODEL_H
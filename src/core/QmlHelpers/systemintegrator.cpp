@@ -22,46 +22,182 @@
  * THE SOFTWARE.
  * ===========================================================================*/
 #include "systemintegrator.h"
+#include "CoreEngine/attractorgrid.h"
+#include "CoreEngine/bogackishampine32.h"
 #include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/cellmapping.h"
+#include "CoreEngine/costmodel.h"
+#include "CoreEngine/dormandprince54.h"
+#include "CoreEngine/dormandprince853.h"
+#include "CoreEngine/fatecache.h"
+#include "CoreEngine/mapcheckpoint.h"
+#include "CoreEngine/rosenbrock23.h"
+#include "CoreEngine/stepsizecontroller.h"
+#include "CoreEngine/stiffnessswitching.h"
+#include "CoreEngine/supersampling.h"
+#include "CoreEngine/symmetry.h"
+#include "CoreEngine/tiledmapfile.h"
+#include "CoreEngine/tilescheduler.h"
+#include "CoreEngine/vectorizedpendulumsystem.h"
+#include "CoreEngine/verner65.h"
 #include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pointselection.h"
+#include "CoreEngine/progressiverender.h"
+#include "CoreEngine/rectanglefill.h"
 #include <QFutureWatcher>
 #include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtDebug>
 #include <QtConcurrent/QtConcurrent>
+#include <chrono>
+#include <functional>
+#include <mutex>
 
 namespace staticpendulum {
+namespace {
+// integrates the points of a range of a map (or of a copy of some of its
+// points), skipping points that are not integrable
+using PointsFunction = std::function<void(PointIterator, PointIterator)>;
+
+// same as PointsFunction, also taking the progress of the points of the range
+// (or null) to resume and suspend them, see integratePoint
+using ResumablePointsFunction =
+    std::function<void(PointIterator, PointIterator, PointProgress *)>;
+
+// image of the map, every pixel takes the color of the upper left point of its
+// latticeStep x latticeStep block (only those are integrated while rendering
+// progressively)
+QImage createImage(const Map &map, const std::map<int, QColor> &colorMap,
+                   std::size_t latticeStep) {
+  const auto rows = map.rows();
+  const auto cols = map.cols();
+  QImage image(cols, rows, QImage::Format_RGB32);
+
+  for (std::size_t y = 0; y < rows; ++y) {
+    const std::size_t latticeRowIndex = (y - y % latticeStep) * cols;
+    for (std::size_t x = 0; x < cols; ++x) {
+      const int convergePosition =
+          map.convergePosition(latticeRowIndex + x - x % latticeStep);
+      image.setPixelColor(x, y, colorMap.at(convergePosition));
+    }
+  }
+
+  return image;
+}
+
+// json of the pendulum system without the attractor colors, which only change
+// the image
+QJsonObject systemResultsJson(const PendulumSystemModel &pendulumSystemModel) {
+  QJsonObject systemJson;
+  pendulumSystemModel.write(systemJson);
+  QJsonArray attractorsJson =
+      systemJson[PendulumSystemModel::attractorsJsonKey()].toArray();
+  for (int i = 0; i < attractorsJson.size(); ++i) {
+    QJsonObject attractorJson = attractorsJson[i].toObject();
+    attractorJson.remove(AttractorModel::colorJsonKey());
+    attractorsJson[i] = attractorJson;
+  }
+  systemJson[PendulumSystemModel::attractorsJsonKey()] = attractorsJson;
+  return systemJson;
+}
+
+// saves the image as a png through a temporary file that replaces the file at
+// path once complete, so QML never loads a half written image
+bool saveImage(const QImage &image, const QString &path) {
+  QSaveFile file(path);
+  return file.open(QIODevice::WriteOnly) && image.save(&file, "PNG") &&
+         file.commit();
+}
+
+// hash of the parameters the map results depend on, a checkpoint is only
+// resumed by an integration with the same hash
+std::uint64_t checkpointHash(const PendulumSystemModel &pendulumSystemModel,
+                             const PendulumMapModel &pendulumMapModel,
+                             const IntegratorModel &integratorModel) {
+  const QJsonObject systemJson = systemResultsJson(pendulumSystemModel);
+  QJsonObject mapJson;
+  pendulumMapModel.write(mapJson);
+  mapJson.remove(PendulumMapModel::midConvergeColorJsonKey());
+  mapJson.remove(PendulumMapModel::outOfBoundsColorJsonKey());
+  mapJson.remove(PendulumMapModel::unresolvedColorJsonKey());
+  mapJson.remove(PendulumMapModel::supersampleCountJsonKey());
+  QJsonObject integratorJson;
+  integratorModel.write(integratorJson);
+  integratorJson.remove(IntegratorModel::threadCountJsonKey());
+  integratorJson.remove(IntegratorModel::costModelTypeJsonKey());
+  integratorJson.remove(IntegratorModel::checkpointIntervalJsonKey());
+
+  QJsonObject json;
+  json[PendulumSystemModel::modelJsonKey()] = systemJson;
+  json[PendulumMapModel::modelJsonKey()] = mapJson;
+  json[IntegratorModel::modelJsonKey()] = integratorJson;
+  return parameterHash(
+      QJsonDocument(json).toJson(QJsonDocument::Compact).toStdString());
+}
+
+// hash of the parameters the images of a cell mapping depend on, the cells
+// are reused by an integration with the same hash
+std::uint64_t cellMappingHash(const PendulumSystemModel &pendulumSystemModel,
+                              const IntegratorModel &integratorModel) {
+  const QJsonObject systemJson = systemResultsJson(pendulumSystemModel);
+  QJsonObject integratorJson;
+  integratorModel.write(integratorJson);
+  integratorJson.remove(IntegratorModel::threadCountJsonKey());
+  integratorJson.remove(IntegratorModel::costModelTypeJsonKey());
+  integratorJson.remove(IntegratorModel::checkpointIntervalJsonKey());
+  integratorJson.remove(IntegratorModel::timeBudgetJsonKey());
+  integratorJson.remove(IntegratorModel::firstPassTrialBudgetJsonKey());
+  integratorJson.remove(IntegratorModel::fateCachePositionSizeJsonKey());
+  integratorJson.remove(IntegratorModel::fateCacheVelocitySizeJsonKey());
+  integratorJson.remove(IntegratorModel::fateCacheConfidenceJsonKey());
+
+  QJsonObject json;
+  json[PendulumSystemModel::modelJsonKey()] = systemJson;
+  json[IntegratorModel::modelJsonKey()] = integratorJson;
+  return parameterHash(
+      QJsonDocument(json).toJson(QJsonDocument::Compact).toStdString());
+}
+
+// largest side of the preview image written for maps integrated to disk
+constexpr std::size_t diskPreviewSize = 4096;
+}
+
 SystemIntegrator::SystemIntegrator(QObject *parent) : QObject(parent) {
   QObject::connect(&m_futureWatcher, &QFutureWatcher<void>::finished, this,
                    &SystemIntegrator::createImageFile);
-  QObject::connect(&m_futureWatcher,
-                   &QFutureWatcher<void>::progressValueChanged, this,
-                   &SystemIntegrator::setProgressValue);
-  QObject::connect(&m_futureWatcher,
-                   &QFutureWatcher<void>::progressRangeChanged, this,
-                   [this](int minimum, int maximum) {
-                     setProgressMinimum(minimum);
-                     setProgressMaximum(maximum);
-                   });
+  QObject::connect(&m_progressTimer, &QTimer::timeout, this,
+                   &SystemIntegrator::updateProgress);
 }
 
-int SystemIntegrator::progressValue() const { return m_progressValue; }
+qint64 SystemIntegrator::progressValue() const { return m_progressValue; }
 
-int SystemIntegrator::progressMinimum() const { return m_progressMinimum; }
+qint64 SystemIntegrator::progressMinimum() const { return m_progressMinimum; }
 
-int SystemIntegrator::progressMaximum() const { return m_progressMaximum; }
+qint64 SystemIntegrator::progressMaximum() const { return m_progressMaximum; }
 
 void SystemIntegrator::integrateMap(PendulumSystemModel *pendulumSystemModel,
                                     PendulumMapModel *pendulumMapModel,
                                     IntegratorModel *integratorModel) {
-  const auto pendulumSystem = pendulumSystemModel->wrappedSystem();
+  auto pendulumSystem = pendulumSystemModel->wrappedSystem();
+  // the points of this integration share the fates of the phase space cells
+  // they resolve
+  std::shared_ptr<FateCache> fateCache;
+  if (integratorModel->fateCachePositionSize() > 0.0 &&
+      integratorModel->fateCacheVelocitySize() > 0.0) {
+    fateCache = std::make_shared<FateCache>(
+        integratorModel->fateCachePositionSize(),
+        integratorModel->fateCacheVelocitySize(),
+        integratorModel->fateCacheConfidence());
+    pendulumSystem.fateCache = fateCache;
+  }
+
   const double relTol = integratorModel->relativeTolerance();
   const double absTol = integratorModel->absoluteTolerance();
   const double maxStepSize = integratorModel->maximumStepSize();
 
-  // partially apply the cashKarp54 integrator function
-  auto integrator = [=](auto &&dxdt, auto &x, auto &t, auto &h) {
-    return cashKarp54(dxdt, x, t, h, relTol, absTol, maxStepSize);
-  };
-
   const double startingStepSize = integratorModel->startingStepSize();
   const double attractorPosThreshold =
       pendulumMapModel->attractorPosThreshold();
@@ -69,24 +205,319 @@ void SystemIntegrator::integrateMap(PendulumSystemModel *pendulumSystemModel,
   const double convergeTimeThreshold =
       pendulumMapModel->convergeTimeThreshold();
 
-  // partially apply the integratePoint function
-  auto integratePoint = [=](staticpendulum::Point &point) {
-    staticpendulum::integratePoint(integrator, pendulumSystem, point,
-                                   startingStepSize, attractorPosThreshold,
-                                   midPosThreshold, convergeTimeThreshold);
+  // with many attractors the one the head is near is found from a grid with
+  // cells of twice the threshold instead of testing every attractor
+  if (pendulumSystem.attractorList.size() >=
+      AttractorGrid::minimumAttractorCount) {
+    pendulumSystem.attractorGrid = std::make_shared<const AttractorGrid>(
+        pendulumSystem.attractorList, 2.0 * attractorPosThreshold);
+  }
+
+  const bool estimateStartingStepSize =
+      integratorModel->estimateStartingStepSize();
+  const bool stiffnessSwitching = integratorModel->stiffnessSwitching();
+
+  // the scheduler is created first, its cancellation flag stops the points
+  // being integrated within milliseconds of a cancel
+  const auto threadCount =
+      static_cast<unsigned>(std::max(integratorModel->threadCount(), 1));
+  m_scheduler = std::make_shared<TileScheduler>(threadCount);
+  PointBudget budget;
+  budget.trialCount = std::max(integratorModel->trialBudget(), 1);
+  budget.time = std::chrono::duration_cast<PointBudget::Clock::duration>(
+      std::chrono::duration<double>(
+          std::max(integratorModel->timeBudget(), 0.0)));
+  budget.cancelled = &m_scheduler->cancelledFlag();
+
+  // returns the starting step size estimator of the given method (tableau)
+  // for the system, see initialStepSize
+  auto makeStepSizeEstimator = [=](const auto &system, auto method) {
+    using SystemType = std::decay_t<decltype(system)>;
+    using Method = decltype(method);
+    return [=](const SystemType &dxdt, const PendulumSystem::StateType &state,
+               const PendulumSystem::StateType &derivative) {
+      return initialStepSize<Method>(dxdt, state, derivative, 0.0, relTol,
+                                     absTol, maxStepSize);
+    };
+  };
+
+  // returns a function integrating a range of points one by one with the
+  // given scalar integrator (copied for every point), used by the integrators
+  // whose points cannot advance in lockstep
+  auto makeScalarRangeIntegrator = [=](const auto &system, auto integrator,
+                                       auto estimateStepSize,
+                                       const PointBudget &pointBudget)
+      -> ResumablePointsFunction {
+    return [=](PointIterator first, PointIterator last,
+               PointProgress *progress) {
+      for (auto point = first; point != last; ++point) {
+        PointProgress *const pointProgress =
+            progress ? progress + (point - first) : nullptr;
+        if (estimateStartingStepSize) {
+          staticpendulum::integratePoint(
+              integrator, system, *point, estimateStepSize,
+              attractorPosThreshold, midPosThreshold, convergeTimeThreshold,
+              pointBudget, pointProgress);
+        } else {
+          staticpendulum::integratePoint(
+              integrator, system, *point, startingStepSize,
+              attractorPosThreshold, midPosThreshold, convergeTimeThreshold,
+              pointBudget, pointProgress);
+        }
+      }
+    };
   };
 
-  QThreadPool::globalInstance()->setMaxThreadCount(
-      integratorModel->threadCount());
+  // returns a function integrating a range of points with the explicit Runge
+  // Kutta method of the given tableau and the given step size controller,
+  // nativeLaneCount points of the range are advanced together in lockstep
+  // unless trajectories may switch to the implicit integrator
+  auto makeRangeIntegrator = [=](const auto &system, auto tableau,
+                               auto controller, const PointBudget &pointBudget)
+      -> ResumablePointsFunction {
+    using Tableau = decltype(tableau);
+    using Controller = decltype(controller);
+    const auto estimateStepSize = makeStepSizeEstimator(system, tableau);
+    if (stiffnessSwitching) {
+      return makeScalarRangeIntegrator(
+          system,
+          StiffnessSwitchingIntegrator<Tableau, 4, Controller>(
+              relTol, absTol, maxStepSize),
+          estimateStepSize, pointBudget);
+    }
+
+    // partially apply the batched integrator function
+    auto integrator = [=](auto &&dxdt, auto &x, auto &dxdtx, auto &t, auto &h,
+                          auto &accepted, auto &controllers) {
+      explicitRungeKuttaBatch<Tableau>(dxdt, x, dxdtx, t, h, accepted, relTol,
+                                       absTol, maxStepSize, controllers);
+    };
 
-  // set the point map
-  m_pointMap = staticpendulum::Map(
-      pendulumMapModel->xStart(), pendulumMapModel->yStart(),
-      pendulumMapModel->xEnd(), pendulumMapModel->yEnd(),
-      pendulumMapModel->resolution());
+    return [=](PointIterator first, PointIterator last,
+               PointProgress *progress) {
+      if (estimateStartingStepSize) {
+        staticpendulum::integratePoints<nativeLaneCount, Controller>(
+            integrator, system, first, last, estimateStepSize,
+            attractorPosThreshold, midPosThreshold, convergeTimeThreshold,
+            pointBudget, progress);
+      } else {
+        staticpendulum::integratePoints<nativeLaneCount, Controller>(
+            integrator, system, first, last, startingStepSize,
+            attractorPosThreshold, midPosThreshold, convergeTimeThreshold,
+            pointBudget, progress);
+      }
+    };
+  };
+
+  // same as makeRangeIntegrator for the implicit Rosenbrock integrator
+  auto makeRosenbrockRangeIntegrator = [=](const auto &system, auto method,
+                                         auto controller,
+                                         const PointBudget &pointBudget)
+      -> ResumablePointsFunction {
+    using SystemType = std::decay_t<decltype(system)>;
+    auto integrator = [
+      =, derivative = PendulumSystem::StateType(), hasDerivative = false
+    ](const SystemType &dxdt, PendulumSystem::StateType &x, double &t,
+      double &h) mutable {
+      if (!hasDerivative) {
+        dxdt(x, derivative, t);
+        hasDerivative = true;
+      }
+
+      return rosenbrock23(dxdt, x, derivative, t, h, relTol, absTol,
+                          maxStepSize, controller);
+    };
+
+    return makeScalarRangeIntegrator(system, integrator,
+                                     makeStepSizeEstimator(system, method),
+                                     pointBudget);
+  };
+
+  // picks the system type specialised for the attractor count and the step
+  // size controller for the method
+  const auto controllerType = integratorModel->stepControllerType();
+  auto makeControlledRangeIntegrator = [=](auto makeIntegrator, auto method,
+                                           const PointBudget &pointBudget)
+      -> ResumablePointsFunction {
+    return withSpecialisedSystem(
+        pendulumSystem,
+        [=](const auto &system) -> ResumablePointsFunction {
+          if (controllerType == IntegratorModel::ProportionalIntegral) {
+            return makeIntegrator(system, method,
+                                  ProportionalIntegralStepController(),
+                                  pointBudget);
+          }
+
+          return makeIntegrator(system, method, ElementaryStepController(),
+                                pointBudget);
+        });
+  };
+
+  const auto integratorType = integratorModel->integratorType();
+  auto makeIntegrateRange = [=](const PointBudget &pointBudget)
+      -> ResumablePointsFunction {
+    switch (integratorType) {
+    case IntegratorModel::CashKarp54:
+      return makeControlledRangeIntegrator(makeRangeIntegrator,
+                                           CashKarp54Tableau(), pointBudget);
+    case IntegratorModel::DormandPrince54:
+      return makeControlledRangeIntegrator(
+          makeRangeIntegrator, DormandPrince54Tableau(), pointBudget);
+    case IntegratorModel::BogackiShampine32:
+      return makeControlledRangeIntegrator(
+          makeRangeIntegrator, BogackiShampine32Tableau(), pointBudget);
+    case IntegratorModel::Verner65:
+      return makeControlledRangeIntegrator(makeRangeIntegrator,
+                                           Verner65Tableau(), pointBudget);
+    case IntegratorModel::DormandPrince853:
+      return makeControlledRangeIntegrator(
+          makeRangeIntegrator, DormandPrince853Tableau(), pointBudget);
+    case IntegratorModel::Rosenbrock23:
+      return makeControlledRangeIntegrator(
+          makeRosenbrockRangeIntegrator, Rosenbrock23Method(), pointBudget);
+    }
+
+    return ResumablePointsFunction();
+  };
+
+  const ResumablePointsFunction integrateResumableRange =
+      makeIntegrateRange(budget);
+  const PointsFunction integrateRange =
+      [integrateResumableRange](PointIterator first, PointIterator last) {
+        integrateResumableRange(first, last, nullptr);
+      };
+
+  // the first of two passes suspends the points running out of its budget,
+  // the second resumes them with the full budget
+  const int firstPassTrialBudget = integratorModel->firstPassTrialBudget();
+  ResumablePointsFunction integrateFirstPass;
+  if (firstPassTrialBudget > 0) {
+    PointBudget firstPassBudget = budget;
+    firstPassBudget.trialCount = firstPassTrialBudget;
+    firstPassBudget.suspendsPoints = true;
+    integrateFirstPass = makeIntegrateRange(firstPassBudget);
+  }
+
+  // returns the flow of a state over the cell mapping time (see CellMapping)
+  // taking steps with step(system, state, derivative, time, stepSize,
+  // controller)
+  const double cellMapTime = integratorModel->cellMapTime();
+  auto makeCellFlow = [=](auto step) -> CellFlow {
+    return withSpecialisedSystem(
+        pendulumSystem, [=](const auto &system) -> CellFlow {
+          return [=](PendulumSystem::StateType &state) {
+            PendulumSystem::StateType derivative;
+            system(state, derivative, 0.0);
+            ElementaryStepController elementaryController;
+            ProportionalIntegralStepController proportionalIntegralController;
+            auto integrator = [&](const auto &dxdt,
+                                  PendulumSystem::StateType &x, double &t,
+                                  double &h) {
+              if (controllerType == IntegratorModel::ProportionalIntegral) {
+                return step(dxdt, x, derivative, t, h,
+                            proportionalIntegralController);
+              }
+
+              return step(dxdt, x, derivative, t, h, elementaryController);
+            };
+            return advanceState(integrator, system, state, cellMapTime,
+                                startingStepSize, budget.trialCount);
+          };
+        });
+  };
+
+  auto makeExplicitCellFlow = [=](auto tableau) -> CellFlow {
+    using Tableau = decltype(tableau);
+    return makeCellFlow([=](const auto &dxdt, auto &x, auto &derivative,
+                            auto &t, auto &h, auto &controller) {
+      return explicitRungeKutta<Tableau>(dxdt, x, derivative, t, h, relTol,
+                                         absTol, maxStepSize, controller);
+    });
+  };
+
+  auto makeIntegrateCells = [=]() -> CellFlow {
+    switch (integratorType) {
+    case IntegratorModel::CashKarp54:
+      return makeExplicitCellFlow(CashKarp54Tableau());
+    case IntegratorModel::DormandPrince54:
+      return makeExplicitCellFlow(DormandPrince54Tableau());
+    case IntegratorModel::BogackiShampine32:
+      return makeExplicitCellFlow(BogackiShampine32Tableau());
+    case IntegratorModel::Verner65:
+      return makeExplicitCellFlow(Verner65Tableau());
+    case IntegratorModel::DormandPrince853:
+      return makeExplicitCellFlow(DormandPrince853Tableau());
+    case IntegratorModel::Rosenbrock23:
+      return makeCellFlow([=](const auto &dxdt, auto &x, auto &derivative,
+                              auto &t, auto &h, auto &controller) {
+        return rosenbrock23(dxdt, x, derivative, t, h, relTol, absTol,
+                            maxStepSize, controller);
+      });
+    }
+
+    return CellFlow();
+  };
+
+  // the step counts of the previous run predict the costs of this one
+  const auto costModelType = integratorModel->costModelType();
+  std::shared_ptr<const StepCountCostModel> previousRunCostModel;
+  if (costModelType == IntegratorModel::PreviousRun &&
+      m_pointMap.begin() != m_pointMap.end()) {
+    previousRunCostModel =
+        std::make_shared<const StepCountCostModel>(m_pointMap);
+  }
+
+  // set the point map, maps integrated to disk are never held in memory
+  const auto diskMemoryBudget =
+      static_cast<std::uint64_t>(std::max(pendulumMapModel->diskMemoryBudget(),
+                                          0))
+      << 20;
+  m_isDiskMap = diskMemoryBudget > 0;
+  if (m_isDiskMap) {
+    m_pointMap = staticpendulum::Map();
+  } else {
+    m_pointMap = staticpendulum::Map(
+        pendulumMapModel->xStart(), pendulumMapModel->yStart(),
+        pendulumMapModel->xEnd(), pendulumMapModel->yEnd(),
+        pendulumMapModel->resolution());
+  }
+
+  // the cells of the previous cell mapping are reused while the system and
+  // the integrator are unchanged
+  std::shared_ptr<CellMapping> cellMapping;
+  CellFlow integrateCells;
+  const auto cellMapPositionCount =
+      static_cast<std::size_t>(std::max(integratorModel->cellMapPositionCount(),
+                                        0));
+  if (cellMapPositionCount > 0 && !m_isDiskMap) {
+    const auto cellMapVelocityCount = static_cast<std::size_t>(
+        std::max(integratorModel->cellMapVelocityCount(), 1) | 1);
+    const double cellCount = static_cast<double>(cellMapPositionCount) *
+                             static_cast<double>(cellMapPositionCount) *
+                             static_cast<double>(cellMapVelocityCount) *
+                             static_cast<double>(cellMapVelocityCount);
+    const std::uint64_t hash =
+        cellMappingHash(*pendulumSystemModel, *integratorModel);
+    if (cellCount > static_cast<double>(CellMapping::maximumCellCount)) {
+      qCritical() << QString("A cell mapping of %1 cells is too large, "
+                             "integrating every point.")
+                         .arg(cellCount);
+    } else {
+      if (!m_cellMapping || !m_cellMapping->isMapped() ||
+          m_cellMappingHash != hash) {
+        m_cellMapping = std::make_shared<CellMapping>(
+            pendulumSystem, cellMapPositionCount, cellMapVelocityCount,
+            cellMapTime);
+        m_cellMappingHash = hash;
+      }
+      cellMapping = m_cellMapping;
+      integrateCells = makeIntegrateCells();
+    }
+  }
 
   // create the color map to be used
   m_colorMap.clear();
+  m_colorMap[unresolvedPosition] = pendulumMapModel->unresolvedColor();
   m_colorMap[-2] = pendulumMapModel->outOfBoundsColor();
   m_colorMap[-1] = pendulumMapModel->midConvergeColor();
   int index = 0;
@@ -95,38 +526,406 @@ void SystemIntegrator::integrateMap(PendulumSystemModel *pendulumSystemModel,
     ++index;
   }
 
-  // start integrating the points
-  m_futureWatcher.setFuture(
-      QtConcurrent::map(m_pointMap.begin(), m_pointMap.end(), integratePoint));
+  // start integrating the points, the scheduler runs its threads from a
+  // single pool thread
+  setProgressMinimum(0);
+  setProgressMaximum(0);
+  setProgressValue(0);
+  m_progressTimer.start(progressInterval);
+
+  auto scheduler = m_scheduler;
+  Map *pointMap = &m_pointMap;
+  const auto minimumFillSize =
+      static_cast<std::size_t>(pendulumMapModel->minimumFillSize());
+  m_supersamples = BoundarySupersamples();
+  BoundarySupersamples *supersamples = &m_supersamples;
+  const auto supersampleCount = static_cast<std::size_t>(
+      std::max(pendulumMapModel->supersampleCount(), 0));
+  const bool progressiveRendering = pendulumMapModel->progressiveRendering();
+  const bool symmetryReduction = pendulumMapModel->symmetryReduction();
+  const auto colorMap = m_colorMap;
+  const QString previewPath =
+      qApp->applicationDirPath() + "/last_preview.png";
+  const QString applicationDirPath = qApp->applicationDirPath();
+  const double xStart = pendulumMapModel->xStart();
+  const double yStart = pendulumMapModel->yStart();
+  const double xEnd = pendulumMapModel->xEnd();
+  const double yEnd = pendulumMapModel->yEnd();
+  const double resolution = pendulumMapModel->resolution();
+  const auto checkpointInterval =
+      std::chrono::seconds(integratorModel->checkpointInterval());
+  const std::uint64_t parametersHash =
+      checkpointInterval.count() > 0
+          ? checkpointHash(*pendulumSystemModel, *pendulumMapModel,
+                           *integratorModel)
+          : 0;
+  m_futureWatcher.setFuture(QtConcurrent::run([=]() {
+    auto integrateMapRows = [&integrateRange](Map &map) {
+      Map *theMap = &map;
+      return [theMap, &integrateRange](const Tile &row) {
+        const auto rowBegin = theMap->rowBegin(row.firstRow);
+        integrateMapPoints(rowBegin + row.firstColumn,
+                           rowBegin + row.lastColumn, integrateRange);
+      };
+    };
+
+    auto integrateSelectionRows = [&integrateResumableRange,
+                                   pointMap](PointSelection &selection) {
+      PointSelection *theSelection = &selection;
+      return [theSelection, pointMap,
+              &integrateResumableRange](const Tile &row) {
+        theSelection->integrateRow(*pointMap, row, integrateResumableRange);
+      };
+    };
+
+    auto integrateBaseMap = [&]() {
+      if (cellMapping) {
+        if (!cellMapping->isMapped()) {
+          scheduler->run(cellMapping->tiles(), [&](const Tile &row) {
+            cellMapping->mapCells(row, integrateCells);
+          });
+          if (scheduler->isCancelled())
+            return;
+
+          cellMapping->setMapped();
+        }
+
+        cellMapping->resolve(attractorPosThreshold, midPosThreshold);
+        cellMapping->fill(*pointMap);
+        qInfo() << QString("Cell mapping of %1 cells found %2 periodic groups "
+                           "(%3 resolved) and %4 absorbing cells.")
+                       .arg(cellMapping->cellCount())
+                       .arg(cellMapping->periodicGroupCount())
+                       .arg(cellMapping->resolvedGroupCount())
+                       .arg(cellMapping->absorbingCellCount());
+        return;
+      }
+
+      if (progressiveRendering) {
+        for (std::size_t step = progressiveFirstStep; step > 0; step /= 2) {
+          PointSelection level(latticeLevelIndices(
+              *pointMap, step, step == progressiveFirstStep));
+          scheduler->run(level.tiles(), integrateSelectionRows(level));
+          if (scheduler->isCancelled())
+            return;
+
+          // the last level is the full map written by createImageFile
+          if (step > 1) {
+            if (saveImage(createImage(*pointMap, colorMap, step), previewPath))
+              emit previewAvailable();
+          }
+        }
+        return;
+      }
+
+      if (minimumFillSize > 0) {
+        RectangleFillCounts counts;
+        fillMap(*pointMap, pendulumSystem, *scheduler, minimumFillSize,
+                integrateRange, counts);
+        const std::size_t integratedCount = counts.integratedPointCount;
+        const std::size_t filledCount = counts.filledPointCount;
+        qInfo() << QString("Rectangle fill integrated %1 points and filled %2 "
+                           "points (%3% filled).")
+                       .arg(integratedCount)
+                       .arg(filledCount)
+                       .arg(100.0 * filledCount /
+                                std::max<std::size_t>(
+                                    integratedCount + filledCount, 1),
+                            0, 'f', 1);
+        return;
+      }
+
+      if (symmetryReduction) {
+        const SymmetryFill symmetryFill(*pointMap,
+                                        findSymmetries(pendulumSystem));
+        PointSelection selection(symmetryFill.integratedPointIndices());
+        scheduler->run(selection.tiles(), integrateSelectionRows(selection));
+        if (scheduler->isCancelled())
+          return;
+
+        symmetryFill.fill(*pointMap);
+        qInfo() << QString("Found %1 symmetries, filled %2 of %3 points.")
+                       .arg(symmetryFill.symmetryCount())
+                       .arg(symmetryFill.filledPointCount())
+                       .arg(pointMap->rows() * pointMap->cols());
+        return;
+      }
+
+      auto costModel = previousRunCostModel;
+      if (costModelType == IntegratorModel::CoarsePrepass) {
+        Map coarseMap = makeCoarsePrepassMap(*pointMap);
+        scheduler->run(makeTiles(coarseMap, pendulumSystem),
+                       integrateMapRows(coarseMap));
+        if (scheduler->isCancelled())
+          return;
+
+        costModel = std::make_shared<const StepCountCostModel>(coarseMap);
+      }
+
+      std::vector<Tile> tiles;
+      std::vector<double> costs;
+      if (costModel) {
+        tiles = makeCostTiles(*pointMap, pendulumSystem, *costModel,
+                              threadCount, costs);
+      } else {
+        tiles = makeTiles(*pointMap, pendulumSystem);
+      }
+
+      auto runTiles = [&](const TileScheduler::RowFunction &rowFunction) {
+        if (costModel) {
+          scheduler->run(tiles, costs, rowFunction);
+        } else {
+          scheduler->run(tiles, rowFunction);
+        }
+      };
+
+      if (integrateFirstPass) {
+        // publish the image of the first pass, then resume the points it
+        // suspended
+        std::mutex suspendedMutex;
+        std::vector<std::size_t> suspendedIndices;
+        std::vector<PointProgress> suspendedProgress;
+        runTiles([&](const Tile &row) {
+          const auto rowBegin = pointMap->rowBegin(row.firstRow);
+          std::vector<Point> points(rowBegin + row.firstColumn,
+                                    rowBegin + row.lastColumn);
+          std::vector<PointProgress> progress(points.size());
+          integrateFirstPass(points.begin(), points.end(), progress.data());
+          std::copy(points.begin(), points.end(), rowBegin + row.firstColumn);
+
+          const std::size_t firstIndex =
+              row.firstRow * pointMap->cols() + row.firstColumn;
+          std::lock_guard<std::mutex> lock(suspendedMutex);
+          for (std::size_t i = 0; i < points.size(); ++i) {
+            if (isSuspended(progress[i])) {
+              suspendedIndices.push_back(firstIndex + i);
+              suspendedProgress.push_back(progress[i]);
+            }
+          }
+        });
+        if (scheduler->isCancelled())
+          return;
+
+        if (saveImage(createImage(*pointMap, colorMap, 1), previewPath))
+          emit previewAvailable();
+        qInfo() << QString("First pass suspended %1 points.")
+                       .arg(suspendedProgress.size());
+
+        PointSelection suspended(std::move(suspendedIndices),
+                                 std::move(suspendedProgress));
+        scheduler->run(suspended.tiles(), integrateSelectionRows(suspended));
+        return;
+      }
+
+      // resume from the checkpoint of an integration with the same
+      // parameters and record the rows finished by this one
+      TileScheduler::RowFunction integrateRow = integrateMapRows(*pointMap);
+      MapCheckpoint checkpoint;
+      if (checkpointInterval.count() > 0) {
+        const std::string checkpointPath =
+            (applicationDirPath + "/last_integrated.checkpoint")
+                .toStdString();
+        if (checkpoint.open(checkpointPath, parametersHash, *pointMap,
+                            checkpointInterval)) {
+          checkpoint.removeCompleted(tiles, costModel ? &costs : nullptr);
+          qInfo() << QString("Resumed %1 points from the checkpoint.")
+                         .arg(checkpoint.restoredPointCount());
+          auto integrateMapRow = integrateRow;
+          integrateRow = [integrateMapRow, &checkpoint, pointMap,
+                          scheduler](const Tile &row) {
+            integrateMapRow(row);
+            // a cancel abandons the points of the rows still running
+            if (!scheduler->isCancelled())
+              checkpoint.append(row, *pointMap);
+          };
+        } else {
+          qCritical() << "Failed to open the checkpoint:"
+                      << QString::fromStdString(checkpoint.errorString());
+        }
+      }
+
+      runTiles(integrateRow);
+    };
+
+    // integrates the map one tile at a time into a memory mapped file and
+    // streams the image from it
+    auto integrateDiskMap = [&]() {
+      TiledMapFile file;
+      const std::string mapPath =
+          (applicationDirPath + "/last_integrated.map").toStdString();
+      if (!file.create(mapPath, xStart, yStart, xEnd, yEnd, resolution,
+                       TiledMapFile::tileSizeForBudget(diskMemoryBudget))) {
+        qCritical() << "Failed to create the map file:"
+                    << QString::fromStdString(file.errorString());
+        return;
+      }
+
+      qInfo() << QString("Integrating %1 x %2 points to %3 in %4 tiles.")
+                     .arg(file.cols())
+                     .arg(file.rows())
+                     .arg(QString::fromStdString(mapPath))
+                     .arg(file.tileCount());
+
+      // every previewStep-th point of every previewStep-th row
+      const std::size_t previewStep =
+          (std::max(file.rows(), file.cols()) + diskPreviewSize - 1) /
+          diskPreviewSize;
+      QImage preview((file.cols() + previewStep - 1) / previewStep,
+                     (file.rows() + previewStep - 1) / previewStep,
+                     QImage::Format_RGB32);
+      preview.fill(colorMap.at(-2));
+
+      for (std::size_t tile = 0; tile < file.tileCount(); ++tile) {
+        Map tileMap = file.tileMap(tile);
+        scheduler->run(makeTiles(tileMap, pendulumSystem),
+                       integrateMapRows(tileMap));
+        if (scheduler->isCancelled())
+          return;
+
+        file.writeTile(tile, tileMap);
+        const std::size_t firstRow =
+            tile / file.tileColumnCount() * file.tileSize();
+        const std::size_t firstColumn =
+            tile % file.tileColumnCount() * file.tileSize();
+        for (std::size_t row = (previewStep - firstRow % previewStep) %
+                               previewStep;
+             row < tileMap.rows(); row += previewStep) {
+          for (std::size_t column =
+                   (previewStep - firstColumn % previewStep) % previewStep;
+               column < tileMap.cols(); column += previewStep) {
+            preview.setPixelColor(
+                static_cast<int>((firstColumn + column) / previewStep),
+                static_cast<int>((firstRow + row) / previewStep),
+                colorMap.at(
+                    tileMap.convergePosition(row * tileMap.cols() + column)));
+          }
+        }
+      }
+
+      // colors by converge position, unresolved (-3) first
+      std::vector<std::array<std::uint8_t, 3>> colors;
+      for (const auto &positionColor : colorMap) {
+        const QColor &color = positionColor.second;
+        colors.push_back({{static_cast<std::uint8_t>(color.red()),
+                           static_cast<std::uint8_t>(color.green()),
+                           static_cast<std::uint8_t>(color.blue())}});
+      }
+
+      const QString imagePath = applicationDirPath + "/last_integrated.ppm";
+      if (!writePortablePixmap(file, imagePath.toStdString(),
+                               [&colors](std::int16_t convergePosition) {
+                                 return colors[convergePosition -
+                                               unresolvedPosition];
+                               })) {
+        qCritical() << "Failed to write the image file:" << imagePath;
+      }
+
+      saveImage(preview, applicationDirPath + "/last_integrated.png");
+    };
+
+    auto reportFateCache = [&]() {
+      if (!fateCache)
+        return;
+
+      qInfo() << QString("Fate cache hit %1 of %2 lookups (%3%), %4 cells "
+                         "known and %5 with disagreeing trajectories.")
+                     .arg(fateCache->hitCount())
+                     .arg(fateCache->lookupCount())
+                     .arg(100.0 * fateCache->hitRate(), 0, 'f', 1)
+                     .arg(fateCache->knownCellCount())
+                     .arg(fateCache->conflictedCellCount());
+    };
+
+    if (diskMemoryBudget > 0) {
+      integrateDiskMap();
+      reportFateCache();
+      return;
+    }
+
+    integrateBaseMap();
+    reportFateCache();
+    if (supersampleCount < 2 || scheduler->isCancelled())
+      return;
+
+    // resample the points on basin boundaries for the anti aliased image
+    *supersamples = BoundarySupersamples(*pointMap, supersampleCount);
+    // the subsamples of a row live only while it is integrated, only the
+    // counts of their fates are kept
+    scheduler->run(
+        supersamples->tiles(),
+        [supersamples, pointMap, &integrateRange](const Tile &row) {
+          std::vector<Point> samples;
+          supersamples->makeSamples(*pointMap, row.firstRow, samples);
+          const auto first = samples.begin() + row.firstColumn;
+          const auto last = samples.begin() + row.lastColumn;
+          integrateRange(first, last);
+          supersamples->countFates(row.firstRow, first, last);
+        });
+    if (scheduler->isCancelled())
+      *supersamples = BoundarySupersamples();
+  }));
 }
 
 void SystemIntegrator::cancelIntegration() {
-  m_futureWatcher.cancel();
+  if (m_scheduler)
+    m_scheduler->cancel();
+
   m_futureWatcher.waitForFinished();
 }
 
+void SystemIntegrator::updateProgress() {
+  if (!m_scheduler)
+    return;
+
+  // the coarse pre-pass shows as a run of its own
+  setProgressMaximum(static_cast<qint64>(m_scheduler->pointCount()));
+  setProgressValue(static_cast<qint64>(m_scheduler->completedPointCount()));
+}
+
 void SystemIntegrator::createImageFile() {
-  const auto rows = m_pointMap.rows();
+  m_progressTimer.stop();
+  updateProgress();
+
+  // the images of maps integrated to disk are written while integrating
+  if (m_isDiskMap) {
+    emit finishedIntegration();
+    return;
+  }
+
   const auto cols = m_pointMap.cols();
-  QImage image(cols, rows, QImage::Format_RGB32);
+  QImage image = createImage(m_pointMap, m_colorMap, 1);
 
-  for (std::size_t y = 0; y < rows; ++y) {
-    for (std::size_t x = 0; x < cols; ++x) {
-      // data is row major oriented
-      int index = y * cols + x;
-      const int convergePosition =
-          (m_pointMap.begin() + index)->convergePosition;
-      const QColor color = m_colorMap[convergePosition];
-      image.setPixelColor(x, y, color);
+  // blend the colors of the subsamples of the basin boundary points
+  for (std::size_t i = 0; i < m_supersamples.pointCount(); ++i) {
+    int red = 0;
+    int green = 0;
+    int blue = 0;
+    int sampleCount = 0;
+    for (auto fate = m_supersamples.fatesBegin(i),
+              fatesEnd = m_supersamples.fatesEnd(i);
+         fate != fatesEnd; ++fate) {
+      const QColor color = m_colorMap[fate->position];
+      red += fate->count * color.red();
+      green += fate->count * color.green();
+      blue += fate->count * color.blue();
+      sampleCount += fate->count;
     }
+
+    if (sampleCount == 0)
+      continue;
+
+    const std::size_t index = m_supersamples.pointIndex(i);
+    image.setPixelColor(index % cols, index / cols,
+                        QColor(red / sampleCount, green / sampleCount,
+                               blue / sampleCount));
   }
 
-  image.save(qApp->applicationDirPath() + "/last_integrated.png");
+  saveImage(image, qApp->applicationDirPath() + "/last_integrated.png");
 
   emit finishedIntegration();
 }
 
-void SystemIntegrator::setProgressValue(int progressValue) {
+void SystemIntegrator::setProgressValue(qint64 progressValue) {
   if (m_progressValue == progressValue)
     return;
 
@@ -134,7 +933,7 @@ void SystemIntegrator::setProgressValue(int progressValue) {
   emit progressValueChanged(progressValue);
 }
 
-void SystemIntegrator::setProgressMinimum(int progressMinimum) {
+void SystemIntegrator::setProgressMinimum(qint64 progressMinimum) {
   if (m_progressMinimum == progressMinimum)
     return;
 
@@ -142,7 +941,7 @@ void SystemIntegrator::setProgressMinimum(int progressMinimum) {
   emit progressMinimumChanged(progressMinimum);
 }
 
-void SystemIntegrator::setProgressMaximum(int progressMaximum) {
+void SystemIntegrator::setProgressMaximum(qint64 progressMaximum) {
   if (m_progressMaximum == progressMaximum)
     return;
 
@@ -27,26 +27,33 @@
 #include "Models/pendulummapmodel.h"
 #include "Models/pendulumsystemmodel.h"
 #include <CoreEngine/pendulummapintegrator.h>
+#include <CoreEngine/supersampling.h>
 #include <QFutureWatcher>
 #include <QObject>
+#include <QTimer>
+#include <cstdint>
 #include <map>
 #include <memory>
 
 namespace staticpendulum {
+class CellMapping;
+class TileScheduler;
+
 /// QML type to manage integrating pendulum system.
 class SystemIntegrator : public QObject {
   Q_OBJECT
-  Q_PROPERTY(int progressValue READ progressValue NOTIFY progressValueChanged)
   Q_PROPERTY(
-      int progressMinimum READ progressMinimum NOTIFY progressMinimumChanged)
+      qint64 progressValue READ progressValue NOTIFY progressValueChanged)
+  Q_PROPERTY(
+      qint64 progressMinimum READ progressMinimum NOTIFY progressMinimumChanged)
   Q_PROPERTY(
-      int progressMaximum READ progressMaximum NOTIFY progressMaximumChanged)
+      qint64 progressMaximum READ progressMaximum NOTIFY progressMaximumChanged)
 public:
   explicit SystemIntegrator(QObject *parent = 0);
 
-  int progressValue() const;
-  int progressMinimum() const;
-  int progressMaximum() const;
+  qint64 progressValue() const;
+  qint64 progressMinimum() const;
+  qint64 progressMaximum() const;
 
 public slots:
   void integrateMap(PendulumSystemModel *pendulumSystemModel,
@@ -56,21 +63,38 @@ public slots:
 
 signals:
   void finishedIntegration();
-  void progressValueChanged(int progressValue);
-  void progressMinimumChanged(int progressMinimum);
-  void progressMaximumChanged(int progressMaximum);
+  /// Emitted from the integrating thread when a progressive rendering level
+  /// wrote its preview image (last_preview.png).
+  void previewAvailable();
+  void progressValueChanged(qint64 progressValue);
+  void progressMinimumChanged(qint64 progressMinimum);
+  void progressMaximumChanged(qint64 progressMaximum);
 
 private:
+  /// Milliseconds between progress updates while integrating.
+  static constexpr int progressInterval = 100;
+
   void createImageFile();
+  void updateProgress();
   QFutureWatcher<void> m_futureWatcher;
-  int m_progressValue;
-  int m_progressMinimum;
-  int m_progressMaximum;
-  void setProgressValue(int progressValue);
-  void setProgressMinimum(int progressMinimum);
-  void setProgressMaximum(int progressMaximum);
+  QTimer m_progressTimer;
+  std::shared_ptr<TileScheduler> m_scheduler;
+  qint64 m_progressValue = 0;
+  qint64 m_progressMinimum = 0;
+  qint64 m_progressMaximum = 0;
+  void setProgressValue(qint64 progressValue);
+  void setProgressMinimum(qint64 progressMinimum);
+  void setProgressMaximum(qint64 progressMaximum);
   staticpendulum::Map m_pointMap;
+  /// True if the last map was integrated to a TiledMapFile, m_pointMap is
+  /// then empty.
+  bool m_isDiskMap = false;
+  BoundarySupersamples m_supersamples;
   std::map<int, QColor> m_colorMap;
+  /// Cell mapping of the last integration with a cell mapping, reused while
+  /// the hash of its parameters is unchanged.
+  std::shared_ptr<CellMapping> m_cellMapping;
+  std::uint64_t m_cellMappingHash = 0;
 };
 } // namespace staticpendulum
 #endif // SYSTEMINTEGRATOR_H
@@ -5,9 +5,39 @@ CONFIG += staticlib
 
 
 HEADERS += \
+    CoreEngine/alignedallocator.h \
+    CoreEngine/attractorgrid.h \
+    CoreEngine/attractortree.h \
+    CoreEngine/attractorwells.h \
+    CoreEngine/batchstate.h \
+    CoreEngine/bogackishampine32.h \
     CoreEngine/cashkarp54.h \
+    CoreEngine/cellmapping.h \
+    CoreEngine/costmodel.h \
+    CoreEngine/denseoutput.h \
+    CoreEngine/dormandprince54.h \
+    CoreEngine/dormandprince853.h \
+    CoreEngine/eventlocation.h \
+    CoreEngine/explicitrungekutta.h \
+    CoreEngine/fatecache.h \
+    CoreEngine/fixedpendulumsystem.h \
+    CoreEngine/forcefieldtable.h \
+    CoreEngine/mapcheckpoint.h \
+    CoreEngine/mappedfile.h \
+    CoreEngine/vectorizedpendulumsystem.h \
+    CoreEngine/verner65.h \
     CoreEngine/pendulumsystem.h \
+    CoreEngine/pointselection.h \
+    CoreEngine/progressiverender.h \
+    CoreEngine/rectanglefill.h \
+    CoreEngine/rosenbrock23.h \
+    CoreEngine/stepsizecontroller.h \
+    CoreEngine/stiffnessswitching.h \
+    CoreEngine/supersampling.h \
+    CoreEngine/symmetry.h \
     CoreEngine/pendulummapintegrator.h \
+    CoreEngine/tiledmapfile.h \
+    CoreEngine/tilescheduler.h \
     Models/pendulumsystemmodel.h \
     Models/integratormodel.h \
     Models/attractorlistmodel.h \
@@ -17,8 +47,23 @@ HEADERS += \
     Models/modelsrepo.h
 
 SOURCES += \
+    CoreEngine/attractorgrid.cpp \
+    CoreEngine/attractortree.cpp \
+    CoreEngine/attractorwells.cpp \
+    CoreEngine/cellmapping.cpp \
+    CoreEngine/costmodel.cpp \
+    CoreEngine/fatecache.cpp \
+    CoreEngine/forcefieldtable.cpp \
+    CoreEngine/mapcheckpoint.cpp \
+    CoreEngine/mappedfile.cpp \
     CoreEngine/pendulumsystem.cpp \
     CoreEngine/pendulummapintegrator.cpp \
+    CoreEngine/pointselection.cpp \
+    CoreEngine/progressiverender.cpp \
+    CoreEngine/supersampling.cpp \
+    CoreEngine/symmetry.cpp \
+    CoreEngine/tiledmapfile.cpp \
+    CoreEngine/tilescheduler.cpp \
     Models/pendulumsystemmodel.cpp \
     Models/integratormodel.cpp \
     Models/attractorlistmodel.cpp \
@@ -6,6 +6,12 @@ QMAKE_CXXFLAGS += -pedantic
 QMAKE_CXXFLAGS_RELEASE += -ffast-math -O3
 QMAKE_CXXFLAGS_RELEASE -= -O2
 QMAKE_LFLAGS_RELEASE += -flto
+# qmake CONFIG+=native_arch lets the batched integration kernels use the widest
+# vector registers of the build machine, the binaries then only run on CPUs
+# like it
+native_arch {
+    QMAKE_CXXFLAGS_RELEASE += -march=native
+}
 
 #DEFINES
 DEFINES += QT_DEPRECATED_WARNINGS
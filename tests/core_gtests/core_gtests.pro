@@ -9,10 +9,34 @@ QMAKE_CXXFLAGS_RELEASE += -ffast-math -O3
 QMAKE_CXXFLAGS_RELEASE -= -O2
 
 HEADERS += \
+    testsystems.h \
     tst_cashkarp54.h
 
 SOURCES += main.cpp \
-    tst_cashkarp54.cpp
+    tst_attractorgrid.cpp \
+    tst_attractortree.cpp \
+    tst_attractorwells.cpp \
+    tst_cashkarp54.cpp \
+    tst_cellmapping.cpp \
+    tst_costmodel.cpp \
+    tst_dormandprince54.cpp \
+    tst_dormandprince853.cpp \
+    tst_eventlocation.cpp \
+    tst_explicitrungekutta.cpp \
+    tst_fatecache.cpp \
+    tst_fixedpendulumsystem.cpp \
+    tst_forcefieldtable.cpp \
+    tst_mapcheckpoint.cpp \
+    tst_pendulummapmodel.cpp \
+    tst_progressiverender.cpp \
+    tst_rectanglefill.cpp \
+    tst_rosenbrock23.cpp \
+    tst_stepsizecontroller.cpp \
+    tst_supersampling.cpp \
+    tst_symmetry.cpp \
+    tst_tiledmapfile.cpp \
+    tst_tilescheduler.cpp \
+    tst_vectorizedpendulumsystem.cpp
 
 # Including core static library
 win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../src/core/release/ -lcore
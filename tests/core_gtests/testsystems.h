@@ -0,0 +1,48 @@
+#ifndef TESTSYSTEMS_H
+#define TESTSYSTEMS_H
+#include "CoreEngine/pendulumsystem.h"
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+namespace staticpendulum {
+// The three attractor system of the application defaults.
+inline PendulumSystem buildDefaultSystem() {
+  PendulumSystem sys;
+  const double yMag = std::sqrt(1 - 0.5 * 0.5);
+  sys.attractorList.emplace_back(-0.5, yMag, 1);
+  sys.attractorList.emplace_back(-0.5, -yMag, 1);
+  sys.attractorList.emplace_back(1.0, 0.0, 1);
+  return sys;
+}
+
+// System with count attractors at random positions within the pendulum reach,
+// the same count gives the same system.
+inline PendulumSystem buildRandomSystem(std::size_t count) {
+  PendulumSystem sys;
+  std::mt19937 generator(static_cast<unsigned>(count));
+  std::uniform_real_distribution<double> position(-5.0, 5.0);
+  std::uniform_real_distribution<double> forceCoeff(0.1, 2.0);
+  for (std::size_t i = 0; i < count; ++i) {
+    sys.attractorList.emplace_back(position(generator), position(generator),
+                                   forceCoeff(generator));
+  }
+  return sys;
+}
+
+// System with count attractors evenly spaced on the unit circle, the i-th with
+// a force coefficient of 1 + i * forceCoeffStep (equal coefficients keep the
+// symmetries of the ring).
+inline PendulumSystem buildRingSystem(std::size_t count,
+                                      double forceCoeffStep = 0.0) {
+  PendulumSystem sys;
+  const double pi = std::acos(-1.0);
+  for (std::size_t i = 0; i < count; ++i) {
+    const double angle = 2.0 * pi * static_cast<double>(i) / count;
+    sys.attractorList.emplace_back(std::cos(angle), std::sin(angle),
+                                   1.0 + forceCoeffStep * i);
+  }
+  return sys;
+}
+} // namespace staticpendulum
+#endif // TESTSYSTEMS_H
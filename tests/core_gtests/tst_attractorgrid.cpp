@@ -0,0 +1,84 @@
+#include "CoreEngine/attractorgrid.h"
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "testsystems.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+
+namespace staticpendulum {
+namespace {
+// index of the first attractor near (x, y), as ConvergenceMonitor tests
+// every attractor without a grid
+int nearAttractor(const PendulumSystem &sys, double x, double y,
+                  double threshold) {
+  for (std::size_t i = 0; i < sys.attractorList.size(); ++i) {
+    if (isNearAttractor(sys.attractorList[i].xPosition,
+                        sys.attractorList[i].yPosition, x, y, threshold))
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+} // namespace
+
+TEST(AttractorGridTest, findsTheSameAttractorAsTestingEveryOne) {
+  const PendulumSystem sys = buildRandomSystem(200);
+  const AttractorGrid grid(sys.attractorList, 0.6);
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> position(-6.0, 6.0);
+  int foundCount = 0;
+  for (int i = 0; i < 20000; ++i) {
+    const double x = position(generator);
+    const double y = position(generator);
+    // thresholds smaller and larger than half the cell size
+    for (const double threshold : {0.05, 0.3, 1.0}) {
+      const int expected = nearAttractor(sys, x, y, threshold);
+      ASSERT_EQ(grid.nearAttractor(x, y, threshold), expected);
+      if (expected >= 0)
+        ++foundCount;
+    }
+  }
+  EXPECT_GT(foundCount, 1000);
+
+  // the zone of an attractor holds its own position
+  for (std::size_t i = 0; i < sys.attractorList.size(); ++i) {
+    const int index =
+        grid.nearAttractor(sys.attractorList[i].xPosition,
+                           sys.attractorList[i].yPosition, 1e-9);
+    EXPECT_LE(index, static_cast<int>(i));
+    EXPECT_GE(index, 0);
+  }
+}
+
+TEST(AttractorGridTest, smallCellsAreEnlargedToTheCellBudget) {
+  const PendulumSystem sys = buildRandomSystem(50);
+  const AttractorGrid grid(sys.attractorList, 1e-6);
+  EXPECT_LE(grid.cellCount(),
+            AttractorGrid::maximumCellsPerAttractor * 50u);
+  EXPECT_GT(grid.cellSize(), 1e-6);
+
+  const AttractorGrid emptyGrid(PendulumSystem().attractorList, 1.0);
+  EXPECT_EQ(emptyGrid.nearAttractor(0.0, 0.0, 1.0), -1);
+}
+
+TEST(AttractorGridTest, gridDoesNotChangeTheMap) {
+  PendulumSystem sys = buildRandomSystem(12);
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+  Map expected(-2.0, -2.0, 2.0, 2.0, 0.5);
+  for (std::size_t i = 0; i < expected.rows() * expected.cols(); ++i) {
+    integratePoint(integrator, sys, expected.point(i), 0.001, 0.5, 0.1, 5.0);
+  }
+
+  sys.attractorGrid =
+      std::make_shared<const AttractorGrid>(sys.attractorList, 1.0);
+  Map withGrid(-2.0, -2.0, 2.0, 2.0, 0.5);
+  for (std::size_t i = 0; i < withGrid.rows() * withGrid.cols(); ++i) {
+    integratePoint(integrator, sys, withGrid.point(i), 0.001, 0.5, 0.1, 5.0);
+    EXPECT_EQ(withGrid.convergePosition(i), expected.convergePosition(i));
+    EXPECT_EQ(withGrid.point(i).convergeTime, expected.point(i).convergeTime);
+  }
+}
+} // namespace staticpendulum
@@ -0,0 +1,105 @@
+#include "CoreEngine/attractortree.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "testsystems.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+// Largest difference between the tree and the exact attraction forces over a
+// set of head positions, relative to the largest exact attraction force.
+double maximumRelativeError(const PendulumSystem &sys,
+                            const AttractorTree &tree) {
+  double maximumError = 0.0;
+  double maximumForce = 0.0;
+  for (double x = -4.9; x < 5.0; x += 0.7) {
+    for (double y = -4.9; y < 5.0; y += 0.7) {
+      PendulumSystem::StateType state = {{x, y, 0.0, 0.0}};
+      PendulumSystem::StateType exact;
+      sys(state, exact, 0.0);
+
+      const double sqrtTerm = std::sqrt(1.0 - (x * x + y * y) /
+                                                  (sys.length * sys.length));
+      const double value1 = sys.distance + sys.length * (1.0 - sqrtTerm);
+      double xAttractionForce;
+      double yAttractionForce;
+      tree.sumForces(x, y, value1 * value1, xAttractionForce,
+                     yAttractionForce);
+
+      // remove the gravity term from the exact derivative
+      const double gravityValue =
+          -sys.mass * sys.gravity / sys.length * sqrtTerm;
+      const double xExact = exact[2] * sys.mass - x * gravityValue;
+      const double yExact = exact[3] * sys.mass - y * gravityValue;
+      maximumError = std::max(maximumError,
+                              std::hypot(xAttractionForce - xExact,
+                                         yAttractionForce - yExact));
+      maximumForce = std::max(maximumForce, std::hypot(xExact, yExact));
+    }
+  }
+  return maximumError / maximumForce;
+}
+} // namespace
+
+TEST(AttractorTreeTest, zeroOpeningAngleIsExact) {
+  const PendulumSystem sys = buildRandomSystem(500);
+  const AttractorTree tree(sys.attractorList, 0.0);
+  EXPECT_LT(maximumRelativeError(sys, tree), 1e-12);
+}
+
+TEST(AttractorTreeTest, errorShrinksWithOpeningAngle) {
+  const PendulumSystem sys = buildRandomSystem(2000);
+  const double coarseError =
+      maximumRelativeError(sys, AttractorTree(sys.attractorList, 1.0));
+  const double fineError =
+      maximumRelativeError(sys, AttractorTree(sys.attractorList, 0.3));
+  EXPECT_LT(coarseError, 1e-1);
+  EXPECT_LT(fineError, 1e-3);
+  EXPECT_LT(fineError, coarseError);
+}
+
+TEST(AttractorTreeTest, handlesCoincidentAttractors) {
+  PendulumSystem sys;
+  for (std::size_t i = 0; i < 4 * AttractorTree::leafSize; ++i) {
+    sys.attractorList.emplace_back(1.0, 1.0, 1.0);
+  }
+  sys.attractorList.emplace_back(-1.0, 0.0, 1.0);
+  // the coincident attractors are split until the maximum depth
+  const AttractorTree tree(sys.attractorList, 0.0);
+  EXPECT_LE(tree.nodeCount(), 2 * AttractorTree::maximumDepth + 1);
+  EXPECT_LT(maximumRelativeError(sys, tree), 1e-12);
+
+  // the cluster is exactly a point source
+  EXPECT_LT(maximumRelativeError(sys, AttractorTree(sys.attractorList, 0.5)),
+            1e-3);
+}
+
+TEST(AttractorTreeTest, systemUsesTreeWhenSet) {
+  PendulumSystem sys = buildRandomSystem(300);
+  const PendulumSystem::StateType state = {{0.3, -0.7, 0.4, 0.2}};
+  PendulumSystem::StateType exact;
+  sys(state, exact, 0.0);
+
+  sys.attractorTree = std::make_shared<const AttractorTree>(
+      sys.attractorList, 0.0);
+  PendulumSystem::StateType scalarTree;
+  sys(state, scalarTree, 0.0);
+  for (std::size_t i = 0; i < 4; ++i) {
+    EXPECT_NEAR(scalarTree[i], exact[i], 1e-12 * (1.0 + std::abs(exact[i])));
+  }
+
+  BatchState<4, 4> batchState;
+  BatchState<4, 4> batchDerivative;
+  for (std::size_t l = 0; l < 4; ++l) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      batchState[i][l] = state[i];
+    }
+  }
+  sys(batchState, batchDerivative, LaneArray<double, 4>{});
+  for (std::size_t l = 0; l < 4; ++l) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_EQ(batchDerivative[i][l], scalarTree[i]);
+    }
+  }
+}
+} // namespace staticpendulum
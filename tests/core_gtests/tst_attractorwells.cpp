@@ -0,0 +1,94 @@
+#include "CoreEngine/attractorwells.h"
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "testsystems.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+namespace staticpendulum {
+namespace {
+// Integrates the points of the map with cashKarp54 and the default
+// thresholds.
+std::vector<Point> integrateMap(const PendulumSystem &sys, const Map &map) {
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+  std::vector<Point> points(map.begin(), map.end());
+  for (auto &point : points) {
+    integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0);
+  }
+  return points;
+}
+} // namespace
+
+TEST(AttractorWellsTest, everyAttractorHasAWell) {
+  const PendulumSystem sys = buildDefaultSystem();
+  const AttractorWells wells(sys);
+  EXPECT_DOUBLE_EQ(wells.spacing(), 4.0 / (wells.nodeCount() - 1.0));
+
+  for (const auto &attractor : sys.attractorList) {
+    const int wellIndex =
+        wells.wellAt(attractor.xPosition, attractor.yPosition);
+    ASSERT_GE(wellIndex, 0);
+    const auto &well = wells.wells()[static_cast<std::size_t>(wellIndex)];
+    EXPECT_NEAR(well.xPosition, attractor.xPosition, 0.05);
+    EXPECT_NEAR(well.yPosition, attractor.yPosition, 0.05);
+    EXPECT_LT(well.minimumEnergy, well.captureEnergy);
+    EXPECT_LT(well.captureEnergy, well.saddleEnergy);
+    EXPECT_NEAR(well.minimumEnergy,
+                potentialEnergy(sys, well.xPosition, well.yPosition), 1e-12);
+  }
+
+  // the attractors are in different wells and far outside of the grid there
+  // is no well
+  EXPECT_NE(wells.wellAt(1.0, 0.0), wells.wellAt(-0.5, std::sqrt(0.75)));
+  EXPECT_EQ(wells.wellAt(5.0, 5.0), -1);
+}
+
+TEST(AttractorWellsTest, wellsAreSeparatedBySaddles) {
+  // two equal attractors on the x axis, the lowest saddle between them is on
+  // the y axis
+  PendulumSystem sys;
+  sys.attractorList.emplace_back(-1.0, 0.0, 1);
+  sys.attractorList.emplace_back(1.0, 0.0, 1);
+  const AttractorWells wells(sys);
+  const int left = wells.wellAt(-1.0, 0.0);
+  const int right = wells.wellAt(1.0, 0.0);
+  ASSERT_GE(left, 0);
+  ASSERT_GE(right, 0);
+  ASSERT_NE(left, right);
+
+  double saddleEnergy = potentialEnergy(sys, 0.0, -1.0);
+  for (double y = -1.0; y <= 1.0; y += 0.001) {
+    saddleEnergy = std::min(saddleEnergy, potentialEnergy(sys, 0.0, y));
+  }
+  for (const int wellIndex : {left, right}) {
+    const auto &well = wells.wells()[static_cast<std::size_t>(wellIndex)];
+    EXPECT_NEAR(well.saddleEnergy, saddleEnergy,
+                1e-3 * std::abs(saddleEnergy));
+  }
+  EXPECT_EQ(wells.wellAt(0.0, 0.0), -1);
+}
+
+TEST(AttractorWellsTest, captureKeepsClassificationAndSavesSteps) {
+  PendulumSystem sys = buildDefaultSystem();
+  const Map map(-2.0, -2.0, 2.0, 2.0, 0.25);
+  const std::vector<Point> expected = integrateMap(sys, map);
+
+  sys.wells = std::make_shared<const AttractorWells>(sys);
+  const std::vector<Point> captured = integrateMap(sys, map);
+
+  long long expectedSteps = 0;
+  long long capturedSteps = 0;
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(captured[i].convergePosition, expected[i].convergePosition);
+    EXPECT_LE(captured[i].convergeTime, expected[i].convergeTime);
+    expectedSteps += expected[i].stepCount;
+    capturedSteps += captured[i].stepCount;
+  }
+  EXPECT_LT(capturedSteps, expectedSteps);
+}
+} // namespace staticpendulum
@@ -1,4 +1,5 @@
 #include "tst_cashkarp54.h"
+#include "testsystems.h"
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -274,6 +275,217 @@ TEST_P(CashKarp54Test, pendulumSystemTests) {
   compareWithStartState({{2.5, -4.5, 0.1, -0.2}});
 }
 
+TEST(CashKarp54BatchTest, matchesScalarPerLane) {
+  const PendulumSystem sys = buildDefaultSystem();
+  constexpr std::size_t lanes = 4;
+  const std::array<std::array<double, 4>, lanes> startStates = {
+      {{{5.0, 5.0, 0.0, 0.0}},
+       {{2.5, -4.5, 0.1, -0.2}},
+       {{-3.0, 1.0, 0.0, 0.0}},
+       {{0.5, 0.5, 0.0, 0.0}}}};
+
+  BatchState<4, lanes> batchStates;
+  BatchState<4, lanes> batchDerivatives;
+  LaneArray<double, lanes> batchTimes;
+  LaneArray<double, lanes> batchSteps;
+  LaneArray<int, lanes> accepted;
+  for (std::size_t l = 0; l < lanes; ++l) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      batchStates[i][l] = startStates[l][i];
+    }
+    batchTimes[l] = 0.0;
+    batchSteps[l] = 0.01;
+  }
+  sys(batchStates, batchDerivatives, batchTimes);
+
+  std::array<std::array<double, 4>, lanes> states = startStates;
+  LaneArray<double, lanes> times = batchTimes;
+  LaneArray<double, lanes> steps = batchSteps;
+
+  for (int trial = 0; trial < 50; ++trial) {
+    explicitRungeKuttaBatch<CashKarp54Tableau>(sys, batchStates,
+                                               batchDerivatives, batchTimes,
+                                               batchSteps, accepted, 1e-7,
+                                               1e-7, 0.1);
+    for (std::size_t l = 0; l < lanes; ++l) {
+      EXPECT_EQ(accepted[l],
+                cashKarp54(sys, states[l], times[l], steps[l], 1e-7, 1e-7,
+                           0.1))
+          << "Lane: " << l << " trial: " << trial;
+    }
+  }
+
+  // vectorized pow and -ffast-math reassociation differ from the scalar code
+  // in the last bits, which the attractors amplify, so compare with a tolerance
+  for (std::size_t l = 0; l < lanes; ++l) {
+    EXPECT_NEAR(batchTimes[l], times[l], 1e-6) << "Lane: " << l;
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_NEAR(batchStates[i][l], states[l][i], 1e-6)
+          << "Lane: " << l << " index: " << i;
+    }
+  }
+}
+
+TEST(CashKarp54BatchTest, integratePointsMatchesIntegratePoint) {
+  const PendulumSystem sys = buildDefaultSystem();
+  Map batchMap(-2.0, -2.0, 2.0, 2.0, 0.5);
+  Map scalarMap(-2.0, -2.0, 2.0, 2.0, 0.5);
+
+  auto batchIntegrator = [](auto &&dxdt, auto &x, auto &dxdtx, auto &t,
+                            auto &h, auto &accepted, auto &controllers) {
+    explicitRungeKuttaBatch<CashKarp54Tableau>(dxdt, x, dxdtx, t, h, accepted,
+                                               1e-6, 1e-6, 0.1, controllers);
+  };
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+
+  integratePoints<4>(batchIntegrator, sys, batchMap.begin(), batchMap.end(),
+                     0.001, 0.5, 0.1, 5.0);
+  for (auto &&point : scalarMap) {
+    integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0);
+  }
+
+  auto batchIter = batchMap.begin();
+  for (const auto &point : scalarMap) {
+    EXPECT_EQ(batchIter->convergePosition, point.convergePosition);
+    EXPECT_NEAR(batchIter->convergeTime, point.convergeTime, 1e-3);
+    ++batchIter;
+  }
+}
+
+TEST(CashKarp54BatchTest, pointsOutOfBudgetAreUnresolved) {
+  const PendulumSystem sys = buildDefaultSystem();
+  auto batchIntegrator = [](auto &&dxdt, auto &x, auto &dxdtx, auto &t,
+                            auto &h, auto &accepted, auto &controllers) {
+    explicitRungeKuttaBatch<CashKarp54Tableau>(dxdt, x, dxdtx, t, h, accepted,
+                                               1e-6, 1e-6, 0.1, controllers);
+  };
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+
+  PointBudget budget;
+  budget.trialCount = 10;
+  Map batchMap(-2.0, -2.0, 2.0, 2.0, 0.5);
+  integratePoints<4>(batchIntegrator, sys, batchMap.begin(), batchMap.end(),
+                     0.001, 0.5, 0.1, 5.0, budget);
+  Map scalarMap(-2.0, -2.0, 2.0, 2.0, 0.5);
+  for (auto &&point : scalarMap) {
+    integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0, budget);
+  }
+
+  auto batchIter = batchMap.begin();
+  for (const auto &point : scalarMap) {
+    const int expected =
+        isIntegrable(sys, point) ? unresolvedPosition : -2;
+    EXPECT_EQ(point.convergePosition, expected);
+    EXPECT_EQ(batchIter->convergePosition, expected);
+    ++batchIter;
+  }
+
+  // an exhausted time budget stops at the first check
+  budget = PointBudget();
+  budget.time = std::chrono::nanoseconds(1);
+  Point point = *scalarMap.begin();
+  point.xPosition = 1.0;
+  point.yPosition = 1.0;
+  integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0, budget);
+  EXPECT_EQ(point.convergePosition, unresolvedPosition);
+  EXPECT_LE(point.stepCount, budgetCheckInterval);
+}
+
+TEST(CashKarp54BatchTest, suspendedPointsResumeWhereTheyStopped) {
+  const PendulumSystem sys = buildDefaultSystem();
+  auto batchIntegrator = [](auto &&dxdt, auto &x, auto &dxdtx, auto &t,
+                            auto &h, auto &accepted, auto &controllers) {
+    explicitRungeKuttaBatch<CashKarp54Tableau>(dxdt, x, dxdtx, t, h, accepted,
+                                               1e-6, 1e-6, 0.1, controllers);
+  };
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+
+  const Map map(-2.0, -2.0, 2.0, 2.0, 0.5);
+  std::vector<Point> expected(map.begin(), map.end());
+  for (auto &point : expected) {
+    integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0);
+  }
+
+  PointBudget firstPassBudget;
+  firstPassBudget.trialCount = 50;
+  firstPassBudget.suspendsPoints = true;
+  std::vector<Point> scalarPoints(map.begin(), map.end());
+  std::vector<PointProgress> scalarProgress(scalarPoints.size());
+  for (std::size_t i = 0; i < scalarPoints.size(); ++i) {
+    integratePoint(integrator, sys, scalarPoints[i], 0.001, 0.5, 0.1, 5.0,
+                   firstPassBudget, &scalarProgress[i]);
+    EXPECT_EQ(isSuspended(scalarProgress[i]),
+              scalarPoints[i].convergePosition == unresolvedPosition);
+    // the point keeps its initial state
+    EXPECT_EQ(scalarPoints[i].xPosition, expected[i].xPosition);
+  }
+  std::vector<Point> batchPoints(map.begin(), map.end());
+  std::vector<PointProgress> batchProgress(batchPoints.size());
+  integratePoints<4>(batchIntegrator, sys, batchPoints.begin(),
+                     batchPoints.end(), 0.001, 0.5, 0.1, 5.0,
+                     firstPassBudget, batchProgress.data());
+  ASSERT_TRUE(std::any_of(batchProgress.begin(), batchProgress.end(),
+                          [](const PointProgress &progress) {
+                            return isSuspended(progress);
+                          }));
+
+  for (std::size_t i = 0; i < scalarPoints.size(); ++i) {
+    integratePoint(integrator, sys, scalarPoints[i], 0.001, 0.5, 0.1, 5.0,
+                   PointBudget(), &scalarProgress[i]);
+  }
+  integratePoints<4>(batchIntegrator, sys, batchPoints.begin(),
+                     batchPoints.end(), 0.001, 0.5, 0.1, 5.0, PointBudget(),
+                     batchProgress.data());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_FALSE(isSuspended(scalarProgress[i]));
+    EXPECT_FALSE(isSuspended(batchProgress[i]));
+    EXPECT_EQ(scalarPoints[i].convergePosition, expected[i].convergePosition);
+    EXPECT_EQ(scalarPoints[i].convergeTime, expected[i].convergeTime);
+    EXPECT_EQ(scalarPoints[i].stepCount, expected[i].stepCount);
+    EXPECT_EQ(batchPoints[i].convergePosition, expected[i].convergePosition);
+    EXPECT_NEAR(batchPoints[i].convergeTime, expected[i].convergeTime, 1e-3);
+  }
+}
+
+TEST(CashKarp54BatchTest, cancelledPointsKeepTheirResults) {
+  const PendulumSystem sys = buildDefaultSystem();
+  auto batchIntegrator = [](auto &&dxdt, auto &x, auto &dxdtx, auto &t,
+                            auto &h, auto &accepted, auto &controllers) {
+    explicitRungeKuttaBatch<CashKarp54Tableau>(dxdt, x, dxdtx, t, h, accepted,
+                                               1e-6, 1e-6, 0.1, controllers);
+  };
+
+  const std::atomic<bool> cancelled{true};
+  PointBudget budget;
+  budget.cancelled = &cancelled;
+  Map map(-2.0, -2.0, 2.0, 2.0, 0.5);
+  for (auto &&point : map) {
+    point.stepCount = 7;
+  }
+  integratePoints<4>(batchIntegrator, sys, map.begin(), map.end(), 0.001, 0.5,
+                     0.1, 5.0, budget);
+  for (const auto &point : map) {
+    EXPECT_EQ(point.convergePosition, -2);
+    EXPECT_EQ(point.stepCount, 7);
+  }
+
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+  Point point = *map.begin();
+  point.xPosition = 1.0;
+  point.yPosition = 1.0;
+  integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0, budget);
+  EXPECT_EQ(point.convergePosition, -2);
+  EXPECT_EQ(point.stepCount, 7);
+}
+
 // Test data
 namespace {
 std::vector<CashKarp54TestSet> buildCashKarp54Data() {
@@ -0,0 +1,148 @@
+#include "CoreEngine/attractorwells.h"
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/cellmapping.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "testsystems.h"
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace staticpendulum {
+namespace {
+auto cashKarp54Integrator() {
+  return [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-8, 1e-8, 0.1);
+  };
+}
+
+// Maps every cell of the mapping with the flow.
+void mapAllCells(CellMapping &mapping, const CellFlow &flow) {
+  for (const Tile &row : mapping.tiles()) {
+    mapping.mapCells(row, flow);
+  }
+  mapping.setMapped();
+}
+} // namespace
+
+TEST(CellMappingTest, advanceStateEndsAtTheDuration) {
+  const PendulumSystem sys = buildDefaultSystem();
+  PendulumSystem::StateType once{{1.5, -2.0, 0.3, 0.1}};
+  PendulumSystem::StateType twice = once;
+  ASSERT_TRUE(advanceState(cashKarp54Integrator(), sys, once, 1.0, 0.001));
+  ASSERT_TRUE(advanceState(cashKarp54Integrator(), sys, twice, 0.5, 0.001));
+  ASSERT_TRUE(advanceState(cashKarp54Integrator(), sys, twice, 0.5, 0.001));
+  for (std::size_t i = 0; i < once.size(); ++i) {
+    EXPECT_NEAR(once[i], twice[i], 1e-5);
+  }
+
+  // a trial budget too small for the duration fails
+  PendulumSystem::StateType state{{1.5, -2.0, 0.3, 0.1}};
+  EXPECT_FALSE(
+      advanceState(cashKarp54Integrator(), sys, state, 1.0, 0.001, 3));
+}
+
+TEST(CellMappingTest, cellCentersAreInTheirCells) {
+  const PendulumSystem sys = buildDefaultSystem();
+  const CellMapping mapping(sys, 20, 4, 1.0);
+  EXPECT_EQ(mapping.velocityCellCount(), 5u);
+  EXPECT_EQ(mapping.cellCount(), 20u * 20u * 5u * 5u);
+  EXPECT_DOUBLE_EQ(mapping.positionSpacing(), 2.0 * sys.length / 20.0);
+
+  for (std::size_t cell = 0; cell < mapping.cellCount(); cell += 7) {
+    EXPECT_EQ(mapping.cellOf(mapping.cellCenter(cell)),
+              static_cast<std::int32_t>(cell));
+  }
+
+  // the middle velocity cell is centered on rest
+  const std::int32_t restCell = mapping.cellOf({{0.25, 0.25, 0.0, 0.0}});
+  ASSERT_NE(restCell, CellMapping::sinkCell);
+  const auto center = mapping.cellCenter(static_cast<std::size_t>(restCell));
+  EXPECT_DOUBLE_EQ(center[2], 0.0);
+  EXPECT_DOUBLE_EQ(center[3], 0.0);
+  EXPECT_EQ(mapping.cellOf({{2.0 * sys.length, 0.0, 0.0, 0.0}}),
+            CellMapping::sinkCell);
+}
+
+TEST(CellMappingTest, resolveFollowsImagesToPeriodicGroups) {
+  const PendulumSystem sys = buildDefaultSystem();
+  CellMapping mapping(sys, 40, 3, 0.5);
+  // states right of the y axis pass the attractor at (1, 0) too fast to be
+  // captured by its well, the others leave the cells
+  const double fastVelocity = mapping.velocitySpacing();
+  const std::int32_t fastCell =
+      mapping.cellOf({{1.0, 0.0, fastVelocity, 0.0}});
+  const CellFlow flow = [fastVelocity](PendulumSystem::StateType &state) {
+    if (state[0] <= 0.0)
+      return false;
+
+    state = {{1.0, 0.0, fastVelocity, 0.0}};
+    return true;
+  };
+  mapAllCells(mapping, flow);
+  mapping.resolve(0.5, 0.1);
+  EXPECT_EQ(mapping.periodicGroupCount(), 1u);
+  EXPECT_EQ(mapping.resolvedGroupCount(), 1u);
+  EXPECT_EQ(mapping.absorbingCellCount(), 0u);
+  EXPECT_EQ(mapping.convergePosition(static_cast<std::size_t>(fastCell)), 2);
+  EXPECT_DOUBLE_EQ(
+      mapping.convergeTime(static_cast<std::size_t>(fastCell)), 0.0);
+
+  const auto right = static_cast<std::size_t>(
+      mapping.cellOf({{6.0, 6.0, 0.0, 0.0}}));
+  EXPECT_EQ(mapping.image(right), fastCell);
+  EXPECT_EQ(mapping.convergePosition(right), 2);
+  EXPECT_DOUBLE_EQ(mapping.convergeTime(right), 0.5);
+
+  const auto left = static_cast<std::size_t>(
+      mapping.cellOf({{-6.0, 6.0, 0.0, 0.0}}));
+  EXPECT_EQ(mapping.image(left), CellMapping::sinkCell);
+  EXPECT_EQ(mapping.convergePosition(left), unresolvedPosition);
+
+  // with energy capture the absorbing cells are resolved without following
+  // their images, they are the only cells resolving differently
+  PendulumSystem capturingSys = sys;
+  capturingSys.wells = std::make_shared<const AttractorWells>(sys);
+  CellMapping capturingMapping(capturingSys, 40, 3, 0.5);
+  mapAllCells(capturingMapping, flow);
+  capturingMapping.resolve(0.5, 0.1);
+  EXPECT_GT(capturingMapping.absorbingCellCount(), 0u);
+  std::size_t absorbedCount = 0;
+  for (std::size_t cell = 0; cell < mapping.cellCount(); ++cell) {
+    const int position = capturingMapping.convergePosition(cell);
+    if (position != mapping.convergePosition(cell) ||
+        capturingMapping.convergeTime(cell) != mapping.convergeTime(cell)) {
+      EXPECT_NE(position, unresolvedPosition);
+      EXPECT_EQ(capturingMapping.convergeTime(cell), 0.0);
+      ++absorbedCount;
+    }
+  }
+  EXPECT_GT(absorbedCount, 0u);
+  EXPECT_LE(absorbedCount, capturingMapping.absorbingCellCount());
+}
+
+TEST(CellMappingTest, fillAgreesWithIntegratedPoints) {
+  // strong drag keeps the basins coarse enough for the cells
+  PendulumSystem sys = buildDefaultSystem();
+  sys.drag = 2.0;
+  CellMapping mapping(sys, 32, 5, 1.0);
+  mapAllCells(mapping, [&sys](PendulumSystem::StateType &state) {
+    return advanceState(cashKarp54Integrator(), sys, state, 1.0, 0.001);
+  });
+  mapping.resolve(0.5, 0.1);
+  Map cellMap(-3.0, -3.0, 3.0, 3.0, 0.25);
+  mapping.fill(cellMap);
+
+  Map integratedMap(-3.0, -3.0, 3.0, 3.0, 0.25);
+  std::size_t agreeing = 0;
+  const std::size_t count = cellMap.rows() * cellMap.cols();
+  for (std::size_t index = 0; index < count; ++index) {
+    Point point = integratedMap.point(index);
+    integratePoint(cashKarp54Integrator(), sys, point, 0.001, 0.5, 0.1, 5.0);
+    const Point cellPoint = cellMap.point(index);
+    EXPECT_EQ(cellPoint.stepCount, 0);
+    if (cellPoint.convergePosition == point.convergePosition)
+      ++agreeing;
+  }
+  EXPECT_GE(agreeing, count * 8 / 10);
+}
+} // namespace staticpendulum
@@ -0,0 +1,113 @@
+#include "CoreEngine/costmodel.h"
+#include "testsystems.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+namespace staticpendulum {
+namespace {
+// Map whose integrable points have a step count growing towards the center,
+// standing in for an integrated map.
+Map buildIntegratedMap(const PendulumSystem &sys) {
+  Map map(-10.0, -10.0, 10.0, 10.0, 0.1);
+  for (auto &&point : map) {
+    if (isIntegrable(sys, point)) {
+      point.stepCount = static_cast<int>(
+          1000.0 / (1.0 + std::hypot(point.xPosition, point.yPosition)));
+    }
+  }
+  return map;
+}
+} // namespace
+
+TEST(CostModelTest, pointCostIsNearestStepCount) {
+  const PendulumSystem sys = buildDefaultSystem();
+  const Map map = buildIntegratedMap(sys);
+  const StepCountCostModel costModel(map);
+  for (const auto &point : map) {
+    if (point.stepCount > 0) {
+      EXPECT_EQ(costModel.pointCost(point.xPosition + 0.04,
+                                    point.yPosition - 0.04),
+                point.stepCount);
+    } else {
+      EXPECT_EQ(costModel.pointCost(point.xPosition, point.yPosition),
+                costModel.meanCost());
+    }
+  }
+
+  // outside of the integrated map
+  EXPECT_EQ(costModel.pointCost(20.0, 0.0), costModel.meanCost());
+  EXPECT_GT(costModel.meanCost(), 0.0);
+}
+
+TEST(CostModelTest, coarsePrepassMapCoversSameArea) {
+  const Map map(-10.0, -10.0, 10.0, 10.0, 0.01);
+  const Map coarseMap = makeCoarsePrepassMap(map);
+  EXPECT_DOUBLE_EQ(coarseMap.resolution(),
+                   map.resolution() * coarsePrepassFactor);
+  EXPECT_EQ(coarseMap.cols(), (map.cols() - 1) / coarsePrepassFactor + 1);
+  EXPECT_DOUBLE_EQ(coarseMap.begin()->xPosition, map.begin()->xPosition);
+  EXPECT_DOUBLE_EQ(coarseMap.begin()->yPosition, map.begin()->yPosition);
+}
+
+TEST(CostModelTest, costTilesCoverIntegrablePointsWithinTarget) {
+  const PendulumSystem sys = buildDefaultSystem();
+  const Map map = buildIntegratedMap(sys);
+  const StepCountCostModel costModel(map);
+  const unsigned threadCount = 4;
+
+  std::vector<double> costs;
+  const std::vector<Tile> tiles =
+      makeCostTiles(map, sys, costModel, threadCount, costs);
+  ASSERT_EQ(costs.size(), tiles.size());
+  EXPECT_EQ(costs, tileCosts(map, sys, tiles, costModel));
+
+  const std::vector<Tile> uniformTiles = makeTiles(map, sys);
+  const std::vector<double> expectedCosts =
+      tileCosts(map, sys, uniformTiles, costModel);
+  const double totalCost =
+      std::accumulate(expectedCosts.begin(), expectedCosts.end(), 0.0);
+  EXPECT_NEAR(std::accumulate(costs.begin(), costs.end(), 0.0), totalCost,
+              1e-9 * totalCost);
+
+  const double targetCost = totalCost / (threadCount * costTilesPerThread);
+  bool hasLargeTile = false;
+  std::vector<int> covered(map.rows() * map.cols(), 0);
+  for (std::size_t i = 0; i < tiles.size(); ++i) {
+    if (tiles[i].pointCount() >= minimumCostTilePointCount) {
+      EXPECT_LE(costs[i], targetCost);
+    }
+    hasLargeTile = hasLargeTile || tiles[i].pointCount() >
+                                       defaultTileRows * defaultTileColumns;
+    for (std::size_t row = tiles[i].firstRow; row < tiles[i].lastRow; ++row) {
+      for (std::size_t column = tiles[i].firstColumn;
+           column < tiles[i].lastColumn; ++column) {
+        ++covered[row * map.cols() + column];
+      }
+    }
+  }
+  // cheap areas keep tiles larger than the default
+  EXPECT_TRUE(hasLargeTile);
+
+  auto point = map.begin();
+  for (int count : covered) {
+    EXPECT_LE(count, 1);
+    if (isIntegrable(sys, *point)) {
+      EXPECT_EQ(count, 1);
+    }
+    ++point;
+  }
+}
+
+TEST(CostModelTest, schedulerRunsLongestTilesFirst) {
+  const std::vector<Tile> tiles = {
+      {0, 1, 0, 1}, {1, 2, 0, 1}, {2, 3, 0, 1}, {3, 4, 0, 1}};
+  const std::vector<double> costs = {1.0, 4.0, 2.0, 3.0};
+  TileScheduler scheduler(1);
+  std::vector<std::size_t> order;
+  scheduler.run(tiles, costs,
+                [&](const Tile &row) { order.push_back(row.firstRow); });
+  EXPECT_EQ(order, (std::vector<std::size_t>{1, 3, 2, 0}));
+}
+} // namespace staticpendulum
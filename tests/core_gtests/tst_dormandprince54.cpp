@@ -0,0 +1,66 @@
+#include "CoreEngine/dormandprince54.h"
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+// Harmonic oscillator x'' = -x with exact solution x = cos(t), counts the
+// number of times it is evaluated.
+struct HarmonicOscillator {
+  void operator()(const std::array<double, 2> &x, std::array<double, 2> &dxdt,
+                  const double /* t */) {
+    dxdt[0] = x[1];
+    dxdt[1] = -x[0];
+    ++evaluationCount;
+  }
+
+  int evaluationCount = 0;
+};
+} // namespace
+
+TEST(DormandPrince54Test, harmonicOscillatorAccuracy) {
+  HarmonicOscillator sys;
+  std::array<double, 2> x = {{1.0, 0.0}};
+  std::array<double, 2> dxdtx;
+  double t = 0.0;
+  double h = 0.01;
+  sys(x, dxdtx, t);
+
+  const double endTime = 10.0;
+  while (t < endTime) {
+    h = std::min(h, endTime - t);
+    dormandPrince54(sys, x, dxdtx, t, h, 1e-10, 1e-10, 0.1);
+  }
+
+  EXPECT_NEAR(x[0], std::cos(t), 1e-8);
+  EXPECT_NEAR(x[1], -std::sin(t), 1e-8);
+}
+
+TEST(DormandPrince54Test, reusesLastStageDerivative) {
+  HarmonicOscillator sys;
+  std::array<double, 2> x = {{1.0, 0.0}};
+  std::array<double, 2> dxdtx;
+  double t = 0.0;
+  double h = 1.0; // large enough that the first attempts are rejected
+  sys(x, dxdtx, t);
+
+  int attemptCount = 0;
+  int acceptedCount = 0;
+  while (t < 5.0) {
+    acceptedCount += dormandPrince54(sys, x, dxdtx, t, h, 1e-8, 1e-8, 0.5);
+    ++attemptCount;
+
+    // the carried derivative must match the derivative at the new state
+    HarmonicOscillator reference;
+    std::array<double, 2> expected;
+    reference(x, expected, t);
+    EXPECT_DOUBLE_EQ(dxdtx[0], expected[0]);
+    EXPECT_DOUBLE_EQ(dxdtx[1], expected[1]);
+  }
+
+  EXPECT_LT(acceptedCount, attemptCount);
+  // one initial evaluation plus six per attempt
+  EXPECT_EQ(sys.evaluationCount, 1 + 6 * attemptCount);
+}
+} // namespace staticpendulum
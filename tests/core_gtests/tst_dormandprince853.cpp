@@ -0,0 +1,105 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/dormandprince853.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+// Harmonic oscillator x'' = -x with exact solution x = cos(t).
+struct HarmonicOscillator {
+  void operator()(const std::array<double, 2> &x, std::array<double, 2> &dxdt,
+                  const double /* t */) const {
+    dxdt[0] = x[1];
+    dxdt[1] = -x[0];
+  }
+};
+
+template <typename Tableau>
+int stepsToIntegrateOscillator(double tolerance, std::array<double, 2> &x) {
+  HarmonicOscillator sys;
+  x = {{1.0, 0.0}};
+  std::array<double, 2> dxdtx;
+  double t = 0.0;
+  double h = 0.01;
+  sys(x, dxdtx, t);
+
+  int stepCount = 0;
+  const double endTime = 10.0;
+  while (t < endTime) {
+    h = std::min(h, endTime - t);
+    stepCount += explicitRungeKutta<Tableau>(sys, x, dxdtx, t, h, tolerance,
+                                             tolerance, 1.0);
+  }
+  return stepCount;
+}
+} // namespace
+
+TEST(DormandPrince853Test, harmonicOscillatorAccuracy) {
+  HarmonicOscillator sys;
+  std::array<double, 2> x = {{1.0, 0.0}};
+  std::array<double, 2> dxdtx;
+  double t = 0.0;
+  double h = 0.01;
+  sys(x, dxdtx, t);
+
+  const double endTime = 10.0;
+  while (t < endTime) {
+    h = std::min(h, endTime - t);
+    dormandPrince853(sys, x, dxdtx, t, h, 1e-10, 1e-10, 0.1);
+  }
+
+  EXPECT_NEAR(x[0], std::cos(endTime), 1e-8);
+  EXPECT_NEAR(x[1], -std::sin(endTime), 1e-8);
+}
+
+TEST(DormandPrince853Test, fewerStepsThanCashKarpAtTightTolerance) {
+  std::array<double, 2> x;
+  const int cashKarpSteps =
+      stepsToIntegrateOscillator<CashKarp54Tableau>(1e-10, x);
+  const int dormandPrinceSteps =
+      stepsToIntegrateOscillator<DormandPrince853Tableau>(1e-10, x);
+  EXPECT_NEAR(x[0], std::cos(10.0), 1e-8);
+  EXPECT_LT(3 * dormandPrinceSteps, cashKarpSteps);
+}
+
+TEST(DormandPrince853Test, mapStepCountBelowCashKarp) {
+  PendulumSystem sys;
+  const double yMag = std::sqrt(1 - 0.5 * 0.5);
+  sys.attractorList.emplace_back(-0.5, yMag, 1);
+  sys.attractorList.emplace_back(-0.5, -yMag, 1);
+  sys.attractorList.emplace_back(1.0, 0.0, 1);
+  Map cashKarpMap(-2.0, -2.0, 2.0, 2.0, 1.0);
+  Map dormandPrinceMap(-2.0, -2.0, 2.0, 2.0, 1.0);
+
+  auto cashKarpIntegrator = [](auto &&dxdt, auto &x, auto &dxdtx, auto &t,
+                               auto &h, auto &accepted, auto &controllers) {
+    explicitRungeKuttaBatch<CashKarp54Tableau>(
+        dxdt, x, dxdtx, t, h, accepted, 1e-10, 1e-10, 1.0, controllers);
+  };
+  auto dormandPrinceIntegrator = [](auto &&dxdt, auto &x, auto &dxdtx,
+                                    auto &t, auto &h, auto &accepted,
+                                    auto &controllers) {
+    explicitRungeKuttaBatch<DormandPrince853Tableau>(
+        dxdt, x, dxdtx, t, h, accepted, 1e-10, 1e-10, 1.0, controllers);
+  };
+
+  integratePoints<4>(cashKarpIntegrator, sys, cashKarpMap.begin(),
+                     cashKarpMap.end(), 0.001, 0.5, 0.1, 5.0);
+  integratePoints<4>(dormandPrinceIntegrator, sys, dormandPrinceMap.begin(),
+                     dormandPrinceMap.end(), 0.001, 0.5, 0.1, 5.0);
+
+  int cashKarpSteps = 0;
+  int dormandPrinceSteps = 0;
+  auto cashKarpIter = cashKarpMap.begin();
+  for (const auto &point : dormandPrinceMap) {
+    EXPECT_EQ(point.convergePosition, cashKarpIter->convergePosition);
+    cashKarpSteps += cashKarpIter->stepCount;
+    dormandPrinceSteps += point.stepCount;
+    ++cashKarpIter;
+  }
+  EXPECT_LT(dormandPrinceSteps, cashKarpSteps);
+}
+} // namespace staticpendulum
@@ -0,0 +1,104 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/denseoutput.h"
+#include "CoreEngine/eventlocation.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "testsystems.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+// Integrates the point from (x, y) at rest with cashKarp54 limited to the
+// maximum step size.
+Point integrateWithMaximumStep(const PendulumSystem &sys, double x, double y,
+                               double maxStepSize) {
+  auto integrator = [maxStepSize](auto &&dxdt, auto &state, auto &t,
+                                  auto &h) {
+    return cashKarp54(dxdt, state, t, h, 1e-10, 1e-10, maxStepSize);
+  };
+  Point point;
+  point.xPosition = x;
+  point.yPosition = y;
+  point.xVelocity = 0.0;
+  point.yVelocity = 0.0;
+  integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0);
+  return point;
+}
+} // namespace
+
+TEST(EventLocationTest, hermiteInterpolantIsExactForCubics) {
+  auto cubic = [](double t) { return t * t * t - 2.0 * t + 1.0; };
+  auto derivative = [](double t) { return 3.0 * t * t - 2.0; };
+  const HermiteInterpolant<1> interpolant(0.5, {{cubic(0.5)}},
+                                          {{derivative(0.5)}}, 2.0,
+                                          {{cubic(2.0)}}, {{derivative(2.0)}});
+  EXPECT_DOUBLE_EQ(interpolant.startTime(), 0.5);
+  EXPECT_DOUBLE_EQ(interpolant.endTime(), 2.0);
+  for (double t = 0.5; t <= 2.0; t += 0.125) {
+    EXPECT_NEAR(interpolant(0, t), cubic(t), 1e-12);
+  }
+}
+
+TEST(EventLocationTest, denseOutputFollowsTheStep) {
+  const PendulumSystem sys = buildDefaultSystem();
+  PendulumSystem::StateType startState = {{1.5, -2.0, 0.3, 0.1}};
+  PendulumSystem::StateType startDerivative;
+  sys(startState, startDerivative, 0.0);
+
+  // one step of 0.1, then the middle of it integrated on its own
+  PendulumSystem::StateType endState = startState;
+  double time = 0.0;
+  double stepSize = 0.1;
+  ASSERT_EQ(cashKarp54(sys, endState, time, stepSize, 1e-6, 1e-6, 0.1), 1);
+  PendulumSystem::StateType endDerivative;
+  sys(endState, endDerivative, time);
+  const HermiteInterpolant<4> interpolant(0.0, startState, startDerivative,
+                                          time, endState, endDerivative);
+
+  PendulumSystem::StateType middleState = startState;
+  double middleTime = 0.0;
+  double middleStepSize = 0.05;
+  ASSERT_EQ(cashKarp54(sys, middleState, middleTime, middleStepSize, 1e-6,
+                       1e-6, 0.05),
+            1);
+  const PendulumSystem::StateType interpolated = interpolant(middleTime);
+  for (std::size_t i = 0; i < 4; ++i) {
+    EXPECT_NEAR(interpolated[i], middleState[i], 1e-6);
+  }
+
+  // the head position only needs the states
+  const auto head = headPositionInterpolant(0.0, startState, time, endState);
+  EXPECT_NEAR(head(0, middleTime), interpolated[0], 1e-12);
+  EXPECT_NEAR(head(1, middleTime), interpolated[1], 1e-12);
+}
+
+TEST(EventLocationTest, locateEventFindsTheCrossing) {
+  auto smooth = [](double t) { return 2.0 - t * t; };
+  EXPECT_NEAR(locateEvent(smooth, 0.0, smooth(0.0), 3.0, smooth(3.0), 1e-12),
+              std::sqrt(2.0), 1e-10);
+
+  // a kink in the maximum norm distance to a zone does not stop the search
+  auto kinked = [](double t) {
+    return std::max(std::abs(t - 3.0), std::abs(0.5 * t - 1.0)) - 1.0;
+  };
+  const double crossing =
+      locateEvent(kinked, 0.0, kinked(0.0), 2.5, kinked(2.5), 1e-12);
+  EXPECT_NEAR(crossing, 2.0, 1e-10);
+  EXPECT_LE(kinked(crossing), 0.0);
+}
+
+TEST(EventLocationTest, convergeTimeDoesNotDependOnTheStepSize) {
+  const PendulumSystem sys = buildDefaultSystem();
+  for (const auto &start : {std::make_pair(-2.0, 1.0),
+                           std::make_pair(0.3, -1.7)}) {
+    const Point largeSteps =
+        integrateWithMaximumStep(sys, start.first, start.second, 0.1);
+    const Point smallSteps =
+        integrateWithMaximumStep(sys, start.first, start.second, 0.001);
+    EXPECT_EQ(largeSteps.convergePosition, smallSteps.convergePosition);
+    EXPECT_NEAR(largeSteps.convergeTime, smallSteps.convergeTime, 1e-6);
+    EXPECT_LT(largeSteps.stepCount, smallSteps.stepCount);
+  }
+}
+} // namespace staticpendulum
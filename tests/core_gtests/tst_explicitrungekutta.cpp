@@ -0,0 +1,146 @@
+#include "CoreEngine/bogackishampine32.h"
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/dormandprince54.h"
+#include "CoreEngine/dormandprince853.h"
+#include "CoreEngine/explicitrungekutta.h"
+#include "CoreEngine/verner65.h"
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+// Nonlinear scalar test equation y' = -y^2 + t with y(0) = 1, accepts single
+// and batched states.
+struct TestEquation {
+  void operator()(const std::array<double, 1> &x, std::array<double, 1> &dxdt,
+                  const double t) const {
+    dxdt[0] = -x[0] * x[0] + t;
+  }
+
+  template <std::size_t Lanes>
+  void operator()(const BatchState<1, Lanes> &x, BatchState<1, Lanes> &dxdt,
+                  const LaneArray<double, Lanes> &t) const {
+    for (std::size_t l = 0; l < Lanes; ++l) {
+      dxdt[0][l] = -x[0][l] * x[0][l] + t[l];
+    }
+  }
+};
+
+// Integrates the test equation to t = 1 with a fixed step size by making the
+// tolerances so loose that every step is accepted and capping the step size.
+template <typename Tableau> double integrateFixedStep(double h) {
+  TestEquation sys;
+  std::array<double, 1> x = {{1.0}};
+  std::array<double, 1> dxdtx;
+  double t = 0.0;
+  sys(x, dxdtx, t);
+  const int stepCount = static_cast<int>(std::lround(1.0 / h));
+  for (int i = 0; i < stepCount; ++i) {
+    double stepSize = h;
+    explicitRungeKutta<Tableau>(sys, x, dxdtx, t, stepSize, 1e10, 1e10, h);
+  }
+  return x[0];
+}
+} // namespace
+
+template <typename Tableau>
+class ExplicitRungeKuttaTest : public testing::Test {};
+
+typedef testing::Types<CashKarp54Tableau, DormandPrince54Tableau,
+                       BogackiShampine32Tableau, Verner65Tableau,
+                       DormandPrince853Tableau>
+    Tableaus;
+TYPED_TEST_CASE(ExplicitRungeKuttaTest, Tableaus);
+
+TYPED_TEST(ExplicitRungeKuttaTest, rowSumsMatchNodes) {
+  for (std::size_t i = 0; i < TypeParam::stageCount; ++i) {
+    double rowSum = 0.0;
+    for (std::size_t j = 0; j < i; ++j) {
+      rowSum += TypeParam::a(i, j);
+    }
+    EXPECT_NEAR(rowSum, TypeParam::c(i), 1e-14) << "Row: " << i;
+  }
+}
+
+TYPED_TEST(ExplicitRungeKuttaTest, convergesWithTableauOrder) {
+  // compare against a much finer solution, halving the step size should
+  // divide the global error by at least 2^order (at these step sizes some
+  // tableaus still converge faster than their asymptotic order)
+  const double reference = integrateFixedStep<TypeParam>(1.0 / 2048.0);
+  const double coarseError =
+      std::abs(integrateFixedStep<TypeParam>(1.0 / 8.0) - reference);
+  const double fineError =
+      std::abs(integrateFixedStep<TypeParam>(1.0 / 16.0) - reference);
+  const double observedOrder = std::log2(coarseError / fineError);
+  EXPECT_GT(observedOrder, TypeParam::order - 0.5);
+}
+
+TYPED_TEST(ExplicitRungeKuttaTest, batchMatchesScalarPerLane) {
+  TestEquation sys;
+  constexpr std::size_t lanes = 4;
+  BatchState<1, lanes> batchStates = {{{{1.0, 0.5, 2.0, -0.5}}}};
+  BatchState<1, lanes> batchDerivatives;
+  LaneArray<double, lanes> batchTimes = {{0.0, 0.1, 0.2, 0.3}};
+  LaneArray<double, lanes> batchSteps = {{0.1, 0.5, 0.01, 1.0}};
+  LaneArray<int, lanes> accepted;
+  sys(batchStates, batchDerivatives, batchTimes);
+
+  std::array<std::array<double, 1>, lanes> states;
+  std::array<std::array<double, 1>, lanes> derivatives;
+  LaneArray<double, lanes> times = batchTimes;
+  LaneArray<double, lanes> steps = batchSteps;
+  for (std::size_t l = 0; l < lanes; ++l) {
+    states[l][0] = batchStates[0][l];
+    sys(states[l], derivatives[l], times[l]);
+  }
+
+  for (int trial = 0; trial < 20; ++trial) {
+    explicitRungeKuttaBatch<TypeParam>(sys, batchStates, batchDerivatives,
+                                       batchTimes, batchSteps, accepted, 1e-8,
+                                       1e-8, 0.5);
+    for (std::size_t l = 0; l < lanes; ++l) {
+      EXPECT_EQ(accepted[l], explicitRungeKutta<TypeParam>(
+                                 sys, states[l], derivatives[l], times[l],
+                                 steps[l], 1e-8, 1e-8, 0.5))
+          << "Lane: " << l << " trial: " << trial;
+    }
+  }
+
+  // release builds use fast math so vectorized lanes may round differently,
+  // the step size control amplifies the difference over the steps
+  for (std::size_t l = 0; l < lanes; ++l) {
+    EXPECT_NEAR(batchTimes[l], times[l], 1e-7) << "Lane: " << l;
+    EXPECT_NEAR(batchStates[0][l], states[l][0], 1e-7) << "Lane: " << l;
+    EXPECT_NEAR(batchDerivatives[0][l], derivatives[l][0], 1e-7)
+        << "Lane: " << l;
+  }
+}
+
+TEST(ExplicitRungeKuttaTest, cashKarp54TableauMatchesUnrolledStep) {
+  // the engine keeps the summation order of the unrolled step, release builds
+  // use fast math which may still round the two differently in the last bits
+  TestEquation sys;
+  for (const double start : {1.0, 0.5, -0.5, 2.0}) {
+    std::array<double, 1> engineState = {{start}};
+    std::array<double, 1> unrolledState = engineState;
+    std::array<double, 1> derivative;
+    double engineTime = 0.0;
+    double engineStep = 0.3;
+    for (int trial = 0; trial < 10; ++trial) {
+      double unrolledTime = engineTime;
+      double unrolledStep = engineStep;
+      unrolledState = engineState;
+      sys(engineState, derivative, engineTime);
+      EXPECT_EQ(explicitRungeKutta<CashKarp54Tableau>(
+                    sys, engineState, derivative, engineTime, engineStep,
+                    1e-8, 1e-8, 0.5),
+                cashKarp54(sys, unrolledState, unrolledTime, unrolledStep,
+                           1e-8, 1e-8, 0.5));
+      EXPECT_DOUBLE_EQ(engineState[0], unrolledState[0]);
+      EXPECT_DOUBLE_EQ(engineTime, unrolledTime);
+      EXPECT_DOUBLE_EQ(engineStep, unrolledStep);
+    }
+  }
+}
+} // namespace staticpendulum
@@ -0,0 +1,171 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/fatecache.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "testsystems.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace staticpendulum {
+namespace {
+// Integrates the points of the map with cashKarp54 and the default
+// thresholds, returns the total step count.
+long long integrateMap(const PendulumSystem &sys, Map &map) {
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+  long long stepCount = 0;
+  for (std::size_t i = 0; i < map.rows() * map.cols(); ++i) {
+    integratePoint(integrator, sys, map.point(i), 0.001, 0.5, 0.1, 5.0);
+    stepCount += map.point(i).stepCount;
+  }
+  return stepCount;
+}
+} // namespace
+
+TEST(FateCacheTest, statesInTheSameCellShareIt) {
+  const FateCache cache(0.1, 0.5, 1, 64);
+  EXPECT_EQ(cache.slotCount(), 64u);
+  const std::uint64_t cell = cache.cellOf({{0.12, -0.31, 0.2, -0.7}});
+  EXPECT_NE(cell, 0u);
+  EXPECT_EQ(cache.cellOf({{0.19, -0.39, 0.4, -0.9}}), cell);
+  EXPECT_NE(cache.cellOf({{0.21, -0.31, 0.2, -0.7}}), cell);
+  EXPECT_NE(cache.cellOf({{0.12, -0.31, 0.2, -0.2}}), cell);
+
+  // states far outside of the quantised range share the border cells
+  EXPECT_EQ(cache.cellOf({{-1e9, -1e9, -1e9, -1e9}}),
+            cache.cellOf({{-2e9, -2e9, -2e9, -2e9}}));
+  EXPECT_NE(cache.cellOf({{-1e9, -1e9, -1e9, -1e9}}), 0u);
+}
+
+TEST(FateCacheTest, cellIsKnownAfterConfidenceAgreeingTrajectories) {
+  FateCache cache(0.1, 0.1, 3, 64);
+  const std::uint64_t cell = cache.cellOf({{1.0, 0.0, 0.0, 0.0}});
+  int position = -2;
+  double remainingTime = 0.0;
+  cache.record(cell, 2, 4.0);
+  cache.record(cell, 2, 3.0);
+  EXPECT_FALSE(cache.find(cell, position, remainingTime));
+  EXPECT_EQ(cache.knownCellCount(), 0u);
+
+  cache.record(cell, 2, 2.0);
+  ASSERT_TRUE(cache.find(cell, position, remainingTime));
+  EXPECT_EQ(position, 2);
+  EXPECT_DOUBLE_EQ(remainingTime, 4.0);
+  EXPECT_EQ(cache.knownCellCount(), 1u);
+
+  // the middle is a fate too
+  const std::uint64_t middleCell = cache.cellOf({{0.0, 0.0, 0.0, 0.0}});
+  for (int i = 0; i < 3; ++i) {
+    cache.record(middleCell, -1, 0.5);
+  }
+  ASSERT_TRUE(cache.find(middleCell, position, remainingTime));
+  EXPECT_EQ(position, -1);
+
+  // a disagreeing trajectory makes the cell unknown for good
+  cache.record(cell, 0, 1.0);
+  cache.record(cell, 2, 1.0);
+  EXPECT_FALSE(cache.find(cell, position, remainingTime));
+  EXPECT_EQ(cache.knownCellCount(), 1u);
+  EXPECT_EQ(cache.conflictedCellCount(), 1u);
+
+  EXPECT_EQ(cache.lookupCount(), 4u);
+  EXPECT_EQ(cache.hitCount(), 2u);
+  EXPECT_DOUBLE_EQ(cache.hitRate(), 0.5);
+  EXPECT_EQ(cache.recordCount(), 8u);
+  EXPECT_EQ(cache.droppedCount(), 0u);
+}
+
+TEST(FateCacheTest, fullTableDropsRecords) {
+  FateCache cache(0.1, 0.1, 1, 1);
+  const std::uint64_t firstCell = cache.cellOf({{1.0, 0.0, 0.0, 0.0}});
+  const std::uint64_t secondCell = cache.cellOf({{-1.0, 0.0, 0.0, 0.0}});
+  cache.record(firstCell, 2, 1.0);
+  cache.record(secondCell, 0, 1.0);
+  EXPECT_EQ(cache.droppedCount(), 1u);
+
+  int position;
+  double remainingTime;
+  EXPECT_TRUE(cache.find(firstCell, position, remainingTime));
+  EXPECT_FALSE(cache.find(secondCell, position, remainingTime));
+}
+
+TEST(FateCacheTest, concurrentRecordsAreAllCounted) {
+  FateCache cache(0.1, 0.1, 4000, 1024);
+  constexpr std::size_t cellCount = 64;
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; ++thread) {
+    threads.emplace_back([&cache]() {
+      for (int i = 0; i < 1000; ++i) {
+        for (std::size_t cell = 0; cell < cellCount; ++cell) {
+          const double x = 0.1 * static_cast<double>(cell) + 0.05;
+          cache.record(cache.cellOf({{x, 0.0, 0.0, 0.0}}),
+                       static_cast<int>(cell % 3), 1.0);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // every cell needs all 4000 of its records to be known
+  EXPECT_EQ(cache.recordCount(), 4u * 1000u * cellCount);
+  EXPECT_EQ(cache.knownCellCount(), cellCount);
+  EXPECT_EQ(cache.conflictedCellCount(), 0u);
+}
+
+TEST(FateCacheTest, trailSpansTheWholeTrajectory) {
+  FateCache cache(1.0, 1.0, 1, 1024);
+  FateTrail trail;
+  std::vector<std::uint64_t> cells;
+  for (int i = 0; i < 100; ++i) {
+    cells.push_back(cache.cellOf({{static_cast<double>(i), 0.0, 0.0, 0.0}}));
+    // the same cell twice in a row is a single visit
+    trail.push(cells.back(), i);
+    trail.push(cells.back(), i + 0.5);
+  }
+  trail.record(cache, 1, 200.0);
+
+  EXPECT_LE(cache.knownCellCount(), FateTrail::maximumLength);
+  EXPECT_GE(cache.knownCellCount(), FateTrail::maximumLength / 2);
+  int position;
+  double remainingTime;
+  std::size_t earlyCellCount = 0;
+  for (int i = 0; i < 100; ++i) {
+    if (cache.find(cells[static_cast<std::size_t>(i)], position,
+                   remainingTime)) {
+      EXPECT_EQ(position, 1);
+      EXPECT_DOUBLE_EQ(remainingTime, 200.0 - i);
+      if (i < 10)
+        ++earlyCellCount;
+    }
+  }
+  EXPECT_GT(earlyCellCount, 0u);
+}
+
+TEST(FateCacheTest, pointsStopOnCellsOfKnownFate) {
+  PendulumSystem sys = buildDefaultSystem();
+  Map expected(-2.0, -2.0, 2.0, 2.0, 0.25);
+  const long long expectedSteps = integrateMap(sys, expected);
+
+  // the second pass reaches the cells the first one resolved
+  sys.fateCache = std::make_shared<FateCache>(0.1, 0.1, 1, 1 << 16);
+  Map firstPass(-2.0, -2.0, 2.0, 2.0, 0.25);
+  integrateMap(sys, firstPass);
+  Map secondPass(-2.0, -2.0, 2.0, 2.0, 0.25);
+  const long long secondPassSteps = integrateMap(sys, secondPass);
+  EXPECT_GT(sys.fateCache->hitCount(), 0u);
+  EXPECT_LT(secondPassSteps, expectedSteps / 2);
+
+  std::size_t agreeing = 0;
+  const std::size_t count = expected.rows() * expected.cols();
+  for (std::size_t i = 0; i < count; ++i) {
+    if (secondPass.convergePosition(i) == expected.convergePosition(i))
+      ++agreeing;
+  }
+  EXPECT_GE(agreeing, count * 9 / 10);
+}
+} // namespace staticpendulum
@@ -0,0 +1,106 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/fixedpendulumsystem.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "testsystems.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <type_traits>
+
+namespace staticpendulum {
+namespace {
+template <typename SystemType>
+void expectSameDerivatives(const PendulumSystem &reference,
+                           const SystemType &sys) {
+  const PendulumSystem::StateType x = {{0.3, -0.7, 0.4, 0.2}};
+  PendulumSystem::StateType expected;
+  PendulumSystem::StateType actual;
+  reference(x, expected, 0.0);
+  sys(x, actual, 0.0);
+  for (std::size_t i = 0; i < 4; ++i) {
+    EXPECT_NEAR(actual[i], expected[i], 1e-12 * (1.0 + std::abs(expected[i])));
+  }
+
+  PendulumSystem::JacobianType expectedJacobian;
+  PendulumSystem::JacobianType actualJacobian;
+  reference.jacobian(x, expectedJacobian, 0.0);
+  sys.jacobian(x, actualJacobian, 0.0);
+  for (std::size_t i = 0; i < 4; ++i) {
+    for (std::size_t j = 0; j < 4; ++j) {
+      EXPECT_NEAR(actualJacobian[i][j], expectedJacobian[i][j],
+                  1e-12 * (1.0 + std::abs(expectedJacobian[i][j])));
+    }
+  }
+
+  BatchState<4, 4> batchX;
+  BatchState<4, 4> batchExpected;
+  BatchState<4, 4> batchActual;
+  for (std::size_t l = 0; l < 4; ++l) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      batchX[i][l] = x[i] * (1.0 - 0.1 * l);
+    }
+  }
+  const LaneArray<double, 4> t = {};
+  reference(batchX, batchExpected, t);
+  sys(batchX, batchActual, t);
+  for (std::size_t l = 0; l < 4; ++l) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_NEAR(batchActual[i][l], batchExpected[i][l],
+                  1e-12 * (1.0 + std::abs(batchExpected[i][l])));
+    }
+  }
+}
+} // namespace
+
+TEST(FixedPendulumSystemTest, matchesPendulumSystemForEveryCount) {
+  for (std::size_t count = 0; count <= maximumFixedAttractorCount + 1;
+       ++count) {
+    SCOPED_TRACE(count);
+    const PendulumSystem reference = buildRingSystem(count, 0.1);
+    withFixedAttractorCount(reference, [&](const auto &sys) {
+      expectSameDerivatives(reference, sys);
+      return 0;
+    });
+  }
+}
+
+TEST(FixedPendulumSystemTest, dispatchesOnAttractorCount) {
+  auto fixedCount = [](const auto &sys) -> std::size_t {
+    using SystemType = std::decay_t<decltype(sys)>;
+    return std::is_same<SystemType, PendulumSystem>::value
+               ? 0
+               : sys.attractorList.size();
+  };
+
+  EXPECT_EQ(withFixedAttractorCount(buildRingSystem(0), fixedCount), 0u);
+  for (std::size_t count = 1; count <= maximumFixedAttractorCount; ++count) {
+    EXPECT_EQ(withFixedAttractorCount(buildRingSystem(count), fixedCount),
+              count);
+  }
+  EXPECT_EQ(withFixedAttractorCount(
+                buildRingSystem(maximumFixedAttractorCount + 1), fixedCount),
+            0u);
+}
+
+TEST(FixedPendulumSystemTest, mapMatchesPendulumSystem) {
+  const PendulumSystem reference = buildRingSystem(3, 0.1);
+  const FixedPendulumSystem<3> sys(reference);
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+
+  Map expectedMap(-2.0, -2.0, 2.0, 2.0, 0.5);
+  Map actualMap = expectedMap;
+  for (auto &&point : expectedMap) {
+    integratePoint(integrator, reference, point, 0.001, 0.5, 0.1, 5.0);
+  }
+  for (auto &&point : actualMap) {
+    integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0);
+  }
+
+  auto expected = expectedMap.begin();
+  for (const auto &point : actualMap) {
+    EXPECT_EQ(point.convergePosition, expected->convergePosition);
+    ++expected;
+  }
+}
+} // namespace staticpendulum
@@ -0,0 +1,118 @@
+#include "CoreEngine/forcefieldtable.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "testsystems.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace staticpendulum {
+namespace {
+// Nodes per side for the memory budget in bytes.
+std::size_t budgetFor(std::size_t nodeCount) {
+  return nodeCount * nodeCount * ForceFieldTable::nodeBytes;
+}
+} // namespace
+
+TEST(ForceFieldTableTest, gridFitsMemoryBudget) {
+  const PendulumSystem sys = buildRandomSystem(3);
+  const ForceFieldTable table(sys, budgetFor(100) + 1, 1);
+  EXPECT_EQ(table.nodeCount(), 100u);
+  EXPECT_DOUBLE_EQ(table.spacing(), 2.0 * sys.length / 96.0);
+
+  const ForceFieldTable smallestTable(sys, 0, 1);
+  EXPECT_EQ(smallestTable.nodeCount(), ForceFieldTable::minimumNodeCount);
+}
+
+TEST(ForceFieldTableTest, errorShrinksWithMemoryBudget) {
+  const PendulumSystem sys = buildRandomSystem(3);
+  const ForceFieldTable coarseTable(sys, budgetFor(200), 2);
+  const ForceFieldTable fineTable(sys, budgetFor(800), 2);
+  EXPECT_GT(coarseTable.maximumForce(), 0.0);
+  EXPECT_LT(fineTable.maximumError(), coarseTable.maximumError());
+  EXPECT_LT(fineTable.maximumError(), 1e-2 * fineTable.maximumForce());
+}
+
+TEST(ForceFieldTableTest, interpolatesWithinReportedError) {
+  PendulumSystem sys = buildRandomSystem(3);
+  const ForceFieldTable table(sys, budgetFor(400), 2);
+
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> position(-sys.length, sys.length);
+  const double validatedRadius = sys.length - 2.0 * table.spacing();
+  for (int i = 0; i < 1000; ++i) {
+    const double x = position(generator);
+    const double y = position(generator);
+    if (x * x + y * y > validatedRadius * validatedRadius)
+      continue;
+
+    const PendulumSystem::StateType state = {{x, y, 0.0, 0.0}};
+    PendulumSystem::StateType exact;
+    sys(state, exact, 0.0);
+    double xForce;
+    double yForce;
+    table.force(x, y, xForce, yForce);
+    // cell centers are not always the worst point of a cell
+    EXPECT_LE(std::hypot(xForce - exact[2] * sys.mass,
+                         yForce - exact[3] * sys.mass),
+              2.0 * table.maximumError());
+  }
+}
+
+TEST(ForceFieldTableTest, threadCountDoesNotChangeTable) {
+  const PendulumSystem sys = buildRandomSystem(50);
+  const ForceFieldTable singleThreadTable(sys, budgetFor(300), 1);
+  const ForceFieldTable multiThreadTable(sys, budgetFor(300), 4);
+  // the threads compute the same nodes, but with -ffast-math the copies of the
+  // row loop run by the calling thread and by the other threads may be
+  // contracted differently, so nodes may differ by the rounding of the
+  // largest force
+  const double tolerance = 1e-12 * singleThreadTable.maximumForce();
+  EXPECT_NEAR(multiThreadTable.maximumError(), singleThreadTable.maximumError(),
+              tolerance);
+  EXPECT_NEAR(multiThreadTable.maximumForce(), singleThreadTable.maximumForce(),
+              tolerance);
+  for (double x = -9.0; x < 10.0; x += 0.37) {
+    double xExpected;
+    double yExpected;
+    double xActual;
+    double yActual;
+    singleThreadTable.force(x, 0.5 * x, xExpected, yExpected);
+    multiThreadTable.force(x, 0.5 * x, xActual, yActual);
+    EXPECT_NEAR(xActual, xExpected, tolerance);
+    EXPECT_NEAR(yActual, yExpected, tolerance);
+  }
+}
+
+TEST(ForceFieldTableTest, systemUsesTableWhenSet) {
+  PendulumSystem sys = buildRandomSystem(20);
+  sys.forceTable =
+      std::make_shared<const ForceFieldTable>(sys, budgetFor(100), 1);
+  const PendulumSystem::StateType state = {{0.3, -0.7, 0.4, 0.2}};
+  PendulumSystem::StateType scalarTable;
+  sys(state, scalarTable, 0.0);
+
+  double xForce;
+  double yForce;
+  sys.forceTable->force(state[0], state[1], xForce, yForce);
+  EXPECT_EQ(scalarTable[0], state[2]);
+  EXPECT_EQ(scalarTable[1], state[3]);
+  EXPECT_DOUBLE_EQ(scalarTable[2], (xForce - sys.drag * state[2]) / sys.mass);
+  EXPECT_DOUBLE_EQ(scalarTable[3], (yForce - sys.drag * state[3]) / sys.mass);
+
+  BatchState<4, 4> batchState;
+  BatchState<4, 4> batchDerivative;
+  for (std::size_t l = 0; l < 4; ++l) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      batchState[i][l] = state[i];
+    }
+  }
+  sys(batchState, batchDerivative, LaneArray<double, 4>{});
+  // the batch evaluates the same expressions, -ffast-math may order the drag
+  // and force terms differently in its vector loop
+  for (std::size_t l = 0; l < 4; ++l) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_DOUBLE_EQ(batchDerivative[i][l], scalarTable[i]);
+    }
+  }
+}
+} // namespace staticpendulum
@@ -0,0 +1,143 @@
+#include "CoreEngine/mapcheckpoint.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+
+namespace staticpendulum {
+namespace {
+// Stands in for the integration of a row of the map.
+void fillRow(Map &map, std::size_t row) {
+  for (std::size_t column = 0; column < map.cols(); ++column) {
+    auto point = map.point(row * map.cols() + column);
+    point.convergePosition = static_cast<std::int16_t>(row % 3);
+    point.convergeTime = static_cast<float>(column);
+    point.stepCount = static_cast<std::uint32_t>(row * 100 + column);
+  }
+}
+
+Tile rowTile(const Map &map, std::size_t row) {
+  return {row, row + 1, 0, map.cols()};
+}
+} // namespace
+
+TEST(MapCheckpointTest, hashDependsOnEveryByte) {
+  EXPECT_EQ(parameterHash("{\"resolution\":0.05}"),
+            parameterHash("{\"resolution\":0.05}"));
+  EXPECT_NE(parameterHash("{\"resolution\":0.05}"),
+            parameterHash("{\"resolution\":0.06}"));
+}
+
+TEST(MapCheckpointTest, resumesFinishedTiles) {
+  const std::string path = ::testing::TempDir() + "tst_mapcheckpoint.ckpt";
+  std::remove(path.c_str());
+  Map map(-1.0, -1.0, 1.0, 1.0, 0.25);
+  {
+    MapCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.open(path, 42, map, std::chrono::hours(1)));
+    EXPECT_EQ(checkpoint.restoredPointCount(), 0u);
+    for (std::size_t row = 0; row < 4; ++row) {
+      fillRow(map, row);
+      checkpoint.append(rowTile(map, row), map);
+    }
+  }
+
+  Map resumedMap(-1.0, -1.0, 1.0, 1.0, 0.25);
+  MapCheckpoint checkpoint;
+  ASSERT_TRUE(checkpoint.open(path, 42, resumedMap, std::chrono::hours(1)));
+  EXPECT_EQ(checkpoint.restoredPointCount(), 4 * map.cols());
+  for (std::size_t i = 0; i < 4 * map.cols(); ++i) {
+    const Point expected = map.point(i);
+    const Point actual = static_cast<const Map &>(resumedMap).point(i);
+    EXPECT_EQ(actual.convergePosition, expected.convergePosition);
+    EXPECT_EQ(actual.convergeTime, expected.convergeTime);
+    EXPECT_EQ(actual.stepCount, expected.stepCount);
+  }
+
+  std::vector<Tile> tiles;
+  std::vector<double> costs;
+  for (std::size_t row = 0; row < map.rows(); ++row) {
+    tiles.push_back(rowTile(map, row));
+    costs.push_back(static_cast<double>(row));
+  }
+  // a tile reaching into unfinished rows is integrated again
+  tiles.push_back({2, 6, 0, 1});
+  costs.push_back(-1.0);
+  checkpoint.removeCompleted(tiles, &costs);
+  ASSERT_EQ(tiles.size(), map.rows() - 3);
+  EXPECT_EQ(tiles.front().firstRow, 4u);
+  EXPECT_EQ(costs.front(), 4.0);
+  EXPECT_EQ(costs.back(), -1.0);
+  std::remove(path.c_str());
+}
+
+TEST(MapCheckpointTest, dropsOtherParametersAndTornRecords) {
+  const std::string path = ::testing::TempDir() + "tst_mapcheckpoint2.ckpt";
+  Map map(-1.0, -1.0, 1.0, 1.0, 0.25);
+  {
+    MapCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.open(path, 1, map, std::chrono::hours(1)));
+    for (std::size_t row = 0; row < 2; ++row) {
+      fillRow(map, row);
+      checkpoint.append(rowTile(map, row), map);
+    }
+  }
+
+  // cut the last record short as a crash while writing would
+  std::string contents;
+  {
+    std::ifstream file(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(),
+               static_cast<std::streamsize>(contents.size() - 5));
+  }
+
+  {
+    Map resumedMap(-1.0, -1.0, 1.0, 1.0, 0.25);
+    MapCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.open(path, 1, resumedMap, std::chrono::hours(1)));
+    EXPECT_EQ(checkpoint.restoredPointCount(), map.cols());
+    EXPECT_TRUE(checkpoint.isCompleted(rowTile(map, 0)));
+    EXPECT_FALSE(checkpoint.isCompleted(rowTile(map, 1)));
+  }
+
+  Map otherMap(-1.0, -1.0, 1.0, 1.0, 0.25);
+  MapCheckpoint checkpoint;
+  ASSERT_TRUE(checkpoint.open(path, 2, otherMap, std::chrono::hours(1)));
+  EXPECT_EQ(checkpoint.restoredPointCount(), 0u);
+  EXPECT_FALSE(checkpoint.isCompleted(rowTile(map, 0)));
+  checkpoint.close();
+  std::remove(path.c_str());
+}
+
+TEST(MapCheckpointTest, compactsThroughATemporaryFile) {
+  const std::string path = ::testing::TempDir() + "tst_mapcheckpoint3.ckpt";
+  const std::string temporaryPath = path + ".tmp";
+  Map map(-1.0, -1.0, 1.0, 1.0, 0.25);
+  {
+    MapCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.open(path, 3, map, std::chrono::hours(1)));
+    fillRow(map, 0);
+    checkpoint.append(rowTile(map, 0), map);
+  }
+
+  // the leftover of a crash while compacting is not read and is replaced
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    file << "torn";
+  }
+
+  Map resumedMap(-1.0, -1.0, 1.0, 1.0, 0.25);
+  MapCheckpoint checkpoint;
+  ASSERT_TRUE(checkpoint.open(path, 3, resumedMap, std::chrono::hours(1)));
+  EXPECT_EQ(checkpoint.restoredPointCount(), map.cols());
+  EXPECT_FALSE(std::ifstream(temporaryPath).good());
+  checkpoint.close();
+  std::remove(path.c_str());
+}
+} // namespace staticpendulum
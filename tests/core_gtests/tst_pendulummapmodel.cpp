@@ -0,0 +1,28 @@
+#include "Models/pendulummapmodel.h"
+#include <QColor>
+#include <QJsonObject>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+TEST(PendulumMapModelTest, oldFilesKeepTheDefaultUnresolvedColor) {
+  // a file saved before the unresolved color existed
+  const PendulumMapModel defaultModel;
+  QJsonObject oldJson;
+  defaultModel.write(oldJson);
+  oldJson.remove(PendulumMapModel::unresolvedColorJsonKey());
+
+  PendulumMapModel oldFileModel;
+  oldFileModel.read(oldJson);
+  EXPECT_TRUE(oldFileModel.unresolvedColor() ==
+              defaultModel.unresolvedColor());
+
+  // a saved color is read back
+  PendulumMapModel savedModel;
+  savedModel.setUnresolvedColor(QColor(10, 20, 30));
+  QJsonObject json;
+  savedModel.write(json);
+  PendulumMapModel readModel;
+  readModel.read(json);
+  EXPECT_TRUE(readModel.unresolvedColor() == QColor(10, 20, 30));
+}
+} // namespace staticpendulum
@@ -0,0 +1,73 @@
+#include "CoreEngine/pointselection.h"
+#include "CoreEngine/progressiverender.h"
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+TEST(ProgressiveRenderTest, levelsIntegrateEveryPointOnce) {
+  Map map(-3.0, -2.0, 3.0, 2.0, 0.05);
+  for (auto &&point : map) {
+    point.stepCount = 0;
+  }
+
+  for (std::size_t step = progressiveFirstStep; step > 0; step /= 2) {
+    PointSelection level(
+        latticeLevelIndices(map, step, step == progressiveFirstStep));
+    std::size_t tilePointCount = 0;
+    for (const Tile &tile : level.tiles()) {
+      tilePointCount += tile.pointCount();
+      for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+        level.integrateRow(map, {row, row + 1, tile.firstColumn,
+                                 tile.lastColumn},
+                           [](PointIterator first, PointIterator last,
+                              PointProgress *progress) {
+                             EXPECT_EQ(progress, nullptr);
+                             for (auto point = first; point != last; ++point) {
+                               ++point->stepCount;
+                             }
+                           });
+      }
+    }
+    EXPECT_EQ(tilePointCount, level.pointCount());
+
+    // every point of the lattice is done once its row is integrated
+    for (std::size_t row = 0; row < map.rows(); row += step) {
+      for (std::size_t column = 0; column < map.cols(); column += step) {
+        EXPECT_EQ((map.rowBegin(row) + column)->stepCount, 1);
+      }
+    }
+  }
+
+  for (const auto &point : map) {
+    EXPECT_EQ(point.stepCount, 1);
+  }
+}
+
+TEST(ProgressiveRenderTest, selectionOfSuspendedPointsKeepsItsProgress) {
+  Map map(-1.0, -1.0, 1.0, 1.0, 0.5);
+  PointProgress suspended;
+  suspended.trialCount = 42;
+  PointSelection selection({7}, {suspended});
+  ASSERT_EQ(selection.tiles().size(), 1u);
+  const Point expected = static_cast<const Map &>(map).point(7);
+  selection.integrateRow(map, selection.tiles().front(),
+                         [&expected](PointIterator first, PointIterator last,
+                                     PointProgress *progress) {
+                           ASSERT_EQ(last - first, 1);
+                           EXPECT_EQ(first->xPosition, expected.xPosition);
+                           EXPECT_EQ(first->yPosition, expected.yPosition);
+                           ASSERT_NE(progress, nullptr);
+                           EXPECT_EQ(progress->trialCount, 42);
+                           first->convergePosition = 1;
+                         });
+  EXPECT_EQ(map.convergePosition(7), 1);
+}
+
+TEST(ProgressiveRenderTest, firstLevelIsSparse) {
+  const Map map(-10.0, -10.0, 10.0, 10.0, 0.05);
+  // 401 points per side, 26 of them on the lattice
+  EXPECT_EQ(latticeLevelIndices(map, progressiveFirstStep, true).size(),
+            26u * 26u);
+  EXPECT_EQ(latticeLevelIndices(map, 1, false).size(),
+            map.rows() * map.cols() - 201u * 201u);
+}
+} // namespace staticpendulum
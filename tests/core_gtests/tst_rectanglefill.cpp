@@ -0,0 +1,110 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/rectanglefill.h"
+#include "testsystems.h"
+#include <atomic>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+std::size_t integrableCount(const Map &map, const PendulumSystem &sys) {
+  std::size_t count = 0;
+  for (const auto &point : map) {
+    if (isIntegrable(sys, point))
+      ++count;
+  }
+  return count;
+}
+} // namespace
+
+TEST(RectangleFillTest, uniformBasinsAreFilled) {
+  const PendulumSystem sys = buildDefaultSystem();
+  Map map(-5.0, -5.0, 5.0, 5.0, 0.05);
+  // stand in integrator, the basins are the four quadrants
+  std::atomic<std::size_t> integratedCount(0);
+  auto integratePoints = [&](PointIterator first, PointIterator last) {
+    for (auto point = first; point != last; ++point) {
+      if (!isIntegrable(sys, *point))
+        continue;
+
+      point->convergePosition =
+          (point->xPosition < 0.0 ? 1 : 0) + (point->yPosition < 0.0 ? 2 : 0);
+      point->stepCount = 1;
+      ++integratedCount;
+    }
+  };
+
+  TileScheduler scheduler(3);
+  RectangleFillCounts counts;
+  fillMap(map, sys, scheduler, 4, integratePoints, counts);
+
+  EXPECT_EQ(counts.integratedPointCount, integratedCount);
+  EXPECT_EQ(counts.integratedPointCount + counts.filledPointCount,
+            integrableCount(map, sys));
+  EXPECT_GT(counts.filledPointCount, 2 * counts.integratedPointCount);
+  EXPECT_EQ(scheduler.completedPointCount(), scheduler.pointCount());
+
+  for (const auto &point : map) {
+    if (!isIntegrable(sys, point)) {
+      EXPECT_EQ(point.convergePosition, -2);
+      continue;
+    }
+
+    // the quadrant boundaries lie on rows and columns of integrated points
+    EXPECT_EQ(point.convergePosition, (point.xPosition < 0.0 ? 1 : 0) +
+                                          (point.yPosition < 0.0 ? 2 : 0));
+  }
+}
+
+TEST(RectangleFillTest, smallRectanglesAreIntegrated) {
+  const PendulumSystem sys = buildDefaultSystem();
+  Map map(-2.0, -2.0, 2.0, 2.0, 0.1);
+  auto integratePoints = [&](PointIterator first, PointIterator last) {
+    for (auto point = first; point != last; ++point) {
+      if (isIntegrable(sys, *point))
+        point->convergePosition = 0;
+    }
+  };
+
+  // rectangles never get larger than the minimum size
+  TileScheduler scheduler(2);
+  RectangleFillCounts counts;
+  fillMap(map, sys, scheduler, rectangleFillTileSize, integratePoints, counts);
+  EXPECT_EQ(counts.filledPointCount, 0u);
+  EXPECT_EQ(counts.integratedPointCount, integrableCount(map, sys));
+}
+
+TEST(RectangleFillTest, matchesFullMapOutsideBasinBoundaries) {
+  const PendulumSystem sys = buildDefaultSystem();
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+  auto integratePoints = [&](PointIterator first, PointIterator last) {
+    for (auto point = first; point != last; ++point) {
+      integratePoint(integrator, sys, *point, 0.001, 0.5, 0.1, 5.0);
+    }
+  };
+
+  Map expectedMap(-3.0, -3.0, 3.0, 3.0, 0.05);
+  Map actualMap = expectedMap;
+  integrateMapPoints(expectedMap.begin(), expectedMap.end(), integratePoints);
+
+  TileScheduler scheduler(2);
+  RectangleFillCounts counts;
+  fillMap(actualMap, sys, scheduler, 4, integratePoints, counts);
+  // the basins are fractal away from the attractors
+  EXPECT_GT(counts.filledPointCount, 0u);
+
+  std::size_t differentCount = 0;
+  auto expected = expectedMap.begin();
+  for (const auto &point : actualMap) {
+    if (point.stepCount > 0) {
+      // integrated points are not changed by the fill
+      EXPECT_EQ(point.convergePosition, expected->convergePosition);
+    } else if (point.convergePosition != expected->convergePosition) {
+      ++differentCount;
+    }
+    ++expected;
+  }
+  EXPECT_LT(differentCount, counts.filledPointCount / 100);
+}
+} // namespace staticpendulum
@@ -0,0 +1,230 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "CoreEngine/rosenbrock23.h"
+#include "CoreEngine/stiffnessswitching.h"
+#include "testsystems.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+// Stiff linear system x0' = -1000 x0, x1' = -x1 with exact solution
+// x = (exp(-1000 t), exp(-t)) for x(0) = (1, 1).
+struct StiffDecay {
+  void operator()(const std::array<double, 2> &x, std::array<double, 2> &dxdt,
+                  const double /* t */) const {
+    dxdt[0] = -1000.0 * x[0];
+    dxdt[1] = -x[1];
+  }
+
+  void jacobian(const std::array<double, 2> & /* x */, SquareMatrix<2> &dfdx,
+                const double /* t */) const {
+    dfdx = {{{{-1000.0, 0.0}}, {{0.0, -1.0}}}};
+  }
+};
+
+// Harmonic oscillator x'' = -x with exact solution x = cos(t).
+struct HarmonicOscillator {
+  void operator()(const std::array<double, 2> &x, std::array<double, 2> &dxdt,
+                  const double /* t */) const {
+    dxdt[0] = x[1];
+    dxdt[1] = -x[0];
+  }
+
+  void jacobian(const std::array<double, 2> & /* x */, SquareMatrix<2> &dfdx,
+                const double /* t */) const {
+    dfdx = {{{{0.0, 1.0}}, {{-1.0, 0.0}}}};
+  }
+};
+
+// Integrates until endTime, returns the number of accepted steps.
+template <typename Integrator, typename SystemType>
+int integrateTo(Integrator &integrator, const SystemType &sys,
+                std::array<double, 2> &x, double endTime) {
+  double t = 0.0;
+  double h = 1e-4;
+  int acceptedCount = 0;
+  while (t < endTime) {
+    h = std::min(h, endTime - t);
+    acceptedCount += integrator(sys, x, t, h);
+  }
+  return acceptedCount;
+}
+
+// Suspends a pendulum point integrated with the integrator after a few
+// trials, then checks that resuming it takes the saved step size rather than
+// estimating a new one.
+template <typename Integrator>
+void expectResumesWithSavedStepSize(Integrator integrator) {
+  const PendulumSystem sys = buildDefaultSystem();
+  constexpr double estimatedStepSize = 0.0625;
+  int estimateCount = 0;
+  auto estimateStepSize = [&estimateCount](
+      const PendulumSystem &, const PendulumSystem::StateType &,
+      const PendulumSystem::StateType &) {
+    ++estimateCount;
+    return estimatedStepSize;
+  };
+
+  Point point;
+  point.xPosition = 1.5;
+  point.yPosition = -1.0;
+  point.xVelocity = 0.0;
+  point.yVelocity = 0.0;
+  PointBudget firstPassBudget;
+  firstPassBudget.trialCount = 20;
+  firstPassBudget.suspendsPoints = true;
+  PointProgress progress;
+  integratePoint(integrator, sys, point, estimateStepSize, 0.5, 0.1, 5.0,
+                 firstPassBudget, &progress);
+  ASSERT_TRUE(isSuspended(progress));
+  EXPECT_EQ(estimateCount, 1);
+  const double savedStepSize = progress.stepSize;
+  EXPECT_NE(savedStepSize, estimatedStepSize);
+
+  // length of the first step taken after resuming
+  double firstStepLength = 0.0;
+  auto recordingIntegrator = [integrator, &firstStepLength,
+                              isFirstStep = true](
+      const PendulumSystem &dxdt, PendulumSystem::StateType &x, double &t,
+      double &h) mutable {
+    const double startTime = t;
+    const int accepted = integrator(dxdt, x, t, h);
+    if (isFirstStep) {
+      firstStepLength = t - startTime;
+      isFirstStep = false;
+    }
+    return accepted;
+  };
+  integratePoint(recordingIntegrator, sys, point, estimateStepSize, 0.5, 0.1,
+                 5.0, PointBudget(), &progress);
+  EXPECT_EQ(estimateCount, 1);
+  // up to the rounding of the time it advanced
+  EXPECT_NEAR(firstStepLength, savedStepSize, 1e-12);
+  EXPECT_NE(point.convergePosition, unresolvedPosition);
+}
+} // namespace
+
+TEST(Rosenbrock23Test, luSolveMatchesKnownSolution) {
+  // solution of the system is (1, 2, 3)
+  SquareMatrix<3> a = {
+      {{{0.0, 2.0, 1.0}}, {{3.0, 1.0, -1.0}}, {{1.0, 1.0, 1.0}}}};
+  std::array<double, 3> b = {{7.0, 2.0, 6.0}};
+  std::array<std::size_t, 3> pivot;
+  ASSERT_TRUE(luDecompose(a, pivot));
+  luSolve(a, pivot, b);
+  EXPECT_NEAR(b[0], 1.0, 1e-14);
+  EXPECT_NEAR(b[1], 2.0, 1e-14);
+  EXPECT_NEAR(b[2], 3.0, 1e-14);
+
+  SquareMatrix<2> singular = {{{{1.0, 2.0}}, {{2.0, 4.0}}}};
+  std::array<std::size_t, 2> singularPivot;
+  EXPECT_FALSE(luDecompose(singular, singularPivot));
+}
+
+TEST(Rosenbrock23Test, pendulumJacobianMatchesFiniteDifferences) {
+  PendulumSystem sys;
+  const double yMag = std::sqrt(1 - 0.5 * 0.5);
+  sys.attractorList.emplace_back(-0.5, yMag, 1);
+  sys.attractorList.emplace_back(-0.5, -yMag, 1);
+  sys.attractorList.emplace_back(1.0, 0.0, 1);
+
+  const PendulumSystem::StateType x = {{0.3, -0.7, 0.4, 0.2}};
+  PendulumSystem::JacobianType dfdx;
+  sys.jacobian(x, dfdx, 0.0);
+
+  const double delta = 1e-6;
+  for (std::size_t j = 0; j < 4; ++j) {
+    PendulumSystem::StateType forward = x;
+    PendulumSystem::StateType backward = x;
+    forward[j] += delta;
+    backward[j] -= delta;
+    PendulumSystem::StateType forwardDerivative;
+    PendulumSystem::StateType backwardDerivative;
+    sys(forward, forwardDerivative, 0.0);
+    sys(backward, backwardDerivative, 0.0);
+    for (std::size_t i = 0; i < 4; ++i) {
+      const double expected =
+          (forwardDerivative[i] - backwardDerivative[i]) / (2.0 * delta);
+      EXPECT_NEAR(dfdx[i][j], expected, 1e-6 * (1.0 + std::abs(expected)))
+          << "row " << i << " column " << j;
+    }
+  }
+}
+
+TEST(Rosenbrock23Test, spectralRadiusEstimate) {
+  const SquareMatrix<2> diagonal = {{{{-1000.0, 0.0}}, {{0.0, -1.0}}}};
+  EXPECT_NEAR(spectralRadiusEstimate(diagonal), 1000.0, 1.0);
+
+  // rotation scaled by 3 has both eigenvalues of magnitude 3
+  const SquareMatrix<2> rotation = {{{{0.0, 3.0}}, {{-3.0, 0.0}}}};
+  EXPECT_NEAR(spectralRadiusEstimate(rotation), 3.0, 0.1);
+
+  const SquareMatrix<2> zero = {{{{0.0, 0.0}}, {{0.0, 0.0}}}};
+  EXPECT_EQ(spectralRadiusEstimate(zero), 0.0);
+}
+
+TEST(Rosenbrock23Test, stiffSystemTakesFewerStepsThanExplicit) {
+  StiffDecay sys;
+  auto rosenbrock = [dxdtx = std::array<double, 2>(), hasDerivative = false](
+      const StiffDecay &dxdt, std::array<double, 2> &x, double &t,
+      double &h) mutable {
+    if (!hasDerivative) {
+      dxdt(x, dxdtx, t);
+      hasDerivative = true;
+    }
+    return rosenbrock23(dxdt, x, dxdtx, t, h, 1e-6, 1e-6, 1.0);
+  };
+  std::array<double, 2> x = {{1.0, 1.0}};
+  const int implicitSteps = integrateTo(rosenbrock, sys, x, 10.0);
+  EXPECT_NEAR(x[0], 0.0, 1e-6);
+  EXPECT_NEAR(x[1], std::exp(-10.0), 1e-4);
+
+  auto explicitIntegrator = [](const StiffDecay &dxdt, std::array<double, 2> &x,
+                               double &t, double &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 1.0);
+  };
+  std::array<double, 2> xExplicit = {{1.0, 1.0}};
+  const int explicitSteps =
+      integrateTo(explicitIntegrator, sys, xExplicit, 10.0);
+
+  EXPECT_LT(implicitSteps * 10, explicitSteps);
+}
+
+TEST(Rosenbrock23Test, switchesToImplicitOnlyWhenStiff) {
+  StiffnessSwitchingIntegrator<CashKarp54Tableau, 2> stiffIntegrator(
+      1e-6, 1e-6, 1.0);
+  std::array<double, 2> x = {{1.0, 1.0}};
+  integrateTo(stiffIntegrator, StiffDecay(), x, 10.0);
+  EXPECT_TRUE(stiffIntegrator.isStiff());
+  EXPECT_EQ(stiffIntegrator.switchCount(), 1);
+  EXPECT_NEAR(x[1], std::exp(-10.0), 1e-4);
+
+  StiffnessSwitchingIntegrator<CashKarp54Tableau, 2> nonStiffIntegrator(
+      1e-8, 1e-8, 1.0);
+  std::array<double, 2> y = {{1.0, 0.0}};
+  integrateTo(nonStiffIntegrator, HarmonicOscillator(), y, 20.0);
+  EXPECT_FALSE(nonStiffIntegrator.isStiff());
+  EXPECT_EQ(nonStiffIntegrator.switchCount(), 0);
+  EXPECT_NEAR(y[0], std::cos(20.0), 1e-6);
+}
+
+TEST(Rosenbrock23Test, resumedPointsKeepTheirStepSize) {
+  auto rosenbrock = [dxdtx = PendulumSystem::StateType(),
+                     hasDerivative = false](
+      const PendulumSystem &dxdt, PendulumSystem::StateType &x, double &t,
+      double &h) mutable {
+    if (!hasDerivative) {
+      dxdt(x, dxdtx, t);
+      hasDerivative = true;
+    }
+    return rosenbrock23(dxdt, x, dxdtx, t, h, 1e-6, 1e-6, 0.1);
+  };
+  expectResumesWithSavedStepSize(rosenbrock);
+  expectResumesWithSavedStepSize(
+      StiffnessSwitchingIntegrator<CashKarp54Tableau, 4>(1e-6, 1e-6, 0.1));
+}
+} // namespace staticpendulum
@@ -0,0 +1,127 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/dormandprince54.h"
+#include "CoreEngine/pendulummapintegrator.h"
+#include "CoreEngine/pendulumsystem.h"
+#include "CoreEngine/stepsizecontroller.h"
+#include "testsystems.h"
+#include <array>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+// Harmonic oscillator x'' = -x with exact solution x = cos(t).
+struct HarmonicOscillator {
+  void operator()(const std::array<double, 2> &x, std::array<double, 2> &dxdt,
+                  const double /* t */) const {
+    dxdt[0] = x[1];
+    dxdt[1] = -x[0];
+  }
+};
+
+// Integrates a map with the given controller, returns the number of rejected
+// steps.
+template <typename Controller> int rejectedStepCount(Map &theMap) {
+  int attemptCount = 0;
+  auto integrator = [&attemptCount](auto &&dxdt, auto &x, auto &dxdtx, auto &t,
+                                    auto &h, auto &accepted,
+                                    auto &controllers) {
+    explicitRungeKuttaBatch<DormandPrince54Tableau>(
+        dxdt, x, dxdtx, t, h, accepted, 1e-8, 1e-8, 1.0, controllers);
+    for (auto lane : accepted) {
+      (void)lane;
+      ++attemptCount;
+    }
+  };
+
+  integratePoints<4, Controller>(integrator, buildDefaultSystem(),
+                                 theMap.begin(), theMap.end(), 0.001, 0.5, 0.1,
+                                 5.0);
+  int acceptedCount = 0;
+  for (const auto &point : theMap) {
+    acceptedCount += point.stepCount;
+  }
+  return attemptCount - acceptedCount;
+}
+} // namespace
+
+TEST(StepSizeControllerTest, elementaryMatchesDefaultController) {
+  HarmonicOscillator sys;
+  std::array<double, 2> x1 = {{1.0, 0.0}};
+  std::array<double, 2> x2 = x1;
+  std::array<double, 2> dxdtx1;
+  sys(x1, dxdtx1, 0.0);
+  std::array<double, 2> dxdtx2 = dxdtx1;
+  double t1 = 0.0;
+  double t2 = 0.0;
+  double h1 = 1.0;
+  double h2 = 1.0;
+  ElementaryStepController controller;
+  // both calls run the same step, but with -ffast-math their inlined copies may
+  // be contracted differently. The last bits of the error estimate (a
+  // difference of two nearly equal solutions) then differ and the controller
+  // turns them into slightly different step sizes, so the runs only agree to
+  // the requested tolerance.
+  const double tolerance = 1e-8;
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(explicitRungeKutta<CashKarp54Tableau>(sys, x1, dxdtx1, t1, h1,
+                                                    tolerance, tolerance, 0.5),
+              explicitRungeKutta<CashKarp54Tableau>(sys, x2, dxdtx2, t2, h2,
+                                                    tolerance, tolerance, 0.5,
+                                                    controller));
+    EXPECT_NEAR(h1, h2, tolerance);
+    EXPECT_NEAR(x1[0], x2[0], tolerance);
+    EXPECT_NEAR(x1[1], x2[1], tolerance);
+  }
+}
+
+TEST(StepSizeControllerTest, proportionalIntegralHoldsStepAfterRejection) {
+  ProportionalIntegralStepController controller;
+  const double shrunk = controller.rejected<CashKarp54Tableau>(1.0, 10.0);
+  EXPECT_LT(shrunk, 1.0);
+  // a tiny error would normally grow the step, right after a rejection it must
+  // not
+  EXPECT_LE(controller.accepted<CashKarp54Tableau>(shrunk, 1e-6, 10.0), shrunk);
+  // the following accepted step may grow again
+  EXPECT_GT(controller.accepted<CashKarp54Tableau>(shrunk, 1e-6, 10.0), shrunk);
+}
+
+TEST(StepSizeControllerTest, proportionalIntegralRejectsFewerSteps) {
+  Map elementaryMap(-2.0, -2.0, 2.0, 2.0, 0.5);
+  Map proportionalIntegralMap(-2.0, -2.0, 2.0, 2.0, 0.5);
+  const int elementaryRejections =
+      rejectedStepCount<ElementaryStepController>(elementaryMap);
+  const int proportionalIntegralRejections =
+      rejectedStepCount<ProportionalIntegralStepController>(
+          proportionalIntegralMap);
+  EXPECT_LT(proportionalIntegralRejections, elementaryRejections);
+}
+
+TEST(StepSizeControllerTest, initialStepSizeIsAcceptedAndScalesWithTolerance) {
+  HarmonicOscillator sys;
+  std::array<double, 2> x = {{1.0, 0.0}};
+  std::array<double, 2> dxdtx;
+  sys(x, dxdtx, 0.0);
+
+  const double looseStep = initialStepSize<DormandPrince54Tableau>(
+      sys, x, dxdtx, 0.0, 1e-6, 1e-6, 1.0);
+  const double tightStep = initialStepSize<DormandPrince54Tableau>(
+      sys, x, dxdtx, 0.0, 1e-10, 1e-10, 1.0);
+  EXPECT_LT(tightStep, looseStep);
+  EXPECT_LE(looseStep, 1.0);
+  EXPECT_EQ(initialStepSize<DormandPrince54Tableau>(sys, x, dxdtx, 0.0, 1e-6,
+                                                    1e-6, 1e-4),
+            1e-4);
+
+  for (double tolerance : {1e-6, 1e-10}) {
+    double t = 0.0;
+    double h = initialStepSize<DormandPrince54Tableau>(
+        sys, x, dxdtx, t, tolerance, tolerance, 1.0);
+    std::array<double, 2> state = x;
+    std::array<double, 2> derivative = dxdtx;
+    EXPECT_EQ(dormandPrince54(sys, state, derivative, t, h, tolerance,
+                              tolerance, 1.0),
+              1)
+        << "Tolerance: " << tolerance;
+  }
+}
+} // namespace staticpendulum
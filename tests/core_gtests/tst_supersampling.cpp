@@ -0,0 +1,135 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/supersampling.h"
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+TEST(SupersamplingTest, findsPointsNextToOtherBasins) {
+  Map map(-1.0, -1.0, 1.0, 1.0, 0.25);
+  for (auto &&point : map) {
+    point.convergePosition = point.xPosition < 0.1 ? 0 : 1;
+  }
+
+  // columns 4 (x = 0) and 5 (x = 0.25) lie on the boundary
+  for (std::size_t row = 0; row < map.rows(); ++row) {
+    for (std::size_t column = 0; column < map.cols(); ++column) {
+      EXPECT_EQ(isBasinBoundary(map, row, column),
+                column == 4 || column == 5);
+    }
+  }
+
+  const BoundarySupersamples supersamples(map, 3);
+  EXPECT_EQ(supersamples.pointCount(), 2 * map.rows());
+}
+
+TEST(SupersamplingTest, samplesSpreadOverThePixel) {
+  Map map(-1.0, -1.0, 1.0, 1.0, 0.5);
+  (map.begin() + 12)->convergePosition = 0;
+  BoundarySupersamples supersamples(map, 4);
+  ASSERT_EQ(supersamples.pointCount(), 9u);
+  EXPECT_EQ(supersamples.sampleCount(), 4u);
+
+  std::vector<Point> samples;
+  for (std::size_t i = 0; i < supersamples.pointCount(); ++i) {
+    const Point &point = *(map.begin() + supersamples.pointIndex(i));
+    supersamples.makeSamples(map, i, samples);
+    ASSERT_EQ(samples.size(), 16u);
+    double xSum = 0.0;
+    double ySum = 0.0;
+    for (const Point &sample : samples) {
+      EXPECT_LT(std::abs(sample.xPosition - point.xPosition), 0.25);
+      EXPECT_LT(std::abs(sample.yPosition - point.yPosition), 0.25);
+      xSum += sample.xPosition;
+      ySum += sample.yPosition;
+    }
+
+    EXPECT_NEAR(xSum / 16.0, point.xPosition, 1e-12);
+    EXPECT_NEAR(ySum / 16.0, point.yPosition, 1e-12);
+  }
+
+  // the first subsample is the upper left one
+  const Point &first = *(map.begin() + supersamples.pointIndex(0));
+  supersamples.makeSamples(map, 0, samples);
+  EXPECT_NEAR(samples.front().xPosition, first.xPosition - 0.1875, 1e-12);
+  EXPECT_NEAR(samples.front().yPosition, first.yPosition + 0.1875, 1e-12);
+
+  std::size_t tilePointCount = 0;
+  for (const Tile &tile : supersamples.tiles()) {
+    EXPECT_EQ(tile.columnCount(), 16u);
+    tilePointCount += tile.rowCount();
+  }
+  EXPECT_EQ(tilePointCount, supersamples.pointCount());
+}
+
+TEST(SupersamplingTest, singleSampleMatchesMap) {
+  PendulumSystem sys;
+  const double yMag = std::sqrt(1 - 0.5 * 0.5);
+  sys.attractorList.emplace_back(-0.5, yMag, 1);
+  sys.attractorList.emplace_back(-0.5, -yMag, 1);
+  sys.attractorList.emplace_back(1.0, 0.0, 1);
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+  auto integratePoints = [&](auto first, auto last) {
+    for (auto point = first; point != last; ++point) {
+      integratePoint(integrator, sys, *point, 0.001, 0.5, 0.1, 5.0);
+    }
+  };
+
+  Map map(-2.0, -2.0, 2.0, 2.0, 0.25);
+  integratePoints(map.begin(), map.end());
+  BoundarySupersamples supersamples(map, 1);
+  ASSERT_GT(supersamples.pointCount(), 0u);
+  EXPECT_LT(supersamples.pointCount(), map.rows() * map.cols());
+
+  TileScheduler scheduler(2);
+  scheduler.run(supersamples.tiles(), [&](const Tile &row) {
+    std::vector<Point> samples;
+    supersamples.makeSamples(map, row.firstRow, samples);
+    const auto first = samples.begin() + row.firstColumn;
+    const auto last = samples.begin() + row.lastColumn;
+    integratePoints(first, last);
+    supersamples.countFates(row.firstRow, first, last);
+  });
+
+  for (std::size_t i = 0; i < supersamples.pointCount(); ++i) {
+    const Point &point = *(map.begin() + supersamples.pointIndex(i));
+    ASSERT_EQ(supersamples.fatesEnd(i) - supersamples.fatesBegin(i), 1);
+    EXPECT_EQ(supersamples.fatesBegin(i)->position, point.convergePosition);
+    EXPECT_EQ(supersamples.fatesBegin(i)->count, 1u);
+  }
+}
+
+TEST(SupersamplingTest, countsEveryFateOfAPoint) {
+  Map map(-1.0, -1.0, 1.0, 1.0, 0.5);
+  (map.begin() + 12)->convergePosition = 0;
+  BoundarySupersamples supersamples(map, 2);
+  std::vector<Point> samples;
+  supersamples.makeSamples(map, 0, samples);
+  EXPECT_EQ(supersamples.fatesBegin(0), supersamples.fatesEnd(0));
+
+  // two fates fit inline, a third moves them all to the overflow
+  for (const int position : {2, 2, -1, 2}) {
+    samples.front().convergePosition = position;
+    supersamples.countFates(0, samples.begin(), samples.begin() + 1);
+  }
+  ASSERT_EQ(supersamples.fatesEnd(0) - supersamples.fatesBegin(0), 2);
+  EXPECT_EQ(supersamples.fatesBegin(0)->count, 3u);
+
+  samples[0].convergePosition = 0;
+  samples[1].convergePosition = -1;
+  supersamples.countFates(0, samples.begin(), samples.begin() + 2);
+  ASSERT_EQ(supersamples.fatesEnd(0) - supersamples.fatesBegin(0), 3);
+  const SubsampleFate *fates = supersamples.fatesBegin(0);
+  EXPECT_EQ(fates[0].position, 2);
+  EXPECT_EQ(fates[0].count, 3u);
+  EXPECT_EQ(fates[1].position, -1);
+  EXPECT_EQ(fates[1].count, 2u);
+  EXPECT_EQ(fates[2].position, 0);
+  EXPECT_EQ(fates[2].count, 1u);
+
+  // the other points are untouched
+  EXPECT_EQ(supersamples.fatesBegin(1), supersamples.fatesEnd(1));
+}
+} // namespace staticpendulum
@@ -0,0 +1,103 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/symmetry.h"
+#include "testsystems.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace staticpendulum {
+namespace {
+std::size_t reflectionCount(const std::vector<SystemSymmetry> &symmetries) {
+  std::size_t count = 0;
+  for (const auto &symmetry : symmetries) {
+    // reflections have determinant -1
+    if (symmetry.xx * symmetry.yy - symmetry.xy * symmetry.yx < 0.0)
+      ++count;
+  }
+  return count;
+}
+} // namespace
+
+TEST(SymmetryTest, findsRingSymmetries) {
+  for (std::size_t count = 1; count <= 6; ++count) {
+    SCOPED_TRACE(count);
+    const auto symmetries = findSymmetries(buildRingSystem(count));
+    // the dihedral group of order 2 * count without the identity
+    EXPECT_EQ(symmetries.size(), 2 * count - 1);
+    EXPECT_EQ(reflectionCount(symmetries), count);
+    for (const auto &symmetry : symmetries) {
+      std::vector<int> sorted = symmetry.attractorImages;
+      std::sort(sorted.begin(), sorted.end());
+      for (std::size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(sorted[i], static_cast<int>(i));
+      }
+    }
+  }
+
+  // no attractors off the pivot, the symmetries of the square are used
+  EXPECT_EQ(findSymmetries(PendulumSystem()).size(), 7u);
+}
+
+TEST(SymmetryTest, forceCoeffsBreakSymmetry) {
+  PendulumSystem sys = buildRingSystem(4);
+  sys.attractorList[0].forceCoeff = 2.0;
+  const auto symmetries = findSymmetries(sys);
+  // only the reflection about the axis through the stronger attractor
+  ASSERT_EQ(symmetries.size(), 1u);
+  EXPECT_EQ(symmetries[0].attractorImages, (std::vector<int>{0, 3, 2, 1}));
+
+  sys.attractorList[2].forceCoeff = 2.0;
+  EXPECT_EQ(findSymmetries(sys).size(), 3u);
+}
+
+TEST(SymmetryTest, fourFoldSymmetryIntegratesAnEighth) {
+  const Map map(-2.0, -2.0, 2.0, 2.0, 0.25);
+  const SymmetryFill symmetryFill(map, findSymmetries(buildRingSystem(4)));
+  EXPECT_EQ(symmetryFill.symmetryCount(), 7u);
+  // 17 x 17 points, the fundamental domain is a triangle of 9 * 10 / 2
+  EXPECT_EQ(symmetryFill.integratedPointIndices().size(), 45u);
+  EXPECT_EQ(symmetryFill.integratedPointIndices().size() +
+                symmetryFill.filledPointCount(),
+            map.rows() * map.cols());
+
+  // three fold rotations leave the grid, only the mirror is used
+  const SymmetryFill ringFill(map, findSymmetries(buildRingSystem(3)));
+  EXPECT_EQ(ringFill.symmetryCount(), 5u);
+  EXPECT_EQ(ringFill.integratedPointIndices().size(), 9u * 17u);
+}
+
+TEST(SymmetryTest, fillMatchesFullMap) {
+  PendulumSystem sys;
+  const double yMag = std::sqrt(1 - 0.5 * 0.5);
+  sys.attractorList.emplace_back(-0.5, yMag, 1);
+  sys.attractorList.emplace_back(-0.5, -yMag, 1);
+  sys.attractorList.emplace_back(1.0, 0.0, 1);
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+
+  Map expectedMap(-2.0, -2.0, 2.0, 2.0, 0.1);
+  Map map = expectedMap;
+  for (auto &&point : expectedMap) {
+    integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0);
+  }
+
+  const SymmetryFill symmetryFill(map, findSymmetries(sys));
+  for (const std::size_t index : symmetryFill.integratedPointIndices()) {
+    integratePoint(integrator, sys, *(map.begin() + index), 0.001, 0.5, 0.1,
+                   5.0);
+  }
+  symmetryFill.fill(map);
+  EXPECT_EQ(symmetryFill.integratedPointIndices().size(), 21u * 41u);
+
+  // the mirrored trajectories sum the attractor forces in another order, so
+  // the chaotic points may round differently
+  std::size_t differentCount = 0;
+  auto expected = expectedMap.begin();
+  for (const auto &point : map) {
+    if (point.convergePosition != expected->convergePosition)
+      ++differentCount;
+    ++expected;
+  }
+  EXPECT_LT(differentCount, map.rows() * map.cols() / 100);
+}
+} // namespace staticpendulum
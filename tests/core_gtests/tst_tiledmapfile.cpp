@@ -0,0 +1,102 @@
+#include "CoreEngine/tiledmapfile.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+
+namespace staticpendulum {
+namespace {
+// Stands in for the integration, the results only depend on the position.
+void fillResults(Map &map) {
+  for (auto &&point : map) {
+    point.convergePosition = static_cast<std::int16_t>(
+        std::lround(point.xPosition * 4.0 + point.yPosition * 40.0));
+    point.convergeTime = static_cast<float>(point.xPosition);
+    point.stepCount = static_cast<std::uint32_t>(point.yPosition * 8.0 + 100);
+  }
+}
+} // namespace
+
+TEST(TiledMapFileTest, tileSizeFollowsTheBudget) {
+  EXPECT_EQ(TiledMapFile::tileSizeForBudget(0), TiledMapFile::tileSizeMultiple);
+  const std::size_t tileSize = TiledMapFile::tileSizeForBudget(256 << 20);
+  EXPECT_EQ(tileSize % TiledMapFile::tileSizeMultiple, 0u);
+  EXPECT_LE(2 * 10 * tileSize * tileSize, 256u << 20);
+  EXPECT_GT(2 * 10 * (tileSize + 32) * (tileSize + 32), 256u << 20);
+}
+
+TEST(TiledMapFileTest, tilesRoundTripThroughTheFile) {
+  const std::string path = ::testing::TempDir() + "tst_tiledmapfile.map";
+  Map expectedMap(-5.0, -3.0, 5.0, 4.0, 0.125);
+  fillResults(expectedMap);
+
+  {
+    TiledMapFile file;
+    ASSERT_TRUE(file.create(path, -5.0, -3.0, 5.0, 4.0, 0.125, 32));
+    ASSERT_EQ(file.rows(), expectedMap.rows());
+    ASSERT_EQ(file.cols(), expectedMap.cols());
+    EXPECT_EQ(file.tileRowCount(), 2u);
+    EXPECT_EQ(file.tileColumnCount(), 3u);
+    for (std::size_t tile = 0; tile < file.tileCount(); ++tile) {
+      Map tileMap = file.tileMap(tile);
+      fillResults(tileMap);
+      file.writeTile(tile, tileMap);
+    }
+  }
+
+  TiledMapFile file;
+  ASSERT_TRUE(file.open(path));
+  for (std::size_t tile = 0; tile < file.tileCount(); ++tile) {
+    const Map tileMap = file.readTile(tile);
+    const std::size_t firstRow = tile / file.tileColumnCount() * 32;
+    const std::size_t firstColumn = tile % file.tileColumnCount() * 32;
+    for (std::size_t row = 0; row < tileMap.rows(); ++row) {
+      for (std::size_t column = 0; column < tileMap.cols(); ++column) {
+        const Point actual = tileMap.point(row * tileMap.cols() + column);
+        const Point expected = expectedMap.point(
+            (firstRow + row) * expectedMap.cols() + firstColumn + column);
+        // the tile points are the points of the whole map
+        EXPECT_EQ(actual.xPosition, expected.xPosition);
+        EXPECT_EQ(actual.yPosition, expected.yPosition);
+        EXPECT_EQ(actual.convergePosition, expected.convergePosition);
+        EXPECT_EQ(actual.convergeTime, expected.convergeTime);
+        EXPECT_EQ(actual.stepCount, expected.stepCount);
+      }
+    }
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TiledMapFileTest, writesPortablePixmap) {
+  const std::string path = ::testing::TempDir() + "tst_tiledmapfile2.map";
+  const std::string imagePath = ::testing::TempDir() + "tst_tiledmapfile.ppm";
+  TiledMapFile file;
+  ASSERT_TRUE(file.create(path, 0.0, 0.0, 4.0, 2.0, 0.1, 32));
+  for (std::size_t tile = 0; tile < file.tileCount(); ++tile) {
+    Map tileMap = file.tileMap(tile);
+    fillResults(tileMap);
+    file.writeTile(tile, tileMap);
+  }
+  ASSERT_TRUE(writePortablePixmap(file, imagePath, [](std::int16_t position) {
+    return std::array<std::uint8_t, 3>{
+        {static_cast<std::uint8_t>(position), 0, 255}};
+  }));
+
+  std::ifstream image(imagePath, std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(image)),
+                             std::istreambuf_iterator<char>());
+  const std::string header = "P6\n41 21\n255\n";
+  ASSERT_EQ(contents.size(), header.size() + 3 * 41 * 21);
+  EXPECT_EQ(contents.substr(0, header.size()), header);
+
+  Map expectedMap(0.0, 0.0, 4.0, 2.0, 0.1);
+  fillResults(expectedMap);
+  for (std::size_t i = 0; i < expectedMap.rows() * expectedMap.cols(); ++i) {
+    EXPECT_EQ(static_cast<std::uint8_t>(contents[header.size() + 3 * i]),
+              static_cast<std::uint8_t>(expectedMap.convergePosition(i)));
+  }
+  std::remove(path.c_str());
+  std::remove(imagePath.c_str());
+}
+} // namespace staticpendulum
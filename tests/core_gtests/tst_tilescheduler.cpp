@@ -0,0 +1,147 @@
+#include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/tilescheduler.h"
+#include "testsystems.h"
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace staticpendulum {
+namespace {
+// Runs the tiles and counts how often every point of the map was visited.
+std::vector<int> visitCounts(TileScheduler &scheduler, const Map &map,
+                             const std::vector<Tile> &tiles) {
+  std::vector<std::atomic<int>> counts(map.rows() * map.cols());
+  for (auto &count : counts) {
+    count = 0;
+  }
+  scheduler.run(tiles, [&](const Tile &row) {
+    EXPECT_EQ(row.rowCount(), 1u);
+    for (std::size_t column = row.firstColumn; column < row.lastColumn;
+         ++column) {
+      ++counts[row.firstRow * map.cols() + column];
+    }
+  });
+  return std::vector<int>(counts.begin(), counts.end());
+}
+} // namespace
+
+TEST(TileSchedulerTest, tilesCoverIntegrablePointsOnly) {
+  const PendulumSystem sys = buildDefaultSystem();
+  // the map extends past the pendulum reach in every direction
+  const Map map(-15.0, -15.0, 15.0, 15.0, 0.1);
+  const std::vector<Tile> tiles = makeTiles(map, sys, 16, 32);
+
+  std::vector<int> covered(map.rows() * map.cols(), 0);
+  for (const auto &tile : tiles) {
+    EXPECT_LE(tile.rowCount(), 16u);
+    EXPECT_LE(tile.columnCount(), 32u);
+    for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+      for (std::size_t column = tile.firstColumn; column < tile.lastColumn;
+           ++column) {
+        ++covered[row * map.cols() + column];
+      }
+    }
+  }
+
+  std::size_t coveredCount = 0;
+  auto point = map.begin();
+  for (int count : covered) {
+    EXPECT_LE(count, 1);
+    if (isIntegrable(sys, *point)) {
+      EXPECT_EQ(count, 1);
+    }
+    coveredCount += count;
+    ++point;
+  }
+  // tiles are trimmed to the disk of the reach, far less than the whole map
+  EXPECT_LT(coveredCount, map.rows() * map.cols() / 2);
+}
+
+TEST(TileSchedulerTest, runsEveryRowOnce) {
+  const Map map(-10.0, -10.0, 10.0, 10.0, 0.1);
+  const std::vector<Tile> tiles = makeTiles(map, buildDefaultSystem());
+  for (unsigned threadCount : {1u, 2u, 7u}) {
+    SCOPED_TRACE(threadCount);
+    TileScheduler scheduler(threadCount);
+    const std::vector<int> counts = visitCounts(scheduler, map, tiles);
+    std::vector<int> expected(counts.size(), 0);
+    for (const auto &tile : tiles) {
+      for (std::size_t row = tile.firstRow; row < tile.lastRow; ++row) {
+        for (std::size_t column = tile.firstColumn; column < tile.lastColumn;
+             ++column) {
+          expected[row * map.cols() + column] = 1;
+        }
+      }
+    }
+    EXPECT_EQ(counts, expected);
+    EXPECT_EQ(scheduler.completedPointCount(), scheduler.pointCount());
+  }
+}
+
+TEST(TileSchedulerTest, splitsExpensiveTileForIdleThreads) {
+  // a single tile, only splitting lets the other threads help
+  const std::vector<Tile> tiles = {{0, 64, 0, 4}};
+  TileScheduler scheduler(4);
+  std::atomic<int> rowCount(0);
+  std::mutex threadsMutex;
+  std::vector<std::thread::id> threads;
+  scheduler.run(tiles, [&](const Tile &) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    ++rowCount;
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    if (std::find(threads.begin(), threads.end(),
+                  std::this_thread::get_id()) == threads.end()) {
+      threads.push_back(std::this_thread::get_id());
+    }
+  });
+  EXPECT_EQ(rowCount, 64);
+  EXPECT_GT(scheduler.splitCount(), 0u);
+  EXPECT_GT(threads.size(), 1u);
+}
+
+TEST(TileSchedulerTest, cancelStopsHandingOutRows) {
+  const std::vector<Tile> tiles = {{0, 1000, 0, 1}};
+  TileScheduler scheduler(2);
+  std::atomic<int> rowCount(0);
+  scheduler.run(tiles, [&](const Tile &) {
+    if (++rowCount == 10)
+      scheduler.cancel();
+  });
+  EXPECT_TRUE(scheduler.isCancelled());
+  EXPECT_LT(rowCount, 20);
+  EXPECT_LT(scheduler.completedPointCount(), scheduler.pointCount());
+}
+
+TEST(TileSchedulerTest, mapMatchesRowByRowIntegration) {
+  const PendulumSystem sys = buildDefaultSystem();
+  auto integrator = [](auto &&dxdt, auto &x, auto &t, auto &h) {
+    return cashKarp54(dxdt, x, t, h, 1e-6, 1e-6, 0.1);
+  };
+
+  Map expectedMap(-2.0, -2.0, 2.0, 2.0, 0.1);
+  Map actualMap = expectedMap;
+  for (auto &&point : expectedMap) {
+    integratePoint(integrator, sys, point, 0.001, 0.5, 0.1, 5.0);
+  }
+
+  TileScheduler scheduler(3);
+  scheduler.run(makeTiles(actualMap, sys, 8, 8), [&](const Tile &row) {
+    const auto rowBegin = actualMap.rowBegin(row.firstRow);
+    for (auto point = rowBegin + row.firstColumn;
+         point != rowBegin + row.lastColumn; ++point) {
+      integratePoint(integrator, sys, *point, 0.001, 0.5, 0.1, 5.0);
+    }
+  });
+
+  auto expected = expectedMap.begin();
+  for (const auto &point : actualMap) {
+    EXPECT_EQ(point.convergePosition, expected->convergePosition);
+    EXPECT_EQ(point.stepCount, expected->stepCount);
+    ++expected;
+  }
+}
+} // namespace staticpendulum
@@ -0,0 +1,107 @@
+#include "CoreEngine/vectorizedpendulumsystem.h"
+#include "testsystems.h"
+#include <cmath>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <type_traits>
+
+namespace staticpendulum {
+namespace {
+// Sum of the magnitudes of the individual attractor forces, the scale of the
+// documented tolerance.
+double forceMagnitudeSum(const PendulumSystem &sys,
+                         const PendulumSystem::StateType &x) {
+  const double sqrtTerm =
+      std::sqrt(1.0 - (x[0] * x[0] + x[1] * x[1]) / (sys.length * sys.length));
+  const double value1 = sys.distance + sys.length * (1.0 - sqrtTerm);
+  double sum = 0.0;
+  for (const auto &attractor : sys.attractorList) {
+    const double dx = x[0] - attractor.xPosition;
+    const double dy = x[1] - attractor.yPosition;
+    const double squaredDistance = dx * dx + dy * dy + value1 * value1;
+    sum += attractor.forceCoeff / squaredDistance;
+  }
+  return sum;
+}
+} // namespace
+
+TEST(VectorizedPendulumSystemTest, alignedAllocatorAlignsStorage) {
+  for (std::size_t size = 1; size < 20; ++size) {
+    AttractorArrays::ArrayType values(size, 1.0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(values.data()) %
+                  attractorArrayAlignment,
+              0u);
+  }
+}
+
+TEST(VectorizedPendulumSystemTest, attractorArraysArePadded) {
+  const PendulumSystem sys = buildRandomSystem(nativeLaneCount + 1);
+  const AttractorArrays arrays(sys.attractorList);
+  EXPECT_EQ(arrays.attractorCount, nativeLaneCount + 1);
+  EXPECT_EQ(arrays.size(), 2 * nativeLaneCount);
+  for (std::size_t i = arrays.attractorCount; i < arrays.size(); ++i) {
+    EXPECT_EQ(arrays.forceCoeffs[i], 0.0);
+  }
+}
+
+TEST(VectorizedPendulumSystemTest, matchesScalarReferenceWithinTolerance) {
+  for (std::size_t count : {1, 3, 9, 100, 1000}) {
+    SCOPED_TRACE(count);
+    const PendulumSystem reference = buildRandomSystem(count);
+    const VectorizedPendulumSystem sys(reference);
+    for (const PendulumSystem::StateType &x :
+         {PendulumSystem::StateType{{0.3, -0.7, 0.4, 0.2}},
+          PendulumSystem::StateType{{-4.0, 2.5, -1.0, 0.0}},
+          PendulumSystem::StateType{{reference.attractorList[0].xPosition,
+                                     reference.attractorList[0].yPosition,
+                                     0.0, 0.0}}}) {
+      PendulumSystem::StateType expected;
+      PendulumSystem::StateType actual;
+      reference(x, expected, 0.0);
+      sys(x, actual, 0.0);
+      const double tolerance =
+          1e-14 * forceMagnitudeSum(reference, x) / reference.mass;
+      EXPECT_EQ(actual[0], expected[0]);
+      EXPECT_EQ(actual[1], expected[1]);
+      EXPECT_NEAR(actual[2], expected[2], tolerance);
+      EXPECT_NEAR(actual[3], expected[3], tolerance);
+    }
+  }
+}
+
+TEST(VectorizedPendulumSystemTest, batchMatchesScalarPerLane) {
+  const VectorizedPendulumSystem sys(buildRandomSystem(50));
+  BatchState<4, 4> x;
+  BatchState<4, 4> dxdt;
+  for (std::size_t l = 0; l < 4; ++l) {
+    x[0][l] = 0.5 * l - 1.0;
+    x[1][l] = 0.3 - 0.2 * l;
+    x[2][l] = 0.1 * l;
+    x[3][l] = -0.1;
+  }
+  sys(x, dxdt, LaneArray<double, 4>{});
+
+  for (std::size_t l = 0; l < 4; ++l) {
+    const PendulumSystem::StateType laneState = {
+        {x[0][l], x[1][l], x[2][l], x[3][l]}};
+    PendulumSystem::StateType laneDerivative;
+    sys(laneState, laneDerivative, 0.0);
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_EQ(dxdt[i][l], laneDerivative[i]);
+    }
+  }
+}
+
+TEST(VectorizedPendulumSystemTest, dispatchesOnAttractorCount) {
+  auto isVectorized = [](const auto &sys) {
+    return std::is_same<std::decay_t<decltype(sys)>,
+                        VectorizedPendulumSystem>::value;
+  };
+
+  EXPECT_FALSE(withSpecialisedSystem(buildRandomSystem(0), isVectorized));
+  EXPECT_FALSE(withSpecialisedSystem(
+      buildRandomSystem(maximumFixedAttractorCount), isVectorized));
+  EXPECT_TRUE(withSpecialisedSystem(
+      buildRandomSystem(maximumFixedAttractorCount + 1), isVectorized));
+}
+} // namespace staticpendulum
@@ -1,9 +1,13 @@
 #include <QString>
 #include <QtTest>
 #include <array>
+#include "CoreEngine/bogackishampine32.h"
 #include "CoreEngine/cashkarp54.h"
+#include "CoreEngine/dormandprince54.h"
+#include "CoreEngine/dormandprince853.h"
 #include "CoreEngine/pendulummapintegrator.h"
 #include "CoreEngine/pendulumsystem.h"
+#include "CoreEngine/verner65.h"
 #include <cmath>
 
 using namespace staticpendulum;
@@ -22,6 +26,10 @@ public:
 private Q_SLOTS:
   void benchmark1_data();
   void benchmark1();
+  void benchmarkBatch_data();
+  void benchmarkBatch();
+  void benchmarkTableaus_data();
+  void benchmarkTableaus();
 };
 
 IntegrationBenchmarks::IntegrationBenchmarks()
@@ -57,6 +65,101 @@ void IntegrationBenchmarks::benchmark1()
   }
 }
 
+void IntegrationBenchmarks::benchmarkBatch_data() { benchmark1_data(); }
+
+void IntegrationBenchmarks::benchmarkBatch()
+{
+  QFETCH(StateType, state);
+  QFETCH(PendulumSystem, system);
+  QBENCHMARK {
+    // same state in every lane to compare against benchmark1 per point
+    const double endTime = 20.0;
+    BatchState<4, nativeLaneCount> states;
+    BatchState<4, nativeLaneCount> derivatives;
+    LaneArray<double, nativeLaneCount> t;
+    LaneArray<double, nativeLaneCount> step;
+    LaneArray<int, nativeLaneCount> accepted;
+    for (std::size_t l = 0; l < nativeLaneCount; ++l) {
+      for (std::size_t i = 0; i < 4; ++i) {
+        states[i][l] = state[i];
+      }
+      t[l] = 0.0;
+      step[l] = 0.01;
+    }
+    system(states, derivatives, t);
+    while (t[0] < endTime) {
+      explicitRungeKuttaBatch<CashKarp54Tableau>(
+          system, states, derivatives, t, step, accepted, 1e-7, 1e-7, 0.1);
+    }
+  }
+}
+
+void IntegrationBenchmarks::benchmarkTableaus_data()
+{
+  QTest::addColumn<StateType>("state");
+  QTest::addColumn<PendulumSystem>("system");
+  QTest::addColumn<int>("tableau");
+  QTest::addColumn<double>("tolerance");
+  PendulumSystem sys;
+  const double yMag = std::sqrt(1 - 0.5 * 0.5);
+  sys.attractorList.emplace_back(-0.5, yMag, 1);
+  sys.attractorList.emplace_back(-0.5, -yMag, 1);
+  sys.attractorList.emplace_back(1.0, 0.0, 1);
+  const StateType state{{2.5, -4.5, 0.1, -0.2}};
+  const char *names[] = {"CashKarp54", "DormandPrince54", "BogackiShampine32",
+                         "Verner65", "DormandPrince853"};
+  for (int tableau = 0; tableau < 5; ++tableau) {
+    for (double tolerance : {1e-5, 1e-7, 1e-10}) {
+      QTest::newRow(
+          qPrintable(QString("%1 tol=%2").arg(names[tableau]).arg(tolerance)))
+          << state << sys << tableau << tolerance;
+    }
+  }
+}
+
+namespace {
+template <typename Tableau>
+void integrateTableau(const PendulumSystem &system, StateType state,
+                      double tolerance)
+{
+  StateType dxdt;
+  double t = 0.0;
+  double step = 0.01;
+  system(state, dxdt, t);
+  while (t < 20.0) {
+    explicitRungeKutta<Tableau>(system, state, dxdt, t, step, tolerance,
+                                tolerance, 0.1);
+  }
+}
+} // namespace
+
+void IntegrationBenchmarks::benchmarkTableaus()
+{
+  QFETCH(StateType, state);
+  QFETCH(PendulumSystem, system);
+  QFETCH(int, tableau);
+  QFETCH(double, tolerance);
+  QBENCHMARK {
+    switch (tableau) {
+    case 0:
+      integrateTableau<CashKarp54Tableau>(system, state, tolerance);
+      break;
+    case 1:
+      integrateTableau<DormandPrince54Tableau>(system, state, tolerance);
+      break;
+    case 2:
+      integrateTableau<BogackiShampine32Tableau>(system, state, tolerance);
+      break;
+    case 3:
+      integrateTableau<Verner65Tableau>(system, state, tolerance);
+      break;
+    case 4:
+      integrateTableau<DormandPrince853Tableau>(system, state, tolerance);
+      break;
+    }
+  }
+}
+
 QTEST_APPLESS_MAIN(IntegrationBenchmarks)
 
 #include "tst_integrationbenchmarks.moc"